@@ -332,6 +332,26 @@ typedef struct
     uint32_t count;
 } daxa_ResetTimestampsInfo;
 
+typedef struct
+{
+    daxa_QueryPool * query_pool;
+    uint32_t query_index;
+} daxa_QueryInfo;
+
+typedef struct
+{
+    daxa_QueryPool * query_pool;
+    uint32_t start_index;
+    uint32_t count;
+} daxa_ResetQueriesInfo;
+
+typedef struct
+{
+    daxa_BufferId buffer;
+    size_t offset;
+    daxa_Bool8 inverted;
+} daxa_ConditionalRenderingInfo;
+
 typedef struct
 {
     daxa_f32vec4 label_color;
@@ -344,6 +364,17 @@ typedef struct
     VkPipelineStageFlags stage_masks;
 } daxa_ResetEventInfo;
 
+typedef struct
+{
+    // Binding slot the buffer will be bound to.
+    uint32_t slot;
+    daxa_BufferId buffer;
+    size_t size;
+    size_t offset;
+} daxa_SetUniformBufferInfo;
+
+static daxa_SetUniformBufferInfo const DAXA_DEFAULT_SET_UNIFORM_BUFFER_INFO = DAXA_ZERO_INIT;
+
 typedef struct
 {
     float constant_factor;
@@ -376,6 +407,27 @@ typedef struct
 
 static daxa_BuildAccelerationStucturesInfo const DAXA_DEFAULT_BUILD_ACCELERATION_STRUCTURES_INFO = DAXA_ZERO_INIT;
 
+typedef struct
+{
+    daxa_BlasId const * blas;
+    size_t blas_count;
+    // Receives one uint64_t compacted size per blas, tightly packed.
+    daxa_BufferId dst_buffer;
+    size_t dst_offset;
+} daxa_WriteBlasCompactedSizesInfo;
+
+static daxa_WriteBlasCompactedSizesInfo const DAXA_DEFAULT_WRITE_BLAS_COMPACTED_SIZES_INFO = DAXA_ZERO_INIT;
+
+typedef struct
+{
+    daxa_BlasId src_blas;
+    daxa_BlasId dst_blas;
+    // When set, src_blas is compacted into dst_blas, which only needs to be as large as the compacted size.
+    daxa_Bool8 compact;
+} daxa_BlasCopyInfo;
+
+static daxa_BlasCopyInfo const DAXA_DEFAULT_BLAS_COPY_INFO = DAXA_ZERO_INIT;
+
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_copy_buffer_to_buffer(daxa_CommandRecorder cmd_enc, daxa_BufferCopyInfo const * info);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
@@ -388,6 +440,10 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_blit_image_to_image(daxa_CommandRecorder cmd_enc, daxa_ImageBlitInfo const * info);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_build_acceleration_structures(daxa_CommandRecorder cmd_rec, daxa_BuildAccelerationStucturesInfo const * info);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_write_blas_compacted_sizes(daxa_CommandRecorder cmd_rec, daxa_WriteBlasCompactedSizesInfo const * info);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_copy_blas_to_blas(daxa_CommandRecorder cmd_rec, daxa_BlasCopyInfo const * info);
 
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_clear_buffer(daxa_CommandRecorder cmd_enc, daxa_BufferClearInfo const * info);
@@ -415,6 +471,14 @@ daxa_cmd_reset_event(daxa_CommandRecorder cmd_enc, daxa_ResetEventInfo const * i
 
 DAXA_EXPORT void
 daxa_cmd_push_constant(daxa_CommandRecorder cmd_enc, void const * data, uint32_t size);
+/// @brief  Binds a buffer range as a uniform buffer to the given slot of the uniform buffer set (set 1).
+///         The bindings are pushed as push descriptors right before the next draw, dispatch or trace rays command,
+///         so they can be set before or after setting the pipeline. Bindings stay set until they are overwritten.
+///         The offset must be a multiple of min_uniform_buffer_offset_alignment.
+///         Fails with DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_PUSH_DESCRIPTOR when the device lacks VK_KHR_push_descriptor.
+/// @param info parameters.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_set_uniform_buffer(daxa_CommandRecorder cmd_enc, daxa_SetUniformBufferInfo const * info);
 DAXA_EXPORT void
 daxa_cmd_set_ray_tracing_pipeline(daxa_CommandRecorder cmd_enc, daxa_RayTracingPipeline pipeline);
 DAXA_EXPORT void
@@ -447,6 +511,15 @@ daxa_cmd_destroy_image_view_deferred(daxa_CommandRecorder cmd_enc, daxa_ImageVie
 /// @param id image sampler be destroyed after command list finishes.
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_destroy_sampler_deferred(daxa_CommandRecorder cmd_enc, daxa_SamplerId id);
+/// @brief  Destroys the tlas AFTER the gpu is finished executing the command list.
+/// @param id tlas to be destroyed after command list finishes.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_destroy_tlas_deferred(daxa_CommandRecorder cmd_enc, daxa_TlasId id);
+/// @brief  Destroys the blas AFTER the gpu is finished executing the command list.
+///         Useful to release the original blas after recording a compacting copy.
+/// @param id blas to be destroyed after command list finishes.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_destroy_blas_deferred(daxa_CommandRecorder cmd_enc, daxa_BlasId id);
 
 
 
@@ -490,6 +563,18 @@ DAXA_EXPORT void
 daxa_cmd_write_timestamp(daxa_CommandRecorder cmd_enc, daxa_WriteTimestampInfo const * info);
 DAXA_EXPORT void
 daxa_cmd_reset_timestamps(daxa_CommandRecorder cmd_enc, daxa_ResetTimestampsInfo const * info);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_begin_query(daxa_CommandRecorder cmd_enc, daxa_QueryInfo const * info);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_end_query(daxa_CommandRecorder cmd_enc, daxa_QueryInfo const * info);
+// Must be recorded outside of renderpasses.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_reset_queries(daxa_CommandRecorder cmd_enc, daxa_ResetQueriesInfo const * info);
+// Requires DAXA_DEVICE_FLAG_CONDITIONAL_RENDERING. Must be recorded outside of renderpasses and can not be nested.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_begin_conditional_rendering(daxa_CommandRecorder cmd_enc, daxa_ConditionalRenderingInfo const * info);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_end_conditional_rendering(daxa_CommandRecorder cmd_enc);
 
 DAXA_EXPORT void
 daxa_cmd_begin_label(daxa_CommandRecorder cmd_enc, daxa_CommandLabelInfo const * info);
@@ -42,6 +42,7 @@ typedef struct daxa_ImplBinarySemaphore * daxa_BinarySemaphore;
 typedef struct daxa_ImplTimelineSemaphore * daxa_TimelineSemaphore;
 typedef struct daxa_ImplEvent * daxa_Event;
 typedef struct daxa_ImplTimelineQueryPool * daxa_TimelineQueryPool;
+typedef struct daxa_ImplQueryPool * daxa_QueryPool;
 typedef struct daxa_ImplMemoryBlock * daxa_MemoryBlock;
 
 typedef uint64_t daxa_Flags;
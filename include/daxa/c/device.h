@@ -213,6 +213,10 @@ typedef struct
     daxa_Optional(daxa_RayTracingPipelineProperties) ray_tracing_pipeline_properties;
     daxa_Optional(daxa_AccelerationStructureProperties) acceleration_structure_properties;
     daxa_Optional(daxa_RayTracingInvocationReorderProperties) ray_tracing_invocation_reorder_properties;
+    // VK_KHR_push_descriptor is enabled when supported, set_uniform_buffer requires it.
+    daxa_Bool8 push_descriptor_supported;
+    // VK_EXT_memory_budget is enabled when supported, it makes the heap budgets of memory reports exact.
+    daxa_Bool8 memory_budget_supported;
 } daxa_DeviceProperties;
 
 DAXA_EXPORT int32_t
@@ -227,6 +231,14 @@ typedef enum
     DAXA_DEVICE_FLAG_IMAGE_ATOMIC64 = 0x1 << 4,
     DAXA_DEVICE_FLAG_VK_MEMORY_MODEL = 0x1 << 5,
     DAXA_DEVICE_FLAG_RAY_TRACING = 0x1 << 6,
+    // Deduplicates samplers with identical infos (ignoring the name). Destroying a shared sampler only decrements its refcount.
+    DAXA_DEVICE_FLAG_SAMPLER_CACHE = 0x1 << 7,
+    // Enables pipeline statistics query pools.
+    DAXA_DEVICE_FLAG_PIPELINE_STATISTICS_QUERY = 0x1 << 8,
+    // Retires zombies on a device owned thread as soon as the gpu finished using them.
+    DAXA_DEVICE_FLAG_BACKGROUND_GARBAGE_COLLECTION = 0x1 << 9,
+    // Enables VK_EXT_conditional_rendering, commands can be skipped based on a value in a buffer.
+    DAXA_DEVICE_FLAG_CONDITIONAL_RENDERING = 0x1 << 10,
 } daxa_DeviceFlagBits;
 
 typedef uint32_t daxa_DeviceFlags;
@@ -252,6 +264,92 @@ static daxa_DeviceInfo const DAXA_DEFAULT_DEVICE_INFO = {
     .name = DAXA_ZERO_INIT,
 };
 
+typedef struct
+{
+    VkDeviceSize heap_size;
+    VkMemoryHeapFlags heap_flags;
+    // Device memory blocks allocated by daxa from this heap.
+    uint64_t block_bytes;
+    uint32_t block_count;
+    // Live allocations within those blocks.
+    uint64_t allocation_bytes;
+    uint32_t allocation_count;
+    // Memory used by the whole process and the memory available to it in this heap.
+    // Only exact when the device supports VK_EXT_memory_budget, otherwise they are estimated from daxa's own allocations.
+    uint64_t usage;
+    uint64_t budget;
+} daxa_MemoryHeapReport;
+
+typedef struct
+{
+    uint32_t heap_count;
+    daxa_MemoryHeapReport heaps[16U];
+    daxa_Bool8 memory_budget_supported;
+    // Live memory per resource type.
+    // Buffers and images placed in memory blocks are only counted as part of the memory block.
+    uint64_t buffer_bytes;
+    uint64_t buffer_count;
+    uint64_t image_bytes;
+    uint64_t image_count;
+    uint64_t memory_block_bytes;
+    uint64_t memory_block_count;
+    // Memory blocks allocated by task graphs for their transient resources, these are not part of memory_block_bytes.
+    uint64_t transient_memory_block_bytes;
+    uint64_t transient_memory_block_count;
+    // Acceleration structures live in buffers, their bytes are also counted in the bytes of their buffers.
+    uint64_t tlas_bytes;
+    uint64_t tlas_count;
+    uint64_t blas_bytes;
+    uint64_t blas_count;
+} daxa_MemoryReport;
+
+typedef struct
+{
+    daxa_ImageId image;
+    // Layout the image is in when the gpu executes the copies of a pass. A moved image is left in this layout.
+    daxa_ImageLayout layout;
+} daxa_DefragmentationImage;
+
+typedef struct
+{
+    // Per call budget, one call performs at most one defragmentation pass.
+    uint64_t max_bytes_per_pass;
+    uint32_t max_allocations_per_pass;
+    // Moving a buffer changes its device address, so buffer moves must be explicitly enabled.
+    // Host mapped buffers and buffers backing acceleration structures are never moved.
+    daxa_Bool8 move_buffers;
+    // Images are only moved when they are listed here together with their layout.
+    // Of those, only images with transfer src and dst usage and without attachment or storage usage are moved.
+    daxa_DefragmentationImage const * movable_images;
+    uint64_t movable_image_count;
+} daxa_DefragmentationInfo;
+
+static daxa_DefragmentationInfo const DAXA_DEFAULT_DEFRAGMENTATION_INFO = {
+    .max_bytes_per_pass = 1ull << 24ull,
+    .max_allocations_per_pass = 64,
+    .move_buffers = 0,
+    .movable_images = 0,
+    .movable_image_count = 0,
+};
+
+typedef struct
+{
+    // A defragmentation is still running after this call, it continues with the next call.
+    daxa_Bool8 in_progress;
+    // Resources whose gpu copies were submitted in this call.
+    uint32_t moved_buffer_count;
+    uint32_t moved_image_count;
+    uint64_t moved_bytes;
+    // A defragmentation finished since the last call, the totals below describe it.
+    daxa_Bool8 completed;
+    uint64_t total_bytes_moved;
+    uint64_t total_bytes_freed;
+    uint32_t total_allocations_moved;
+    uint32_t total_device_memory_blocks_freed;
+} daxa_DefragmentationStatus;
+
+typedef void (*daxa_TimelineCallback)(void * user_data);
+
 typedef struct
 {
     VkPipelineStageFlags wait_stages;
@@ -352,6 +450,14 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_tlas_from_buffer(daxa_Device device, daxa_BufferTlasInfo const * info, daxa_TlasId * out_id);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_blas_from_buffer(daxa_Device device, daxa_BufferBlasInfo const * info, daxa_BlasId * out_id);
+// Batched variants create either all resources or none.
+// They reserve all slots up front and write the descriptors of all resources at once.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_buffers(daxa_Device device, daxa_BufferInfo const * infos, size_t info_count, daxa_BufferId * out_ids);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_images(daxa_Device device, daxa_ImageInfo const * infos, size_t info_count, daxa_ImageId * out_ids);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_image_views(daxa_Device device, daxa_ImageViewInfo const * infos, size_t info_count, daxa_ImageViewId * out_ids);
 
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_destroy_buffer(daxa_Device device, daxa_BufferId buffer);
@@ -365,6 +471,13 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_destroy_tlas(daxa_Device device, daxa_TlasId tlas);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_destroy_blas(daxa_Device device, daxa_BlasId blas);
+// Batched variants destroy all valid ids, taking the zombie lock once. Returns the invalid id error if any id was invalid.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_destroy_buffers(daxa_Device device, daxa_BufferId const * buffers, size_t buffer_count);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_destroy_images(daxa_Device device, daxa_ImageId const * images, size_t image_count);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_destroy_image_views(daxa_Device device, daxa_ImageViewId const * ids, size_t id_count);
 
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_info_buffer(daxa_Device device, daxa_BufferId buffer, daxa_BufferInfo * out_info);
@@ -432,6 +545,8 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_event(daxa_Device device, daxa_EventInfo const * info, daxa_Event * out_event);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_timeline_query_pool(daxa_Device device, daxa_TimelineQueryPoolInfo const * info, daxa_TimelineQueryPool * out_timeline_query_pool);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_query_pool(daxa_Device device, daxa_QueryPoolInfo const * info, daxa_QueryPool * out_query_pool);
 
 DAXA_EXPORT daxa_DeviceInfo const *
 daxa_dvc_info(daxa_Device device);
@@ -450,6 +565,15 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_collect_garbage(daxa_Device device);
 DAXA_EXPORT daxa_DeviceProperties const *
 daxa_dvc_properties(daxa_Device device);
+// Does not synchronize with the gpu, cheap enough to be called every frame.
+DAXA_EXPORT void
+daxa_dvc_memory_report(daxa_Device device, daxa_MemoryReport * out_report);
+// Performs one incremental defragmentation pass, see Device::defragment.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_defragment(daxa_Device device, daxa_DefragmentationInfo const * info, daxa_DefragmentationStatus * out_status);
+// Invokes the callback once the timeline semaphore reached the value, see Device::on_timeline_reached.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_on_timeline_reached(daxa_Device device, daxa_TimelineSemaphore semaphore, uint64_t value, daxa_TimelineCallback callback, void * user_data);
 
 // Returns previous ref count.
 DAXA_EXPORT uint64_t
@@ -250,6 +250,9 @@ typedef struct
     daxa_TlasInstanceInfo const * instances;
     uint32_t instance_count;
     daxa_DeviceAddress scratch_data;
+    // When set, the build updates (refits) src_tlas into dst_tlas instead of building from scratch.
+    // src_tlas must have been built with DAXA_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE. It may be the same as dst_tlas.
+    daxa_TlasId src_tlas;
 } daxa_TlasBuildInfo;
 
 static daxa_TlasBuildInfo const DAXA_DEFAULT_TLAS_BUILD_INFO = {
@@ -258,6 +261,7 @@ static daxa_TlasBuildInfo const DAXA_DEFAULT_TLAS_BUILD_INFO = {
     .instances = DAXA_ZERO_INIT,
     .instance_count = DAXA_ZERO_INIT,
     .scratch_data = DAXA_ZERO_INIT,
+    .src_tlas = DAXA_ZERO_INIT,
 };
 
 typedef struct
@@ -266,6 +270,9 @@ typedef struct
     daxa_BlasId dst_blas;
     daxa_Variant(daxa_BlasGeometryInfoSpansUnion) geometries;
     daxa_DeviceAddress scratch_data;
+    // When set, the build updates (refits) src_blas into dst_blas instead of building from scratch.
+    // src_blas must have been built with DAXA_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE. It may be the same as dst_blas.
+    daxa_BlasId src_blas;
 } daxa_BlasBuildInfo;
 
 static daxa_BlasBuildInfo const DAXA_DEFAULT_BLAS_BUILD_INFO = {
@@ -273,6 +280,7 @@ static daxa_BlasBuildInfo const DAXA_DEFAULT_BLAS_BUILD_INFO = {
     .dst_blas = DAXA_ZERO_INIT,
     .geometries = DAXA_ZERO_INIT,
     .scratch_data = DAXA_ZERO_INIT,
+    .src_blas = DAXA_ZERO_INIT,
 };
 
 typedef struct
@@ -104,6 +104,11 @@ typedef enum
     DAXA_RESULT_INVALID_TLAS_ID = (1 << 30) + 52,
     DAXA_RESULT_INVALID_BLAS_ID = (1 << 30) + 53,
     DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING = (1 << 30) + 54,
+    DAXA_RESULT_INVALID_WITHOUT_ENABLING_PIPELINE_STATISTICS_QUERY = (1 << 30) + 55,
+    DAXA_RESULT_COMMAND_INVALID_WITHIN_RENDERPASS = (1 << 30) + 56,
+    DAXA_RESULT_INVALID_WITHOUT_ENABLING_CONDITIONAL_RENDERING = (1 << 30) + 57,
+    DAXA_RESULT_UNBALANCED_CONDITIONAL_RENDERING = (1 << 30) + 58,
+    DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_PUSH_DESCRIPTOR = (1 << 30) + 59,
     DAXA_RESULT_MAX_ENUM = 0x7FFFFFFF,
 } daxa_Result;
 
@@ -202,6 +207,8 @@ typedef struct
 {
     VkMemoryRequirements requirements;
     daxa_MemoryFlags flags;
+    // Reports the block in the transient memory block fields of the memory report, used for task graph transient memory.
+    daxa_Bool8 transient;
 } daxa_MemoryBlockInfo;
 
 DAXA_EXPORT daxa_MemoryBlockInfo const *
@@ -229,4 +236,31 @@ daxa_timeline_query_pool_inc_refcnt(daxa_TimelineQueryPool timeline_query_pool);
 DAXA_EXPORT uint64_t
 daxa_timeline_query_pool_dec_refcnt(daxa_TimelineQueryPool timeline_query_pool);
 
+// Only occlusion and pipeline statistics queries are supported.
+// Pipeline statistics queries require the device flag DAXA_DEVICE_FLAG_PIPELINE_STATISTICS_QUERY.
+typedef struct
+{
+    VkQueryType query_type;
+    VkQueryPipelineStatisticFlags pipeline_statistics;
+    uint32_t query_count;
+    daxa_SmallString name;
+} daxa_QueryPoolInfo;
+
+DAXA_EXPORT daxa_QueryPoolInfo const *
+daxa_query_pool_info(daxa_QueryPool query_pool);
+
+// Returns the number of values each query writes, the statistic count for pipeline statistics queries, 1 otherwise.
+DAXA_EXPORT uint32_t
+daxa_query_pool_value_count(daxa_QueryPool query_pool);
+
+// Does not wait for the queries. Writes (value_count + 1) values per query, the last one being the availability.
+// Returns DAXA_RESULT_NOT_READY when some of the queries are not yet available.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_query_pool_query_results(daxa_QueryPool query_pool, uint32_t start, uint32_t count, uint64_t * out_results);
+
+DAXA_EXPORT uint64_t
+daxa_query_pool_inc_refcnt(daxa_QueryPool query_pool);
+DAXA_EXPORT uint64_t
+daxa_query_pool_dec_refcnt(daxa_QueryPool query_pool);
+
 #endif // #ifndef __DAXA_TYPES_H__
@@ -209,6 +209,26 @@ namespace daxa
         u32 count = {};
     };
 
+    struct QueryInfo
+    {
+        QueryPool & query_pool;
+        u32 query_index = {};
+    };
+
+    struct ResetQueriesInfo
+    {
+        QueryPool & query_pool;
+        u32 start_index = {};
+        u32 count = {};
+    };
+
+    struct ConditionalRenderingInfo
+    {
+        BufferId buffer = {};
+        usize offset = {};
+        bool inverted = {};
+    };
+
     struct CommandLabelInfo
     {
         std::array<f32, 4> label_color = {0.463f, 0.333f, 0.671f, 1.0f};
@@ -244,6 +264,22 @@ namespace daxa
         std::span<BlasBuildInfo const> blas_build_infos = {};
     };
 
+    struct WriteBlasCompactedSizesInfo
+    {
+        std::span<BlasId const> blas = {};
+        /// @brief  Receives one u64 compacted size per blas, tightly packed.
+        BufferId dst_buffer = {};
+        usize dst_offset = {};
+    };
+
+    struct BlasCopyInfo
+    {
+        BlasId src_blas = {};
+        BlasId dst_blas = {};
+        /// @brief  When set, src_blas is compacted into dst_blas, which only needs to be as large as the compacted size.
+        bool compact = {};
+    };
+
     struct DAXA_EXPORT_CXX ExecutableCommandList : ManagedPtr<ExecutableCommandList, daxa_ExecutableCommandList>
     {
       protected:
@@ -279,6 +315,12 @@ namespace daxa
         {
             push_constant_vptr(&constant, static_cast<u32>(sizeof(T)));
         }
+        /// @brief  Binds a buffer range as a uniform buffer to the given slot of the uniform buffer set (set 1).
+        ///         The binding is pushed as a push descriptor right before the next draw/dispatch, so it can be set before or after set_pipeline.
+        ///         Bindings stay set until overwritten or until the current commands are completed.
+        ///         Requires DeviceProperties::push_descriptor_supported.
+        /// @param info parameters.
+        void set_uniform_buffer(SetUniformBufferInfo const & info);
         void set_pipeline(RasterPipeline const & pipeline);
         void set_viewport(ViewportInfo const & info);
         void set_scissor(Rect2D const & info);
@@ -335,6 +377,13 @@ namespace daxa
         void clear_buffer(BufferClearInfo const & info);
         void clear_image(ImageClearInfo const & info);
         void build_acceleration_structures(BuildAccelerationStructuresInfo const & info);
+        /// @brief  Writes the compacted sizes of the given blas into a buffer.
+        ///         The blas must be built with ALLOW_COMPACTION and the builds must be made visible to
+        ///         ACCELERATION_STRUCTURE_BUILD reads with a pipeline barrier beforehand.
+        ///         The sizes can be read after the command list finished executing.
+        /// @param info parameters.
+        void write_blas_compacted_sizes(WriteBlasCompactedSizesInfo const & info);
+        void copy_blas_to_blas(BlasCopyInfo const & info);
 
         /// @brief  Successive pipeline barrier calls are combined.
         ///         As soon as a non-pipeline barrier command is recorded, the currently recorded barriers are flushed with a vkCmdPipelineBarrier2 call.
@@ -355,6 +404,12 @@ namespace daxa
         {
             push_constant_vptr(&constant, static_cast<u32>(sizeof(T)));
         }
+        /// @brief  Binds a buffer range as a uniform buffer to the given slot of the uniform buffer set (set 1).
+        ///         The binding is pushed as a push descriptor right before the next draw/dispatch, so it can be set before or after set_pipeline.
+        ///         Bindings stay set until overwritten or until the current commands are completed.
+        ///         Requires DeviceProperties::push_descriptor_supported.
+        /// @param info parameters.
+        void set_uniform_buffer(SetUniformBufferInfo const & info);
         void set_pipeline(ComputePipeline const & pipeline);
         void dispatch(DispatchInfo const & info);
         void dispatch_indirect(DispatchIndirectInfo const & info);
@@ -379,6 +434,15 @@ namespace daxa
         ///         Useful for large uploads exceeding staging memory pools.
         /// @param id image sampler be destroyed after command list finishes.
         void destroy_sampler_deferred(SamplerId id);
+        /// @brief  Destroys the tlas AFTER the gpu is finished executing the command list.
+        ///         Zombifies object after submitting the commands.
+        /// @param id tlas to be destroyed after command list finishes.
+        void destroy_tlas_deferred(TlasId id);
+        /// @brief  Destroys the blas AFTER the gpu is finished executing the command list.
+        ///         Zombifies object after submitting the commands.
+        ///         Useful to release the original blas after recording a compacting copy.
+        /// @param id blas to be destroyed after command list finishes.
+        void destroy_blas_deferred(BlasId id);
 
         /// @brief  Starts a renderpass scope akin to the dynamic rendering feature in vulkan.
         ///         Between the begin and end renderpass commands, the renderpass persists and drawcalls can be recorded.
@@ -403,6 +467,17 @@ namespace daxa
 
         void write_timestamp(WriteTimestampInfo const & info);
         void reset_timestamps(ResetTimestampsInfo const & info);
+        void begin_query(QueryInfo const & info);
+        void end_query(QueryInfo const & info);
+        /// @brief  Must be recorded outside of renderpasses.
+        void reset_queries(ResetQueriesInfo const & info);
+        /// @brief  Requires the CONDITIONAL_RENDERING device flag.
+        ///         Until end_conditional_rendering, draws, dispatches and their indirect variants are skipped by the gpu
+        ///         when the u32 at the given 4 byte aligned buffer offset is zero (or non zero when inverted).
+        ///         Copies, clears and barriers are always executed. The value is read at the CONDITIONAL_RENDERING pipeline stage.
+        ///         Must be recorded outside of renderpasses, renderpasses can be begun and ended in between. Can not be nested.
+        void begin_conditional_rendering(ConditionalRenderingInfo const & info);
+        void end_conditional_rendering();
 
         void begin_label(CommandLabelInfo const & info);
         void end_label();
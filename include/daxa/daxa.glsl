@@ -243,6 +243,12 @@ DAXA_ACCELERATION_STRUCTURE_LAYOUT uniform accelerationStructureEXT daxa_Acceler
         STRUCT NAME;                                          \
     };
 
+/// @brief Declares a uniform buffer block that is bound with set_uniform_buffer.
+/// @param SLOT Slot the buffer is bound to with set_uniform_buffer.
+/// Usage example:
+///     DAXA_DECL_UNIFORM_BUFFER(0) MyConstants { daxa_f32mat4x4 view_proj; } constants;
+#define DAXA_DECL_UNIFORM_BUFFER(SLOT) layout(scalar, set = DAXA_CONSTANT_BUFFER_BINDING_SET, binding = SLOT) uniform
+
 /// @brief  Can be used to define a specialized way to access image views.
 ///         Daxa only provides default accessors with no annotations, meaning that there is no way to get the glsl functionality of restrict, readonly, etc..
 //          As the permutation count is gigantic, daxa does not predefine all possible accessors, instead the user can declare more specialized accessors themselfes.
@@ -6,6 +6,7 @@
 #define DAXA_SAMPLER_BINDING 3
 #define DAXA_BUFFER_DEVICE_ADDRESS_BUFFER_BINDING 4
 #define DAXA_ACCELERATION_STRUCTURE_BINDING 5
+#define DAXA_CONSTANT_BUFFER_BINDING_SET 1
 #define DAXA_ID_INDEX_BITS 20
 #define DAXA_ID_INDEX_MASK ((uint64_t(1) << DAXA_ID_INDEX_BITS) - uint64_t(1))
 #define DAXA_ID_INDEX_OFFSTET 0
@@ -135,6 +136,11 @@ namespace daxa
 #define daxa_ByteAddressBuffer(SAMPLER_ID) daxa::ByteAddressBufferTable[SAMPLER_ID.index()]
 #define daxa_RWByteAddressBuffer(SAMPLER_ID) daxa::RWByteAddressBufferTable[SAMPLER_ID.index()]
 
+/// @brief Annotates a ConstantBuffer bound with set_uniform_buffer.
+/// Usage example:
+///     DAXA_DECL_UNIFORM_BUFFER(0) ConstantBuffer<MyConstants> constants;
+#define DAXA_DECL_UNIFORM_BUFFER(SLOT) [[vk::binding(SLOT, DAXA_CONSTANT_BUFFER_BINDING_SET)]]
+
 #define DAXA_DECL_BUFFER_PTR_ALIGN(Type, Align) DAXA_DECL_BUFFER_PTR(Type)
 #define DAXA_DECL_BUFFER_PTR(Type)                                                                              \
     namespace daxa                                                                                              \
@@ -1,6 +1,7 @@
 #pragma once
 
 #define DAXA_GPU_TABLE_SET_BINDING 0
+#define DAXA_CONSTANT_BUFFER_BINDING_SET 1
 #define DAXA_STORAGE_BUFFER_BINDING 0
 #define DAXA_STORAGE_IMAGE_BINDING 1
 #define DAXA_SAMPLED_IMAGE_BINDING 2
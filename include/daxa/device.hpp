@@ -7,6 +7,8 @@
 #include <daxa/command_recorder.hpp>
 #include <daxa/sync.hpp>
 
+#include <functional>
+
 namespace daxa
 {
     enum struct DeviceType
@@ -204,6 +206,10 @@ namespace daxa
         Optional<RayTracingPipelineProperties> ray_tracing_properties = {};
         Optional<AccelerationStructureProperties> acceleration_structure_properties = {};
         Optional<InvocationReorderProperties> invocation_reorder_properties = {};
+        /// @brief  VK_KHR_push_descriptor is enabled when supported, set_uniform_buffer requires it.
+        bool push_descriptor_supported = {};
+        /// @brief  VK_EXT_memory_budget is enabled when supported, it makes the heap budgets of memory reports exact.
+        bool memory_budget_supported = {};
     };
 
     DAXA_EXPORT_CXX auto default_device_score(DeviceProperties const & device_props) -> i32;
@@ -223,6 +229,17 @@ namespace daxa
         static inline constexpr DeviceFlags IMAGE_ATOMIC64 = {0x1 << 4};
         static inline constexpr DeviceFlags VK_MEMORY_MODEL = {0x1 << 5};
         static inline constexpr DeviceFlags RAY_TRACING = {0x1 << 6};
+        /// @brief  create_sampler returns the same refcounted sampler for identical sampler infos (ignoring the name).
+        ///         Each create_sampler call must be matched by a destroy_sampler call, the sampler is destroyed with its last reference.
+        static inline constexpr DeviceFlags SAMPLER_CACHE = {0x1 << 7};
+        static inline constexpr DeviceFlags PIPELINE_STATISTICS_QUERY = {0x1 << 8};
+        /// @brief  A device owned thread waits on the main queue timeline and destroys zombies as soon as the gpu finished using them,
+        ///         keeping destruction work off the threads submitting work. Manual collect_garbage calls are still possible.
+        ///         The thread skips a collection while command recorders hold the lifetime lock and retries shortly after.
+        static inline constexpr DeviceFlags BACKGROUND_GARBAGE_COLLECTION = {0x1 << 9};
+        /// @brief  Enables begin_conditional_rendering and end_conditional_rendering on command recorders.
+        ///         Draws and dispatches recorded in between are skipped by the gpu when the 32 bit condition value in a buffer is zero.
+        static inline constexpr DeviceFlags CONDITIONAL_RENDERING = {0x1 << 10};
     };
 
     struct DeviceFlags2
@@ -234,6 +251,10 @@ namespace daxa
         u32 image_atomic64 : 1 = 1;
         u32 vk_memory_model : 1 = {};
         u32 ray_tracing : 1 = {};
+        u32 sampler_cache : 1 = {};
+        u32 pipeline_statistics_query : 1 = {};
+        u32 background_garbage_collection : 1 = {};
+        u32 conditional_rendering : 1 = {};
 
         operator DeviceFlags()
         {
@@ -256,6 +277,81 @@ namespace daxa
         SmallString name = "";
     };
 
+    struct MemoryHeapReport
+    {
+        u64 heap_size = {};
+        u32 heap_flags = {};
+        // Device memory blocks allocated by daxa from this heap.
+        u64 block_bytes = {};
+        u32 block_count = {};
+        // Live allocations within those blocks.
+        u64 allocation_bytes = {};
+        u32 allocation_count = {};
+        // Memory used by the whole process and the memory available to it in this heap.
+        // Only exact when memory_budget_supported is set, otherwise they are estimated from daxa's own allocations.
+        u64 usage = {};
+        u64 budget = {};
+    };
+
+    struct MemoryReport
+    {
+        u32 heap_count = {};
+        MemoryHeapReport heaps[16U] = {};
+        bool memory_budget_supported = {};
+        // Live memory per resource type.
+        // Buffers and images placed in memory blocks are only counted as part of the memory block.
+        u64 buffer_bytes = {};
+        u64 buffer_count = {};
+        u64 image_bytes = {};
+        u64 image_count = {};
+        u64 memory_block_bytes = {};
+        u64 memory_block_count = {};
+        // Memory blocks allocated by task graphs for their transient resources, these are not part of memory_block_bytes.
+        u64 transient_memory_block_bytes = {};
+        u64 transient_memory_block_count = {};
+        // Acceleration structures live in buffers, their bytes are also counted in the bytes of their buffers.
+        u64 tlas_bytes = {};
+        u64 tlas_count = {};
+        u64 blas_bytes = {};
+        u64 blas_count = {};
+    };
+
+    struct DefragmentationImage
+    {
+        ImageId image = {};
+        // Layout the image is in when the gpu executes the copies of a pass. A moved image is left in this layout.
+        ImageLayout layout = {};
+    };
+
+    struct DefragmentationInfo
+    {
+        // Per call budget, one call performs at most one defragmentation pass.
+        u64 max_bytes_per_pass = 1ull << 24ull;
+        u32 max_allocations_per_pass = 64;
+        // Moving a buffer changes its device address, so buffer moves must be explicitly enabled.
+        // Host mapped buffers and buffers backing acceleration structures are never moved.
+        bool move_buffers = false;
+        // Images are only moved when they are listed here together with their layout.
+        // Of those, only images with transfer src and dst usage and without attachment or storage usage are moved.
+        std::span<DefragmentationImage const> movable_images = {};
+    };
+
+    struct DefragmentationStatus
+    {
+        // A defragmentation is still running after this call, it continues with the next call.
+        bool in_progress = {};
+        // Resources whose gpu copies were submitted in this call.
+        u32 moved_buffer_count = {};
+        u32 moved_image_count = {};
+        u64 moved_bytes = {};
+        // A defragmentation finished since the last call, the totals below describe it.
+        bool completed = {};
+        u64 total_bytes_moved = {};
+        u64 total_bytes_freed = {};
+        u32 total_allocations_moved = {};
+        u32 total_device_memory_blocks_freed = {};
+    };
+
     struct CommandSubmitInfo
     {
         PipelineStageFlags wait_stages = {};
@@ -337,6 +433,11 @@ namespace daxa
         [[nodiscard]] auto create_blas(BlasInfo const & info) -> BlasId;
         [[nodiscard]] auto create_tlas_from_buffer(BufferTlasInfo const & info) -> TlasId;
         [[nodiscard]] auto create_blas_from_buffer(BufferBlasInfo const & info) -> BlasId;
+        /// @brief  Creates all resources at once, amortizing slot allocation and descriptor writes.
+        ///         Either all or none of the resources are created.
+        [[nodiscard]] auto create_buffers(std::span<BufferInfo const> infos) -> std::vector<BufferId>;
+        [[nodiscard]] auto create_images(std::span<ImageInfo const> infos) -> std::vector<ImageId>;
+        [[nodiscard]] auto create_image_views(std::span<ImageViewInfo const> infos) -> std::vector<ImageViewId>;
 
         void destroy_buffer(BufferId id);
         void destroy_image(ImageId id);
@@ -344,6 +445,10 @@ namespace daxa
         void destroy_sampler(SamplerId id);
         void destroy_tlas(TlasId id);
         void destroy_blas(BlasId id);
+        /// @brief  Destroys all resources at once, taking the zombie lock once.
+        void destroy_buffers(std::span<BufferId const> ids);
+        void destroy_images(std::span<ImageId const> ids);
+        void destroy_image_views(std::span<ImageViewId const> ids);
 
         /// @brief  Daxa stores each create info and keeps it up to date if the object changes
         ///         This is also the case for gpu resources (buffer, image(view), sampler, as).
@@ -392,6 +497,7 @@ namespace daxa
         [[nodiscard]] auto create_timeline_semaphore(TimelineSemaphoreInfo const & info) -> TimelineSemaphore;
         [[nodiscard]] auto create_event(EventInfo const & info) -> Event;
         [[nodiscard]] auto create_timeline_query_pool(TimelineQueryPoolInfo const & info) -> TimelineQueryPool;
+        [[nodiscard]] auto create_query_pool(QueryPoolInfo const & info) -> QueryPool;
 
         /// THREADSAFETY:
         /// * reference MUST NOT be read after the device is destroyed.
@@ -413,10 +519,33 @@ namespace daxa
         ///   you can freely record those in parallel with collect_garbage
         void collect_garbage();
 
+        /// @brief  Performs one pass of an incremental defragmentation of the memory daxa allocated for buffers and images.
+        ///         Moved resources keep their ids. Their contents are copied on the main queue,
+        ///         their vulkan handles and descriptors are replaced and the old allocations are freed
+        ///         by collect_garbage once the gpu finished the copies.
+        ///         Call it once per frame until the returned status is no longer in progress.
+        /// NOTE:
+        /// * like collect_garbage, this function blocks until it gains an exclusive resource lock
+        /// * executable command lists recorded before the call must be submitted before the call
+        /// * the device addresses of moved buffers change
+        auto defragment(DefragmentationInfo const & info = {}) -> DefragmentationStatus;
+
+        /// @brief  Invokes the callback once the timeline semaphore reached the value.
+        ///         All pending callbacks of a device are serviced by a single device owned thread, that waits on all their semaphores at once.
+        ///         The callback is invoked right away on the calling thread if the value was already reached.
+        ///         Callbacks are also invoked, when waiting on the semaphores fails, e.g. because the device was lost.
+        /// NOTE:
+        /// * the semaphore is kept alive until the callback was invoked, as is the device
+        /// * callbacks must be short, they delay all other callbacks of the device
+        void on_timeline_reached(TimelineSemaphore const & semaphore, u64 value, std::function<void()> callback);
+
         /// THREADSAFETY:
         /// * reference MUST NOT be read after the device is destroyed.
         /// @return reference to device properties
         [[nodiscard]] auto properties() const -> DeviceProperties const &;
+        /// @brief  Does not synchronize with the gpu, cheap enough to be called every frame.
+        /// @return heap budgets and usages as well as the live memory of each resource type.
+        [[nodiscard]] auto memory_report() const -> MemoryReport;
         [[nodiscard]] auto get_supported_present_modes(NativeWindowHandle native_handle, NativeWindowPlatform native_platform) const -> std::vector<PresentMode>;
 
       protected:
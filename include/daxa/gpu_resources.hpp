@@ -209,6 +209,9 @@ namespace daxa
         TlasId dst_tlas = {};
         Span<TlasInstanceInfo const> instances = {};
         DeviceAddress scratch_data = {};
+        /// @brief  When set, the build updates (refits) src_tlas into dst_tlas instead of building from scratch.
+        ///         src_tlas must have been built with ALLOW_UPDATE. It may be the same as dst_tlas.
+        TlasId src_tlas = {};
     };
 
     struct BlasBuildInfo
@@ -220,6 +223,9 @@ namespace daxa
             Span<BlasAabbGeometryInfo const>>
             geometries;
         DeviceAddress scratch_data = {};
+        /// @brief  When set, the build updates (refits) src_blas into dst_blas instead of building from scratch.
+        ///         src_blas must have been built with ALLOW_UPDATE. It may be the same as dst_blas.
+        BlasId src_blas = {};
     };
 
     struct TlasInfo
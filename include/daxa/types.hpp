@@ -1470,6 +1470,7 @@ namespace daxa
         static inline constexpr PipelineStageFlags MESH_SHADER = {0x00100000ull};
         static inline constexpr PipelineStageFlags ACCELERATION_STRUCTURE_BUILD = {0x02000000ull};
         static inline constexpr PipelineStageFlags RAY_TRACING_SHADER = {0x00200000ull};
+        static inline constexpr PipelineStageFlags CONDITIONAL_RENDERING = {0x00040000ull};
     };
 
     [[nodiscard]] auto to_string(PipelineStageFlags flags) -> std::string;
@@ -1517,6 +1518,7 @@ namespace daxa
         static inline constexpr Access MESH_SHADER_READ = {.stages = PipelineStageFlagBits::MESH_SHADER, .type = AccessTypeFlagBits::READ};
         static inline constexpr Access ACCELERATION_STRUCTURE_BUILD_READ = {.stages = PipelineStageFlagBits::ACCELERATION_STRUCTURE_BUILD, .type = AccessTypeFlagBits::READ};
         static inline constexpr Access RAY_TRACING_SHADER_READ = {.stages = PipelineStageFlagBits::RAY_TRACING_SHADER, .type = AccessTypeFlagBits::READ};
+        static inline constexpr Access CONDITIONAL_RENDERING_READ = {.stages = PipelineStageFlagBits::CONDITIONAL_RENDERING, .type = AccessTypeFlagBits::READ};
 
         static inline constexpr Access TOP_OF_PIPE_WRITE = {.stages = PipelineStageFlagBits::TOP_OF_PIPE, .type = AccessTypeFlagBits::WRITE};
         static inline constexpr Access DRAW_INDIRECT_WRITE = {.stages = PipelineStageFlagBits::DRAW_INDIRECT, .type = AccessTypeFlagBits::WRITE};
@@ -1770,6 +1772,8 @@ namespace daxa
     {
         MemoryRequirements requirements = {};
         MemoryFlags flags = {};
+        // Reports the block in the transient memory block fields of the memory report, used for task graph transient memory.
+        bool transient = {};
     };
 
     struct DAXA_EXPORT_CXX MemoryBlock : ManagedPtr<MemoryBlock, daxa_MemoryBlock>
@@ -1812,6 +1816,67 @@ namespace daxa
         static auto dec_refcnt(ImplHandle const * object) -> u64;
     };
 
+    enum struct QueryType
+    {
+        OCCLUSION = 0,
+        PIPELINE_STATISTICS = 1,
+        MAX_ENUM = 0x7fffffff,
+    };
+
+    struct PipelineStatisticFlagsProperties
+    {
+        using Data = u32;
+    };
+    using PipelineStatisticFlags = Flags<PipelineStatisticFlagsProperties>;
+    struct PipelineStatisticFlagBits
+    {
+        static inline constexpr PipelineStatisticFlags NONE = {0x00000000};
+        static inline constexpr PipelineStatisticFlags INPUT_ASSEMBLY_VERTICES = {0x00000001};
+        static inline constexpr PipelineStatisticFlags INPUT_ASSEMBLY_PRIMITIVES = {0x00000002};
+        static inline constexpr PipelineStatisticFlags VERTEX_SHADER_INVOCATIONS = {0x00000004};
+        static inline constexpr PipelineStatisticFlags GEOMETRY_SHADER_INVOCATIONS = {0x00000008};
+        static inline constexpr PipelineStatisticFlags GEOMETRY_SHADER_PRIMITIVES = {0x00000010};
+        static inline constexpr PipelineStatisticFlags CLIPPING_INVOCATIONS = {0x00000020};
+        static inline constexpr PipelineStatisticFlags CLIPPING_PRIMITIVES = {0x00000040};
+        static inline constexpr PipelineStatisticFlags FRAGMENT_SHADER_INVOCATIONS = {0x00000080};
+        static inline constexpr PipelineStatisticFlags TESSELLATION_CONTROL_SHADER_PATCHES = {0x00000100};
+        static inline constexpr PipelineStatisticFlags TESSELLATION_EVALUATION_SHADER_INVOCATIONS = {0x00000200};
+        static inline constexpr PipelineStatisticFlags COMPUTE_SHADER_INVOCATIONS = {0x00000400};
+    };
+
+    struct QueryPoolInfo
+    {
+        QueryType query_type = QueryType::OCCLUSION;
+        // Only used for pipeline statistics queries.
+        // Each query writes one value per set bit, ordered from the lowest to the highest bit.
+        PipelineStatisticFlags pipeline_statistics = {};
+        u32 query_count = {};
+        SmallString name = "";
+    };
+
+    struct DAXA_EXPORT_CXX QueryPool : ManagedPtr<QueryPool, daxa_QueryPool>
+    {
+        QueryPool() = default;
+
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        [[nodiscard]] auto info() const -> QueryPoolInfo const &;
+        /// @return number of values written by each query.
+        [[nodiscard]] auto value_count() const -> u32;
+
+        /// @brief  Does not wait for the gpu.
+        /// @return value_count() values followed by the availability for each query.
+        ///         Values of queries with an availability of 0 are not yet written.
+        [[nodiscard]] auto get_query_results(u32 start_index, u32 count) -> std::vector<u64>;
+
+      protected:
+        template <typename T, typename H_T>
+        friend struct ManagedPtr;
+        static auto inc_refcnt(ImplHandle const * object) -> u64;
+        static auto dec_refcnt(ImplHandle const * object) -> u64;
+    };
+
     enum struct IndexType
     {
         uint16 = 0,
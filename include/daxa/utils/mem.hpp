@@ -7,7 +7,14 @@
 #include <daxa/core.hpp>
 #include <daxa/device.hpp>
 
+#include <chrono>
 #include <deque>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
 
 namespace daxa
 {
@@ -16,10 +23,20 @@ namespace daxa
         Device device = {};
         u32 capacity = 1 << 25;
         bool use_bar_memory = {};
+        // When the pool is full, a larger buffer is created and chained instead of failing the allocation.
+        // Buffers that are no longer current are destroyed once all their allocations retired.
+        bool allow_growth = {};
+        // Retire allocations per frame instead of one by one, see TransferMemoryPool.
+        bool per_frame_retirement = {};
         std::string name = {};
     };
 
-    /// @brief Ring buffer based transfer memory allocator for easy and efficient cpu gpu communication.
+    /// @brief  Ring buffer allocator for host visible staging memory.
+    ///         Every submit using memory from the pool must signal timeline_semaphore() with timeline_value().
+    ///         By default, every allocation advances the timeline value and is reused once the gpu reached it.
+    ///         With per_frame_retirement, allocations are bump allocated lock free from any number of threads.
+    ///         All allocations made between two calls to advance_timeline share one timeline value and are reused together,
+    ///         advance_timeline() must then be called after the last submit of a frame.
     struct TransferMemoryPool
     {
         DAXA_EXPORT_CXX TransferMemoryPool(TransferMemoryPoolInfo a_info);
@@ -34,8 +51,11 @@ namespace daxa
             u32 buffer_offset = {};
             usize size = {};
             u64 timeline_index = {};
+            // Buffer the allocation was made from. Only differs from buffer() when growth is allowed.
+            daxa::BufferId buffer = {};
         };
         // Returns nullopt if the allocation fails.
+        // THREADSAFETY: may be called from multiple threads at the same time, but not concurrently with advance_timeline.
         DAXA_EXPORT_CXX auto allocate(u32 size, u32 alignment_requirement = 1) -> std::optional<Allocation>;
         /// @brief  Allocates a section of a buffer with the size of T, writes the given T to the allocation.
         /// @return allocation. 
@@ -52,9 +72,13 @@ namespace daxa
         }
         // Returns current timeline index.
         DAXA_EXPORT_CXX auto timeline_value() const -> usize;
+        /// @brief  Reclaims the memory of allocations the gpu finished.
+        ///         With per_frame_retirement, it also ends the current frame of allocations.
+        DAXA_EXPORT_CXX void advance_timeline();
         // Returns timeline semaphore that needs to be signaled with the latest timeline value,
         // on a queue that uses memory from this pool.
         DAXA_EXPORT_CXX auto timeline_semaphore() -> TimelineSemaphore const &;
+        // Returns the buffer new allocations are currently made from.
         DAXA_EXPORT_CXX auto buffer() const -> daxa::BufferId;
         /// THREADSAFETY:
         /// * reference MUST NOT be read after the object is destroyed.
@@ -62,25 +86,375 @@ namespace daxa
         DAXA_EXPORT_CXX auto info() const -> TransferMemoryPoolInfo const &;
 
       private:
-        // Reclaim expired memory allocations.
-        DAXA_EXPORT_CXX void reclaim_unused_memory();
-        struct TrackedAllocation
+        struct State;
+
+        TransferMemoryPoolInfo m_info = {};
+        TimelineSemaphore gpu_timeline = {};
+        std::unique_ptr<State> state = {};
+    };
+
+    struct UploadQueueInfo
+    {
+        Device device = {};
+        // Initial size of the staging memory, it grows when a frame uploads more.
+        u64 staging_capacity = 1 << 24;
+        std::string name = {};
+    };
+
+    struct UploadBufferInfo
+    {
+        BufferId dst_buffer = {};
+        u64 dst_offset = {};
+        std::span<std::byte const> data = {};
+    };
+
+    struct UploadImageInfo
+    {
+        ImageId dst_image = {};
+        ImageArraySlice image_slice = {};
+        Offset3D image_offset = {};
+        Extent3D image_extent = {};
+        // Tightly packed texels of the copied region.
+        std::span<std::byte const> data = {};
+        // Layout of the image slice before and after the flush.
+        ImageLayout src_layout = ImageLayout::UNDEFINED;
+        ImageLayout dst_layout = ImageLayout::READ_ONLY_OPTIMAL;
+    };
+
+    struct UploadFileInfo
+    {
+        std::filesystem::path path = {};
+        u64 file_offset = {};
+        // Reads up to the end of the file when left at the maximum.
+        u64 size = std::numeric_limits<u64>::max();
+        BufferId dst_buffer = {};
+        u64 dst_offset = {};
+    };
+
+    struct UploadQueueFlushInfo
+    {
+        // Accesses to the uploaded resources that must finish before the copies.
+        Access src_access = AccessConsts::READ_WRITE;
+        // Accesses to the uploaded resources that wait for the copies.
+        Access dst_access = AccessConsts::READ_WRITE;
+    };
+
+    struct UploadQueueStats
+    {
+        u64 write_count = {};
+        u64 uploaded_bytes = {};
+        // Number of copy commands recorded, after adjacent buffer writes were coalesced.
+        u64 buffer_copy_count = {};
+        u64 image_copy_count = {};
+        u64 barrier_count = {};
+        // Cpu time spent writing data into the staging memory, summed over all threads.
+        std::chrono::nanoseconds staging_time = {};
+    };
+
+    struct UploadQueueFlushResult
+    {
+        // The submit containing the flushed commands must signal timeline_semaphore() with this value.
+        u64 timeline_value = {};
+        UploadQueueStats stats = {};
+    };
+
+    /// @brief  Collects many small uploads into buffers and images and records them as one batched copy pass.
+    ///         The data of each upload is written into host visible staging memory immediately, so the source memory can be reused right away.
+    ///         Buffer writes that are adjacent in both the staging memory and the destination buffer are coalesced into a single copy.
+    ///         Buffer and image writes overlapping an earlier write of the same flush are copied after it, separated by a transfer barrier.
+    ///         Image writes of one flush that target the same image must either use the same image slice or not overlap at all,
+    ///         as writes to the same slice share their layout transitions.
+    /// THREADSAFETY:
+    /// * upload functions may be called from any number of threads at the same time.
+    /// * flush must not be called concurrently with uploads.
+    struct UploadQueue
+    {
+        DAXA_EXPORT_CXX UploadQueue(UploadQueueInfo a_info);
+        DAXA_EXPORT_CXX UploadQueue(UploadQueue && other);
+        DAXA_EXPORT_CXX UploadQueue & operator=(UploadQueue && other);
+        DAXA_EXPORT_CXX ~UploadQueue();
+
+        DAXA_EXPORT_CXX void upload_buffer(UploadBufferInfo const & info);
+        DAXA_EXPORT_CXX void upload_image(UploadImageInfo const & info);
+        /// @brief  Reads the file range directly into the staging memory.
+        /// @return false if the file could not be read.
+        DAXA_EXPORT_CXX auto upload_file(UploadFileInfo const & info) -> bool;
+        /// @brief  Records barriers and copies for all uploads since the last flush.
+        DAXA_EXPORT_CXX auto flush(CommandRecorder & recorder, UploadQueueFlushInfo const & info = {}) -> UploadQueueFlushResult;
+        // Returns the accumulated stats of all flushes.
+        DAXA_EXPORT_CXX auto stats() const -> UploadQueueStats;
+        DAXA_EXPORT_CXX auto timeline_semaphore() -> TimelineSemaphore const &;
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        DAXA_EXPORT_CXX auto info() const -> UploadQueueInfo const &;
+
+      private:
+        struct State;
+
+        UploadQueueInfo m_info = {};
+        std::unique_ptr<State> state = {};
+    };
+
+    struct ReadbackRingInfo
+    {
+        Device device = {};
+        u64 capacity = 1 << 22;
+        std::string name = {};
+    };
+
+    struct ReadbackBufferInfo
+    {
+        BufferId src_buffer = {};
+        u64 src_offset = {};
+        u64 size = {};
+    };
+
+    struct ReadbackImageInfo
+    {
+        ImageId src_image = {};
+        ImageLayout image_layout = ImageLayout::TRANSFER_SRC_OPTIMAL;
+        ImageArraySlice image_slice = {};
+        Offset3D image_offset = {};
+        Extent3D image_extent = {};
+        // Byte size of the tightly packed texels of the copied region.
+        u64 size = {};
+    };
+
+    using ReadbackCallback = std::function<void(std::span<std::byte const> data)>;
+
+    /// @brief  Ring buffer of host visible memory for reading back gpu results without stalling.
+    ///         Readbacks record a copy into a ring slot. flush() records a single barrier making all copies since the last flush visible to the host,
+    ///         it must be recorded after the last readback of a command list.
+    ///         Sources must be made visible to transfer reads beforehand.
+    ///         Like the TransferMemoryPool, every submit containing readbacks must signal timeline_semaphore() with timeline_value(),
+    ///         and advance_timeline() must be called after the last such submit of a frame.
+    ///         poll() invokes the callbacks of all frames the gpu finished and reclaims their slots,
+    ///         it should be called once per frame. It never waits on the gpu.
+    struct ReadbackRing
+    {
+        DAXA_EXPORT_CXX ReadbackRing(ReadbackRingInfo a_info);
+        DAXA_EXPORT_CXX ReadbackRing(ReadbackRing && other);
+        DAXA_EXPORT_CXX ReadbackRing & operator=(ReadbackRing && other);
+        DAXA_EXPORT_CXX ~ReadbackRing();
+
+        struct Readback
         {
-            usize timeline_index = {};
-            u32 offset = {};
-            u32 size = {};
+            u64 buffer_offset = {};
+            u64 size = {};
+            u64 timeline_value = {};
         };
+        /// @brief  Records a copy of the buffer range into the ring.
+        ///         The optional callback is invoked by poll once the copy finished on the gpu.
+        /// @return nullopt if the ring is full.
+        DAXA_EXPORT_CXX auto readback_buffer(CommandRecorder & recorder, ReadbackBufferInfo const & info, ReadbackCallback callback = {}) -> std::optional<Readback>;
+        DAXA_EXPORT_CXX auto readback_image(CommandRecorder & recorder, ReadbackImageInfo const & info, ReadbackCallback callback = {}) -> std::optional<Readback>;
+        /// @brief  Records one barrier making all readback copies since the last flush visible to the host.
+        ///         Records nothing if there were no such copies.
+        DAXA_EXPORT_CXX void flush(CommandRecorder & recorder);
+        /// @brief  Does not wait on the gpu.
+        /// @return the data of a finished readback, nullopt if the gpu did not finish it yet or poll already reclaimed it.
+        ///         The data stays valid until the next call to poll.
+        DAXA_EXPORT_CXX auto try_read(Readback const & readback) const -> std::optional<std::span<std::byte const>>;
+        /// @brief  Invokes the callbacks of all finished frames in order and reclaims their ring slots.
+        /// @return number of invoked callbacks.
+        DAXA_EXPORT_CXX auto poll() -> usize;
+        DAXA_EXPORT_CXX auto timeline_value() const -> u64;
+        DAXA_EXPORT_CXX void advance_timeline();
+        DAXA_EXPORT_CXX auto timeline_semaphore() -> TimelineSemaphore const &;
+        DAXA_EXPORT_CXX auto buffer() const -> daxa::BufferId;
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        DAXA_EXPORT_CXX auto info() const -> ReadbackRingInfo const &;
 
-        TransferMemoryPoolInfo m_info = {};
+      private:
+        auto allocate(u64 size, u64 alignment) -> std::optional<u64>;
+
+        struct PendingCallback
+        {
+            u64 buffer_offset = {};
+            u64 size = {};
+            ReadbackCallback callback = {};
+        };
+        struct Frame
+        {
+            u64 timeline_value = {};
+            u64 end_head = {};
+            std::vector<PendingCallback> callbacks = {};
+        };
+
+        ReadbackRingInfo m_info = {};
         TimelineSemaphore gpu_timeline = {};
+        BufferId m_buffer = {};
+        std::byte const * buffer_host_address = {};
+        // Monotonic byte positions, the offset into the buffer is the position modulo the capacity.
+        u64 head = {};
+        u64 tail = {};
+        u64 current_timeline_value = 1;
+        u64 reclaimed_timeline_value = {};
+        bool has_unflushed_copies = {};
+        std::vector<PendingCallback> current_callbacks = {};
+        std::deque<Frame> frames = {};
+    };
+
+    struct BufferSuballocatorInfo
+    {
+        Device device = {};
+        // Rounded up to a power of two.
+        u64 capacity = 1ull << 26ull;
+        // Smallest block handed out, rounded up to a power of two.
+        // Smaller values waste less memory per allocation but need more bookkeeping memory.
+        u64 min_allocation_size = 256;
+        std::string name = {};
+    };
+
+    /// @brief  Buddy allocator sub-allocating one big device local buffer.
+    ///         Allocations need no buffer, bindless slot or descriptor of their own.
+    ///         They are addressed by their offset into buffer() or their device address.
+    ///         Freed memory is reused once the gpu reached the timeline value the allocator had when it was freed.
+    ///         Every submit using memory of the allocator must signal timeline_semaphore() with timeline_value(),
+    ///         advance_timeline() must be called after each such submit.
+    /// THREADSAFETY:
+    /// * allocate and free can be called from any thread in parallel.
+    /// * free is lock-free, allocate takes a lock.
+    struct BufferSuballocator
+    {
+        DAXA_EXPORT_CXX BufferSuballocator(BufferSuballocatorInfo a_info);
+        DAXA_EXPORT_CXX BufferSuballocator(BufferSuballocator && other);
+        DAXA_EXPORT_CXX BufferSuballocator & operator=(BufferSuballocator && other);
+        DAXA_EXPORT_CXX ~BufferSuballocator();
+
+        struct Allocation
+        {
+            daxa::DeviceAddress device_address = {};
+            u64 buffer_offset = {};
+            u64 size = {};
+        };
+        // Returns nullopt if the allocation fails. The alignment must be a power of two.
+        DAXA_EXPORT_CXX auto allocate(u64 size, u64 alignment_requirement = 1) -> std::optional<Allocation>;
+        // The memory is reused after the gpu reached the current timeline value.
+        DAXA_EXPORT_CXX void free(Allocation const & allocation);
+        // Returns the timeline value submits using memory from the allocator must signal.
+        DAXA_EXPORT_CXX auto timeline_value() const -> u64;
+        DAXA_EXPORT_CXX void advance_timeline();
+        DAXA_EXPORT_CXX auto timeline_semaphore() -> TimelineSemaphore const &;
+        DAXA_EXPORT_CXX auto buffer() const -> daxa::BufferId;
+        // Returns the size of all blocks currently allocated or waiting for the gpu to be reused.
+        DAXA_EXPORT_CXX auto used_size() const -> u64;
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        DAXA_EXPORT_CXX auto info() const -> BufferSuballocatorInfo const &;
 
       private:
-        u64 current_timeline_value = {};
-        std::deque<TrackedAllocation> live_allocations = {};
+        struct State;
+
+        BufferSuballocatorInfo m_info = {};
+        TimelineSemaphore gpu_timeline = {};
         BufferId m_buffer = {};
         daxa::DeviceAddress buffer_device_address = {};
-        void * buffer_host_address = {};
-        u32 claimed_start = {};
-        u32 claimed_size = {};
+        std::unique_ptr<State> state = {};
+    };
+
+    struct BlasCompactorInfo
+    {
+        Device device = {};
+        std::string name = {};
+    };
+
+    /// @brief  Batched blas compaction.
+    ///         Blas built with ALLOW_COMPACTION are enqueued, which records a query of their compacted sizes.
+    ///         Once the gpu finished these queries, compact creates a compacted blas for each of them,
+    ///         records the compacting copies and destroys the original blas after the copies finished.
+    ///         Compacted blas have a new device address, tlas instances referencing the originals must be rebuilt.
+    struct BlasCompactor
+    {
+        DAXA_EXPORT_CXX BlasCompactor(BlasCompactorInfo a_info);
+        DAXA_EXPORT_CXX BlasCompactor(BlasCompactor && other);
+        DAXA_EXPORT_CXX BlasCompactor & operator=(BlasCompactor && other);
+        DAXA_EXPORT_CXX ~BlasCompactor();
+
+        struct Compaction
+        {
+            BlasId original = {};
+            BlasId compacted = {};
+            u64 original_size = {};
+            u64 compacted_size = {};
+        };
+        /// @brief  Records a compacted size query for each blas.
+        ///         The builds of the blas must be made visible to ACCELERATION_STRUCTURE_BUILD reads with a pipeline barrier beforehand.
+        ///         The commands must be submitted signaling timeline_semaphore() with timeline_value().
+        DAXA_EXPORT_CXX void enqueue(CommandRecorder & recorder, std::span<BlasId const> blas);
+        /// @brief  Records the compacting copies for all enqueued blas whose size queries finished on the gpu.
+        ///         The original blas are destroyed once the recorded commands finished executing.
+        /// @return the compacted blas, the caller owns these.
+        DAXA_EXPORT_CXX auto compact(CommandRecorder & recorder) -> std::vector<Compaction>;
+        // Returns the number of enqueued blas that were not yet compacted.
+        DAXA_EXPORT_CXX auto pending_count() const -> usize;
+        // Returns current timeline index.
+        DAXA_EXPORT_CXX auto timeline_value() const -> u64;
+        // Returns timeline semaphore that needs to be signaled with the latest timeline value,
+        // on a queue that executes the enqueued size queries.
+        DAXA_EXPORT_CXX auto timeline_semaphore() -> TimelineSemaphore const &;
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        DAXA_EXPORT_CXX auto info() const -> BlasCompactorInfo const &;
+
+      private:
+        struct PendingBatch
+        {
+            u64 timeline_index = {};
+            BufferId size_buffer = {};
+            std::vector<BlasId> blas = {};
+        };
+
+        BlasCompactorInfo m_info = {};
+        TimelineSemaphore gpu_timeline = {};
+        u64 current_timeline_value = {};
+        std::deque<PendingBatch> pending_batches = {};
+    };
+
+    struct BlasBatchBuilderInfo
+    {
+        Device device = {};
+        // Maximum scratch memory used by a single build batch.
+        // A blas requiring more scratch than this is built in its own batch.
+        u64 scratch_budget = 1 << 26;
+        std::string name = {};
+    };
+
+    /// @brief  Builds many blas with a single, reused scratch buffer.
+    ///         Computes the build sizes for all given builds, creates the missing destination blas,
+    ///         packs the scratch memory of consecutive builds into one aligned arena and splits the builds into batches that fit the scratch budget.
+    ///         Batches are separated by pipeline barriers, as they reuse the same scratch memory.
+    struct BlasBatchBuilder
+    {
+        DAXA_EXPORT_CXX BlasBatchBuilder(BlasBatchBuilderInfo a_info);
+        DAXA_EXPORT_CXX BlasBatchBuilder(BlasBatchBuilder && other);
+        DAXA_EXPORT_CXX BlasBatchBuilder & operator=(BlasBatchBuilder && other);
+        DAXA_EXPORT_CXX ~BlasBatchBuilder();
+
+        /// @brief  Records the builds of all given blas.
+        ///         The scratch_data of the build infos is ignored.
+        ///         Build infos without a dst_blas get a newly created blas of the required size.
+        ///         The builds must be made visible with a pipeline barrier before the blas are used.
+        /// @return the built blas, in the order of the given build infos. The caller owns newly created blas.
+        DAXA_EXPORT_CXX auto build(CommandRecorder & recorder, std::span<BlasBuildInfo const> build_infos) -> std::vector<BlasId>;
+        DAXA_EXPORT_CXX auto scratch_buffer() const -> BufferId;
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        DAXA_EXPORT_CXX auto info() const -> BlasBatchBuilderInfo const &;
+
+      private:
+        BlasBatchBuilderInfo m_info = {};
+        BufferId m_scratch_buffer = {};
+        u64 scratch_buffer_size = {};
+        // Reused between builds to avoid reallocating them for every call.
+        std::vector<u64> scratch_offsets = {};
+        std::vector<usize> batch_ends = {};
+        std::vector<BlasBuildInfo> batch_build_infos = {};
     };
 } // namespace daxa
@@ -70,6 +70,8 @@ namespace daxa
         u32 max_ray_recursion_depth = {};
         u32 push_constant_size = {};
         std::string name = {};
+        // Used in place of the pipeline while it is compiled asynchronously.
+        RayTracingPipeline fallback_pipeline = {};
     };
 
     struct ComputePipelineCompileInfo
@@ -77,6 +79,8 @@ namespace daxa
         ShaderCompileInfo shader_info = {};
         u32 push_constant_size = {};
         std::string name = {};
+        // Used in place of the pipeline while it is compiled asynchronously.
+        ComputePipeline fallback_pipeline = {};
     };
 
     struct RasterPipelineCompileInfo
@@ -93,6 +97,8 @@ namespace daxa
         TesselationInfo tesselation = {};
         u32 push_constant_size = {};
         std::string name = {};
+        // Used in place of the pipeline while it is compiled asynchronously.
+        RasterPipeline fallback_pipeline = {};
     };
 
     struct PipelineManagerInfo
@@ -100,6 +106,10 @@ namespace daxa
         Device device;
         ShaderCompileOptions shader_compile_options = {};
         bool register_null_pipelines_when_first_compile_fails = false;
+        // When enabled, add_*_pipeline and reload_all do not compile on the calling thread.
+        // The returned pipeline holds the fallback pipeline (or is null) until the background compilation finished.
+        // Finished compilations are swapped in by the next reload_all or wait_for_async_compilations call.
+        bool async_compilation = false;
         std::function<void(std::string &, std::filesystem::path const & path)> custom_preprocessor = {};
         std::string name = {};
     };
@@ -136,6 +146,10 @@ namespace daxa
         void remove_raster_pipeline(std::shared_ptr<RasterPipeline> const & pipeline);
         void add_virtual_file(VirtualFileInfo const & info);
         auto reload_all() -> PipelineReloadResult;
+        /// @brief  Blocks until all queued async compilations are finished and swaps in the results.
+        auto wait_for_async_compilations() -> PipelineReloadResult;
+        /// @returns number of async compilations that are queued, running or not yet swapped in.
+        auto pending_async_compilations() const -> u32;
         auto all_pipelines_valid() const -> bool;
 
       protected:
@@ -0,0 +1,125 @@
+#pragma once
+
+#if !DAXA_BUILT_WITH_UTILS_PROFILER
+#error "[package management error] You must build Daxa with the DAXA_ENABLE_UTILS_PROFILER CMake option enabled, or request the utils-profiler feature in vcpkg"
+#endif
+
+#include <daxa/core.hpp>
+#include <daxa/device.hpp>
+#include <daxa/command_recorder.hpp>
+
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace daxa
+{
+    struct GpuProfilerInfo
+    {
+        Device device = {};
+        // Number of frames whose timestamps can be in flight at the same time.
+        // The profiler keeps one query pool per frame in flight.
+        u32 frames_in_flight = 3;
+        // Scopes beyond this limit are ignored for the rest of the frame.
+        u32 max_scopes_per_frame = 512;
+        // Number of resolved frames kept for results() and the chrome trace export.
+        u32 history_size = 64;
+        std::string name = {};
+    };
+
+    struct GpuProfilerScopeResult
+    {
+        std::string name = {};
+        // Nesting depth of the scope, 0 for top level scopes.
+        u32 depth = {};
+        // Timestamps in nanoseconds of the gpu clock.
+        u64 begin_ns = {};
+        u64 end_ns = {};
+    };
+
+    struct GpuProfilerFrameResult
+    {
+        u64 frame_index = {};
+        std::vector<GpuProfilerScopeResult> scopes = {};
+    };
+
+    /// @brief  Gpu timestamp profiler with per frame scopes.
+    ///         Timestamps of each frame are written into their own query pool, taken from a ring of frames_in_flight pools.
+    ///         Results are only read back once the gpu made them available, resolving never waits on the gpu.
+    ///         A frame whose results are still not available when its query pool is reused is dropped.
+    ///         The query pool reset of a frame is recorded together with the first scope of the frame,
+    ///         so the recorder of the first scope must also be the first one submitted in that frame.
+    struct GpuProfiler
+    {
+        DAXA_EXPORT_CXX GpuProfiler(GpuProfilerInfo a_info);
+        DAXA_EXPORT_CXX GpuProfiler(GpuProfiler && other);
+        DAXA_EXPORT_CXX GpuProfiler & operator=(GpuProfiler && other);
+        DAXA_EXPORT_CXX ~GpuProfiler();
+
+        /// @brief  Begins a scope on construction and ends it on destruction.
+        struct Scope
+        {
+            DAXA_EXPORT_CXX Scope(GpuProfiler & profiler, CommandRecorder & recorder, std::string_view name);
+            DAXA_EXPORT_CXX ~Scope();
+            Scope(Scope const &) = delete;
+            Scope & operator=(Scope const &) = delete;
+
+          private:
+            GpuProfiler & profiler;
+            CommandRecorder & recorder;
+        };
+
+        /// @brief  Starts a new frame. Resolves all finished frames beforehand.
+        DAXA_EXPORT_CXX void begin_frame();
+        /// @brief  Ends the current frame. All scopes of the frame must be ended.
+        DAXA_EXPORT_CXX void end_frame();
+        /// @brief  Writes a begin timestamp. Scopes of a frame must be properly nested.
+        DAXA_EXPORT_CXX void begin_scope(CommandRecorder & recorder, std::string_view name);
+        DAXA_EXPORT_CXX void end_scope(CommandRecorder & recorder);
+        /// @brief  Reads back the timestamps of all ended frames the gpu finished, without waiting.
+        /// @return number of newly resolved frames.
+        DAXA_EXPORT_CXX auto resolve() -> usize;
+        /// @return resolved frames, oldest first.
+        DAXA_EXPORT_CXX auto results() const -> std::deque<GpuProfilerFrameResult> const &;
+        // Returns the number of frames that were dropped because their results were not available in time.
+        DAXA_EXPORT_CXX auto dropped_frame_count() const -> u64;
+        /// @brief  Serializes the resolved frames into the chrome trace event format (chrome://tracing, perfetto).
+        DAXA_EXPORT_CXX auto chrome_trace_json() const -> std::string;
+        DAXA_EXPORT_CXX void write_chrome_trace(std::filesystem::path const & path) const;
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        DAXA_EXPORT_CXX auto info() const -> GpuProfilerInfo const &;
+
+      private:
+        struct RecordedScope
+        {
+            std::string name = {};
+            u32 depth = {};
+            u32 begin_query = {};
+            u32 end_query = {};
+        };
+        struct FrameSlot
+        {
+            TimelineQueryPool query_pool = {};
+            u64 frame_index = {};
+            u32 query_count = {};
+            bool reset_recorded = {};
+            bool pending = {};
+            std::vector<RecordedScope> scopes = {};
+        };
+        auto try_resolve(FrameSlot & slot) -> bool;
+
+        GpuProfilerInfo m_info = {};
+        f64 timestamp_period = {};
+        std::vector<FrameSlot> frame_slots = {};
+        u64 current_frame_index = {};
+        bool frame_active = {};
+        // Indices into the current frames scopes, of all currently open scopes.
+        std::vector<u32> open_scopes = {};
+        std::deque<GpuProfilerFrameResult> resolved_frames = {};
+        u64 dropped_frames = {};
+    };
+} // namespace daxa
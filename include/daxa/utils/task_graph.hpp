@@ -9,6 +9,7 @@
 #endif
 
 #include "mem.hpp"
+#include "profiler.hpp"
 
 namespace daxa
 {
@@ -62,6 +63,10 @@ namespace daxa
     struct TaskTransientBufferInfo
     {
         u32 size = {};
+        /// @brief  Optional name of a runtime extent, see TaskGraph::set_transient_extent.
+        ///         When set, size is the byte size per element and the buffer holds one element per texel of the scaled extent.
+        std::string size_extent = {};
+        std::array<f32, 3> size_extent_scale = {1.0f, 1.0f, 1.0f};
         std::string name = {};
     };
 
@@ -70,6 +75,10 @@ namespace daxa
         u32 dimensions = 2;
         Format format = Format::R8G8B8A8_UNORM;
         Extent3D size = {0, 0, 0};
+        /// @brief  Optional name of a runtime extent, see TaskGraph::set_transient_extent.
+        ///         When set, size is ignored and the image is sized to the extent times size_extent_scale, rounded up and at least 1.
+        std::string size_extent = {};
+        std::array<f32, 3> size_extent_scale = {1.0f, 1.0f, 1.0f};
         u32 mip_level_count = 1;
         u32 array_layer_count = 1;
         u32 sample_count = 1;
@@ -98,6 +107,36 @@ namespace daxa
         std::string name = {};
     };
 
+    struct TransientMemoryHeapInfo
+    {
+        Device device = {};
+        std::string name = {};
+    };
+
+    /// @brief  Memory block shared by the transient resources of multiple task graphs.
+    ///         The graphs alias the same memory, so they must execute in a known order on the same queue, never interleaved.
+    ///         The heap grows to the largest transient memory requirement of its users.
+    ///         Graphs whose transients live in an outgrown block recreate them on their next execution.
+    struct ImplTransientMemoryHeap;
+    struct DAXA_EXPORT_CXX TransientMemoryHeap : ManagedPtr<TransientMemoryHeap, ImplTransientMemoryHeap *>
+    {
+        TransientMemoryHeap() = default;
+        TransientMemoryHeap(TransientMemoryHeapInfo const & info);
+
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        auto info() const -> TransientMemoryHeapInfo const &;
+        /// @brief  Current size of the shared memory block, zero until a task graph using the heap is completed.
+        auto size() const -> usize;
+
+      protected:
+        template <typename T, typename H_T>
+        friend struct ManagedPtr;
+        static auto inc_refcnt(ImplHandle const * object) -> u64;
+        static auto dec_refcnt(ImplHandle const * object) -> u64;
+    };
+
     struct TaskGraphInfo
     {
         Device device = {};
@@ -106,8 +145,29 @@ namespace daxa
         /// @brief  Task reordering can drastically improve performance,
         ///         yet is it also nice to have sequential callback execution.
         bool reorder_tasks = true;
+        /// @brief  Reschedules every submit scope when completing the graph.
+        ///         Builds the dependency graph of all tasks and uses list scheduling, which places reads of the same resource
+        ///         next to each other and prefers tasks on the longest dependency chain.
+        ///         The new schedule is only used when it needs fewer batches or barriers than the recording order schedule.
+        ///         Requires reorder_tasks. Increases the cost of complete.
+        bool optimize_schedule = {};
+        /// @brief  Removes tasks whose outputs are never consumed when completing the graph, per permutation.
+        ///         Tasks writing persistent resources, tasks without any writes and tasks marked with side_effects are always kept.
+        ///         Every other task is only kept when a kept task reads something it writes.
+        ///         Transient resources that are only used by culled tasks are not allocated.
+        bool cull_dead_tasks = {};
         /// @brief  Allows task graph to alias transient resources memory (ofc only when that wont break the program)
         bool alias_transients = {};
+        /// @brief  Optionally the transient resources can be placed in a heap shared with other task graphs instead of a dedicated memory block.
+        ///         Each execution then starts with a full memory barrier, as other graphs alias the same memory.
+        std::optional<TransientMemoryHeap> transient_memory_heap = {};
+        /// @brief  Execution submits the commands of a submit scope early, once this many batches were recorded since the last submit.
+        ///         Keeps the gpu busy while the rest of the scope is recorded. Zero disables it.
+        ///         The first submit of a scope waits on its semaphores, the last one signals them and presents.
+        ///         Only applies to scopes ended by a submit, tasks after the last submit are never submitted by the task graph.
+        u32 auto_submit_batch_count = {};
+        /// @brief  Same as auto_submit_batch_count, but counts the recorded tasks. Both can be combined.
+        u32 auto_submit_task_count = {};
         /// @brief  Some drivers have bad implementations for split barriers.
         ///         If that is the case for you, you can turn off all use of split barriers.
         ///         Daxa will use pipeline barriers instead if this is set.
@@ -126,6 +186,9 @@ namespace daxa
         std::array<f32, 4> task_graph_label_color = {0.463f, 0.333f, 0.671f, 1.0f};
         std::array<f32, 4> task_batch_label_color = {0.563f, 0.433f, 0.771f, 1.0f};
         std::array<f32, 4> task_label_color = {0.663f, 0.533f, 0.871f, 1.0f};
+        /// @brief  Optionally the user can provide a gpu profiler. Task graph then writes a profiler scope around each tasks execution.
+        ///         The profiler must outlive the task graph, and frames must be begun and ended by the user around execute.
+        GpuProfiler * gpu_profiler = {};
         /// @brief  Records debug information about the execution if enabled. This string is retrievable with the function get_debug_string.
         bool record_debug_information = {};
         /// @brief  Sets the size of the linear allocator of device local, host visible memory used by the linear staging allocator.
@@ -154,6 +217,16 @@ namespace daxa
     {
     };
 
+    struct TaskGraphScheduleStats
+    {
+        u32 submit_scope_count = {};
+        u32 batch_count = {};
+        u32 barrier_count = {};
+        u32 split_barrier_count = {};
+        // Barriers recorded before the batches after merging, all memory barriers of a batch count as one.
+        u32 merged_barrier_count = {};
+    };
+
     struct TaskImageLastUse
     {
         ImageMipArraySlice slice = {};
@@ -168,6 +241,16 @@ namespace daxa
         std::function<void()> when_false = {};
     };
 
+    struct TaskGraphGpuConditionalInfo
+    {
+        /// @brief  Buffer containing the u32 condition value. Written by earlier tasks or uploaded by the user.
+        TaskBufferView condition_buffer = {};
+        /// @brief  Byte offset of the condition value, must be 4 byte aligned.
+        usize condition_offset = {};
+        std::function<void()> when_true = {};
+        std::function<void()> when_false = {};
+    };
+
     struct ExecutionInfo
     {
         std::span<bool> permutation_condition_values = {};
@@ -179,6 +262,8 @@ namespace daxa
         std::vector<GenericTaskResourceUse> uses = {};
         TaskCallback task = {};
         std::string name = {};
+        /// @brief  Marks the task as having effects outside of its task resource uses, it is never culled.
+        bool side_effects = {};
     };
 
     struct ImplTaskGraph;
@@ -195,6 +280,11 @@ namespace daxa
 
         DAXA_EXPORT_CXX auto create_transient_buffer(TaskTransientBufferInfo const & info) -> TaskBufferView;
         DAXA_EXPORT_CXX auto create_transient_image(TaskTransientImageInfo const & info) -> TaskImageView;
+        /// @brief  Sets a named extent that transient resources can be sized relative to.
+        ///         Every extent referenced by a transient resource must be set before completing the graph.
+        ///         Changing an extent after completion keeps the compiled batches and barriers,
+        ///         the next execution only reallocates the transient memory and recreates the transient resources.
+        DAXA_EXPORT_CXX void set_transient_extent(std::string const & name, Extent3D extent);
 
         template <typename Task>
         void add_task(Task const & task)
@@ -208,13 +298,21 @@ namespace daxa
             std::unique_ptr<detail::BaseTask> base_task = std::make_unique<detail::InlineTask>(
                 std::move(info.uses),
                 std::move(info.task),
-                std::move(info.name));
+                std::move(info.name),
+                info.side_effects);
             add_task(std::move(base_task));
         }
 
         DAXA_EXPORT_CXX void add_preamble(TaskCallback callback);
 
         DAXA_EXPORT_CXX void conditional(TaskGraphConditionalInfo const & conditional_info);
+        /// @brief  Conditional resolved by the gpu. Requires the CONDITIONAL_RENDERING device flag.
+        ///         Unlike conditional, the tasks of both branches are recorded into the same permutations and the cpu never needs to know the value.
+        ///         Each task gets an implicit CONDITIONAL_RENDERING_READ use of the condition buffer and its callback is wrapped in conditional rendering.
+        ///         Draws and dispatches of when_true tasks only execute when the condition value is non zero, the ones of when_false only when it is zero.
+        ///         Copies, clears and barriers are always executed. Tasks in the branches must not use the condition buffer themselves.
+        ///         Can not be nested in another gpu conditional.
+        DAXA_EXPORT_CXX void gpu_conditional(TaskGraphGpuConditionalInfo const & conditional_info);
         DAXA_EXPORT_CXX void submit(TaskSubmitInfo const & info);
         DAXA_EXPORT_CXX void present(TaskPresentInfo const & info);
 
@@ -227,6 +325,8 @@ namespace daxa
 
         DAXA_EXPORT_CXX auto get_debug_string() -> std::string;
         DAXA_EXPORT_CXX auto get_transient_memory_size() -> daxa::usize;
+        /// @brief  Sums up the scheduling results of all permutations. Only valid after completion.
+        DAXA_EXPORT_CXX auto get_schedule_stats() -> TaskGraphScheduleStats;
 
       protected:
         template <typename T, typename H_T>
@@ -56,6 +56,7 @@ namespace daxa
         TRANSFER_WRITE,
         HOST_TRANSFER_READ,
         HOST_TRANSFER_WRITE,
+        CONDITIONAL_RENDERING_READ,
         MAX_ENUM = 0x7fffffff,
     };
 
@@ -539,6 +540,8 @@ namespace daxa
             virtual auto get_generic_uses() const -> std::span<GenericTaskResourceUse const> = 0;
             virtual auto get_task_head_shader_blob_size() const -> u64 = 0;
             virtual auto get_name() const -> std::string = 0;
+            /// @brief  Tasks with side effects are never culled, even if no other task reads their outputs.
+            virtual auto has_side_effects() const -> bool { return false; }
             virtual void callback(TaskInterface const & ti) = 0;
             virtual ~BaseTask() {}
         };
@@ -591,6 +594,18 @@ namespace daxa
                 }
             }
 
+            virtual auto has_side_effects() const -> bool override
+            {
+                if constexpr (requires { task.side_effects; })
+                {
+                    return static_cast<bool>(task.side_effects);
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
             virtual void callback(TaskInterface const & ti) override
             {
                 task.callback(ti);
@@ -602,12 +617,14 @@ namespace daxa
             std::vector<GenericTaskResourceUse> uses = {};
             std::function<void(daxa::TaskInterface const &)> callback_lambda = {};
             std::string name = {};
+            bool side_effects = {};
 
             InlineTask(
                 std::vector<GenericTaskResourceUse> && a_uses,
                 std::function<void(daxa::TaskInterface const &)> && a_callback_lambda,
-                std::string && a_name)
-                : uses{a_uses}, callback_lambda{a_callback_lambda}, name{a_name}
+                std::string && a_name,
+                bool a_side_effects = false)
+                : uses{a_uses}, callback_lambda{a_callback_lambda}, name{a_name}, side_effects{a_side_effects}
             {
             }
 
@@ -633,6 +650,11 @@ namespace daxa
                 return name;
             }
 
+            virtual auto has_side_effects() const -> bool override
+            {
+                return side_effects;
+            }
+
             virtual void callback(TaskInterface const & ti) override
             {
                 callback_lambda(ti);
@@ -684,6 +706,7 @@ namespace daxa
         using BufferTransferWrite = daxa::TaskBufferUse<daxa::TaskBufferAccess::TRANSFER_WRITE>;
         using BufferHostTransferRead = daxa::TaskBufferUse<daxa::TaskBufferAccess::HOST_TRANSFER_READ>;
         using BufferHostTransferWrite = daxa::TaskBufferUse<daxa::TaskBufferAccess::HOST_TRANSFER_WRITE>;
+        using BufferConditionalRenderingRead = daxa::TaskBufferUse<daxa::TaskBufferAccess::CONDITIONAL_RENDERING_READ, 0>;
         using BufferRayTracingShaderRead = daxa::TaskBufferUse<daxa::TaskBufferAccess::RAY_TRACING_SHADER_READ>;
         using BufferRayTracingShaderWrite = daxa::TaskBufferUse<daxa::TaskBufferAccess::RAY_TRACING_SHADER_WRITE>;
         using BufferRayTracingShaderReadWrite = daxa::TaskBufferUse<daxa::TaskBufferAccess::RAY_TRACING_SHADER_READ_WRITE>;
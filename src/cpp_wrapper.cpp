@@ -116,6 +116,11 @@ auto daxa_result_to_string(daxa_Result result) -> std::string_view
     case DAXA_RESULT_INVALID_TLAS_ID: return "DAXA_RESULT_INVALID_TLAS_ID";
     case DAXA_RESULT_INVALID_BLAS_ID: return "DAXA_RESULT_INVALID_BLAS_ID";
     case DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING: return "DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING";
+    case DAXA_RESULT_INVALID_WITHOUT_ENABLING_PIPELINE_STATISTICS_QUERY: return "DAXA_RESULT_INVALID_WITHOUT_ENABLING_PIPELINE_STATISTICS_QUERY";
+    case DAXA_RESULT_COMMAND_INVALID_WITHIN_RENDERPASS: return "DAXA_RESULT_COMMAND_INVALID_WITHIN_RENDERPASS";
+    case DAXA_RESULT_INVALID_WITHOUT_ENABLING_CONDITIONAL_RENDERING: return "DAXA_RESULT_INVALID_WITHOUT_ENABLING_CONDITIONAL_RENDERING";
+    case DAXA_RESULT_UNBALANCED_CONDITIONAL_RENDERING: return "DAXA_RESULT_UNBALANCED_CONDITIONAL_RENDERING";
+    case DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_PUSH_DESCRIPTOR: return "DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_PUSH_DESCRIPTOR";
     case DAXA_RESULT_MAX_ENUM: return "DAXA_RESULT_MAX_ENUM";
     default: return "UNIMPLEMENTED";
     }
@@ -335,6 +340,32 @@ namespace daxa
     _DAXA_DECL_GPU_RES_FN(Tlas, tlas)
     _DAXA_DECL_GPU_RES_FN(Blas, blas)
 
+#define _DAXA_DECL_GPU_RES_BATCH_FN(Name, name)                                               \
+    auto Device::create_##name##s(std::span<Name##Info const> infos) -> std::vector<Name##Id> \
+    {                                                                                         \
+        std::vector<Name##Id> ids(infos.size());                                              \
+        check_result(                                                                         \
+            daxa_dvc_create_##name##s(                                                        \
+                r_cast<daxa_Device>(this->object),                                            \
+                r_cast<daxa_##Name##Info const *>(infos.data()),                              \
+                infos.size(),                                                                 \
+                r_cast<daxa_##Name##Id *>(ids.data())),                                       \
+            "failed to create " #name "s");                                                   \
+        return ids;                                                                           \
+    }                                                                                         \
+    void Device::destroy_##name##s(std::span<Name##Id const> ids)                             \
+    {                                                                                         \
+        auto result = daxa_dvc_destroy_##name##s(                                             \
+            r_cast<daxa_Device>(this->object),                                                \
+            r_cast<daxa_##Name##Id const *>(ids.data()),                                      \
+            ids.size());                                                                      \
+        check_result(result, "invalid resource id");                                          \
+    }
+
+    _DAXA_DECL_GPU_RES_BATCH_FN(Buffer, buffer)
+    _DAXA_DECL_GPU_RES_BATCH_FN(Image, image)
+    _DAXA_DECL_GPU_RES_BATCH_FN(ImageView, image_view)
+
     auto Device::get_device_address(BufferId id) const -> Optional<DeviceAddress>
     {
         DeviceAddress ret;
@@ -416,6 +447,7 @@ namespace daxa
     _DAXA_DECL_DVC_CREATE_FN(TimelineSemaphore, timeline_semaphore)
     _DAXA_DECL_DVC_CREATE_FN(Event, event)
     _DAXA_DECL_DVC_CREATE_FN(TimelineQueryPool, timeline_query_pool)
+    _DAXA_DECL_DVC_CREATE_FN(QueryPool, query_pool)
 
     auto Device::info() const -> DeviceInfo const &
     {
@@ -467,11 +499,48 @@ namespace daxa
             "failed to collect garbage");
     }
 
+    auto Device::defragment(DefragmentationInfo const & info) -> DefragmentationStatus
+    {
+        DefragmentationStatus ret = {};
+        check_result(
+            daxa_dvc_defragment(r_cast<daxa_Device>(this->object), r_cast<daxa_DefragmentationInfo const *>(&info), r_cast<daxa_DefragmentationStatus *>(&ret)),
+            "failed to defragment");
+        return ret;
+    }
+
+    void Device::on_timeline_reached(TimelineSemaphore const & semaphore, u64 value, std::function<void()> callback)
+    {
+        auto * heap_callback = new std::function<void()>{std::move(callback)};
+        auto result = daxa_dvc_on_timeline_reached(
+            r_cast<daxa_Device>(this->object),
+            *r_cast<daxa_TimelineSemaphore const *>(&semaphore),
+            value,
+            [](void * user_data)
+            {
+                auto * function = static_cast<std::function<void()> *>(user_data);
+                (*function)();
+                delete function;
+            },
+            heap_callback);
+        if (result != DAXA_RESULT_SUCCESS)
+        {
+            delete heap_callback;
+        }
+        check_result(result, "failed to register timeline callback");
+    }
+
     auto Device::properties() const -> DeviceProperties const &
     {
         return *r_cast<DeviceProperties const *>(daxa_dvc_properties(rc_cast<daxa_Device>(object)));
     }
 
+    auto Device::memory_report() const -> MemoryReport
+    {
+        MemoryReport ret = {};
+        daxa_dvc_memory_report(rc_cast<daxa_Device>(object), r_cast<daxa_MemoryReport *>(&ret));
+        return ret;
+    }
+
     auto Device::get_supported_present_modes(NativeWindowHandle native_handle, NativeWindowPlatform native_platform) const -> std::vector<PresentMode>
     {
         auto c_device = rc_cast<daxa_Device>(object);
@@ -649,6 +718,39 @@ namespace daxa
 
     /// --- End TimelineQueryPool ---
 
+    /// --- Begin QueryPool ---
+
+    auto QueryPool::info() const -> QueryPoolInfo const &
+    {
+        return *r_cast<QueryPoolInfo const *>(daxa_query_pool_info(rc_cast<daxa_QueryPool>(this->object)));
+    }
+
+    auto QueryPool::value_count() const -> u32
+    {
+        return daxa_query_pool_value_count(rc_cast<daxa_QueryPool>(this->object));
+    }
+
+    auto QueryPool::get_query_results(u32 start_index, u32 count) -> std::vector<u64>
+    {
+        std::vector<u64> ret = {};
+        ret.resize(static_cast<usize>(count) * (this->value_count() + 1));
+        check_result(
+            daxa_query_pool_query_results(rc_cast<daxa_QueryPool>(this->object), start_index, count, ret.data()),
+            "failed to query results of query pool", std::array{DAXA_RESULT_SUCCESS, DAXA_RESULT_NOT_READY});
+        return ret;
+    }
+
+    auto QueryPool::inc_refcnt(ImplHandle const * object) -> u64
+    {
+        return daxa_query_pool_inc_refcnt(rc_cast<daxa_QueryPool>(object));
+    }
+    auto QueryPool::dec_refcnt(ImplHandle const * object) -> u64
+    {
+        return daxa_query_pool_dec_refcnt(rc_cast<daxa_QueryPool>(object));
+    }
+
+    /// --- End QueryPool ---
+
     /// --- Begin Swapchain ---
 
     void Swapchain::resize()
@@ -901,6 +1003,7 @@ namespace daxa
         daxa_cmd_push_constant(
             this->internal, data, size);
     }
+    _DAXA_DECL_RENDER_COMMAND_LIST_WRAPPER_CHECK_RESULT(set_uniform_buffer, SetUniformBufferInfo)
 
     /// --- End RenderCommandBuffer
 
@@ -936,6 +1039,8 @@ namespace daxa
             r_cast<daxa_BuildAccelerationStucturesInfo const *>(&info));
         check_result(result, "failed to build acceleration structures");
     }
+    _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(write_blas_compacted_sizes, WriteBlasCompactedSizesInfo)
+    _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(copy_blas_to_blas, BlasCopyInfo)
     _DAXA_DECL_COMMAND_LIST_WRAPPER(pipeline_barrier, MemoryBarrierInfo)
     _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(pipeline_barrier_image_transition, ImageMemoryBarrierInfo)
     _DAXA_DECL_COMMAND_LIST_WRAPPER(signal_event, EventSignalInfo)
@@ -954,6 +1059,7 @@ namespace daxa
         daxa_cmd_push_constant(
             this->internal, data, size);
     }
+    _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(set_uniform_buffer, SetUniformBufferInfo)
 
     void CommandRecorder::set_pipeline(ComputePipeline const & pipeline)
     {
@@ -983,6 +1089,8 @@ namespace daxa
     _DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(image, Image)
     _DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(image_view, ImageView)
     _DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(sampler, Sampler)
+    _DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(tlas, Tlas)
+    _DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(blas, Blas)
 
     auto CommandRecorder::begin_renderpass(RenderPassBeginInfo const & info) && -> RenderCommandRecorder
     {
@@ -1008,8 +1116,18 @@ namespace daxa
 
     _DAXA_DECL_COMMAND_LIST_WRAPPER(write_timestamp, WriteTimestampInfo)
     _DAXA_DECL_COMMAND_LIST_WRAPPER(reset_timestamps, ResetTimestampsInfo)
+    _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(begin_query, QueryInfo)
+    _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(end_query, QueryInfo)
+    _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(reset_queries, ResetQueriesInfo)
+    _DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(begin_conditional_rendering, ConditionalRenderingInfo)
     _DAXA_DECL_COMMAND_LIST_WRAPPER(begin_label, CommandLabelInfo)
 
+    void CommandRecorder::end_conditional_rendering()
+    {
+        auto result = daxa_cmd_end_conditional_rendering(this->internal);
+        check_result(result, "failed in end_conditional_rendering");
+    }
+
     void CommandRecorder::end_label()
     {
         daxa_cmd_end_label(this->internal);
@@ -1605,6 +1723,14 @@ namespace daxa
             }
             ret += "RAY_TRACING_SHADER";
         }
+        if ((flags & PipelineStageFlagBits::CONDITIONAL_RENDERING) != PipelineStageFlagBits::NONE)
+        {
+            if (!ret.empty())
+            {
+                ret += " | ";
+            }
+            ret += "CONDITIONAL_RENDERING";
+        }
         if ((flags & PipelineStageFlagBits::TRANSFER) != PipelineStageFlagBits::NONE)
         {
             if (!ret.empty())
@@ -253,6 +253,54 @@ void remember_ids(daxa_CommandRecorder self, Args... args)
     _DAXA_CHECK_IDS(__VA_ARGS__)          \
     _DAXA_REMEMBER_IDS(__VA_ARGS__)
 
+void flush_uniform_buffer_bindings(daxa_CommandRecorder self)
+{
+    if (!self->uniform_buffer_bindings_dirty || self->current_pipeline_layout == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    std::array<VkWriteDescriptorSet, CONSTANT_BUFFER_BINDING_COUNT> writes = {};
+    u32 write_count = 0;
+    for (u32 binding = 0; binding < CONSTANT_BUFFER_BINDING_COUNT; ++binding)
+    {
+        if (self->uniform_buffer_bindings.at(binding).buffer == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+        writes.at(write_count++) = VkWriteDescriptorSet{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = {},
+            .dstBinding = binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pImageInfo = nullptr,
+            .pBufferInfo = &self->uniform_buffer_bindings.at(binding),
+            .pTexelBufferView = nullptr,
+        };
+    }
+    if (write_count > 0)
+    {
+        self->device->vkCmdPushDescriptorSetKHR(
+            self->current_command_data.vk_cmd_buffer,
+            self->current_pipeline_bind_point,
+            self->current_pipeline_layout,
+            CONSTANT_BUFFER_BINDING_SET,
+            write_count,
+            writes.data());
+    }
+    self->uniform_buffer_bindings_dirty = false;
+}
+
+void set_uniform_buffer_pipeline_layout(daxa_CommandRecorder self, VkPipelineLayout layout, VkPipelineBindPoint bind_point)
+{
+    self->current_pipeline_layout = layout;
+    self->current_pipeline_bind_point = bind_point;
+    // Binding a pipeline with a different push constant size can disturb the pushed uniform buffer set.
+    self->uniform_buffer_bindings_dirty = true;
+}
+
 /// --- End Helpers ---
 
 /// --- Begin API Functions ---
@@ -382,53 +430,171 @@ auto daxa_cmd_build_acceleration_structures(daxa_CommandRecorder self, daxa_Buil
     {
         _DAXA_CHECK_IDS(self, bb_info.dst_blas)
     }
+    // Source acceleration structures are optional, they are only set for updates.
+    for (auto const & tb_info : std::span{info->tlas_build_infos, info->tlas_build_info_count})
+    {
+        if (tb_info.src_tlas.value != 0)
+        {
+            _DAXA_CHECK_IDS(self, tb_info.src_tlas)
+        }
+    }
+    for (auto const & bb_info : std::span{info->blas_build_infos, info->blas_build_info_count})
+    {
+        if (bb_info.src_blas.value != 0)
+        {
+            _DAXA_CHECK_IDS(self, bb_info.src_blas)
+        }
+    }
     for (auto const & tb_info : std::span{info->tlas_build_infos, info->tlas_build_info_count})
     {
         _DAXA_REMEMBER_IDS(self, tb_info.dst_tlas)
+        if (tb_info.src_tlas.value != 0)
+        {
+            _DAXA_REMEMBER_IDS(self, tb_info.src_tlas)
+        }
     }
     for (auto const & bb_info : std::span{info->blas_build_infos, info->blas_build_info_count})
     {
         _DAXA_REMEMBER_IDS(self, bb_info.dst_blas)
+        if (bb_info.src_blas.value != 0)
+        {
+            _DAXA_REMEMBER_IDS(self, bb_info.src_blas)
+        }
     }
     // TODO(Raytracing): properties validation!
-    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> vk_build_geometry_infos;
-    std::vector<VkAccelerationStructureGeometryKHR> vk_geometry_infos;
-    std::vector<u32> primitive_counts;
-    std::vector<u32 const *> primitive_counts_ptrs;
+    // The conversion vectors are kept in the recorder to reuse their allocations across builds.
+    auto & scratch = self->as_build_scratch;
+    scratch.vk_build_geometry_infos.clear();
+    scratch.vk_geometry_infos.clear();
+    scratch.primitive_counts.clear();
+    scratch.primitive_counts_ptrs.clear();
+    scratch.vk_build_ranges.clear();
+    scratch.vk_build_ranges_ptrs.clear();
     daxa_as_build_info_to_vk(
         self->device,
         info->tlas_build_infos,
         info->tlas_build_info_count,
         info->blas_build_infos,
         info->blas_build_info_count,
-        vk_build_geometry_infos,
-        vk_geometry_infos,
-        primitive_counts,
-        primitive_counts_ptrs);
+        scratch.vk_build_geometry_infos,
+        scratch.vk_geometry_infos,
+        scratch.primitive_counts,
+        scratch.primitive_counts_ptrs);
     // Convert the primitive count arrays to build range arrays:
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR> vk_build_ranges;
-    vk_build_ranges.reserve(primitive_counts.size());
-    for (auto prim_count : primitive_counts)
+    scratch.vk_build_ranges.reserve(scratch.primitive_counts.size());
+    for (auto prim_count : scratch.primitive_counts)
     {
-        vk_build_ranges.push_back(VkAccelerationStructureBuildRangeInfoKHR{
+        scratch.vk_build_ranges.push_back(VkAccelerationStructureBuildRangeInfoKHR{
             .primitiveCount = prim_count,
             .primitiveOffset = {},
             .firstVertex = {},
             .transformOffset = {},
         });
     }
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR const *> vk_build_ranges_ptrs;
-    vk_build_ranges_ptrs.reserve(primitive_counts_ptrs.size());
-    for (auto prim_counts_ptr : primitive_counts_ptrs)
+    scratch.vk_build_ranges_ptrs.reserve(scratch.primitive_counts_ptrs.size());
+    for (auto prim_counts_ptr : scratch.primitive_counts_ptrs)
     {
-        u64 prim_counts_start_idx = static_cast<u64>(prim_counts_ptr - primitive_counts.data()) / sizeof(u32);
-        vk_build_ranges_ptrs.push_back(vk_build_ranges.data() + prim_counts_start_idx);
+        u64 prim_counts_start_idx = static_cast<u64>(prim_counts_ptr - scratch.primitive_counts.data());
+        scratch.vk_build_ranges_ptrs.push_back(scratch.vk_build_ranges.data() + prim_counts_start_idx);
     }
     self->device->vkCmdBuildAccelerationStructuresKHR(
         self->current_command_data.vk_cmd_buffer,
-        static_cast<u32>(vk_build_geometry_infos.size()),
-        vk_build_geometry_infos.data(),
-        vk_build_ranges_ptrs.data());
+        static_cast<u32>(scratch.vk_build_geometry_infos.size()),
+        scratch.vk_build_geometry_infos.data(),
+        scratch.vk_build_ranges_ptrs.data());
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_write_blas_compacted_sizes(daxa_CommandRecorder self, daxa_WriteBlasCompactedSizesInfo const * info) -> daxa_Result
+{
+    if ((self->device->info.flags & DeviceFlagBits::RAY_TRACING) == DeviceFlagBits::NONE)
+    {
+        return DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING;
+    }
+    if (info->blas_count == 0)
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+    _DAXA_CHECK_IDS(self, info->dst_buffer)
+    for (auto const & blas : std::span{info->blas, info->blas_count})
+    {
+        _DAXA_CHECK_IDS(self, blas)
+    }
+    if (info->dst_offset % sizeof(u64) != 0)
+    {
+        return DAXA_RESULT_INVALID_BUFFER_OFFSET;
+    }
+    if (info->dst_offset + info->blas_count * sizeof(u64) > self->device->slot(info->dst_buffer).info.size)
+    {
+        return DAXA_RESULT_INVALID_BUFFER_RANGE;
+    }
+    _DAXA_REMEMBER_IDS(self, info->dst_buffer)
+    for (auto const & blas : std::span{info->blas, info->blas_count})
+    {
+        _DAXA_REMEMBER_IDS(self, blas)
+    }
+    // Compacted sizes can only be written to query pools.
+    // The pool is owned by the recorder and lives as long as the recorded commands.
+    VkQueryPoolCreateInfo const vk_query_pool_create_info{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = {},
+        .queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+        .queryCount = static_cast<u32>(info->blas_count),
+        .pipelineStatistics = {},
+    };
+    VkQueryPool vk_query_pool = {};
+    auto vk_result = vkCreateQueryPool(self->device->vk_device, &vk_query_pool_create_info, nullptr, &vk_query_pool);
+    if (vk_result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+    self->owned_query_pools.push_back(vk_query_pool);
+    std::vector<VkAccelerationStructureKHR> vk_acceleration_structures = {};
+    vk_acceleration_structures.reserve(info->blas_count);
+    for (auto const & blas : std::span{info->blas, info->blas_count})
+    {
+        vk_acceleration_structures.push_back(self->device->slot(blas).vk_acceleration_structure);
+    }
+    daxa_cmd_flush_barriers(self);
+    vkCmdResetQueryPool(self->current_command_data.vk_cmd_buffer, vk_query_pool, 0, static_cast<u32>(info->blas_count));
+    self->device->vkCmdWriteAccelerationStructuresPropertiesKHR(
+        self->current_command_data.vk_cmd_buffer,
+        static_cast<u32>(vk_acceleration_structures.size()),
+        vk_acceleration_structures.data(),
+        VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+        vk_query_pool,
+        0);
+    vkCmdCopyQueryPoolResults(
+        self->current_command_data.vk_cmd_buffer,
+        vk_query_pool,
+        0,
+        static_cast<u32>(info->blas_count),
+        self->device->slot(info->dst_buffer).vk_buffer,
+        info->dst_offset,
+        sizeof(u64),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_copy_blas_to_blas(daxa_CommandRecorder self, daxa_BlasCopyInfo const * info) -> daxa_Result
+{
+    if ((self->device->info.flags & DeviceFlagBits::RAY_TRACING) == DeviceFlagBits::NONE)
+    {
+        return DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING;
+    }
+    _DAXA_CHECK_AND_REMEMBER_IDS(self, info->src_blas, info->dst_blas)
+    daxa_cmd_flush_barriers(self);
+    VkCopyAccelerationStructureInfoKHR const vk_copy_info{
+        .sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR,
+        .pNext = nullptr,
+        .src = self->device->slot(info->src_blas).vk_acceleration_structure,
+        .dst = self->device->slot(info->dst_blas).vk_acceleration_structure,
+        .mode = info->compact != 0
+                    ? VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR
+                    : VK_COPY_ACCELERATION_STRUCTURE_MODE_CLONE_KHR,
+    };
+    self->device->vkCmdCopyAccelerationStructureKHR(self->current_command_data.vk_cmd_buffer, &vk_copy_info);
     return DAXA_RESULT_SUCCESS;
 }
 
@@ -629,11 +795,42 @@ void daxa_cmd_push_constant(daxa_CommandRecorder self, void const * data, uint32
     vkCmdPushConstants(self->current_command_data.vk_cmd_buffer, self->device->gpu_sro_table.pipeline_layouts.at(layout_index), VK_SHADER_STAGE_ALL, 0, size, data);
 }
 
+auto daxa_cmd_set_uniform_buffer(daxa_CommandRecorder self, daxa_SetUniformBufferInfo const * info) -> daxa_Result
+{
+    if (!self->device->physical_device_properties.push_descriptor_supported)
+    {
+        return DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_PUSH_DESCRIPTOR;
+    }
+    if (info->slot >= CONSTANT_BUFFER_BINDING_COUNT)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    _DAXA_CHECK_AND_REMEMBER_IDS(self, info->buffer)
+    auto const & limits = self->device->physical_device_properties.limits;
+    if (info->offset % limits.min_uniform_buffer_offset_alignment != 0)
+    {
+        return DAXA_RESULT_INVALID_BUFFER_OFFSET;
+    }
+    auto const & buffer_slot = self->device->slot(info->buffer);
+    if (info->size == 0 || info->size > limits.max_uniform_buffer_range || info->offset + info->size > buffer_slot.info.size)
+    {
+        return DAXA_RESULT_INVALID_BUFFER_RANGE;
+    }
+    self->uniform_buffer_bindings.at(info->slot) = VkDescriptorBufferInfo{
+        .buffer = buffer_slot.vk_buffer,
+        .offset = info->offset,
+        .range = info->size,
+    };
+    self->uniform_buffer_bindings_dirty = true;
+    return DAXA_RESULT_SUCCESS;
+}
+
 void daxa_cmd_set_ray_tracing_pipeline(daxa_CommandRecorder self, daxa_RayTracingPipeline pipeline)
 {
     self->shader_binding_table = pipeline->info.shader_binding_table;
     daxa_cmd_flush_barriers(self);
     vkCmdBindDescriptorSets(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline->vk_pipeline_layout, 0, 1, &self->device->gpu_sro_table.vk_descriptor_set, 0, nullptr);
+    set_uniform_buffer_pipeline_layout(self, pipeline->vk_pipeline_layout, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR);
     vkCmdBindPipeline(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline->vk_pipeline);
 }
 
@@ -641,6 +838,7 @@ void daxa_cmd_set_compute_pipeline(daxa_CommandRecorder self, daxa_ComputePipeli
 {
     daxa_cmd_flush_barriers(self);
     vkCmdBindDescriptorSets(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, (**pipeline).vk_pipeline_layout, 0, 1, &self->device->gpu_sro_table.vk_descriptor_set, 0, nullptr);
+    set_uniform_buffer_pipeline_layout(self, (**pipeline).vk_pipeline_layout, VK_PIPELINE_BIND_POINT_COMPUTE);
     vkCmdBindPipeline(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, (**pipeline).vk_pipeline);
 }
 
@@ -648,11 +846,13 @@ void daxa_cmd_set_raster_pipeline(daxa_CommandRecorder self, daxa_RasterPipeline
 {
     daxa_cmd_flush_barriers(self);
     vkCmdBindDescriptorSets(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->vk_pipeline_layout, 0, 1, &self->device->gpu_sro_table.vk_descriptor_set, 0, nullptr);
+    set_uniform_buffer_pipeline_layout(self, pipeline->vk_pipeline_layout, VK_PIPELINE_BIND_POINT_GRAPHICS);
     vkCmdBindPipeline(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->vk_pipeline);
 }
 
 void daxa_cmd_trace_rays(daxa_CommandRecorder self, daxa_TraceRaysInfo const * info)
 {
+    flush_uniform_buffer_bindings(self);
     // TODO: Check if those offsets are in range?
     StridedDeviceAddressRegion raygen_handle = self->shader_binding_table.raygen_region;
     raygen_handle.address += self->shader_binding_table.raygen_region.stride * info->raygen_handle_offset;
@@ -673,12 +873,14 @@ void daxa_cmd_trace_rays(daxa_CommandRecorder self, daxa_TraceRaysInfo const * i
 
 void daxa_cmd_dispatch(daxa_CommandRecorder self, daxa_DispatchInfo const * info)
 {
+    flush_uniform_buffer_bindings(self);
     vkCmdDispatch(self->current_command_data.vk_cmd_buffer, info->x, info->y, info->z);
 }
 
 auto daxa_cmd_dispatch_indirect(daxa_CommandRecorder self, daxa_DispatchIndirectInfo const * info) -> daxa_Result
 {
     _DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer)
+    flush_uniform_buffer_bindings(self);
     vkCmdDispatchIndirect(self->current_command_data.vk_cmd_buffer, self->device->slot(info->indirect_buffer).vk_buffer, info->offset);
     return DAXA_RESULT_SUCCESS;
 }
@@ -711,6 +913,20 @@ auto daxa_cmd_destroy_sampler_deferred(daxa_CommandRecorder self, daxa_SamplerId
     return DAXA_RESULT_SUCCESS;
 }
 
+auto daxa_cmd_destroy_tlas_deferred(daxa_CommandRecorder self, daxa_TlasId id) -> daxa_Result
+{
+    _DAXA_CHECK_AND_REMEMBER_IDS(self, id)
+    self->current_command_data.deferred_destructions.emplace_back(std::bit_cast<GPUResourceId>(id), DEFERRED_DESTRUCTION_TLAS_INDEX);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_destroy_blas_deferred(daxa_CommandRecorder self, daxa_BlasId id) -> daxa_Result
+{
+    _DAXA_CHECK_AND_REMEMBER_IDS(self, id)
+    self->current_command_data.deferred_destructions.emplace_back(std::bit_cast<GPUResourceId>(id), DEFERRED_DESTRUCTION_BLAS_INDEX);
+    return DAXA_RESULT_SUCCESS;
+}
+
 auto daxa_cmd_begin_renderpass(daxa_CommandRecorder self, daxa_RenderPassBeginInfo const * info) -> daxa_Result
 {
     daxa_cmd_flush_barriers(self);
@@ -847,17 +1063,20 @@ auto daxa_cmd_set_index_buffer(daxa_CommandRecorder self, daxa_SetIndexBufferInf
 
 void daxa_cmd_draw(daxa_CommandRecorder self, daxa_DrawInfo const * info)
 {
+    flush_uniform_buffer_bindings(self);
     vkCmdDraw(self->current_command_data.vk_cmd_buffer, info->vertex_count, info->instance_count, info->first_vertex, info->first_instance);
 }
 
 void daxa_cmd_draw_indexed(daxa_CommandRecorder self, daxa_DrawIndexedInfo const * info)
 {
+    flush_uniform_buffer_bindings(self);
     vkCmdDrawIndexed(self->current_command_data.vk_cmd_buffer, info->index_count, info->instance_count, info->first_index, info->vertex_offset, info->first_instance);
 }
 
 auto daxa_cmd_draw_indirect(daxa_CommandRecorder self, daxa_DrawIndirectInfo const * info) -> daxa_Result
 {
     _DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer)
+    flush_uniform_buffer_bindings(self);
     if (info->is_indexed)
     {
         vkCmdDrawIndexedIndirect(
@@ -882,6 +1101,7 @@ auto daxa_cmd_draw_indirect(daxa_CommandRecorder self, daxa_DrawIndirectInfo con
 auto daxa_cmd_draw_indirect_count(daxa_CommandRecorder self, daxa_DrawIndirectCountInfo const * info) -> daxa_Result
 {
     _DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer, info->count_buffer)
+    flush_uniform_buffer_bindings(self);
     if (info->is_indexed)
     {
         vkCmdDrawIndexedIndirectCount(
@@ -909,6 +1129,7 @@ auto daxa_cmd_draw_indirect_count(daxa_CommandRecorder self, daxa_DrawIndirectCo
 
 void daxa_cmd_draw_mesh_tasks(daxa_CommandRecorder self, uint32_t x, uint32_t y, uint32_t z)
 {
+    flush_uniform_buffer_bindings(self);
     if ((self->device->info.flags & DeviceFlagBits::MESH_SHADER) != DeviceFlagBits::MESH_SHADER)
     {
         self->device->vkCmdDrawMeshTasksEXT(self->current_command_data.vk_cmd_buffer, x, y, z);
@@ -918,6 +1139,7 @@ void daxa_cmd_draw_mesh_tasks(daxa_CommandRecorder self, uint32_t x, uint32_t y,
 auto daxa_cmd_draw_mesh_tasks_indirect(daxa_CommandRecorder self, daxa_DrawMeshTasksIndirectInfo const * info) -> daxa_Result
 {
     _DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer)
+    flush_uniform_buffer_bindings(self);
     if ((self->device->info.flags & DeviceFlagBits::MESH_SHADER) != DeviceFlagBits::MESH_SHADER)
     {
         self->device->vkCmdDrawMeshTasksIndirectEXT(
@@ -935,6 +1157,7 @@ auto daxa_cmd_draw_mesh_tasks_indirect_count(
     daxa_DrawMeshTasksIndirectCountInfo const * info) -> daxa_Result
 {
     _DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer, info->count_buffer)
+    flush_uniform_buffer_bindings(self);
     if ((self->device->info.flags & DeviceFlagBits::MESH_SHADER) != DeviceFlagBits::MESH_SHADER)
     {
         self->device->vkCmdDrawMeshTasksIndirectCountEXT(
@@ -969,6 +1192,110 @@ void daxa_cmd_reset_timestamps(daxa_CommandRecorder self, daxa_ResetTimestampsIn
         info->count);
 }
 
+auto daxa_cmd_begin_query(daxa_CommandRecorder self, daxa_QueryInfo const * info) -> daxa_Result
+{
+    daxa_QueryPool query_pool = *info->query_pool;
+    if (info->query_index >= query_pool->info.query_count)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    daxa_cmd_flush_barriers(self);
+    vkCmdBeginQuery(
+        self->current_command_data.vk_cmd_buffer,
+        query_pool->vk_query_pool,
+        info->query_index,
+        0);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_end_query(daxa_CommandRecorder self, daxa_QueryInfo const * info) -> daxa_Result
+{
+    daxa_QueryPool query_pool = *info->query_pool;
+    if (info->query_index >= query_pool->info.query_count)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    daxa_cmd_flush_barriers(self);
+    vkCmdEndQuery(
+        self->current_command_data.vk_cmd_buffer,
+        query_pool->vk_query_pool,
+        info->query_index);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_reset_queries(daxa_CommandRecorder self, daxa_ResetQueriesInfo const * info) -> daxa_Result
+{
+    daxa_QueryPool query_pool = *info->query_pool;
+    if (static_cast<u64>(info->start_index) + info->count > query_pool->info.query_count)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    if (self->in_renderpass)
+    {
+        return DAXA_RESULT_COMMAND_INVALID_WITHIN_RENDERPASS;
+    }
+    daxa_cmd_flush_barriers(self);
+    vkCmdResetQueryPool(
+        self->current_command_data.vk_cmd_buffer,
+        query_pool->vk_query_pool,
+        info->start_index,
+        info->count);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_begin_conditional_rendering(daxa_CommandRecorder self, daxa_ConditionalRenderingInfo const * info) -> daxa_Result
+{
+    if ((self->device->info.flags & DeviceFlagBits::CONDITIONAL_RENDERING) == DeviceFlagBits::NONE)
+    {
+        return DAXA_RESULT_INVALID_WITHOUT_ENABLING_CONDITIONAL_RENDERING;
+    }
+    if (self->in_renderpass)
+    {
+        return DAXA_RESULT_COMMAND_INVALID_WITHIN_RENDERPASS;
+    }
+    if (self->in_conditional_rendering)
+    {
+        return DAXA_RESULT_UNBALANCED_CONDITIONAL_RENDERING;
+    }
+    _DAXA_CHECK_AND_REMEMBER_IDS(self, info->buffer)
+    // The condition is a 32 bit value, its offset must be 4 byte aligned.
+    if ((info->offset % 4) != 0 || info->offset + sizeof(u32) > self->device->slot(info->buffer).info.size)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    daxa_cmd_flush_barriers(self);
+    VkConditionalRenderingBeginInfoEXT const vk_conditional_rendering_begin_info{
+        .sType = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT,
+        .pNext = nullptr,
+        .buffer = self->device->slot(info->buffer).vk_buffer,
+        .offset = info->offset,
+        .flags = info->inverted ? VK_CONDITIONAL_RENDERING_INVERTED_BIT_EXT : VkConditionalRenderingFlagsEXT{},
+    };
+    self->device->vkCmdBeginConditionalRenderingEXT(self->current_command_data.vk_cmd_buffer, &vk_conditional_rendering_begin_info);
+    self->in_conditional_rendering = true;
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_end_conditional_rendering(daxa_CommandRecorder self) -> daxa_Result
+{
+    if ((self->device->info.flags & DeviceFlagBits::CONDITIONAL_RENDERING) == DeviceFlagBits::NONE)
+    {
+        return DAXA_RESULT_INVALID_WITHOUT_ENABLING_CONDITIONAL_RENDERING;
+    }
+    if (self->in_renderpass)
+    {
+        return DAXA_RESULT_COMMAND_INVALID_WITHIN_RENDERPASS;
+    }
+    if (!self->in_conditional_rendering)
+    {
+        return DAXA_RESULT_UNBALANCED_CONDITIONAL_RENDERING;
+    }
+    daxa_cmd_flush_barriers(self);
+    self->device->vkCmdEndConditionalRenderingEXT(self->current_command_data.vk_cmd_buffer);
+    self->in_conditional_rendering = false;
+    return DAXA_RESULT_SUCCESS;
+}
+
 void daxa_cmd_begin_label(daxa_CommandRecorder self, daxa_CommandLabelInfo const * info)
 {
     daxa_cmd_flush_barriers(self);
@@ -1025,6 +1352,10 @@ auto daxa_cmd_complete_current_commands(
     daxa_CommandRecorder self,
     daxa_ExecutableCommandList * out_executable_cmds) -> daxa_Result
 {
+    if (self->in_conditional_rendering)
+    {
+        return DAXA_RESULT_UNBALANCED_CONDITIONAL_RENDERING;
+    }
     daxa_cmd_flush_barriers(self);
     auto vk_result = vkEndCommandBuffer(self->current_command_data.vk_cmd_buffer);
     if (vk_result != VK_SUCCESS)
@@ -1064,6 +1395,15 @@ auto daxa_cmd_get_vk_command_pool(daxa_CommandRecorder self) -> VkCommandPool
 void daxa_destroy_command_recorder(daxa_CommandRecorder self)
 {
     self->device->gpu_sro_table.lifetime_lock.unlock_shared();
+    if ((self->device->info.flags & DeviceFlagBits::BACKGROUND_GARBAGE_COLLECTION) != DeviceFlagBits::NONE &&
+        self->device->command_recorder_count.fetch_sub(1) == 1)
+    {
+        // Taking the mutex orders the notification after a concurrent check of the count by the garbage collection thread.
+        {
+            std::unique_lock wake_lock{self->device->garbage_collection_wake_mtx};
+        }
+        self->device->garbage_collection_wake_cv.notify_all();
+    }
     self->dec_refcnt(
         daxa_ImplCommandRecorder::zero_ref_callback,
         self->device->instance);
@@ -1101,6 +1441,11 @@ auto daxa_dvc_create_command_recorder(daxa_Device device, daxa_CommandRecorderIn
         };
         ret.device->vkSetDebugUtilsObjectNameEXT(ret.device->vk_device, &cmd_pool_name_info);
     }
+    if ((ret.device->info.flags & DeviceFlagBits::BACKGROUND_GARBAGE_COLLECTION) != DeviceFlagBits::NONE)
+    {
+        // Counted before taking the lock, so that the garbage collection thread never sees zero recorders while one holds it.
+        ret.device->command_recorder_count.fetch_add(1);
+    }
     // TODO(lifetime): Maybe we should have a try lock variant?
     ret.device->gpu_sro_table.lifetime_lock.lock_shared();
     ret.strong_count = 1;
@@ -1152,6 +1497,10 @@ auto daxa_ImplCommandRecorder::generate_new_current_command_data() -> daxa_Resul
         return std::bit_cast<daxa_Result>(vk_result);
     }
     this->allocated_command_buffers.push_back(this->current_command_data.vk_cmd_buffer);
+    // Pipeline and push descriptor state does not carry over into the new command buffer.
+    this->uniform_buffer_bindings = {};
+    this->uniform_buffer_bindings_dirty = false;
+    this->current_pipeline_layout = {};
     this->current_command_data.used_buffers.reserve(12);
     this->current_command_data.used_images.reserve(12);
     this->current_command_data.used_image_views.reserve(12);
@@ -1169,6 +1518,7 @@ void daxa_ImplCommandRecorder::zero_ref_callback(ImplHandle const * handle)
         CommandRecorderZombie{
             .vk_cmd_pool = self->vk_cmd_pool,
             .allocated_command_buffers = std::move(self->allocated_command_buffers),
+            .owned_query_pools = std::move(self->owned_query_pools),
         },
     });
     self->device->dec_weak_refcnt(
@@ -16,6 +16,8 @@ static inline constexpr u8 DEFERRED_DESTRUCTION_IMAGE_INDEX = 1;
 static inline constexpr u8 DEFERRED_DESTRUCTION_IMAGE_VIEW_INDEX = 2;
 static inline constexpr u8 DEFERRED_DESTRUCTION_SAMPLER_INDEX = 3;
 static inline constexpr u8 DEFERRED_DESTRUCTION_TIMELINE_QUERY_POOL_INDEX = 4;
+static inline constexpr u8 DEFERRED_DESTRUCTION_TLAS_INDEX = 5;
+static inline constexpr u8 DEFERRED_DESTRUCTION_BLAS_INDEX = 6;
 // TODO: maybe reintroduce this in some fashion?
 // static inline constexpr usize DEFERRED_DESTRUCTION_COUNT_MAX = 32;
 
@@ -37,6 +39,7 @@ struct CommandRecorderZombie
 {
     VkCommandPool vk_cmd_pool = {};
     std::vector<VkCommandBuffer> allocated_command_buffers = {};
+    std::vector<VkQueryPool> owned_query_pools = {};
 };
 
 struct ExecutableCommandListData
@@ -55,10 +58,21 @@ struct ExecutableCommandListData
     std::vector<BlasId> used_blass = {};
 };
 
+struct AccelerationStructureBuildScratch
+{
+    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> vk_build_geometry_infos = {};
+    std::vector<VkAccelerationStructureGeometryKHR> vk_geometry_infos = {};
+    std::vector<u32> primitive_counts = {};
+    std::vector<u32 const *> primitive_counts_ptrs = {};
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR> vk_build_ranges = {};
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR const *> vk_build_ranges_ptrs = {};
+};
+
 struct daxa_ImplCommandRecorder final : ImplHandle
 {
     daxa_Device device = {};
     bool in_renderpass = {};
+    bool in_conditional_rendering = {};
     daxa_CommandRecorderInfo info = {};
     VkCommandPool vk_cmd_pool = {};
     std::vector<VkCommandBuffer> allocated_command_buffers = {};
@@ -69,6 +83,16 @@ struct daxa_ImplCommandRecorder final : ImplHandle
     usize split_barrier_batch_count = {};
     // TODO: pass this by parameter to the functions that need it.
     RayTracingShaderBindingTable shader_binding_table = {};
+    // Uniform buffer bindings are pushed lazily before the next draw/dispatch/trace,
+    // as push descriptors need the layout and bind point of the currently set pipeline.
+    std::array<VkDescriptorBufferInfo, CONSTANT_BUFFER_BINDING_COUNT> uniform_buffer_bindings = {};
+    bool uniform_buffer_bindings_dirty = {};
+    VkPipelineLayout current_pipeline_layout = {};
+    VkPipelineBindPoint current_pipeline_bind_point = {};
+    // Query pools created internally by commands (e.g. compacted size queries).
+    // They are destroyed together with the command buffers once the gpu is done with them.
+    std::vector<VkQueryPool> owned_query_pools = {};
+    AccelerationStructureBuildScratch as_build_scratch = {};
 
     ExecutableCommandListData current_command_data = {};
 
@@ -41,6 +41,197 @@ auto infer_aspect_from_format(Format format) -> VkImageAspectFlags
     return VK_IMAGE_ASPECT_COLOR_BIT;
 }
 
+// Size in bytes of a texel, or of a block for block compressed formats.
+// Combined depth stencil formats return the texel size of their depth aspect.
+auto texel_block_size(Format format) -> u32
+{
+    switch (format)
+    {
+    case Format::R4G4_UNORM_PACK8: return 1;
+    case Format::R4G4B4A4_UNORM_PACK16: return 2;
+    case Format::B4G4R4A4_UNORM_PACK16: return 2;
+    case Format::R5G6B5_UNORM_PACK16: return 2;
+    case Format::B5G6R5_UNORM_PACK16: return 2;
+    case Format::R5G5B5A1_UNORM_PACK16: return 2;
+    case Format::B5G5R5A1_UNORM_PACK16: return 2;
+    case Format::A1R5G5B5_UNORM_PACK16: return 2;
+    case Format::R8_UNORM: return 1;
+    case Format::R8_SNORM: return 1;
+    case Format::R8_USCALED: return 1;
+    case Format::R8_SSCALED: return 1;
+    case Format::R8_UINT: return 1;
+    case Format::R8_SINT: return 1;
+    case Format::R8_SRGB: return 1;
+    case Format::R8G8_UNORM: return 2;
+    case Format::R8G8_SNORM: return 2;
+    case Format::R8G8_USCALED: return 2;
+    case Format::R8G8_SSCALED: return 2;
+    case Format::R8G8_UINT: return 2;
+    case Format::R8G8_SINT: return 2;
+    case Format::R8G8_SRGB: return 2;
+    case Format::R8G8B8_UNORM: return 3;
+    case Format::R8G8B8_SNORM: return 3;
+    case Format::R8G8B8_USCALED: return 3;
+    case Format::R8G8B8_SSCALED: return 3;
+    case Format::R8G8B8_UINT: return 3;
+    case Format::R8G8B8_SINT: return 3;
+    case Format::R8G8B8_SRGB: return 3;
+    case Format::B8G8R8_UNORM: return 3;
+    case Format::B8G8R8_SNORM: return 3;
+    case Format::B8G8R8_USCALED: return 3;
+    case Format::B8G8R8_SSCALED: return 3;
+    case Format::B8G8R8_UINT: return 3;
+    case Format::B8G8R8_SINT: return 3;
+    case Format::B8G8R8_SRGB: return 3;
+    case Format::R8G8B8A8_UNORM: return 4;
+    case Format::R8G8B8A8_SNORM: return 4;
+    case Format::R8G8B8A8_USCALED: return 4;
+    case Format::R8G8B8A8_SSCALED: return 4;
+    case Format::R8G8B8A8_UINT: return 4;
+    case Format::R8G8B8A8_SINT: return 4;
+    case Format::R8G8B8A8_SRGB: return 4;
+    case Format::B8G8R8A8_UNORM: return 4;
+    case Format::B8G8R8A8_SNORM: return 4;
+    case Format::B8G8R8A8_USCALED: return 4;
+    case Format::B8G8R8A8_SSCALED: return 4;
+    case Format::B8G8R8A8_UINT: return 4;
+    case Format::B8G8R8A8_SINT: return 4;
+    case Format::B8G8R8A8_SRGB: return 4;
+    case Format::A8B8G8R8_UNORM_PACK32: return 4;
+    case Format::A8B8G8R8_SNORM_PACK32: return 4;
+    case Format::A8B8G8R8_USCALED_PACK32: return 4;
+    case Format::A8B8G8R8_SSCALED_PACK32: return 4;
+    case Format::A8B8G8R8_UINT_PACK32: return 4;
+    case Format::A8B8G8R8_SINT_PACK32: return 4;
+    case Format::A8B8G8R8_SRGB_PACK32: return 4;
+    case Format::A2R10G10B10_UNORM_PACK32: return 4;
+    case Format::A2R10G10B10_SNORM_PACK32: return 4;
+    case Format::A2R10G10B10_USCALED_PACK32: return 4;
+    case Format::A2R10G10B10_SSCALED_PACK32: return 4;
+    case Format::A2R10G10B10_UINT_PACK32: return 4;
+    case Format::A2R10G10B10_SINT_PACK32: return 4;
+    case Format::A2B10G10R10_UNORM_PACK32: return 4;
+    case Format::A2B10G10R10_SNORM_PACK32: return 4;
+    case Format::A2B10G10R10_USCALED_PACK32: return 4;
+    case Format::A2B10G10R10_SSCALED_PACK32: return 4;
+    case Format::A2B10G10R10_UINT_PACK32: return 4;
+    case Format::A2B10G10R10_SINT_PACK32: return 4;
+    case Format::R16_UNORM: return 2;
+    case Format::R16_SNORM: return 2;
+    case Format::R16_USCALED: return 2;
+    case Format::R16_SSCALED: return 2;
+    case Format::R16_UINT: return 2;
+    case Format::R16_SINT: return 2;
+    case Format::R16_SFLOAT: return 2;
+    case Format::R16G16_UNORM: return 4;
+    case Format::R16G16_SNORM: return 4;
+    case Format::R16G16_USCALED: return 4;
+    case Format::R16G16_SSCALED: return 4;
+    case Format::R16G16_UINT: return 4;
+    case Format::R16G16_SINT: return 4;
+    case Format::R16G16_SFLOAT: return 4;
+    case Format::R16G16B16_UNORM: return 6;
+    case Format::R16G16B16_SNORM: return 6;
+    case Format::R16G16B16_USCALED: return 6;
+    case Format::R16G16B16_SSCALED: return 6;
+    case Format::R16G16B16_UINT: return 6;
+    case Format::R16G16B16_SINT: return 6;
+    case Format::R16G16B16_SFLOAT: return 6;
+    case Format::R16G16B16A16_UNORM: return 8;
+    case Format::R16G16B16A16_SNORM: return 8;
+    case Format::R16G16B16A16_USCALED: return 8;
+    case Format::R16G16B16A16_SSCALED: return 8;
+    case Format::R16G16B16A16_UINT: return 8;
+    case Format::R16G16B16A16_SINT: return 8;
+    case Format::R16G16B16A16_SFLOAT: return 8;
+    case Format::R32_UINT: return 4;
+    case Format::R32_SINT: return 4;
+    case Format::R32_SFLOAT: return 4;
+    case Format::R32G32_UINT: return 8;
+    case Format::R32G32_SINT: return 8;
+    case Format::R32G32_SFLOAT: return 8;
+    case Format::R32G32B32_UINT: return 12;
+    case Format::R32G32B32_SINT: return 12;
+    case Format::R32G32B32_SFLOAT: return 12;
+    case Format::R32G32B32A32_UINT: return 16;
+    case Format::R32G32B32A32_SINT: return 16;
+    case Format::R32G32B32A32_SFLOAT: return 16;
+    case Format::R64_UINT: return 8;
+    case Format::R64_SINT: return 8;
+    case Format::R64_SFLOAT: return 8;
+    case Format::R64G64_UINT: return 16;
+    case Format::R64G64_SINT: return 16;
+    case Format::R64G64_SFLOAT: return 16;
+    case Format::R64G64B64_UINT: return 24;
+    case Format::R64G64B64_SINT: return 24;
+    case Format::R64G64B64_SFLOAT: return 24;
+    case Format::R64G64B64A64_UINT: return 32;
+    case Format::R64G64B64A64_SINT: return 32;
+    case Format::R64G64B64A64_SFLOAT: return 32;
+    case Format::B10G11R11_UFLOAT_PACK32: return 4;
+    case Format::E5B9G9R9_UFLOAT_PACK32: return 4;
+    case Format::D16_UNORM: return 2;
+    case Format::X8_D24_UNORM_PACK32: return 4;
+    case Format::D32_SFLOAT: return 4;
+    case Format::S8_UINT: return 1;
+    case Format::D16_UNORM_S8_UINT: return 2;
+    case Format::D24_UNORM_S8_UINT: return 4;
+    case Format::D32_SFLOAT_S8_UINT: return 4;
+    case Format::BC1_RGB_UNORM_BLOCK: return 8;
+    case Format::BC1_RGB_SRGB_BLOCK: return 8;
+    case Format::BC1_RGBA_UNORM_BLOCK: return 8;
+    case Format::BC1_RGBA_SRGB_BLOCK: return 8;
+    case Format::BC2_UNORM_BLOCK: return 16;
+    case Format::BC2_SRGB_BLOCK: return 16;
+    case Format::BC3_UNORM_BLOCK: return 16;
+    case Format::BC3_SRGB_BLOCK: return 16;
+    case Format::BC4_UNORM_BLOCK: return 8;
+    case Format::BC4_SNORM_BLOCK: return 8;
+    case Format::BC5_UNORM_BLOCK: return 16;
+    case Format::BC5_SNORM_BLOCK: return 16;
+    case Format::BC6H_UFLOAT_BLOCK: return 16;
+    case Format::BC6H_SFLOAT_BLOCK: return 16;
+    case Format::BC7_UNORM_BLOCK: return 16;
+    case Format::BC7_SRGB_BLOCK: return 16;
+    case Format::ETC2_R8G8B8_UNORM_BLOCK: return 8;
+    case Format::ETC2_R8G8B8_SRGB_BLOCK: return 8;
+    case Format::ETC2_R8G8B8A1_UNORM_BLOCK: return 8;
+    case Format::ETC2_R8G8B8A1_SRGB_BLOCK: return 8;
+    case Format::ETC2_R8G8B8A8_UNORM_BLOCK: return 16;
+    case Format::ETC2_R8G8B8A8_SRGB_BLOCK: return 16;
+    case Format::EAC_R11_UNORM_BLOCK: return 8;
+    case Format::EAC_R11_SNORM_BLOCK: return 8;
+    case Format::EAC_R11G11_UNORM_BLOCK: return 16;
+    case Format::EAC_R11G11_SNORM_BLOCK: return 16;
+    case Format::G8B8G8R8_422_UNORM: return 4;
+    case Format::B8G8R8G8_422_UNORM: return 4;
+    case Format::R10X6_UNORM_PACK16: return 2;
+    case Format::R10X6G10X6_UNORM_2PACK16: return 4;
+    case Format::R10X6G10X6B10X6A10X6_UNORM_4PACK16: return 8;
+    case Format::G10X6B10X6G10X6R10X6_422_UNORM_4PACK16: return 8;
+    case Format::B10X6G10X6R10X6G10X6_422_UNORM_4PACK16: return 8;
+    case Format::R12X4_UNORM_PACK16: return 2;
+    case Format::R12X4G12X4_UNORM_2PACK16: return 4;
+    case Format::R12X4G12X4B12X4A12X4_UNORM_4PACK16: return 8;
+    case Format::G12X4B12X4G12X4R12X4_422_UNORM_4PACK16: return 8;
+    case Format::B12X4G12X4R12X4G12X4_422_UNORM_4PACK16: return 8;
+    case Format::G16B16G16R16_422_UNORM: return 8;
+    case Format::B16G16R16G16_422_UNORM: return 8;
+    case Format::A4R4G4B4_UNORM_PACK16: return 2;
+    case Format::A4B4G4R4_UNORM_PACK16: return 2;
+    case Format::PVRTC1_2BPP_UNORM_BLOCK_IMG: return 8;
+    case Format::PVRTC1_4BPP_UNORM_BLOCK_IMG: return 8;
+    case Format::PVRTC2_2BPP_UNORM_BLOCK_IMG: return 8;
+    case Format::PVRTC2_4BPP_UNORM_BLOCK_IMG: return 8;
+    case Format::PVRTC1_2BPP_SRGB_BLOCK_IMG: return 8;
+    case Format::PVRTC1_4BPP_SRGB_BLOCK_IMG: return 8;
+    case Format::PVRTC2_2BPP_SRGB_BLOCK_IMG: return 8;
+    case Format::PVRTC2_4BPP_SRGB_BLOCK_IMG: return 8;
+    // Multi planar formats are copied per plane, 16 is a multiple of the texel size of every plane.
+    default: return 16;
+    }
+}
+
 auto make_subresource_range(ImageMipArraySlice const & slice, VkImageAspectFlags aspect) -> VkImageSubresourceRange
 {
     return VkImageSubresourceRange{
@@ -184,6 +375,14 @@ auto construct_daxa_physical_device_properties(VkPhysicalDevice physical_device)
             vk_physical_device_mesh_shader_properties_ext.pNext = pNextChain;
             pNextChain = &vk_physical_device_mesh_shader_properties_ext;
         }
+        if (std::strcmp(extension.extensionName, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) == 0)
+        {
+            ret.push_descriptor_supported = static_cast<daxa_Bool8>(true);
+        }
+        if (std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+        {
+            ret.memory_budget_supported = static_cast<daxa_Bool8>(true);
+        }
     }
 
     VkPhysicalDeviceProperties2 vk_physical_device_properties2 = {
@@ -296,8 +495,13 @@ void daxa_as_build_info_to_vk(
             .pNext = nullptr,
             .type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
             .flags = static_cast<VkBuildAccelerationStructureFlagsKHR>(info.flags),
-            .mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
-            .srcAccelerationStructure = {}, // TODO(Raytracing)
+            .mode = info.src_tlas.value != 0
+                        ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR
+                        : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+            .srcAccelerationStructure =
+                info.src_tlas.value != 0
+                    ? device->slot(info.src_tlas).vk_acceleration_structure
+                    : 0,
             .dstAccelerationStructure =
                 info.dst_tlas.value != 0
                     ? device->slot(info.dst_tlas).vk_acceleration_structure
@@ -358,8 +562,13 @@ void daxa_as_build_info_to_vk(
             .pNext = nullptr,
             .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
             .flags = static_cast<VkBuildAccelerationStructureFlagsKHR>(info.flags),
-            .mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
-            .srcAccelerationStructure = {}, // TODO(Raytracing)
+            .mode = info.src_blas.value != 0
+                        ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR
+                        : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+            .srcAccelerationStructure =
+                info.src_blas.value != 0
+                    ? device->slot(info.src_blas).vk_acceleration_structure
+                    : 0,
             .dstAccelerationStructure =
                 info.dst_blas.value != 0
                     ? device->slot(info.dst_blas).vk_acceleration_structure
@@ -517,6 +726,11 @@ auto daxa_dvc_create_memory(daxa_Device self, daxa_MemoryBlockInfo const * info,
         return std::bit_cast<daxa_Result>(result);
     }
 
+    auto & block_bytes = info->transient ? self->memory_report_counters.transient_memory_block_bytes : self->memory_report_counters.memory_block_bytes;
+    auto & block_count = info->transient ? self->memory_report_counters.transient_memory_block_count : self->memory_report_counters.memory_block_count;
+    block_bytes.fetch_add(ret.alloc_info.size, std::memory_order_relaxed);
+    block_count.fetch_add(1, std::memory_order_relaxed);
+
     ret.strong_count = 1;
     self->inc_weak_refcnt();
     *out_memory_block = new daxa_ImplMemoryBlock{};
@@ -551,6 +765,7 @@ void daxa_ImplMemoryBlock::zero_ref_callback(ImplHandle const * handle)
         main_queue_cpu_timeline_value,
         MemoryBlockZombie{
             .allocation = self->allocation,
+            .transient = self->info.transient,
         },
     });
     self->device->dec_weak_refcnt(
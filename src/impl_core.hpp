@@ -75,6 +75,8 @@ auto is_stencil_format(Format format) -> bool;
 
 auto infer_aspect_from_format(Format format) -> VkImageAspectFlags;
 
+auto texel_block_size(Format format) -> u32;
+
 auto make_subresource_range(ImageMipArraySlice const & slice, VkImageAspectFlags aspect) -> VkImageSubresourceRange;
 
 auto make_subresource_layers(ImageArraySlice const & slice, VkImageAspectFlags aspect) -> VkImageSubresourceLayers;
@@ -138,6 +140,7 @@ namespace daxa
 struct MemoryBlockZombie
 {
     VmaAllocation allocation = {};
+    bool transient = {};
 };
 
 struct daxa_ImplMemoryBlock final : ImplHandle
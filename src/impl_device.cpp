@@ -1,6 +1,10 @@
 #include "impl_device.hpp"
 
 #include <utility>
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <chrono>
 #include "impl_features.hpp"
 
 #include "impl_device.hpp"
@@ -43,10 +47,37 @@ namespace
         };
         return vk_image_create_info;
     }
+
+    auto initialize_buffer_create_info_from_buffer_info(daxa_BufferInfo const & buffer_info, VkBufferUsageFlags usage, u32 const * queue_family_index_ptr) -> VkBufferCreateInfo
+    {
+        VkBufferCreateInfo const vk_buffer_create_info{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .size = static_cast<VkDeviceSize>(buffer_info.size),
+            .usage = usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 1,
+            .pQueueFamilyIndices = queue_family_index_ptr,
+        };
+        return vk_buffer_create_info;
+    }
+
+    template <typename ResourceT>
+    auto pool_slot_at(GpuResourcePool<ResourceT> & pool, u64 index) -> std::pair<ResourceT, std::atomic_uint64_t> &
+    {
+        using PoolT = GpuResourcePool<ResourceT>;
+        return pool.pages[static_cast<usize>(index) >> PoolT::PAGE_BITS]->at(static_cast<usize>(index) & PoolT::PAGE_MASK);
+    }
+
+    // Set when a completion callback released the last reference to its device on the completion thread.
+    // The device is destroyed at that point, so the thread must exit without touching it again.
+    thread_local bool tl_completion_thread_released_device = false;
     using namespace daxa::types;
 } // namespace
 
-auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_BufferId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset) -> daxa_Result
+// When opt_descriptor_writes is set, the descriptor write is only recorded into it and must be flushed by the caller.
+auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_BufferId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset, DescriptorSetWriteBatch * opt_descriptor_writes) -> daxa_Result
 {
     // --- Begin Parameter Validation ---
 
@@ -67,16 +98,7 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
 
     ret.info = *info;
 
-    VkBufferCreateInfo const vk_buffer_create_info{
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = {},
-        .size = static_cast<VkDeviceSize>(ret.info.size),
-        .usage = BUFFER_USE_FLAGS,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &self->main_queue_family_index,
-    };
+    VkBufferCreateInfo const vk_buffer_create_info = initialize_buffer_create_info_from_buffer_info(ret.info, self->vk_buffer_usage_flags, &self->main_queue_family_index);
 
     bool host_accessible = false;
     VmaAllocationInfo vma_allocation_info = {};
@@ -98,7 +120,7 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
             .preferredFlags = {},
             .memoryTypeBits = std::numeric_limits<u32>::max(),
             .pool = nullptr,
-            .pUserData = nullptr,
+            .pUserData = reinterpret_cast<void *>(static_cast<uintptr_t>((id.index << VMA_USER_DATA_TAG_BITS) | VMA_USER_DATA_BUFFER_TAG)),
             .priority = 0.5f,
         };
 
@@ -111,6 +133,7 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
             &vma_allocation_info);
         if (result != VK_SUCCESS)
         {
+            self->gpu_sro_table.buffer_slots.unsafe_destroy_zombie_slot(id);
             return std::bit_cast<daxa_Result>(result);
         }
     }
@@ -125,6 +148,7 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
         auto result = vkCreateBuffer(self->vk_device, &vk_buffer_create_info, nullptr, &ret.vk_buffer);
         if (result != VK_SUCCESS)
         {
+            self->gpu_sro_table.buffer_slots.unsafe_destroy_zombie_slot(id);
             return std::bit_cast<daxa_Result>(result);
         }
 
@@ -137,6 +161,7 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
         if (result != VK_SUCCESS)
         {
             vkDestroyBuffer(self->vk_device, ret.vk_buffer, nullptr);
+            self->gpu_sro_table.buffer_slots.unsafe_destroy_zombie_slot(id);
             return std::bit_cast<daxa_Result>(result);
         }
     }
@@ -167,18 +192,32 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
         self->vkSetDebugUtilsObjectNameEXT(self->vk_device, &buffer_name_info);
     }
 
-    write_descriptor_set_buffer(
-        self->vk_device,
-        self->gpu_sro_table.vk_descriptor_set, ret.vk_buffer,
-        0,
-        static_cast<VkDeviceSize>(ret.info.size),
-        id.index);
+    if (opt_descriptor_writes != nullptr)
+    {
+        opt_descriptor_writes->add_buffer(ret.vk_buffer, 0, static_cast<VkDeviceSize>(ret.info.size), id.index);
+    }
+    else
+    {
+        write_descriptor_set_buffer(
+            self->vk_device,
+            self->gpu_sro_table.vk_descriptor_set, ret.vk_buffer,
+            0,
+            static_cast<VkDeviceSize>(ret.info.size),
+            id.index);
+    }
+
+    if (opt_memory_block == nullptr)
+    {
+        self->memory_report_counters.buffer_bytes.fetch_add(vma_allocation_info.size, std::memory_order_relaxed);
+        self->memory_report_counters.buffer_count.fetch_add(1, std::memory_order_relaxed);
+    }
 
     *out_id = std::bit_cast<daxa_BufferId>(id);
     return DAXA_RESULT_SUCCESS;
 }
 
-auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_ImageId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset) -> daxa_Result
+// When opt_descriptor_writes is set, the descriptor writes are only recorded into it and must be flushed by the caller.
+auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_ImageId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset, DescriptorSetWriteBatch * opt_descriptor_writes) -> daxa_Result
 {
     /// --- Begin Validation ---
 
@@ -243,6 +282,7 @@ auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_Ima
         },
     };
     VkImageCreateInfo const vk_image_create_info = initialize_image_create_info_from_image_info(*info, &self->main_queue_family_index);
+    VmaAllocationInfo vma_allocation_info = {};
     if (opt_memory_block == nullptr)
     {
         VmaAllocationCreateInfo const vma_allocation_create_info{
@@ -252,11 +292,11 @@ auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_Ima
             .preferredFlags = {},
             .memoryTypeBits = std::numeric_limits<u32>::max(),
             .pool = nullptr,
-            .pUserData = nullptr,
+            .pUserData = reinterpret_cast<void *>(static_cast<uintptr_t>((id.index << VMA_USER_DATA_TAG_BITS) | VMA_USER_DATA_IMAGE_TAG)),
             .priority = 0.5f,
         };
 
-        auto result = vmaCreateImage(self->vma_allocator, &vk_image_create_info, &vma_allocation_create_info, &ret.vk_image, &ret.vma_allocation, nullptr);
+        auto result = vmaCreateImage(self->vma_allocator, &vk_image_create_info, &vma_allocation_create_info, &ret.vk_image, &ret.vma_allocation, &vma_allocation_info);
         if (result != VK_SUCCESS)
         {
             self->gpu_sro_table.image_slots.unsafe_destroy_zombie_slot(id);
@@ -330,12 +370,25 @@ auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_Ima
         self->vkSetDebugUtilsObjectNameEXT(self->vk_device, &swapchain_image_view_name_info);
     }
 
-    write_descriptor_set_image(
-        self->vk_device,
-        self->gpu_sro_table.vk_descriptor_set,
-        ret.view_slot.vk_image_view,
-        std::bit_cast<ImageUsageFlags>(ret.info.usage),
-        id.index);
+    if (opt_descriptor_writes != nullptr)
+    {
+        opt_descriptor_writes->add_image(ret.view_slot.vk_image_view, std::bit_cast<ImageUsageFlags>(ret.info.usage), id.index);
+    }
+    else
+    {
+        write_descriptor_set_image(
+            self->vk_device,
+            self->gpu_sro_table.vk_descriptor_set,
+            ret.view_slot.vk_image_view,
+            std::bit_cast<ImageUsageFlags>(ret.info.usage),
+            id.index);
+    }
+
+    if (opt_memory_block == nullptr)
+    {
+        self->memory_report_counters.image_bytes.fetch_add(vma_allocation_info.size, std::memory_order_relaxed);
+        self->memory_report_counters.image_count.fetch_add(1, std::memory_order_relaxed);
+    }
 
     *out_id = std::bit_cast<daxa_ImageId>(id);
     return DAXA_RESULT_SUCCESS;
@@ -448,6 +501,13 @@ auto create_acceleration_structure_helper(
             self->gpu_sro_table.vk_descriptor_set,
             ret.vk_acceleration_structure,
             id.index);
+        self->memory_report_counters.tlas_bytes.fetch_add(ret.info.size, std::memory_order_relaxed);
+        self->memory_report_counters.tlas_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        self->memory_report_counters.blas_bytes.fetch_add(ret.info.size, std::memory_order_relaxed);
+        self->memory_report_counters.blas_count.fetch_add(1, std::memory_order_relaxed);
     }
 
     *out_id = std::bit_cast<typename std::remove_pointer<decltype(out_id)>::type>(id);
@@ -482,7 +542,7 @@ auto daxa_dvc_buffer_memory_requirements(daxa_Device self, daxa_BufferInfo const
         .pNext = nullptr,
         .flags = {},
         .size = static_cast<VkDeviceSize>(info->size),
-        .usage = BUFFER_USE_FLAGS,
+        .usage = self->vk_buffer_usage_flags,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         .queueFamilyIndexCount = 1,
         .pQueueFamilyIndices = &self->main_queue_family_index,
@@ -602,22 +662,22 @@ auto daxa_dvc_get_blas_build_sizes(
 
 auto daxa_dvc_create_buffer(daxa_Device self, daxa_BufferInfo const * info, daxa_BufferId * out_id) -> daxa_Result
 {
-    return create_buffer_helper(self, info, out_id, nullptr, 0);
+    return create_buffer_helper(self, info, out_id, nullptr, 0, nullptr);
 }
 
 auto daxa_dvc_create_image(daxa_Device self, daxa_ImageInfo const * info, daxa_ImageId * out_id) -> daxa_Result
 {
-    return create_image_helper(self, info, out_id, nullptr, 0);
+    return create_image_helper(self, info, out_id, nullptr, 0, nullptr);
 }
 
 auto daxa_dvc_create_buffer_from_memory_block(daxa_Device self, daxa_MemoryBlockBufferInfo const * info, daxa_BufferId * out_id) -> daxa_Result
 {
-    return create_buffer_helper(self, &info->buffer_info, out_id, *info->memory_block, info->offset);
+    return create_buffer_helper(self, &info->buffer_info, out_id, *info->memory_block, info->offset, nullptr);
 }
 
 auto daxa_dvc_create_image_from_block(daxa_Device self, daxa_MemoryBlockImageInfo const * info, daxa_ImageId * out_id) -> daxa_Result
 {
-    return create_image_helper(self, &info->image_info, out_id, *info->memory_block, info->offset);
+    return create_image_helper(self, &info->image_info, out_id, *info->memory_block, info->offset, nullptr);
 }
 
 auto daxa_dvc_create_tlas(daxa_Device self, daxa_TlasInfo const * info, daxa_TlasId * out_id) -> daxa_Result
@@ -668,7 +728,8 @@ auto daxa_dvc_create_blas_from_buffer(daxa_Device self, daxa_BufferBlasInfo cons
         out_id);
 }
 
-auto daxa_dvc_create_image_view(daxa_Device self, daxa_ImageViewInfo const * info, daxa_ImageViewId * out_id) -> daxa_Result
+// When opt_descriptor_writes is set, the descriptor writes are only recorded into it and must be flushed by the caller.
+auto create_image_view_helper(daxa_Device self, daxa_ImageViewInfo const * info, daxa_ImageViewId * out_id, DescriptorSetWriteBatch * opt_descriptor_writes) -> daxa_Result
 {
     /// --- Begin Validation ---
 
@@ -720,17 +781,119 @@ auto daxa_dvc_create_image_view(daxa_Device self, daxa_ImageViewInfo const * inf
         };
         self->vkSetDebugUtilsObjectNameEXT(self->vk_device, &name_info);
     }
-    write_descriptor_set_image(
-        self->vk_device,
-        self->gpu_sro_table.vk_descriptor_set,
-        ret.vk_image_view,
-        std::bit_cast<ImageUsageFlags>(parent_image_slot.info.usage),
-        id.index);
+    if (opt_descriptor_writes != nullptr)
+    {
+        opt_descriptor_writes->add_image(ret.vk_image_view, std::bit_cast<ImageUsageFlags>(parent_image_slot.info.usage), id.index);
+    }
+    else
+    {
+        write_descriptor_set_image(
+            self->vk_device,
+            self->gpu_sro_table.vk_descriptor_set,
+            ret.vk_image_view,
+            std::bit_cast<ImageUsageFlags>(parent_image_slot.info.usage),
+            id.index);
+    }
     *out_id = std::bit_cast<daxa_ImageViewId>(id);
     return DAXA_RESULT_SUCCESS;
 }
 
-auto daxa_dvc_create_sampler(daxa_Device self, daxa_SamplerInfo const * info, daxa_SamplerId * out_id) -> daxa_Result
+auto daxa_dvc_create_image_view(daxa_Device self, daxa_ImageViewInfo const * info, daxa_ImageViewId * out_id) -> daxa_Result
+{
+    return create_image_view_helper(self, info, out_id, nullptr);
+}
+
+// Creates either all or none of the resources.
+// Slots are reserved before anything is created and the descriptors of all resources are written with a single update.
+auto create_gpu_resources_helper(
+    daxa_Device self,
+    auto & slots,
+    daxa_Result exceeded_max_result,
+    usize info_count,
+    auto const & create_fn,
+    auto const & rollback_fn) -> daxa_Result
+{
+    if (!slots.try_reserve_slots(info_count))
+    {
+        return exceeded_max_result;
+    }
+    DescriptorSetWriteBatch descriptor_writes = {.vk_descriptor_set = self->gpu_sro_table.vk_descriptor_set};
+    for (usize i = 0; i < info_count; ++i)
+    {
+        auto const result = create_fn(i, &descriptor_writes);
+        if (result != DAXA_RESULT_SUCCESS)
+        {
+            // The pending descriptor writes are dropped, the slots of the rolled back resources keep their null descriptors.
+            rollback_fn(i);
+            return result;
+        }
+    }
+    descriptor_writes.flush(self->vk_device);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_dvc_create_buffers(daxa_Device self, daxa_BufferInfo const * infos, size_t info_count, daxa_BufferId * out_ids) -> daxa_Result
+{
+    return create_gpu_resources_helper(
+        self,
+        self->gpu_sro_table.buffer_slots,
+        DAXA_RESULT_EXCEEDED_MAX_BUFFERS,
+        info_count,
+        [&](usize i, DescriptorSetWriteBatch * descriptor_writes)
+        { return create_buffer_helper(self, &infos[i], &out_ids[i], nullptr, 0, descriptor_writes); },
+        [&](usize created_count)
+        { [[maybe_unused]] auto const _ignore = daxa_dvc_destroy_buffers(self, out_ids, created_count); });
+}
+
+auto daxa_dvc_create_images(daxa_Device self, daxa_ImageInfo const * infos, size_t info_count, daxa_ImageId * out_ids) -> daxa_Result
+{
+    return create_gpu_resources_helper(
+        self,
+        self->gpu_sro_table.image_slots,
+        DAXA_RESULT_EXCEEDED_MAX_IMAGES,
+        info_count,
+        [&](usize i, DescriptorSetWriteBatch * descriptor_writes)
+        { return create_image_helper(self, &infos[i], &out_ids[i], nullptr, 0, descriptor_writes); },
+        [&](usize created_count)
+        { [[maybe_unused]] auto const _ignore = daxa_dvc_destroy_images(self, out_ids, created_count); });
+}
+
+auto daxa_dvc_create_image_views(daxa_Device self, daxa_ImageViewInfo const * infos, size_t info_count, daxa_ImageViewId * out_ids) -> daxa_Result
+{
+    return create_gpu_resources_helper(
+        self,
+        self->gpu_sro_table.image_slots,
+        DAXA_RESULT_EXCEEDED_MAX_IMAGE_VIEWS,
+        info_count,
+        [&](usize i, DescriptorSetWriteBatch * descriptor_writes)
+        { return create_image_view_helper(self, &infos[i], &out_ids[i], descriptor_writes); },
+        [&](usize created_count)
+        { [[maybe_unused]] auto const _ignore = daxa_dvc_destroy_image_views(self, out_ids, created_count); });
+}
+
+auto sampler_cache_key(daxa_SamplerInfo const & info) -> SamplerCacheKey
+{
+    return SamplerCacheKey{
+        static_cast<u32>(info.magnification_filter),
+        static_cast<u32>(info.minification_filter),
+        static_cast<u32>(info.mipmap_filter),
+        static_cast<u32>(info.reduction_mode),
+        static_cast<u32>(info.address_mode_u),
+        static_cast<u32>(info.address_mode_v),
+        static_cast<u32>(info.address_mode_w),
+        std::bit_cast<u32>(info.mip_lod_bias),
+        static_cast<u32>(info.enable_anisotropy != 0),
+        std::bit_cast<u32>(info.max_anisotropy),
+        static_cast<u32>(info.enable_compare != 0),
+        static_cast<u32>(info.compare_op),
+        std::bit_cast<u32>(info.min_lod),
+        std::bit_cast<u32>(info.max_lod),
+        static_cast<u32>(info.border_color),
+        static_cast<u32>(info.enable_unnormalized_coordinates != 0),
+    };
+}
+
+auto create_sampler_helper(daxa_Device self, daxa_SamplerInfo const * info, daxa_SamplerId * out_id) -> daxa_Result
 {
     /// --- Begin Validation ---
 
@@ -801,7 +964,56 @@ auto daxa_dvc_create_sampler(daxa_Device self, daxa_SamplerInfo const * info, da
     return DAXA_RESULT_SUCCESS;
 }
 
-#define _DAXA_DECL_COMMON_GP_RES_FUNCTIONS(name, Name, NAME, SLOT_NAME, vk_name, VK_NAME)                        \
+auto daxa_dvc_create_sampler(daxa_Device self, daxa_SamplerInfo const * info, daxa_SamplerId * out_id) -> daxa_Result
+{
+    if ((self->info.flags & DeviceFlagBits::SAMPLER_CACHE) == DeviceFlagBits::NONE)
+    {
+        return create_sampler_helper(self, info, out_id);
+    }
+    auto const key = sampler_cache_key(*info);
+    std::unique_lock const lock{self->sampler_cache_mtx};
+    auto iter = self->sampler_cache.find(key);
+    if (iter != self->sampler_cache.end())
+    {
+        iter->second.ref_count += 1;
+        *out_id = std::bit_cast<daxa_SamplerId>(iter->second.id);
+        return DAXA_RESULT_SUCCESS;
+    }
+    auto result = create_sampler_helper(self, info, out_id);
+    if (result == DAXA_RESULT_SUCCESS)
+    {
+        self->sampler_cache.emplace(key, SamplerCacheEntry{.id = std::bit_cast<SamplerId>(*out_id), .ref_count = 1});
+    }
+    return result;
+}
+
+auto daxa_dvc_destroy_sampler(daxa_Device self, daxa_SamplerId id) -> daxa_Result
+{
+    _DAXA_TEST_PRINT("STRONG daxa_dvc_destroy_sampler\n");
+    if ((self->info.flags & DeviceFlagBits::SAMPLER_CACHE) != DeviceFlagBits::NONE && daxa_dvc_is_sampler_valid(self, id))
+    {
+        std::unique_lock const lock{self->sampler_cache_mtx};
+        auto iter = self->sampler_cache.find(sampler_cache_key(self->slot(id).info));
+        if (iter != self->sampler_cache.end() && iter->second.id == std::bit_cast<SamplerId>(id))
+        {
+            iter->second.ref_count -= 1;
+            if (iter->second.ref_count > 0)
+            {
+                return DAXA_RESULT_SUCCESS;
+            }
+            self->sampler_cache.erase(iter);
+        }
+    }
+    auto success = self->gpu_sro_table.sampler_slots.try_zombify(std::bit_cast<GPUResourceId>(id));
+    if (success)
+    {
+        self->zombify_sampler(std::bit_cast<SamplerId>(id));
+        return DAXA_RESULT_SUCCESS;
+    }
+    return DAXA_RESULT_INVALID_SAMPLER_ID;
+}
+
+#define _DAXA_DECL_GP_RES_DESTROY_FUNCTION(name, Name, NAME, SLOT_NAME)                                         \
     auto daxa_dvc_destroy_##name(daxa_Device self, daxa_##Name##Id id) -> daxa_Result                            \
     {                                                                                                            \
         _DAXA_TEST_PRINT("STRONG daxa_dvc_destroy_%s\n", #name);                                                 \
@@ -812,7 +1024,31 @@ auto daxa_dvc_create_sampler(daxa_Device self, daxa_SamplerInfo const * info, da
             return DAXA_RESULT_SUCCESS;                                                                          \
         }                                                                                                        \
         return DAXA_RESULT_INVALID_##NAME##_ID;                                                                  \
-    }                                                                                                            \
+    }
+
+#define _DAXA_DECL_GP_RES_DESTROY_BATCH_FUNCTION(name, Name, NAME, SLOT_NAME)                                      \
+    auto daxa_dvc_destroy_##name##s(daxa_Device self, daxa_##Name##Id const * ids, size_t id_count) -> daxa_Result \
+    {                                                                                                              \
+        _DAXA_TEST_PRINT("STRONG daxa_dvc_destroy_%ss\n", #name);                                                  \
+        daxa_Result result = DAXA_RESULT_SUCCESS;                                                                  \
+        std::vector<Name##Id> zombies = {};                                                                        \
+        zombies.reserve(id_count);                                                                                 \
+        for (auto const id : std::span{ids, id_count})                                                             \
+        {                                                                                                          \
+            if (self->gpu_sro_table.SLOT_NAME.try_zombify(std::bit_cast<GPUResourceId>(id)))                       \
+            {                                                                                                      \
+                zombies.push_back(std::bit_cast<Name##Id>(id));                                                    \
+            }                                                                                                      \
+            else                                                                                                   \
+            {                                                                                                      \
+                result = DAXA_RESULT_INVALID_##NAME##_ID;                                                          \
+            }                                                                                                      \
+        }                                                                                                          \
+        self->zombify_##name##s(zombies);                                                                          \
+        return result;                                                                                             \
+    }
+
+#define _DAXA_DECL_COMMON_GP_RES_FUNCTIONS(name, Name, NAME, SLOT_NAME, vk_name, VK_NAME)                        \
     auto daxa_dvc_info_##name(daxa_Device self, daxa_##Name##Id id, daxa_##Name##Info * out_info) -> daxa_Result \
     {                                                                                                            \
         /*NOTE: THIS CAN RACE. BUT IT IS OK AS ITS A POD AND WE CHECK IF ITS VALID AFTER THE COPY!*/             \
@@ -846,6 +1082,17 @@ _DAXA_DECL_COMMON_GP_RES_FUNCTIONS(sampler, Sampler, SAMPLER, sampler_slots, sam
 _DAXA_DECL_COMMON_GP_RES_FUNCTIONS(tlas, Tlas, TLAS, tlas_slots, acceleration_structure, VkAccelerationStructureKHR)
 _DAXA_DECL_COMMON_GP_RES_FUNCTIONS(blas, Blas, BLAS, blas_slots, acceleration_structure, VkAccelerationStructureKHR)
 
+// The sampler destroy function is declared separately, as it has to respect the sampler cache.
+_DAXA_DECL_GP_RES_DESTROY_FUNCTION(buffer, Buffer, BUFFER, buffer_slots)
+_DAXA_DECL_GP_RES_DESTROY_FUNCTION(image, Image, IMAGE, image_slots)
+_DAXA_DECL_GP_RES_DESTROY_FUNCTION(image_view, ImageView, IMAGE_VIEW, image_slots)
+_DAXA_DECL_GP_RES_DESTROY_FUNCTION(tlas, Tlas, TLAS, tlas_slots)
+_DAXA_DECL_GP_RES_DESTROY_FUNCTION(blas, Blas, BLAS, blas_slots)
+
+_DAXA_DECL_GP_RES_DESTROY_BATCH_FUNCTION(buffer, Buffer, BUFFER, buffer_slots)
+_DAXA_DECL_GP_RES_DESTROY_BATCH_FUNCTION(image, Image, IMAGE, image_slots)
+_DAXA_DECL_GP_RES_DESTROY_BATCH_FUNCTION(image_view, ImageView, IMAGE_VIEW, image_slots)
+
 auto daxa_dvc_buffer_device_address(daxa_Device self, daxa_BufferId id, daxa_DeviceAddress * out_addr) -> daxa_Result
 {
     if (!daxa_dvc_is_buffer_valid(self, id))
@@ -966,8 +1213,10 @@ auto daxa_dvc_submit(daxa_Device self, daxa_CommandSubmitInfo const * info) -> d
             case DEFERRED_DESTRUCTION_BUFFER_INDEX: _ignore = daxa_dvc_destroy_buffer(self, std::bit_cast<daxa_BufferId>(id)); break;
             case DEFERRED_DESTRUCTION_IMAGE_INDEX: _ignore = daxa_dvc_destroy_image(self, std::bit_cast<daxa_ImageId>(id)); break;
             case DEFERRED_DESTRUCTION_IMAGE_VIEW_INDEX: _ignore = daxa_dvc_destroy_image_view(self, std::bit_cast<daxa_ImageViewId>(id)); break;
-            case DEFERRED_DESTRUCTION_SAMPLER_INDEX:
-                _ignore = daxa_dvc_destroy_sampler(self, std::bit_cast<daxa_SamplerId>(id));
+            case DEFERRED_DESTRUCTION_SAMPLER_INDEX: _ignore = daxa_dvc_destroy_sampler(self, std::bit_cast<daxa_SamplerId>(id)); break;
+            case DEFERRED_DESTRUCTION_TLAS_INDEX: _ignore = daxa_dvc_destroy_tlas(self, std::bit_cast<daxa_TlasId>(id)); break;
+            case DEFERRED_DESTRUCTION_BLAS_INDEX:
+                _ignore = daxa_dvc_destroy_blas(self, std::bit_cast<daxa_BlasId>(id));
                 break;
                 // TODO(capi): DO NOT THROW FROM A C FUNCTION
                 // default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
@@ -1076,9 +1325,9 @@ auto daxa_dvc_present(daxa_Device self, daxa_PresentInfo const * info) -> daxa_R
     return std::bit_cast<daxa_Result>(result);
 }
 
-auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
+// The caller must hold the exclusive lifetime lock.
+auto collect_garbage_helper(daxa_Device self) -> daxa_Result
 {
-    std::unique_lock lifetime_lock{self->gpu_sro_table.lifetime_lock};
     std::unique_lock lock{self->main_queue_zombies_mtx};
 
     u64 gpu_timeline_value = std::numeric_limits<u64>::max();
@@ -1093,6 +1342,11 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
         }
     }
 
+    // Allocations of a pending defragmentation pass must not be freed before the pass ends.
+    // Buffers, images and memory blocks are collected again once it ended.
+    self->try_end_defragmentation_pass(gpu_timeline_value);
+    bool const defragmentation_pass_pending = self->defragmentation.pass_pending;
+
     auto check_and_cleanup_gpu_resources = [&](auto & zombies, auto const & cleanup_fn)
     {
         while (!zombies.empty())
@@ -1108,24 +1362,30 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
             zombies.pop_back();
         }
     };
-    check_and_cleanup_gpu_resources(
-        self->main_queue_buffer_zombies,
-        [&](auto id)
-        {
-            self->cleanup_buffer(id);
-        });
+    if (!defragmentation_pass_pending)
+    {
+        check_and_cleanup_gpu_resources(
+            self->main_queue_buffer_zombies,
+            [&](auto id)
+            {
+                self->cleanup_buffer(id);
+            });
+    }
     check_and_cleanup_gpu_resources(
         self->main_queue_image_view_zombies,
         [&](auto id)
         {
             self->cleanup_image_view(id);
         });
-    check_and_cleanup_gpu_resources(
-        self->main_queue_image_zombies,
-        [&](auto id)
-        {
-            self->cleanup_image(id);
-        });
+    if (!defragmentation_pass_pending)
+    {
+        check_and_cleanup_gpu_resources(
+            self->main_queue_image_zombies,
+            [&](auto id)
+            {
+                self->cleanup_image(id);
+            });
+    }
     check_and_cleanup_gpu_resources(
         self->main_queue_sampler_zombies,
         [&](auto id)
@@ -1169,11 +1429,26 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
             vkDestroyQueryPool(self->vk_device, timeline_query_pool_zombie.vk_timeline_query_pool, nullptr);
         });
     check_and_cleanup_gpu_resources(
-        self->main_queue_memory_block_zombies,
-        [&](auto & memory_block_zombie)
+        self->main_queue_query_pool_zombies,
+        [&](auto & query_pool_zombie)
         {
-            vmaFreeMemory(self->vma_allocator, memory_block_zombie.allocation);
+            vkDestroyQueryPool(self->vk_device, query_pool_zombie.vk_query_pool, nullptr);
         });
+    if (!defragmentation_pass_pending)
+    {
+        check_and_cleanup_gpu_resources(
+            self->main_queue_memory_block_zombies,
+            [&](auto & memory_block_zombie)
+            {
+                VmaAllocationInfo vma_allocation_info = {};
+                vmaGetAllocationInfo(self->vma_allocator, memory_block_zombie.allocation, &vma_allocation_info);
+                auto & block_bytes = memory_block_zombie.transient ? self->memory_report_counters.transient_memory_block_bytes : self->memory_report_counters.memory_block_bytes;
+                auto & block_count = memory_block_zombie.transient ? self->memory_report_counters.transient_memory_block_count : self->memory_report_counters.memory_block_count;
+                block_bytes.fetch_sub(vma_allocation_info.size, std::memory_order_relaxed);
+                block_count.fetch_sub(1, std::memory_order_relaxed);
+                vmaFreeMemory(self->vma_allocator, memory_block_zombie.allocation);
+            });
+    }
     {
         std::unique_lock const l_lock{self->main_queue_command_pool_buffer_recycle_mtx};
         while (!self->main_queue_command_list_zombies.empty())
@@ -1186,6 +1461,10 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
             }
 
             vkFreeCommandBuffers(self->vk_device, object.vk_cmd_pool, static_cast<u32>(object.allocated_command_buffers.size()), object.allocated_command_buffers.data());
+            for (VkQueryPool vk_query_pool : object.owned_query_pools)
+            {
+                vkDestroyQueryPool(self->vk_device, vk_query_pool, nullptr);
+            }
             auto vk_result = vkResetCommandPool(self->vk_device, object.vk_cmd_pool, {});
             if (vk_result != VK_SUCCESS)
             {
@@ -1199,11 +1478,685 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
     return DAXA_RESULT_SUCCESS;
 }
 
+auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
+{
+    std::unique_lock lifetime_lock{self->gpu_sro_table.lifetime_lock};
+    return collect_garbage_helper(self);
+}
+
+auto daxa_dvc_defragment(daxa_Device self, daxa_DefragmentationInfo const * info, daxa_DefragmentationStatus * out_status) -> daxa_Result
+{
+    *out_status = {};
+    std::unique_lock lifetime_lock{self->gpu_sro_table.lifetime_lock};
+    std::unique_lock lock{self->main_queue_zombies_mtx};
+    auto & state = self->defragmentation;
+
+    u64 gpu_timeline_value = {};
+    {
+        auto result = vkGetSemaphoreCounterValue(
+            self->vk_device,
+            self->vk_main_queue_gpu_timeline_semaphore,
+            &gpu_timeline_value);
+        if (result != VK_SUCCESS)
+        {
+            return std::bit_cast<daxa_Result>(result);
+        }
+    }
+    self->try_end_defragmentation_pass(gpu_timeline_value);
+
+    auto report_status = [&]()
+    {
+        out_status->in_progress = static_cast<daxa_Bool8>(state.vma_context != nullptr);
+        if (state.completed)
+        {
+            out_status->completed = 1;
+            out_status->total_bytes_moved = state.completed_stats.bytesMoved;
+            out_status->total_bytes_freed = state.completed_stats.bytesFreed;
+            out_status->total_allocations_moved = state.completed_stats.allocationsMoved;
+            out_status->total_device_memory_blocks_freed = state.completed_stats.deviceMemoryBlocksFreed;
+            state.completed = false;
+        }
+    };
+
+    // The next defragmentation only begins in the call after the last one completed,
+    // so that callers see the completion before new work is started.
+    if (state.pass_pending || state.completed)
+    {
+        report_status();
+        return DAXA_RESULT_SUCCESS;
+    }
+
+    if (state.vma_context == nullptr)
+    {
+        VmaDefragmentationInfo const vma_defragmentation_info{
+            .flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+            .pool = nullptr,
+            .maxBytesPerPass = info->max_bytes_per_pass,
+            .maxAllocationsPerPass = info->max_allocations_per_pass,
+        };
+        auto result = vmaBeginDefragmentation(self->vma_allocator, &vma_defragmentation_info, &state.vma_context);
+        if (result != VK_SUCCESS)
+        {
+            state.vma_context = {};
+            return std::bit_cast<daxa_Result>(result);
+        }
+    }
+
+    auto vk_result = vmaBeginDefragmentationPass(self->vma_allocator, state.vma_context, &state.vma_pass_info);
+    if (vk_result != VK_INCOMPLETE)
+    {
+        // VK_SUCCESS means that there is nothing left to move.
+        self->end_defragmentation();
+        report_status();
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+
+    // Zombies are about to be destroyed, moving them is wasted work.
+    std::vector<u64> zombie_buffer_indices = {};
+    std::vector<u64> zombie_image_indices = {};
+    for (auto const & [timeline_value, id] : self->main_queue_buffer_zombies)
+    {
+        zombie_buffer_indices.push_back(id.index);
+    }
+    for (auto const & [timeline_value, id] : self->main_queue_image_zombies)
+    {
+        zombie_image_indices.push_back(id.index);
+    }
+    std::sort(zombie_buffer_indices.begin(), zombie_buffer_indices.end());
+    std::sort(zombie_image_indices.begin(), zombie_image_indices.end());
+    // Images are only moved when the caller stated the layout they are in.
+    std::unordered_map<u64, VkImageLayout> movable_image_layouts = {};
+    for (auto const & movable_image : std::span{info->movable_images, info->movable_image_count})
+    {
+        movable_image_layouts[std::bit_cast<u64>(movable_image.image)] = static_cast<VkImageLayout>(movable_image.layout);
+    }
+    // Acceleration structures would keep referencing the old buffer, their buffers can not be moved.
+    std::vector<u64> acceleration_structure_buffer_indices = {};
+    if (info->move_buffers != 0)
+    {
+        auto collect_acceleration_structure_buffers = [&](auto & pool)
+        {
+            for (u32 index = 0; index < pool.next_index; ++index)
+            {
+                auto const & as_slot = pool_slot_at(pool, index).first;
+                if (as_slot.vk_acceleration_structure != VK_NULL_HANDLE)
+                {
+                    acceleration_structure_buffer_indices.push_back(as_slot.buffer_id.index);
+                }
+            }
+        };
+        collect_acceleration_structure_buffers(self->gpu_sro_table.tlas_slots);
+        collect_acceleration_structure_buffers(self->gpu_sro_table.blas_slots);
+        std::sort(acceleration_structure_buffer_indices.begin(), acceleration_structure_buffer_indices.end());
+    }
+    // Image views created with create_image_view reference their image and are recreated with it.
+    std::unordered_map<u64, std::vector<u64>> image_view_indices = {};
+    bool image_view_indices_collected = false;
+    auto views_of_image = [&](GPUResourceId image_id) -> std::vector<u64> const &
+    {
+        if (!image_view_indices_collected)
+        {
+            for (u32 index = 0; index < self->gpu_sro_table.image_slots.next_index; ++index)
+            {
+                auto const & view_image_slot = pool_slot_at(self->gpu_sro_table.image_slots, index).first;
+                if (view_image_slot.vk_image == VK_NULL_HANDLE && view_image_slot.view_slot.vk_image_view != VK_NULL_HANDLE)
+                {
+                    auto const parent_id = std::bit_cast<GPUResourceId>(view_image_slot.view_slot.info.image);
+                    image_view_indices[std::bit_cast<u64>(parent_id)].push_back(index);
+                }
+            }
+            image_view_indices_collected = true;
+        }
+        return image_view_indices[std::bit_cast<u64>(image_id)];
+    };
+    auto contains = [](std::vector<u64> const & sorted, u64 value)
+    {
+        return std::binary_search(sorted.begin(), sorted.end(), value);
+    };
+    auto set_debug_name = [&](VkObjectType type, u64 handle, daxa_SmallString const & name)
+    {
+        if ((self->instance->info.flags & InstanceFlagBits::DEBUG_UTILS) != InstanceFlagBits::NONE && name.size != 0)
+        {
+            auto c_str_arr = r_cast<SmallString const *>(&name)->c_str();
+            VkDebugUtilsObjectNameInfoEXT const name_info{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = type,
+                .objectHandle = handle,
+                .pObjectName = c_str_arr.data(),
+            };
+            self->vkSetDebugUtilsObjectNameEXT(self->vk_device, &name_info);
+        }
+    };
+
+    struct BufferMove
+    {
+        u64 index = {};
+        VkBuffer vk_buffer = {};
+    };
+    struct ImageMove
+    {
+        u64 index = {};
+        VkImage vk_image = {};
+        VkImageLayout vk_layout = {};
+        VkImageView vk_default_view = {};
+        std::vector<std::pair<u64, VkImageView>> views = {};
+    };
+    std::vector<BufferMove> buffer_moves = {};
+    std::vector<ImageMove> image_moves = {};
+    for (auto & move : std::span{state.vma_pass_info.pMoves, state.vma_pass_info.moveCount})
+    {
+        move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        VmaAllocationInfo src_allocation_info = {};
+        vmaGetAllocationInfo(self->vma_allocator, move.srcAllocation, &src_allocation_info);
+        // Memory blocks carry no user data, the resources placed in them can not be moved.
+        auto const user_data = static_cast<u64>(reinterpret_cast<uintptr_t>(src_allocation_info.pUserData));
+        u64 const tag = user_data & ((1ull << VMA_USER_DATA_TAG_BITS) - 1ull);
+        u64 const index = user_data >> VMA_USER_DATA_TAG_BITS;
+        if (tag == VMA_USER_DATA_BUFFER_TAG && info->move_buffers != 0)
+        {
+            auto const & buffer_slot = pool_slot_at(self->gpu_sro_table.buffer_slots, index).first;
+            if (buffer_slot.vma_allocation != move.srcAllocation ||
+                buffer_slot.host_address != nullptr ||
+                contains(zombie_buffer_indices, index) ||
+                contains(acceleration_structure_buffer_indices, index))
+            {
+                continue;
+            }
+            VkBufferCreateInfo const vk_buffer_create_info = initialize_buffer_create_info_from_buffer_info(buffer_slot.info, self->vk_buffer_usage_flags, &self->main_queue_family_index);
+            VkBuffer vk_buffer = {};
+            if (vkCreateBuffer(self->vk_device, &vk_buffer_create_info, nullptr, &vk_buffer) != VK_SUCCESS)
+            {
+                continue;
+            }
+            if (vmaBindBufferMemory(self->vma_allocator, move.dstTmpAllocation, vk_buffer) != VK_SUCCESS)
+            {
+                vkDestroyBuffer(self->vk_device, vk_buffer, nullptr);
+                continue;
+            }
+            set_debug_name(VK_OBJECT_TYPE_BUFFER, std::bit_cast<u64>(vk_buffer), buffer_slot.info.name);
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+            buffer_moves.push_back({.index = index, .vk_buffer = vk_buffer});
+            out_status->moved_bytes += src_allocation_info.size;
+        }
+        else if (tag == VMA_USER_DATA_IMAGE_TAG && !movable_image_layouts.empty())
+        {
+            auto & [image_slot, image_version] = pool_slot_at(self->gpu_sro_table.image_slots, index);
+            auto const image_id = GPUResourceId{.index = index, .version = image_version.load(std::memory_order_relaxed)};
+            auto const movable_image_layout = movable_image_layouts.find(std::bit_cast<u64>(image_id));
+            auto const required_usage = ImageUsageFlagBits::TRANSFER_SRC | ImageUsageFlagBits::TRANSFER_DST;
+            auto const excluded_usage = ImageUsageFlagBits::COLOR_ATTACHMENT | ImageUsageFlagBits::DEPTH_STENCIL_ATTACHMENT | ImageUsageFlagBits::SHADER_STORAGE;
+            auto const usage = std::bit_cast<ImageUsageFlags>(image_slot.info.usage);
+            if (movable_image_layout == movable_image_layouts.end() ||
+                image_slot.vma_allocation != move.srcAllocation ||
+                image_slot.vk_image == VK_NULL_HANDLE ||
+                (usage & required_usage) != required_usage ||
+                (usage & excluded_usage) != ImageUsageFlagBits::NONE ||
+                contains(zombie_image_indices, index))
+            {
+                continue;
+            }
+            VkImageCreateInfo const vk_image_create_info = initialize_image_create_info_from_image_info(image_slot.info, &self->main_queue_family_index);
+            ImageMove image_move = {.index = index, .vk_layout = movable_image_layout->second};
+            if (vkCreateImage(self->vk_device, &vk_image_create_info, nullptr, &image_move.vk_image) != VK_SUCCESS)
+            {
+                continue;
+            }
+            auto destroy_image_move = [&]()
+            {
+                for (auto const & [view_index, vk_image_view] : image_move.views)
+                {
+                    vkDestroyImageView(self->vk_device, vk_image_view, nullptr);
+                }
+                if (image_move.vk_default_view != VK_NULL_HANDLE)
+                {
+                    vkDestroyImageView(self->vk_device, image_move.vk_default_view, nullptr);
+                }
+                vkDestroyImage(self->vk_device, image_move.vk_image, nullptr);
+            };
+            if (vmaBindImageMemory(self->vma_allocator, move.dstTmpAllocation, image_move.vk_image) != VK_SUCCESS)
+            {
+                destroy_image_move();
+                continue;
+            }
+            // Same view as the one made in create_image_helper.
+            VkImageViewCreateInfo const vk_default_view_create_info{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = {},
+                .image = image_move.vk_image,
+                .viewType = image_slot.info.array_layer_count > 1 ? static_cast<VkImageViewType>(image_slot.info.dimensions + 3) : static_cast<VkImageViewType>(image_slot.info.dimensions - 1),
+                .format = static_cast<VkFormat>(image_slot.info.format),
+                .components = VkComponentMapping{
+                    .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+                },
+                .subresourceRange = make_subresource_range(image_slot.view_slot.info.slice, image_slot.aspect_flags),
+            };
+            if (vkCreateImageView(self->vk_device, &vk_default_view_create_info, nullptr, &image_move.vk_default_view) != VK_SUCCESS)
+            {
+                destroy_image_move();
+                continue;
+            }
+            bool views_created = true;
+            for (u64 const view_index : views_of_image(image_id))
+            {
+                auto const & view_slot = pool_slot_at(self->gpu_sro_table.image_slots, view_index).first.view_slot;
+                VkImageViewCreateInfo const vk_view_create_info{
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = {},
+                    .image = image_move.vk_image,
+                    .viewType = static_cast<VkImageViewType>(view_slot.info.type),
+                    .format = static_cast<VkFormat>(view_slot.info.format),
+                    .components = VkComponentMapping{
+                        .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    },
+                    .subresourceRange = make_subresource_range(view_slot.info.slice, image_slot.aspect_flags),
+                };
+                VkImageView vk_image_view = {};
+                if (vkCreateImageView(self->vk_device, &vk_view_create_info, nullptr, &vk_image_view) != VK_SUCCESS)
+                {
+                    views_created = false;
+                    break;
+                }
+                set_debug_name(VK_OBJECT_TYPE_IMAGE_VIEW, std::bit_cast<u64>(vk_image_view), view_slot.info.name);
+                image_move.views.push_back({view_index, vk_image_view});
+            }
+            if (!views_created)
+            {
+                destroy_image_move();
+                continue;
+            }
+            set_debug_name(VK_OBJECT_TYPE_IMAGE, std::bit_cast<u64>(image_move.vk_image), image_slot.info.name);
+            set_debug_name(VK_OBJECT_TYPE_IMAGE_VIEW, std::bit_cast<u64>(image_move.vk_default_view), image_slot.info.name);
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+            image_moves.push_back(std::move(image_move));
+            out_status->moved_bytes += src_allocation_info.size;
+        }
+    }
+
+    if (buffer_moves.empty() && image_moves.empty())
+    {
+        out_status->moved_bytes = 0;
+        if (vmaEndDefragmentationPass(self->vma_allocator, state.vma_context, &state.vma_pass_info) == VK_SUCCESS)
+        {
+            self->end_defragmentation();
+        }
+        report_status();
+        return DAXA_RESULT_SUCCESS;
+    }
+
+    // Record the copies from the old into the new resources.
+    VkCommandPool vk_cmd_pool = {};
+    {
+        std::unique_lock const l_lock{self->main_queue_command_pool_buffer_recycle_mtx};
+        vk_cmd_pool = self->buffer_pool_pool.get(self);
+    }
+    VkCommandBuffer vk_cmd_buffer = {};
+    VkCommandBufferAllocateInfo const vk_command_buffer_allocate_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .commandPool = vk_cmd_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+    vk_result = vkAllocateCommandBuffers(self->vk_device, &vk_command_buffer_allocate_info, &vk_cmd_buffer);
+    VkCommandBufferBeginInfo const vk_command_buffer_begin_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = {},
+    };
+    if (vk_result == VK_SUCCESS)
+    {
+        vk_result = vkBeginCommandBuffer(vk_cmd_buffer, &vk_command_buffer_begin_info);
+    }
+    if (vk_result == VK_SUCCESS)
+    {
+        std::vector<VkImageMemoryBarrier2> vk_image_barriers = {};
+        auto push_image_barrier = [&](VkImage vk_image, VkImageAspectFlags aspect_flags, VkImageLayout old_layout, VkImageLayout new_layout, bool before_copy)
+        {
+            vk_image_barriers.push_back(VkImageMemoryBarrier2{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = before_copy ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .srcAccessMask = before_copy ? VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dstStageMask = before_copy ? VK_PIPELINE_STAGE_2_TRANSFER_BIT : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                .dstAccessMask = before_copy ? (VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT) : (VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT),
+                .oldLayout = old_layout,
+                .newLayout = new_layout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = vk_image,
+                .subresourceRange = {
+                    .aspectMask = aspect_flags,
+                    .baseMipLevel = 0,
+                    .levelCount = VK_REMAINING_MIP_LEVELS,
+                    .baseArrayLayer = 0,
+                    .layerCount = VK_REMAINING_ARRAY_LAYERS,
+                },
+            });
+        };
+        auto record_barriers = [&](VkMemoryBarrier2 const & vk_memory_barrier)
+        {
+            VkDependencyInfo const vk_dependency_info{
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr,
+                .dependencyFlags = {},
+                .memoryBarrierCount = 1,
+                .pMemoryBarriers = &vk_memory_barrier,
+                .bufferMemoryBarrierCount = 0,
+                .pBufferMemoryBarriers = nullptr,
+                .imageMemoryBarrierCount = static_cast<u32>(vk_image_barriers.size()),
+                .pImageMemoryBarriers = vk_image_barriers.data(),
+            };
+            vkCmdPipelineBarrier2(vk_cmd_buffer, &vk_dependency_info);
+            vk_image_barriers.clear();
+        };
+
+        for (auto const & image_move : image_moves)
+        {
+            auto const & image_slot = pool_slot_at(self->gpu_sro_table.image_slots, image_move.index).first;
+            push_image_barrier(image_slot.vk_image, image_slot.aspect_flags, image_move.vk_layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, true);
+            push_image_barrier(image_move.vk_image, image_slot.aspect_flags, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true);
+        }
+        record_barriers(VkMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        });
+
+        for (auto const & buffer_move : buffer_moves)
+        {
+            auto const & buffer_slot = pool_slot_at(self->gpu_sro_table.buffer_slots, buffer_move.index).first;
+            VkBufferCopy const vk_buffer_copy{
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = static_cast<VkDeviceSize>(buffer_slot.info.size),
+            };
+            vkCmdCopyBuffer(vk_cmd_buffer, buffer_slot.vk_buffer, buffer_move.vk_buffer, 1, &vk_buffer_copy);
+        }
+        std::vector<VkImageCopy> vk_image_copies = {};
+        for (auto const & image_move : image_moves)
+        {
+            auto const & image_slot = pool_slot_at(self->gpu_sro_table.image_slots, image_move.index).first;
+            vk_image_copies.clear();
+            for (u32 mip = 0; mip < image_slot.info.mip_level_count; ++mip)
+            {
+                VkImageSubresourceLayers const vk_subresource{
+                    .aspectMask = image_slot.aspect_flags,
+                    .mipLevel = mip,
+                    .baseArrayLayer = 0,
+                    .layerCount = image_slot.info.array_layer_count,
+                };
+                vk_image_copies.push_back(VkImageCopy{
+                    .srcSubresource = vk_subresource,
+                    .srcOffset = {},
+                    .dstSubresource = vk_subresource,
+                    .dstOffset = {},
+                    .extent = {
+                        .width = std::max(1u, image_slot.info.size.width >> mip),
+                        .height = std::max(1u, image_slot.info.size.height >> mip),
+                        .depth = std::max(1u, image_slot.info.size.depth >> mip),
+                    },
+                });
+            }
+            vkCmdCopyImage(
+                vk_cmd_buffer,
+                image_slot.vk_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                image_move.vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                static_cast<u32>(vk_image_copies.size()), vk_image_copies.data());
+        }
+
+        for (auto const & image_move : image_moves)
+        {
+            auto const & image_slot = pool_slot_at(self->gpu_sro_table.image_slots, image_move.index).first;
+            push_image_barrier(image_move.vk_image, image_slot.aspect_flags, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image_move.vk_layout, false);
+        }
+        record_barriers(VkMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+        });
+        vk_result = vkEndCommandBuffer(vk_cmd_buffer);
+    }
+
+    u64 current_main_queue_cpu_timeline_value = self->main_queue_cpu_timeline.load(std::memory_order::relaxed);
+    if (vk_result == VK_SUCCESS)
+    {
+        current_main_queue_cpu_timeline_value = self->main_queue_cpu_timeline.fetch_add(1) + 1;
+        VkTimelineSemaphoreSubmitInfo const timeline_info{
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .waitSemaphoreValueCount = 0,
+            .pWaitSemaphoreValues = nullptr,
+            .signalSemaphoreValueCount = 1,
+            .pSignalSemaphoreValues = &current_main_queue_cpu_timeline_value,
+        };
+        VkSubmitInfo const vk_submit_info{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = r_cast<void const *>(&timeline_info),
+            .waitSemaphoreCount = 0,
+            .pWaitSemaphores = nullptr,
+            .pWaitDstStageMask = nullptr,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &vk_cmd_buffer,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &self->vk_main_queue_gpu_timeline_semaphore,
+        };
+        // The submit does not touch the zombie queues, other threads may zombify resources meanwhile.
+        // They are zombified with a later timeline value than the copies, so they outlive them.
+        lock.unlock();
+        vk_result = vkQueueSubmit(self->main_queue_vk_queue, 1, &vk_submit_info, VK_NULL_HANDLE);
+        lock.lock();
+    }
+    self->main_queue_command_list_zombies.push_front({
+        current_main_queue_cpu_timeline_value,
+        CommandRecorderZombie{
+            .vk_cmd_pool = vk_cmd_pool,
+            .allocated_command_buffers = vk_cmd_buffer != VK_NULL_HANDLE ? std::vector<VkCommandBuffer>{vk_cmd_buffer} : std::vector<VkCommandBuffer>{},
+        },
+    });
+    if (vk_result != VK_SUCCESS)
+    {
+        for (auto const & buffer_move : buffer_moves)
+        {
+            vkDestroyBuffer(self->vk_device, buffer_move.vk_buffer, nullptr);
+        }
+        for (auto const & image_move : image_moves)
+        {
+            for (auto const & [view_index, vk_image_view] : image_move.views)
+            {
+                vkDestroyImageView(self->vk_device, vk_image_view, nullptr);
+            }
+            vkDestroyImageView(self->vk_device, image_move.vk_default_view, nullptr);
+            vkDestroyImage(self->vk_device, image_move.vk_image, nullptr);
+        }
+        for (auto & move : std::span{state.vma_pass_info.pMoves, state.vma_pass_info.moveCount})
+        {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        }
+        [[maybe_unused]] auto const _ignore = vmaEndDefragmentationPass(self->vma_allocator, state.vma_context, &state.vma_pass_info);
+        self->end_defragmentation();
+        state.completed = false;
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+
+    // All work recorded from now on uses the new resources.
+    // The old ones stay alive until the gpu finished all work submitted up to and including the copies.
+    for (auto const & buffer_move : buffer_moves)
+    {
+        auto & buffer_slot = pool_slot_at(self->gpu_sro_table.buffer_slots, buffer_move.index).first;
+        state.retired_buffers.push_back(buffer_slot.vk_buffer);
+        buffer_slot.vk_buffer = buffer_move.vk_buffer;
+        VkBufferDeviceAddressInfo const vk_buffer_device_address_info{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr,
+            .buffer = buffer_slot.vk_buffer,
+        };
+        buffer_slot.device_address = vkGetBufferDeviceAddress(self->vk_device, &vk_buffer_device_address_info);
+        self->buffer_device_address_buffer_host_ptr[buffer_move.index] = buffer_slot.device_address;
+        write_descriptor_set_buffer(
+            self->vk_device,
+            self->gpu_sro_table.vk_descriptor_set, buffer_slot.vk_buffer,
+            0,
+            static_cast<VkDeviceSize>(buffer_slot.info.size),
+            static_cast<u32>(buffer_move.index));
+        ++out_status->moved_buffer_count;
+    }
+    for (auto const & image_move : image_moves)
+    {
+        auto & image_slot = pool_slot_at(self->gpu_sro_table.image_slots, image_move.index).first;
+        state.retired_images.push_back(image_slot.vk_image);
+        state.retired_image_views.push_back(image_slot.view_slot.vk_image_view);
+        image_slot.vk_image = image_move.vk_image;
+        image_slot.view_slot.vk_image_view = image_move.vk_default_view;
+        write_descriptor_set_image(
+            self->vk_device,
+            self->gpu_sro_table.vk_descriptor_set,
+            image_slot.view_slot.vk_image_view,
+            std::bit_cast<ImageUsageFlags>(image_slot.info.usage),
+            static_cast<u32>(image_move.index));
+        for (auto const & [view_index, vk_image_view] : image_move.views)
+        {
+            auto & view_slot = pool_slot_at(self->gpu_sro_table.image_slots, view_index).first.view_slot;
+            state.retired_image_views.push_back(view_slot.vk_image_view);
+            view_slot.vk_image_view = vk_image_view;
+            write_descriptor_set_image(
+                self->vk_device,
+                self->gpu_sro_table.vk_descriptor_set,
+                view_slot.vk_image_view,
+                std::bit_cast<ImageUsageFlags>(image_slot.info.usage),
+                static_cast<u32>(view_index));
+        }
+        ++out_status->moved_image_count;
+    }
+    state.pass_pending = true;
+    state.pass_timeline_value = current_main_queue_cpu_timeline_value;
+    report_status();
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_dvc_on_timeline_reached(daxa_Device self, daxa_TimelineSemaphore semaphore, u64 value, daxa_TimelineCallback callback, void * user_data) -> daxa_Result
+{
+    u64 current_value = {};
+    auto result = daxa_timeline_semaphore_get_value(semaphore, &current_value);
+    if (result != DAXA_RESULT_SUCCESS || current_value >= value)
+    {
+        callback(user_data);
+        return DAXA_RESULT_SUCCESS;
+    }
+    {
+        std::unique_lock const lock{self->completion_mtx};
+        if (!self->completion_thread_failed)
+        {
+            if (self->vk_completion_wake_semaphore == VK_NULL_HANDLE)
+            {
+                VkSemaphoreTypeCreateInfo const vk_semaphore_type_create_info{
+                    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+                    .initialValue = 0,
+                };
+                VkSemaphoreCreateInfo const vk_semaphore_create_info{
+                    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                    .pNext = &vk_semaphore_type_create_info,
+                    .flags = {},
+                };
+                auto const vk_result = vkCreateSemaphore(self->vk_device, &vk_semaphore_create_info, nullptr, &self->vk_completion_wake_semaphore);
+                if (vk_result != VK_SUCCESS)
+                {
+                    self->vk_completion_wake_semaphore = {};
+                    return std::bit_cast<daxa_Result>(vk_result);
+                }
+                self->completion_thread = std::thread{[self]()
+                                                      { self->completion_thread_main(); }};
+            }
+            daxa_timeline_semaphore_inc_refcnt(semaphore);
+            self->pending_completions.push_back(TimelineCompletion{
+                .semaphore = semaphore,
+                .value = value,
+                .callback = callback,
+                .user_data = user_data,
+            });
+            // Wakes the completion thread, so that it also waits on the new semaphore value.
+            self->completion_wake_value += 1;
+            VkSemaphoreSignalInfo const vk_semaphore_signal_info{
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+                .pNext = nullptr,
+                .semaphore = self->vk_completion_wake_semaphore,
+                .value = self->completion_wake_value,
+            };
+            auto const vk_result = vkSignalSemaphore(self->vk_device, &vk_semaphore_signal_info);
+            if (vk_result != VK_SUCCESS)
+            {
+                // The caller still holds a reference, so this never releases the semaphore.
+                self->pending_completions.pop_back();
+                daxa_timeline_semaphore_dec_refcnt(semaphore);
+                return std::bit_cast<daxa_Result>(vk_result);
+            }
+            return DAXA_RESULT_SUCCESS;
+        }
+    }
+    // Waiting failed before, the value might never be reached.
+    callback(user_data);
+    return DAXA_RESULT_SUCCESS;
+}
+
 auto daxa_dvc_properties(daxa_Device device) -> daxa_DeviceProperties const *
 {
     return &device->physical_device_properties;
 }
 
+void daxa_dvc_memory_report(daxa_Device self, daxa_MemoryReport * out_report)
+{
+    *out_report = {};
+    VkPhysicalDeviceMemoryProperties const * vk_memory_properties = {};
+    vmaGetMemoryProperties(self->vma_allocator, &vk_memory_properties);
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = {};
+    vmaGetHeapBudgets(self->vma_allocator, budgets.data());
+    out_report->heap_count = vk_memory_properties->memoryHeapCount;
+    for (u32 heap_i = 0; heap_i < vk_memory_properties->memoryHeapCount; ++heap_i)
+    {
+        out_report->heaps[heap_i] = daxa_MemoryHeapReport{
+            .heap_size = vk_memory_properties->memoryHeaps[heap_i].size,
+            .heap_flags = vk_memory_properties->memoryHeaps[heap_i].flags,
+            .block_bytes = budgets[heap_i].statistics.blockBytes,
+            .block_count = budgets[heap_i].statistics.blockCount,
+            .allocation_bytes = budgets[heap_i].statistics.allocationBytes,
+            .allocation_count = budgets[heap_i].statistics.allocationCount,
+            .usage = budgets[heap_i].usage,
+            .budget = budgets[heap_i].budget,
+        };
+    }
+    out_report->memory_budget_supported = self->physical_device_properties.memory_budget_supported;
+    auto const & counters = self->memory_report_counters;
+    out_report->buffer_bytes = counters.buffer_bytes.load(std::memory_order_relaxed);
+    out_report->buffer_count = counters.buffer_count.load(std::memory_order_relaxed);
+    out_report->image_bytes = counters.image_bytes.load(std::memory_order_relaxed);
+    out_report->image_count = counters.image_count.load(std::memory_order_relaxed);
+    out_report->memory_block_bytes = counters.memory_block_bytes.load(std::memory_order_relaxed);
+    out_report->memory_block_count = counters.memory_block_count.load(std::memory_order_relaxed);
+    out_report->transient_memory_block_bytes = counters.transient_memory_block_bytes.load(std::memory_order_relaxed);
+    out_report->transient_memory_block_count = counters.transient_memory_block_count.load(std::memory_order_relaxed);
+    out_report->tlas_bytes = counters.tlas_bytes.load(std::memory_order_relaxed);
+    out_report->tlas_count = counters.tlas_count.load(std::memory_order_relaxed);
+    out_report->blas_bytes = counters.blas_bytes.load(std::memory_order_relaxed);
+    out_report->blas_count = counters.blas_count.load(std::memory_order_relaxed);
+}
+
 auto daxa_dvc_inc_refcnt(daxa_Device self) -> u64
 {
     _DAXA_TEST_PRINT("device inc refcnt from %u to %u\n", self->strong_count, self->strong_count + 1);
@@ -1233,6 +2186,10 @@ auto daxa_ImplDevice::create(daxa_Instance instance, daxa_DeviceInfo const & inf
     self->instance = instance;
     self->info = *r_cast<DeviceInfo const *>(&info);
     self->physical_device_properties = construct_daxa_physical_device_properties(physical_device);
+    if ((self->info.flags & DeviceFlagBits::CONDITIONAL_RENDERING) != DeviceFlagBits::NONE)
+    {
+        self->vk_buffer_usage_flags |= VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT;
+    }
 
     if ((self->info.flags & daxa::DeviceFlagBits::RAY_TRACING) && !self->physical_device_properties.ray_tracing_pipeline_properties.has_value)
     {
@@ -1277,6 +2234,14 @@ auto daxa_ImplDevice::create(daxa_Instance instance, daxa_DeviceInfo const & inf
     feature_table.initialize(info);
     PhysicalDeviceExtensionList extension_list = {};
     extension_list.initialize(info);
+    if (self->physical_device_properties.push_descriptor_supported)
+    {
+        extension_list.data[extension_list.size++] = VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME;
+    }
+    if (self->physical_device_properties.memory_budget_supported)
+    {
+        extension_list.data[extension_list.size++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    }
 
     VkPhysicalDeviceFeatures2 physical_device_features_2{
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
@@ -1317,12 +2282,19 @@ auto daxa_ImplDevice::create(daxa_Instance instance, daxa_DeviceInfo const & inf
         self->vkCmdDrawMeshTasksIndirectCountEXT = r_cast<PFN_vkCmdDrawMeshTasksIndirectCountEXT>(vkGetDeviceProcAddr(self->vk_device, "vkCmdDrawMeshTasksIndirectCountEXT"));
     }
 
+    if ((self->info.flags & DeviceFlagBits::CONDITIONAL_RENDERING) != DeviceFlagBits::NONE)
+    {
+        self->vkCmdBeginConditionalRenderingEXT = r_cast<PFN_vkCmdBeginConditionalRenderingEXT>(vkGetDeviceProcAddr(self->vk_device, "vkCmdBeginConditionalRenderingEXT"));
+        self->vkCmdEndConditionalRenderingEXT = r_cast<PFN_vkCmdEndConditionalRenderingEXT>(vkGetDeviceProcAddr(self->vk_device, "vkCmdEndConditionalRenderingEXT"));
+    }
+
     if ((self->info.flags & DeviceFlagBits::RAY_TRACING) != DeviceFlagBits::NONE)
     {
         self->vkGetAccelerationStructureBuildSizesKHR = r_cast<PFN_vkGetAccelerationStructureBuildSizesKHR>(vkGetDeviceProcAddr(self->vk_device, "vkGetAccelerationStructureBuildSizesKHR"));
         self->vkCreateAccelerationStructureKHR = r_cast<PFN_vkCreateAccelerationStructureKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCreateAccelerationStructureKHR"));
         self->vkDestroyAccelerationStructureKHR = r_cast<PFN_vkDestroyAccelerationStructureKHR>(vkGetDeviceProcAddr(self->vk_device, "vkDestroyAccelerationStructureKHR"));
         self->vkCmdWriteAccelerationStructuresPropertiesKHR = r_cast<PFN_vkCmdWriteAccelerationStructuresPropertiesKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCmdWriteAccelerationStructuresPropertiesKHR"));
+        self->vkCmdCopyAccelerationStructureKHR = r_cast<PFN_vkCmdCopyAccelerationStructureKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCmdCopyAccelerationStructureKHR"));
         self->vkCmdBuildAccelerationStructuresKHR = r_cast<PFN_vkCmdBuildAccelerationStructuresKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCmdBuildAccelerationStructuresKHR"));
         self->vkGetAccelerationStructureDeviceAddressKHR = r_cast<PFN_vkGetAccelerationStructureDeviceAddressKHR>(vkGetDeviceProcAddr(self->vk_device, "vkGetAccelerationStructureDeviceAddressKHR"));
         self->vkCreateRayTracingPipelinesKHR = r_cast<PFN_vkCreateRayTracingPipelinesKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCreateRayTracingPipelinesKHR"));
@@ -1452,7 +2424,8 @@ auto daxa_ImplDevice::create(daxa_Instance instance, daxa_DeviceInfo const & inf
     };
 
     VmaAllocatorCreateInfo const vma_allocator_create_info{
-        .flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
+        .flags = static_cast<VmaAllocatorCreateFlags>(VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT) |
+                 (self->physical_device_properties.memory_budget_supported ? static_cast<VmaAllocatorCreateFlags>(VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT) : 0u),
         .physicalDevice = self->vk_physical_device,
         .device = self->vk_device,
         .preferredLargeHeapBlockSize = 0, // Sets it to lib internal default (256MiB).
@@ -1760,6 +2733,7 @@ auto daxa_ImplDevice::create(daxa_Instance instance, daxa_DeviceInfo const & inf
         (self->info.flags & daxa::DeviceFlagBits::RAY_TRACING) ? self->info.max_allowed_acceleration_structures : (~0u),
         self->vk_device,
         self->buffer_device_address_buffer,
+        self->physical_device_properties.push_descriptor_supported != 0,
         self->vkSetDebugUtilsObjectNameEXT);
 
     auto end_err_cleanup = [&]()
@@ -1807,8 +2781,35 @@ auto daxa_ImplDevice::create(daxa_Instance instance, daxa_DeviceInfo const & inf
         end_err_cleanup();
         return DAXA_RESULT_FAILED_TO_SUBMIT_DEVICE_INIT_COMMANDS;
     }
+    if ((self->info.flags & DeviceFlagBits::BACKGROUND_GARBAGE_COLLECTION) != DeviceFlagBits::NONE)
+    {
+        VkSemaphoreTypeCreateInfo const vk_semaphore_type_create_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue = 0,
+        };
+        VkSemaphoreCreateInfo const vk_semaphore_create_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &vk_semaphore_type_create_info,
+            .flags = {},
+        };
+        result = vkCreateSemaphore(self->vk_device, &vk_semaphore_create_info, nullptr, &self->vk_garbage_collection_stop_semaphore);
+        if (result != VK_SUCCESS)
+        {
+            self->vk_garbage_collection_stop_semaphore = {};
+            end_err_cleanup();
+            return std::bit_cast<daxa_Result>(result);
+        }
+    }
     vkDestroyCommandPool(self->vk_device, init_cmd_pool, {});
 
+    if (self->vk_garbage_collection_stop_semaphore != VK_NULL_HANDLE)
+    {
+        self->garbage_collection_thread = std::thread{[self]()
+                                                      { self->garbage_collection_thread_main(); }};
+    }
+
     return DAXA_RESULT_SUCCESS;
 }
 
@@ -1932,6 +2933,10 @@ void daxa_ImplDevice::cleanup_buffer(BufferId id)
     }
     else
     {
+        VmaAllocationInfo vma_allocation_info = {};
+        vmaGetAllocationInfo(this->vma_allocator, buffer_slot.vma_allocation, &vma_allocation_info);
+        this->memory_report_counters.buffer_bytes.fetch_sub(vma_allocation_info.size, std::memory_order_relaxed);
+        this->memory_report_counters.buffer_count.fetch_sub(1, std::memory_order_relaxed);
         vmaDestroyBuffer(this->vma_allocator, buffer_slot.vk_buffer, buffer_slot.vma_allocation);
     }
     gpu_sro_table.buffer_slots.unsafe_destroy_zombie_slot(std::bit_cast<GPUResourceId>(id));
@@ -1957,6 +2962,10 @@ void daxa_ImplDevice::cleanup_image(ImageId id)
         }
         else
         {
+            VmaAllocationInfo vma_allocation_info = {};
+            vmaGetAllocationInfo(this->vma_allocator, image_slot.vma_allocation, &vma_allocation_info);
+            this->memory_report_counters.image_bytes.fetch_sub(vma_allocation_info.size, std::memory_order_relaxed);
+            this->memory_report_counters.image_count.fetch_sub(1, std::memory_order_relaxed);
             vmaDestroyImage(this->vma_allocator, image_slot.vk_image, image_slot.vma_allocation);
         }
     }
@@ -1986,6 +2995,8 @@ void daxa_ImplDevice::cleanup_tlas(TlasId id)
     // TODO(Raytracing): Add null acceleration structure:
     // write_descriptor_set_acceleration_structure(this->vk_device, this->gpu_sro_table.vk_descriptor_set, this->vk_null_acceleration_structure, std::bit_cast<GPUResourceId>(id).index);
     this->vkDestroyAccelerationStructureKHR(this->vk_device, tlas_slot.vk_acceleration_structure, nullptr);
+    this->memory_report_counters.tlas_bytes.fetch_sub(tlas_slot.info.size, std::memory_order_relaxed);
+    this->memory_report_counters.tlas_count.fetch_sub(1, std::memory_order_relaxed);
     gpu_sro_table.tlas_slots.unsafe_destroy_zombie_slot(std::bit_cast<GPUResourceId>(id));
 }
 
@@ -1993,9 +3004,260 @@ void daxa_ImplDevice::cleanup_blas(BlasId id)
 {
     ImplBlasSlot const & blas_slot = this->gpu_sro_table.blas_slots.unsafe_get(std::bit_cast<GPUResourceId>(id));
     this->vkDestroyAccelerationStructureKHR(this->vk_device, blas_slot.vk_acceleration_structure, nullptr);
+    this->memory_report_counters.blas_bytes.fetch_sub(blas_slot.info.size, std::memory_order_relaxed);
+    this->memory_report_counters.blas_count.fetch_sub(1, std::memory_order_relaxed);
     gpu_sro_table.blas_slots.unsafe_destroy_zombie_slot(std::bit_cast<GPUResourceId>(id));
 }
 
+void daxa_ImplDevice::try_end_defragmentation_pass(u64 gpu_timeline_value)
+{
+    auto & state = this->defragmentation;
+    if (!state.pass_pending || state.pass_timeline_value > gpu_timeline_value)
+    {
+        return;
+    }
+    for (VkImageView vk_image_view : state.retired_image_views)
+    {
+        vkDestroyImageView(this->vk_device, vk_image_view, nullptr);
+    }
+    for (VkImage vk_image : state.retired_images)
+    {
+        vkDestroyImage(this->vk_device, vk_image, nullptr);
+    }
+    for (VkBuffer vk_buffer : state.retired_buffers)
+    {
+        vkDestroyBuffer(this->vk_device, vk_buffer, nullptr);
+    }
+    state.retired_image_views.clear();
+    state.retired_images.clear();
+    state.retired_buffers.clear();
+    state.pass_pending = false;
+    // Frees the old memory of the moved allocations.
+    if (vmaEndDefragmentationPass(this->vma_allocator, state.vma_context, &state.vma_pass_info) == VK_SUCCESS)
+    {
+        this->end_defragmentation();
+    }
+}
+
+void daxa_ImplDevice::completion_thread_main()
+{
+    std::vector<VkSemaphore> wait_semaphores = {};
+    std::vector<u64> wait_values = {};
+    std::unordered_map<VkSemaphore, usize> wait_indices = {};
+    std::unordered_map<VkSemaphore, u64> current_values = {};
+    std::vector<TimelineCompletion> reached = {};
+    while (true)
+    {
+        {
+            std::unique_lock const lock{this->completion_mtx};
+            if (this->completion_thread_stop)
+            {
+                return;
+            }
+            // Waits for the smallest pending value of each semaphore, as well as the next wake up.
+            wait_semaphores.assign({this->vk_completion_wake_semaphore});
+            wait_values.assign({this->completion_wake_value + 1});
+            wait_indices.clear();
+            for (auto const & completion : this->pending_completions)
+            {
+                auto const [iter, inserted] = wait_indices.try_emplace(completion.semaphore->vk_semaphore, wait_semaphores.size());
+                if (inserted)
+                {
+                    wait_semaphores.push_back(completion.semaphore->vk_semaphore);
+                    wait_values.push_back(completion.value);
+                }
+                else
+                {
+                    wait_values[iter->second] = std::min(wait_values[iter->second], completion.value);
+                }
+            }
+        }
+        VkSemaphoreWaitInfo const vk_semaphore_wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = VK_SEMAPHORE_WAIT_ANY_BIT,
+            .semaphoreCount = static_cast<u32>(wait_semaphores.size()),
+            .pSemaphores = wait_semaphores.data(),
+            .pValues = wait_values.data(),
+        };
+        auto const vk_result = vkWaitSemaphores(this->vk_device, &vk_semaphore_wait_info, std::numeric_limits<u64>::max());
+        bool const failed = vk_result != VK_SUCCESS && vk_result != VK_TIMEOUT;
+        {
+            std::unique_lock const lock{this->completion_mtx};
+            if (this->completion_thread_stop)
+            {
+                return;
+            }
+            this->completion_thread_failed = failed;
+            current_values.clear();
+            for (usize i = 0; i < this->pending_completions.size();)
+            {
+                auto const & completion = this->pending_completions[i];
+                auto [iter, inserted] = current_values.try_emplace(completion.semaphore->vk_semaphore, 0);
+                if (inserted && (failed || vkGetSemaphoreCounterValue(this->vk_device, iter->first, &iter->second) != VK_SUCCESS))
+                {
+                    // On failure all callbacks are invoked, their values might never be reached.
+                    iter->second = std::numeric_limits<u64>::max();
+                }
+                if (iter->second >= completion.value)
+                {
+                    reached.push_back(completion);
+                    this->pending_completions[i] = this->pending_completions.back();
+                    this->pending_completions.pop_back();
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+        for (auto const & completion : reached)
+        {
+            completion.callback(completion.user_data);
+        }
+        // Releasing the last semaphore reference can release the last device reference,
+        // which destroys the device and detaches this thread. The device must not be touched after that.
+        for (auto const & completion : reached)
+        {
+            daxa_timeline_semaphore_dec_refcnt(completion.semaphore);
+        }
+        reached.clear();
+        if (tl_completion_thread_released_device || failed)
+        {
+            return;
+        }
+    }
+}
+
+void daxa_ImplDevice::stop_completion_thread()
+{
+    {
+        std::unique_lock const lock{this->completion_mtx};
+        if (this->vk_completion_wake_semaphore == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        this->completion_thread_stop = true;
+        this->completion_wake_value += 1;
+        VkSemaphoreSignalInfo const vk_semaphore_signal_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+            .pNext = nullptr,
+            .semaphore = this->vk_completion_wake_semaphore,
+            .value = this->completion_wake_value,
+        };
+        [[maybe_unused]] auto const vk_result = vkSignalSemaphore(this->vk_device, &vk_semaphore_signal_info);
+    }
+    if (this->completion_thread.get_id() == std::this_thread::get_id())
+    {
+        // The last device reference was released by the completion thread itself, it can not join itself.
+        this->completion_thread.detach();
+        tl_completion_thread_released_device = true;
+    }
+    else
+    {
+        this->completion_thread.join();
+    }
+    vkDestroySemaphore(this->vk_device, this->vk_completion_wake_semaphore, nullptr);
+    this->vk_completion_wake_semaphore = {};
+}
+
+void daxa_ImplDevice::garbage_collection_thread_main()
+{
+    u64 collected_gpu_timeline_value = {};
+    while (true)
+    {
+        // Wakes up when the gpu made progress since the last collection or when the device is destroyed.
+        // Zombies of resources destroyed while the gpu is idle are therefore retired once the next submission completes.
+        std::array<VkSemaphore, 2> const wait_semaphores = {this->vk_main_queue_gpu_timeline_semaphore, this->vk_garbage_collection_stop_semaphore};
+        std::array<u64, 2> const wait_values = {collected_gpu_timeline_value + 1, 1};
+        VkSemaphoreWaitInfo const vk_semaphore_wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = VK_SEMAPHORE_WAIT_ANY_BIT,
+            .semaphoreCount = static_cast<u32>(wait_semaphores.size()),
+            .pSemaphores = wait_semaphores.data(),
+            .pValues = wait_values.data(),
+        };
+        u64 stop_value = {};
+        u64 gpu_timeline_value = {};
+        if (vkWaitSemaphores(this->vk_device, &vk_semaphore_wait_info, std::numeric_limits<u64>::max()) != VK_SUCCESS ||
+            vkGetSemaphoreCounterValue(this->vk_device, this->vk_garbage_collection_stop_semaphore, &stop_value) != VK_SUCCESS ||
+            stop_value != 0 ||
+            vkGetSemaphoreCounterValue(this->vk_device, this->vk_main_queue_gpu_timeline_semaphore, &gpu_timeline_value) != VK_SUCCESS)
+        {
+            // On device loss the thread gives up, manual collect_garbage calls report the error.
+            return;
+        }
+        // Command recorders hold the lifetime lock shared for their whole lifetime.
+        // Instead of stalling the creation of new recorders by blocking on the lock, the thread sleeps until the last recorder is destroyed.
+        std::unique_lock lifetime_lock{this->gpu_sro_table.lifetime_lock, std::try_to_lock};
+        while (!lifetime_lock.owns_lock())
+        {
+            {
+                std::unique_lock wake_lock{this->garbage_collection_wake_mtx};
+                if (this->command_recorder_count.load() == 0)
+                {
+                    // The lock is held by a short operation like a submit or a manual collection, the thread retries shortly after.
+                    constexpr auto RETRY_DELAY = std::chrono::milliseconds{1};
+                    this->garbage_collection_wake_cv.wait_for(wake_lock, RETRY_DELAY, [&]()
+                                                              { return this->garbage_collection_thread_stop; });
+                }
+                else
+                {
+                    this->garbage_collection_wake_cv.wait(wake_lock, [&]()
+                                                          { return this->command_recorder_count.load() == 0 || this->garbage_collection_thread_stop; });
+                }
+                if (this->garbage_collection_thread_stop)
+                {
+                    return;
+                }
+            }
+            // A new recorder may have been created in the meantime, its destruction wakes the thread again.
+            [[maybe_unused]] auto const locked = lifetime_lock.try_lock();
+        }
+        [[maybe_unused]] auto const result = collect_garbage_helper(this);
+        collected_gpu_timeline_value = gpu_timeline_value;
+    }
+}
+
+void daxa_ImplDevice::stop_garbage_collection_thread()
+{
+    if (this->vk_garbage_collection_stop_semaphore == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    {
+        std::unique_lock wake_lock{this->garbage_collection_wake_mtx};
+        this->garbage_collection_thread_stop = true;
+    }
+    this->garbage_collection_wake_cv.notify_all();
+    VkSemaphoreSignalInfo const vk_semaphore_signal_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+        .pNext = nullptr,
+        .semaphore = this->vk_garbage_collection_stop_semaphore,
+        .value = 1,
+    };
+    [[maybe_unused]] auto const vk_result = vkSignalSemaphore(this->vk_device, &vk_semaphore_signal_info);
+    // The thread never releases device references, it is never the one destroying the device.
+    this->garbage_collection_thread.join();
+    vkDestroySemaphore(this->vk_device, this->vk_garbage_collection_stop_semaphore, nullptr);
+    this->vk_garbage_collection_stop_semaphore = {};
+}
+
+void daxa_ImplDevice::end_defragmentation()
+{
+    auto & state = this->defragmentation;
+    if (state.vma_context == nullptr)
+    {
+        return;
+    }
+    DAXA_DBG_ASSERT_TRUE_M(!state.pass_pending, "defragmentation can only end when no pass is pending");
+    vmaEndDefragmentation(this->vma_allocator, state.vma_context, &state.completed_stats);
+    state.vma_context = {};
+    state.vma_pass_info = {};
+    state.completed = true;
+}
+
 auto daxa_ImplDevice::slot(daxa_BufferId id) const -> ImplBufferSlot const &
 {
     return gpu_sro_table.buffer_slots.unsafe_get(std::bit_cast<daxa::GPUResourceId>(id));
@@ -2030,10 +3292,13 @@ void daxa_ImplDevice::zero_ref_callback(ImplHandle const * handle)
 {
     _DAXA_TEST_PRINT("daxa_ImplDevice::zero_ref_callback\n");
     auto self = rc_cast<daxa_Device>(handle);
+    self->stop_completion_thread();
+    self->stop_garbage_collection_thread();
     auto result = daxa_dvc_wait_idle(self);
     DAXA_DBG_ASSERT_TRUE_M(result == DAXA_RESULT_SUCCESS, "failed to wait idle");
     result = daxa_dvc_collect_garbage(self);
     DAXA_DBG_ASSERT_TRUE_M(result == DAXA_RESULT_SUCCESS, "failed to wait idle");
+    self->end_defragmentation();
     self->buffer_pool_pool.cleanup(self);
     vmaUnmapMemory(self->vma_allocator, self->buffer_device_address_buffer_allocation);
     vmaDestroyBuffer(self->vma_allocator, self->buffer_device_address_buffer, self->buffer_device_address_buffer_allocation);
@@ -2053,7 +3318,13 @@ void daxa_ImplDevice::zero_ref_callback(ImplHandle const * handle)
 
 void daxa_ImplDevice::zombify_buffer(BufferId id)
 {
-    _DAXA_TEST_PRINT("daxa_ImplDevice::zombify_buffer\n");
+    this->zombify_buffers({&id, 1});
+}
+
+void daxa_ImplDevice::zombify_buffers(std::span<BufferId const> ids)
+{
+    _DAXA_TEST_PRINT("daxa_ImplDevice::zombify_buffers\n");
+    for (auto const id : ids)
     {
         auto & slot = gpu_sro_table.buffer_slots.unsafe_get(std::bit_cast<GPUResourceId>(id));
         if (slot.opt_memory_block != nullptr)
@@ -2062,46 +3333,64 @@ void daxa_ImplDevice::zombify_buffer(BufferId id)
                 daxa_ImplMemoryBlock::zero_ref_callback,
                 this->instance);
         }
-        u64 const main_queue_cpu_timeline_value = this->main_queue_cpu_timeline.load(std::memory_order::relaxed);
-        {
-            std::unique_lock const lock{this->main_queue_zombies_mtx};
-            this->main_queue_buffer_zombies.push_front({
-                main_queue_cpu_timeline_value,
-                std::bit_cast<BufferId>(id),
-            });
-        }
+    }
+    u64 const main_queue_cpu_timeline_value = this->main_queue_cpu_timeline.load(std::memory_order::relaxed);
+    std::unique_lock const lock{this->main_queue_zombies_mtx};
+    for (auto const id : ids)
+    {
+        this->main_queue_buffer_zombies.push_front({
+            main_queue_cpu_timeline_value,
+            id,
+        });
     }
 }
 
 void daxa_ImplDevice::zombify_image(ImageId id)
 {
-    _DAXA_TEST_PRINT("daxa_ImplDevice::zombify_image (%i,%i)\n", id.index, id.version);
-    auto & slot = gpu_sro_table.image_slots.unsafe_get(std::bit_cast<GPUResourceId>(id));
-    if (slot.opt_memory_block != nullptr)
+    this->zombify_images({&id, 1});
+}
+
+void daxa_ImplDevice::zombify_images(std::span<ImageId const> ids)
+{
+    _DAXA_TEST_PRINT("daxa_ImplDevice::zombify_images\n");
+    for (auto const id : ids)
     {
-        slot.opt_memory_block->dec_weak_refcnt(
-            daxa_ImplMemoryBlock::zero_ref_callback,
-            this->instance);
+        auto & slot = gpu_sro_table.image_slots.unsafe_get(std::bit_cast<GPUResourceId>(id));
+        if (slot.opt_memory_block != nullptr)
+        {
+            slot.opt_memory_block->dec_weak_refcnt(
+                daxa_ImplMemoryBlock::zero_ref_callback,
+                this->instance);
+        }
     }
     u64 const main_queue_cpu_timeline_value = this->main_queue_cpu_timeline.load(std::memory_order::relaxed);
+    std::unique_lock const lock{this->main_queue_zombies_mtx};
+    for (auto const id : ids)
     {
-        std::unique_lock const lock{this->main_queue_zombies_mtx};
         this->main_queue_image_zombies.push_front({
             main_queue_cpu_timeline_value,
-            std::bit_cast<ImageId>(id),
+            id,
         });
     }
 }
 
 void daxa_ImplDevice::zombify_image_view(ImageViewId id)
 {
-    _DAXA_TEST_PRINT("daxa_ImplDevice::zombify_image_view\n");
+    this->zombify_image_views({&id, 1});
+}
+
+void daxa_ImplDevice::zombify_image_views(std::span<ImageViewId const> ids)
+{
+    _DAXA_TEST_PRINT("daxa_ImplDevice::zombify_image_views\n");
     u64 const main_queue_cpu_timeline_value = this->main_queue_cpu_timeline.load(std::memory_order::relaxed);
     std::unique_lock const lock{this->main_queue_zombies_mtx};
-    this->main_queue_image_view_zombies.push_front({
-        main_queue_cpu_timeline_value,
-        std::bit_cast<ImageViewId>(id),
-    });
+    for (auto const id : ids)
+    {
+        this->main_queue_image_view_zombies.push_front({
+            main_queue_cpu_timeline_value,
+            id,
+        });
+    }
 }
 
 void daxa_ImplDevice::zombify_sampler(SamplerId id)
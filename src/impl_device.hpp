@@ -11,6 +11,10 @@
 
 #include <daxa/c/device.h>
 
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
 using namespace daxa;
 
 struct SubmitZombie
@@ -19,6 +23,79 @@ struct SubmitZombie
     std::vector<daxa_TimelineSemaphore> timeline_semaphores = {};
 };
 
+// All sampler info fields except the name, the names of deduplicated samplers are irrelevant.
+using SamplerCacheKey = std::array<u32, 16>;
+
+struct SamplerCacheKeyHash
+{
+    auto operator()(SamplerCacheKey const & key) const -> usize
+    {
+        // FNV-1a over the key fields.
+        u64 hash = 14695981039346656037ull;
+        for (u32 value : key)
+        {
+            hash = (hash ^ value) * 1099511628211ull;
+        }
+        return static_cast<usize>(hash);
+    }
+};
+
+struct SamplerCacheEntry
+{
+    SamplerId id = {};
+    u32 ref_count = {};
+};
+
+// Live memory per resource type, reported by daxa_dvc_memory_report.
+struct MemoryReportCounters
+{
+    std::atomic_uint64_t buffer_bytes = {};
+    std::atomic_uint64_t buffer_count = {};
+    std::atomic_uint64_t image_bytes = {};
+    std::atomic_uint64_t image_count = {};
+    std::atomic_uint64_t memory_block_bytes = {};
+    std::atomic_uint64_t memory_block_count = {};
+    std::atomic_uint64_t transient_memory_block_bytes = {};
+    std::atomic_uint64_t transient_memory_block_count = {};
+    std::atomic_uint64_t tlas_bytes = {};
+    std::atomic_uint64_t tlas_count = {};
+    std::atomic_uint64_t blas_bytes = {};
+    std::atomic_uint64_t blas_count = {};
+};
+
+// Device owned vma allocations of buffers and images carry their resource index and a tag as user data.
+// Defragmentation uses it to find the resource of a moved allocation.
+static inline constexpr u64 VMA_USER_DATA_TAG_BITS = 2;
+static inline constexpr u64 VMA_USER_DATA_BUFFER_TAG = 1;
+static inline constexpr u64 VMA_USER_DATA_IMAGE_TAG = 2;
+
+// Callback registered with daxa_dvc_on_timeline_reached.
+// Holds a reference to the semaphore until the callback was invoked.
+struct TimelineCompletion
+{
+    daxa_TimelineSemaphore semaphore = {};
+    u64 value = {};
+    daxa_TimelineCallback callback = {};
+    void * user_data = {};
+};
+
+// Incremental defragmentation, see daxa_dvc_defragment.
+struct DefragmentationState
+{
+    VmaDefragmentationContext vma_context = {};
+    VmaDefragmentationPassMoveInfo vma_pass_info = {};
+    // A pass is pending from the submit of its copies until the gpu finished them.
+    bool pass_pending = {};
+    u64 pass_timeline_value = {};
+    // Handles of the moved resources before the move. Destroyed when the pending pass ends.
+    std::vector<VkBuffer> retired_buffers = {};
+    std::vector<VkImage> retired_images = {};
+    std::vector<VkImageView> retired_image_views = {};
+    // Set when a defragmentation ends, reported and cleared by the next daxa_dvc_defragment.
+    bool completed = {};
+    VmaDefragmentationStats completed_stats = {};
+};
+
 struct daxa_ImplDevice final : public ImplHandle
 {
     // General data:
@@ -28,6 +105,9 @@ struct daxa_ImplDevice final : public ImplHandle
     daxa_DeviceProperties physical_device_properties = {};
     VkDevice vk_device = {};
     VmaAllocator vma_allocator = {};
+    // Usage flags of every buffer: BUFFER_USE_FLAGS plus the usages of enabled optional device features.
+    VkBufferUsageFlags vk_buffer_usage_flags = BUFFER_USE_FLAGS;
+    MemoryReportCounters memory_report_counters = {};
 
     // Debug utils:
     PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT = {};
@@ -41,11 +121,16 @@ struct daxa_ImplDevice final : public ImplHandle
     PFN_vkCmdDrawMeshTasksIndirectCountEXT vkCmdDrawMeshTasksIndirectCountEXT = {};
     VkPhysicalDeviceMeshShaderPropertiesEXT mesh_shader_properties = {};
 
+    // Conditional rendering:
+    PFN_vkCmdBeginConditionalRenderingEXT vkCmdBeginConditionalRenderingEXT = {};
+    PFN_vkCmdEndConditionalRenderingEXT vkCmdEndConditionalRenderingEXT = {};
+
     // Ray tracing:
     PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR = {};
     PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR = {};
     PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR = {};
     PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR = {};
+    PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR = {};
     PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR = {};
     PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructureDeviceAddressKHR = {};
     PFN_vkCreateRayTracingPipelinesKHR vkCreateRayTracingPipelinesKHR = {};
@@ -99,8 +184,39 @@ struct daxa_ImplDevice final : public ImplHandle
     std::deque<std::pair<u64, EventZombie>> main_queue_split_barrier_zombies = {};
     std::deque<std::pair<u64, PipelineZombie>> main_queue_pipeline_zombies = {};
     std::deque<std::pair<u64, TimelineQueryPoolZombie>> main_queue_timeline_query_pool_zombies = {};
+    std::deque<std::pair<u64, QueryPoolZombie>> main_queue_query_pool_zombies = {};
     std::deque<std::pair<u64, MemoryBlockZombie>> main_queue_memory_block_zombies = {};
 
+    // Sampler deduplication, only used with DeviceFlagBits::SAMPLER_CACHE.
+    // Identical sampler infos share one refcounted sampler, it is destroyed when its last reference is destroyed.
+    std::mutex sampler_cache_mtx = {};
+    std::unordered_map<SamplerCacheKey, SamplerCacheEntry, SamplerCacheKeyHash> sampler_cache = {};
+
+    // Protected by the exclusive lifetime lock and the zombie mutex.
+    DefragmentationState defragmentation = {};
+
+    // Timeline completion callbacks, serviced by one lazily started thread.
+    // The thread waits on all pending semaphores at once, registrations wake it by signaling the wake semaphore.
+    std::mutex completion_mtx = {};
+    std::vector<TimelineCompletion> pending_completions = {};
+    std::thread completion_thread = {};
+    VkSemaphore vk_completion_wake_semaphore = {};
+    u64 completion_wake_value = {};
+    bool completion_thread_stop = {};
+    // Set when waiting failed, e.g. on device loss. Callbacks are then invoked right away.
+    bool completion_thread_failed = {};
+
+    // Only used with DeviceFlagBits::BACKGROUND_GARBAGE_COLLECTION.
+    // The thread waits on the main queue timeline and the stop semaphore, which is signaled on destruction.
+    std::thread garbage_collection_thread = {};
+    VkSemaphore vk_garbage_collection_stop_semaphore = {};
+    // Command recorders hold the lifetime lock shared for their whole lifetime, they are only counted with the flag.
+    // The last recorder to be destroyed wakes the thread when it waits for the lifetime lock.
+    std::atomic<u64> command_recorder_count = {};
+    std::mutex garbage_collection_wake_mtx = {};
+    std::condition_variable garbage_collection_wake_cv = {};
+    bool garbage_collection_thread_stop = {};
+
     auto validate_image_slice(daxa_ImageMipArraySlice const & slice, daxa_ImageId id) -> daxa_ImageMipArraySlice;
     auto validate_image_slice(daxa_ImageMipArraySlice const & slice, daxa_ImageViewId id) -> daxa_ImageMipArraySlice;
     auto new_swapchain_image(VkImage swapchain_image, VkFormat format, u32 index, ImageUsageFlags usage, ImageInfo const & image_info) -> std::pair<daxa_Result, ImageId>;
@@ -125,6 +241,19 @@ struct daxa_ImplDevice final : public ImplHandle
     void zombify_sampler(SamplerId id);
     void zombify_tlas(TlasId id);
     void zombify_blas(BlasId id);
+    // Zombifies many resources while taking the zombie lock once.
+    void zombify_buffers(std::span<BufferId const> ids);
+    void zombify_images(std::span<ImageId const> ids);
+    void zombify_image_views(std::span<ImageViewId const> ids);
+
+    // Ends the pending defragmentation pass when the gpu finished its copies.
+    void try_end_defragmentation_pass(u64 gpu_timeline_value);
+    void end_defragmentation();
+
+    void completion_thread_main();
+    void stop_completion_thread();
+    void garbage_collection_thread_main();
+    void stop_garbage_collection_thread();
 
     // TODO: Give physical device in info so that this function can be removed.
     // TODO: Better device selection.
@@ -29,7 +29,7 @@ namespace daxa
             .textureCompressionASTC_LDR = VK_FALSE,
             .textureCompressionBC = VK_FALSE,
             .occlusionQueryPrecise = VK_FALSE,
-            .pipelineStatisticsQuery = VK_FALSE,
+            .pipelineStatisticsQuery = static_cast<VkBool32>((info.flags & DAXA_DEVICE_FLAG_PIPELINE_STATISTICS_QUERY) != 0),
             .vertexPipelineStoresAndAtomics = VK_FALSE,
             .fragmentStoresAndAtomics = VK_TRUE,
             .shaderTessellationAndGeometryPointSize = VK_FALSE,
@@ -217,6 +217,16 @@ namespace daxa
             };
             this->chain = r_cast<void *>(&this->ray_tracing_invocation_reorder.value());
         }
+        if (info.flags & DAXA_DEVICE_FLAG_CONDITIONAL_RENDERING)
+        {
+            this->conditional_rendering = VkPhysicalDeviceConditionalRenderingFeaturesEXT{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT,
+                .pNext = this->chain,
+                .conditionalRendering = VK_TRUE,
+                .inheritedConditionalRendering = VK_FALSE, // Daxa does not use secondary command buffers.
+            };
+            this->chain = r_cast<void *>(&this->conditional_rendering.value());
+        }
     }
 
     void PhysicalDeviceExtensionList::initialize(daxa_DeviceInfo info)
@@ -245,5 +255,9 @@ namespace daxa
             this->data[size++] = {VK_KHR_RAY_TRACING_POSITION_FETCH_EXTENSION_NAME};
             this->data[size++] = {VK_NV_RAY_TRACING_INVOCATION_REORDER_EXTENSION_NAME};
         }
+        if (info.flags & DAXA_DEVICE_FLAG_CONDITIONAL_RENDERING)
+        {
+            this->data[size++] = {VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME};
+        }
     }
 } // namespace daxa
\ No newline at end of file
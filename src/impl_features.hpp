@@ -32,6 +32,7 @@ namespace daxa
         std::optional<VkPhysicalDeviceRayQueryFeaturesKHR> ray_query = {};
         std::optional<VkPhysicalDeviceRayTracingPositionFetchFeaturesKHR> ray_tracing_position_fetch = {};
         std::optional<VkPhysicalDeviceRayTracingInvocationReorderFeaturesNV > ray_tracing_invocation_reorder = {};
+        std::optional<VkPhysicalDeviceConditionalRenderingFeaturesEXT> conditional_rendering = {};
         void * chain = {};
 
         void initialize(daxa_DeviceInfo info);
@@ -35,7 +35,7 @@ namespace daxa
     }
 
     void GPUShaderResourceTable::initialize(u32 max_buffers, u32 max_images, u32 max_samplers, u32 max_acceleration_structures,
-                                            VkDevice device, VkBuffer device_address_buffer,
+                                            VkDevice device, VkBuffer device_address_buffer, bool push_descriptor_supported,
                                             PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT)
     {
         bool const ray_tracing_enabled = max_acceleration_structures != (~0u);
@@ -230,7 +230,43 @@ namespace daxa
             vkSetDebugUtilsObjectNameEXT(device, &name_info);
         }
 
-        auto vk_descriptor_set_layouts = std::array{this->vk_descriptor_set_layout};
+        std::array<VkDescriptorSetLayoutBinding, CONSTANT_BUFFER_BINDING_COUNT> uniform_buffer_descriptor_set_layout_bindings = {};
+        for (u32 i = 0; i < CONSTANT_BUFFER_BINDING_COUNT; ++i)
+        {
+            uniform_buffer_descriptor_set_layout_bindings.at(i) = VkDescriptorSetLayoutBinding{
+                .binding = i,
+                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_ALL,
+                .pImmutableSamplers = nullptr,
+            };
+        }
+
+        // Without push descriptors the set keeps its layout, so pipeline layouts stay identical, but nothing is ever bound to it.
+        VkDescriptorSetLayoutCreateInfo const vk_uniform_buffer_descriptor_set_layout_create_info{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = push_descriptor_supported ? static_cast<VkDescriptorSetLayoutCreateFlags>(VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR) : VkDescriptorSetLayoutCreateFlags{},
+            .bindingCount = static_cast<u32>(uniform_buffer_descriptor_set_layout_bindings.size()),
+            .pBindings = uniform_buffer_descriptor_set_layout_bindings.data(),
+        };
+
+        vkCreateDescriptorSetLayout(device, &vk_uniform_buffer_descriptor_set_layout_create_info, nullptr, &this->uniform_buffer_descriptor_set_layout);
+        if (vkSetDebugUtilsObjectNameEXT != nullptr)
+        {
+            auto name = "uniform buffer push descriptor set layout";
+            VkDebugUtilsObjectNameInfoEXT name_info{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+                .objectHandle = std::bit_cast<uint64_t>(uniform_buffer_descriptor_set_layout),
+                .pObjectName = name,
+            };
+            vkSetDebugUtilsObjectNameEXT(device, &name_info);
+        }
+
+        // Set GPU_TABLE_SET_BINDING is the bindless table, set CONSTANT_BUFFER_BINDING_SET the uniform buffer push descriptors.
+        auto vk_descriptor_set_layouts = std::array{this->vk_descriptor_set_layout, this->uniform_buffer_descriptor_set_layout};
         VkPipelineLayoutCreateInfo vk_pipeline_create_info{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
             .pNext = nullptr,
@@ -343,6 +379,7 @@ namespace daxa
             vkDestroyPipelineLayout(device, pipeline_layouts.at(i), nullptr);
         }
         vkDestroyDescriptorSetLayout(device, this->vk_descriptor_set_layout, nullptr);
+        vkDestroyDescriptorSetLayout(device, this->uniform_buffer_descriptor_set_layout, nullptr);
         vkResetDescriptorPool(device, this->vk_descriptor_pool, {});
         vkDestroyDescriptorPool(device, this->vk_descriptor_pool, nullptr);
     }
@@ -451,6 +488,98 @@ namespace daxa
         vkUpdateDescriptorSets(vk_device, descriptor_set_write_count, descriptor_set_writes.data(), 0, nullptr);
     }
 
+    void DescriptorSetWriteBatch::add_buffer(VkBuffer vk_buffer, VkDeviceSize offset, VkDeviceSize range, u32 index)
+    {
+        this->buffer_infos.push_back({
+            .buffer = vk_buffer,
+            .offset = offset,
+            .range = range,
+        });
+        // Info pointers are filled in flush, as the info vectors may still reallocate.
+        this->writes.push_back({
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = this->vk_descriptor_set,
+            .dstBinding = DAXA_STORAGE_BUFFER_BINDING,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = nullptr,
+            .pBufferInfo = nullptr,
+            .pTexelBufferView = nullptr,
+        });
+    }
+
+    void DescriptorSetWriteBatch::add_image(VkImageView vk_image_view, ImageUsageFlags usage, u32 index)
+    {
+        if ((usage & ImageUsageFlagBits::SHADER_STORAGE) != ImageUsageFlagBits::NONE)
+        {
+            this->image_infos.push_back({
+                .sampler = VK_NULL_HANDLE,
+                .imageView = vk_image_view,
+                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+            });
+            this->writes.push_back({
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .pNext = nullptr,
+                .dstSet = this->vk_descriptor_set,
+                .dstBinding = DAXA_STORAGE_IMAGE_BINDING,
+                .dstArrayElement = index,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .pImageInfo = nullptr,
+                .pBufferInfo = nullptr,
+                .pTexelBufferView = nullptr,
+            });
+        }
+        if ((usage & ImageUsageFlagBits::SHADER_SAMPLED) != ImageUsageFlagBits::NONE)
+        {
+            this->image_infos.push_back({
+                .sampler = VK_NULL_HANDLE,
+                .imageView = vk_image_view,
+                .imageLayout = VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL,
+            });
+            this->writes.push_back({
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .pNext = nullptr,
+                .dstSet = this->vk_descriptor_set,
+                .dstBinding = DAXA_SAMPLED_IMAGE_BINDING,
+                .dstArrayElement = index,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                .pImageInfo = nullptr,
+                .pBufferInfo = nullptr,
+                .pTexelBufferView = nullptr,
+            });
+        }
+    }
+
+    void DescriptorSetWriteBatch::flush(VkDevice vk_device)
+    {
+        if (this->writes.empty())
+        {
+            return;
+        }
+        // Each write refers to exactly one info, infos are stored in the order of their writes.
+        usize buffer_info_index = 0;
+        usize image_info_index = 0;
+        for (auto & write : this->writes)
+        {
+            if (write.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            {
+                write.pBufferInfo = &this->buffer_infos[buffer_info_index++];
+            }
+            else
+            {
+                write.pImageInfo = &this->image_infos[image_info_index++];
+            }
+        }
+        vkUpdateDescriptorSets(vk_device, static_cast<u32>(this->writes.size()), this->writes.data(), 0, nullptr);
+        this->buffer_infos.clear();
+        this->image_infos.clear();
+        this->writes.clear();
+    }
+
     void write_descriptor_set_acceleration_structure(VkDevice vk_device, VkDescriptorSet vk_descriptor_set, VkAccelerationStructureKHR vk_acceleration_structure, u32 index)
     {
         VkWriteDescriptorSetAccelerationStructureKHR vk_write_descriptor_set_as = {
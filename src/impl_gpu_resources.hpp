@@ -11,6 +11,7 @@ namespace daxa
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
         VK_BUFFER_USAGE_TRANSFER_DST_BIT |
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
         VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
         VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
@@ -160,6 +161,46 @@ namespace daxa
             auto const page = static_cast<usize>(index) >> PAGE_BITS;
             auto const offset = static_cast<usize>(index) & PAGE_MASK;
 
+            this->ensure_page(page);
+
+            u64 version = this->pages[page]->at(offset).second.load(std::memory_order_relaxed);
+
+            auto const id = GPUResourceId{.index = static_cast<u64>(index), .version = version};
+            return std::optional{std::pair<GPUResourceId, ResourceT &>(id, this->pages[page]->at(offset).first)};
+        }
+
+        /**
+         * @brief   Checks that count slots can be created and allocates all pages they can land in up front.
+         *          Lets batched creation fail before any resource was created.
+         *
+         * Same threadsafety as try_create_slot.
+         *
+         * @return If the next count calls to try_create_slot succeed.
+         */
+        auto try_reserve_slots(usize count) -> bool
+        {
+            usize const recycled_count = std::min(count, this->free_index_stack.size());
+            usize const fresh_count = count - recycled_count;
+            usize const index_limit = std::min(static_cast<usize>(this->max_resources), MAX_RESOURCE_COUNT);
+            if (static_cast<usize>(this->next_index) + fresh_count > index_limit)
+            {
+                return false;
+            }
+            if (fresh_count > 0)
+            {
+                usize const first_page = static_cast<usize>(this->next_index) >> PAGE_BITS;
+                usize const last_page = (static_cast<usize>(this->next_index) + fresh_count - 1) >> PAGE_BITS;
+                for (usize page = first_page; page <= last_page; ++page)
+                {
+                    this->ensure_page(page);
+                }
+            }
+            return true;
+        }
+
+        // Pages are only ever allocated in order, as fresh indices are handed out sequentially.
+        void ensure_page(usize page)
+        {
             if (!this->pages[page])
             {
                 this->pages[page] = std::make_unique<PageT>();
@@ -170,11 +211,6 @@ namespace daxa
                 // Needs to be sequential, so that the 0 writes to the versions are visible before the atomic op.
                 this->valid_page_count.fetch_add(1, std::memory_order_seq_cst);
             }
-
-            u64 version = this->pages[page]->at(offset).second.load(std::memory_order_relaxed);
-
-            auto const id = GPUResourceId{.index = static_cast<u64>(index), .version = version};
-            return std::optional{std::pair<GPUResourceId, ResourceT &>(id, this->pages[page]->at(offset).first)};
         }
 
         auto try_zombify(GPUResourceId id) -> bool
@@ -243,15 +279,30 @@ namespace daxa
         VkDescriptorSetLayout vk_descriptor_set_layout = {};
         VkDescriptorSet vk_descriptor_set = {};
         VkDescriptorPool vk_descriptor_pool = {};
+        // Push descriptor set layout containing the uniform buffer bindings set via CommandRecorder::set_uniform_buffer.
+        VkDescriptorSetLayout uniform_buffer_descriptor_set_layout = {};
 
         // Contains pipeline layouts with varying push constant range size.
         // The first size is 0 word, second is 1 word, all others are a power of two (maximum is MAX_PUSH_CONSTANT_BYTE_SIZE).
         std::array<VkPipelineLayout, PIPELINE_LAYOUT_COUNT> pipeline_layouts = {};
 
-        void initialize(u32 max_buffers, u32 max_images, u32 max_samplers, u32 max_acceleration_structures, VkDevice device, VkBuffer device_address_buffer, PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT);
+        void initialize(u32 max_buffers, u32 max_images, u32 max_samplers, u32 max_acceleration_structures, VkDevice device, VkBuffer device_address_buffer, bool push_descriptor_supported, PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT);
         void cleanup(VkDevice device);
     };
 
+    // Collects the descriptor writes of many resources, so that they are issued with a single vkUpdateDescriptorSets call.
+    struct DescriptorSetWriteBatch
+    {
+        VkDescriptorSet vk_descriptor_set = {};
+        std::vector<VkDescriptorBufferInfo> buffer_infos = {};
+        std::vector<VkDescriptorImageInfo> image_infos = {};
+        std::vector<VkWriteDescriptorSet> writes = {};
+
+        void add_buffer(VkBuffer vk_buffer, VkDeviceSize offset, VkDeviceSize range, u32 index);
+        void add_image(VkImageView vk_image_view, ImageUsageFlags usage, u32 index);
+        void flush(VkDevice vk_device);
+    };
+
     void write_descriptor_set_sampler(VkDevice vk_device, VkDescriptorSet vk_descriptor_set, VkSampler vk_sampler, u32 index);
 
     void write_descriptor_set_buffer(VkDevice vk_device, VkDescriptorSet vk_descriptor_set, VkBuffer vk_buffer, VkDeviceSize offset, VkDeviceSize range, u32 index);
@@ -1,5 +1,6 @@
 #include "impl_timeline_query.hpp"
 
+#include <bit>
 #include <utility>
 
 #include "impl_device.hpp"
@@ -68,6 +69,105 @@ auto daxa_timeline_query_pool_query_results(daxa_TimelineQueryPool self, u32 sta
     return std::bit_cast<daxa_Result>(vk_result);
 }
 
+auto daxa_dvc_create_query_pool(daxa_Device device, daxa_QueryPoolInfo const * info, daxa_QueryPool * out_qp) -> daxa_Result
+{
+    auto ret = daxa_ImplQueryPool{};
+    ret.device = device;
+    ret.info = *reinterpret_cast<QueryPoolInfo const *>(info);
+    ret.info_name = std::string{ret.info.name.view()};
+    switch (ret.info.query_type)
+    {
+    case QueryType::OCCLUSION:
+        ret.value_count = 1;
+        break;
+    case QueryType::PIPELINE_STATISTICS:
+        if ((device->info.flags & DeviceFlagBits::PIPELINE_STATISTICS_QUERY) == DeviceFlagBits::NONE)
+        {
+            return DAXA_RESULT_INVALID_WITHOUT_ENABLING_PIPELINE_STATISTICS_QUERY;
+        }
+        ret.value_count = static_cast<u32>(std::popcount(ret.info.pipeline_statistics.data));
+        if (ret.value_count == 0)
+        {
+            return DAXA_RESULT_ERROR_INITIALIZATION_FAILED;
+        }
+        break;
+    default:
+        return DAXA_RESULT_ERROR_FEATURE_NOT_PRESENT;
+    }
+    VkQueryPoolCreateInfo const vk_query_pool_create_info{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .queryType = static_cast<VkQueryType>(ret.info.query_type),
+        .queryCount = ret.info.query_count,
+        .pipelineStatistics = ret.info.query_type == QueryType::PIPELINE_STATISTICS ? ret.info.pipeline_statistics.data : 0u,
+    };
+    auto vk_result = vkCreateQueryPool(ret.device->vk_device, &vk_query_pool_create_info, nullptr, &ret.vk_query_pool);
+    if (vk_result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+    // Queries must be reset before their first use, doing it here allows using the pool without recording a reset first.
+    vkResetQueryPool(ret.device->vk_device, ret.vk_query_pool, 0, ret.info.query_count);
+    if ((ret.device->instance->info.flags & InstanceFlagBits::DEBUG_UTILS) != InstanceFlagBits::NONE && !ret.info_name.empty())
+    {
+        VkDebugUtilsObjectNameInfoEXT const query_pool_name_info{
+            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+            .pNext = nullptr,
+            .objectType = VK_OBJECT_TYPE_QUERY_POOL,
+            .objectHandle = std::bit_cast<uint64_t>(ret.vk_query_pool),
+            .pObjectName = ret.info_name.c_str(),
+        };
+        ret.device->vkSetDebugUtilsObjectNameEXT(ret.device->vk_device, &query_pool_name_info);
+    }
+    ret.strong_count = 1;
+    device->inc_weak_refcnt();
+    *out_qp = new daxa_ImplQueryPool{};
+    **out_qp = std::move(ret);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_query_pool_info(daxa_QueryPool self) -> daxa_QueryPoolInfo const *
+{
+    return reinterpret_cast<daxa_QueryPoolInfo const *>(&self->info);
+}
+
+auto daxa_query_pool_value_count(daxa_QueryPool self) -> u32
+{
+    return self->value_count;
+}
+
+auto daxa_query_pool_query_results(daxa_QueryPool self, u32 start, u32 count, u64 * out_results) -> daxa_Result
+{
+    if (count == 0 || !(start + count - 1 < self->info.query_count))
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    usize const stride = (self->value_count + 1ull) * sizeof(u64);
+    auto vk_result = vkGetQueryPoolResults(
+        self->device->vk_device,
+        self->vk_query_pool,
+        start,
+        count,
+        count * stride,
+        out_results,
+        stride,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    return std::bit_cast<daxa_Result>(vk_result);
+}
+
+auto daxa_query_pool_inc_refcnt(daxa_QueryPool self) -> u64
+{
+    return self->inc_refcnt();
+}
+
+auto daxa_query_pool_dec_refcnt(daxa_QueryPool self) -> u64
+{
+    return self->dec_refcnt(
+        &daxa_ImplQueryPool::zero_ref_callback,
+        self->device->instance);
+}
+
 auto daxa_timeline_query_pool_inc_refcnt(daxa_TimelineQueryPool self) -> u64
 {
     return self->inc_refcnt();
@@ -100,4 +200,20 @@ void daxa_ImplTimelineQueryPool::zero_ref_callback(ImplHandle const * handle)
     delete self;
 }
 
+void daxa_ImplQueryPool::zero_ref_callback(ImplHandle const * handle)
+{
+    auto self = rc_cast<daxa_QueryPool>(handle);
+    std::unique_lock const lock{self->device->main_queue_zombies_mtx};
+    u64 const main_queue_cpu_timeline = self->device->main_queue_cpu_timeline.load(std::memory_order::relaxed);
+    self->device->main_queue_query_pool_zombies.emplace_back(
+        main_queue_cpu_timeline,
+        QueryPoolZombie{
+            .vk_query_pool = self->vk_query_pool,
+        });
+    self->device->dec_weak_refcnt(
+        daxa_ImplDevice::zero_ref_callback,
+        self->device->instance);
+    delete self;
+}
+
 // --- End Internals ---
\ No newline at end of file
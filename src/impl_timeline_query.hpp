@@ -12,6 +12,11 @@ namespace daxa
     {
         VkQueryPool vk_timeline_query_pool = {};
     };
+
+    struct QueryPoolZombie
+    {
+        VkQueryPool vk_query_pool = {};
+    };
 } // namespace daxa
 
 struct daxa_ImplTimelineQueryPool final : ImplHandle
@@ -23,3 +28,15 @@ struct daxa_ImplTimelineQueryPool final : ImplHandle
 
     static void zero_ref_callback(ImplHandle const * handle);
 };
+
+struct daxa_ImplQueryPool final : ImplHandle
+{
+    daxa_Device device = {};
+    QueryPoolInfo info = {};
+    std::string info_name = {};
+    // Number of values each query writes.
+    u32 value_count = {};
+    VkQueryPool vk_query_pool = {};
+
+    static void zero_ref_callback(ImplHandle const * handle);
+};
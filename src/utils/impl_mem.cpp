@@ -1,11 +1,683 @@
 #if DAXA_BUILT_WITH_UTILS_MEM
 
 #include <daxa/utils/mem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <tuple>
 #include <utility>
 
+#include "../impl_core.hpp"
+
 namespace daxa
 {
+    struct TransferMemoryPool::State
+    {
+        struct Segment
+        {
+            BufferId buffer = {};
+            daxa::DeviceAddress device_address = {};
+            std::byte * host_address = {};
+            u64 capacity = {};
+            // Head and tail are monotonic byte positions, the offset into the buffer is the position modulo the capacity.
+            // Head is bumped lock free by allocations, tail is only moved under the mutex when frames retire.
+            std::atomic<u64> head = {};
+            std::atomic<u64> tail = {};
+            // Head position at the end of each frame still in flight, paired with the frames timeline value.
+            std::deque<std::pair<u64, u64>> frame_ends = {};
+        };
+
+        std::mutex mtx = {};
+        std::atomic<u64> timeline_value = {};
+        std::atomic<Segment *> current = {};
+        std::vector<std::unique_ptr<Segment>> segments = {};
+
+        static auto create_segment(TransferMemoryPoolInfo & info, u64 capacity) -> std::unique_ptr<Segment>
+        {
+            auto segment = std::make_unique<Segment>();
+            segment->capacity = capacity;
+            segment->buffer = info.device.create_buffer({
+                .size = capacity,
+                .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_SEQUENTIAL_WRITE | (info.use_bar_memory ? daxa::MemoryFlagBits::DEDICATED_MEMORY : daxa::MemoryFlagBits::NONE),
+                .name = info.name,
+            });
+            segment->device_address = info.device.get_device_address(segment->buffer).value();
+            segment->host_address = info.device.get_host_address_as<std::byte>(segment->buffer).value();
+            return segment;
+        }
+
+        // Returns the offset into the segments buffer or nullopt if the segment is full.
+        static auto try_bump(Segment & segment, u64 size, u64 alignment) -> std::optional<u64>
+        {
+            if (size > segment.capacity)
+            {
+                return std::nullopt;
+            }
+            u64 head = segment.head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                u64 wrap_start = head - head % segment.capacity;
+                u64 offset = (head % segment.capacity + alignment - 1) / alignment * alignment;
+                if (offset + size > segment.capacity)
+                {
+                    // Not enough space left at the end of the buffer, skip the rest and place the allocation at offset 0.
+                    offset = 0;
+                    wrap_start += segment.capacity;
+                }
+                u64 const new_head = wrap_start + offset + size;
+                if (new_head - segment.tail.load(std::memory_order_acquire) > segment.capacity)
+                {
+                    return std::nullopt;
+                }
+                if (segment.head.compare_exchange_weak(head, new_head, std::memory_order_relaxed))
+                {
+                    return offset;
+                }
+            }
+        }
+
+        void retire_finished_frames(TransferMemoryPoolInfo & info, u64 gpu_value)
+        {
+            for (auto & segment : this->segments)
+            {
+                while (!segment->frame_ends.empty() && segment->frame_ends.front().first <= gpu_value)
+                {
+                    segment->tail.store(segment->frame_ends.front().second, std::memory_order_release);
+                    segment->frame_ends.pop_front();
+                }
+            }
+            // Chained buffers that are no longer current are destroyed once all their allocations retired.
+            Segment * const current_segment = this->current.load(std::memory_order_relaxed);
+            auto const erase_begin = std::remove_if(
+                this->segments.begin(), this->segments.end(),
+                [&](std::unique_ptr<Segment> const & segment)
+                {
+                    bool const retired = segment.get() != current_segment && segment->head.load(std::memory_order_relaxed) == segment->tail.load(std::memory_order_relaxed);
+                    if (retired)
+                    {
+                        info.device.destroy_buffer(segment->buffer);
+                    }
+                    return retired;
+                });
+            this->segments.erase(erase_begin, this->segments.end());
+        }
+
+        // Must be called with the mutex locked.
+        // Reclaims retired frames when the current segment is full and grows the pool if that is not enough and growth is allowed.
+        auto locked_bump(TransferMemoryPoolInfo & info, TimelineSemaphore const & gpu_timeline, u64 size, u64 alignment) -> std::optional<std::pair<Segment *, u64>>
+        {
+            Segment * segment = this->current.load(std::memory_order_relaxed);
+            if (auto offset = try_bump(*segment, size, alignment))
+            {
+                return std::pair{segment, offset.value()};
+            }
+            this->retire_finished_frames(info, gpu_timeline.value());
+            if (auto offset = try_bump(*segment, size, alignment))
+            {
+                return std::pair{segment, offset.value()};
+            }
+            // Doubling makes the pool settle on a single buffer large enough for a whole frame.
+            // Allocation offsets are 32 bit, so buffers never grow past that.
+            u64 const new_capacity = std::min(std::max(segment->capacity * 2, size + alignment), u64{std::numeric_limits<u32>::max()});
+            if (!info.allow_growth || size + alignment > new_capacity)
+            {
+                return std::nullopt;
+            }
+            this->segments.push_back(create_segment(info, new_capacity));
+            segment = this->segments.back().get();
+            this->current.store(segment, std::memory_order_release);
+            auto const offset = try_bump(*segment, size, alignment);
+            DAXA_DBG_ASSERT_TRUE_M(offset.has_value(), "allocation must fit into a freshly grown transfer memory pool buffer");
+            return std::pair{segment, offset.value()};
+        }
+    };
+
     TransferMemoryPool::TransferMemoryPool(TransferMemoryPoolInfo a_info)
+        : m_info{std::move(a_info)},
+          gpu_timeline{this->m_info.device.create_timeline_semaphore({
+              .initial_value = {},
+              .name = this->m_info.name,
+          })},
+          state{std::make_unique<State>()}
+    {
+        // Per allocation retirement advances the value before each allocation, per frame retirement after each frame.
+        this->state->timeline_value.store(this->m_info.per_frame_retirement ? 1 : 0, std::memory_order_relaxed);
+        this->state->segments.push_back(State::create_segment(this->m_info, this->m_info.capacity));
+        this->state->current.store(this->state->segments.back().get(), std::memory_order_relaxed);
+    }
+
+    TransferMemoryPool::TransferMemoryPool(TransferMemoryPool && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->gpu_timeline, other.gpu_timeline);
+        std::swap(this->state, other.state);
+    }
+
+    TransferMemoryPool & TransferMemoryPool::operator=(TransferMemoryPool && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->gpu_timeline, other.gpu_timeline);
+        std::swap(this->state, other.state);
+        return *this;
+    }
+
+    TransferMemoryPool::~TransferMemoryPool()
+    {
+        if (this->state != nullptr)
+        {
+            for (auto & segment : this->state->segments)
+            {
+                this->m_info.device.destroy_buffer(segment->buffer);
+            }
+        }
+    }
+
+    auto TransferMemoryPool::allocate(u32 allocation_size, u32 alignment_requirement) -> std::optional<TransferMemoryPool::Allocation>
+    {
+        DAXA_DBG_ASSERT_TRUE_M(alignment_requirement > 0, "transfer memory pool alignment must be greater than zero");
+        auto & s = *this->state;
+        auto make_allocation = [&](State::Segment const & segment, u64 offset, u64 timeline_value)
+        {
+            return Allocation{
+                .device_address = segment.device_address + offset,
+                .host_address = reinterpret_cast<void *>(segment.host_address + offset),
+                .buffer_offset = static_cast<u32>(offset),
+                .size = allocation_size,
+                .timeline_index = timeline_value,
+                .buffer = segment.buffer,
+            };
+        };
+
+        if (!this->m_info.per_frame_retirement)
+        {
+            // Every allocation is its own frame. Allocating is serialized, so that the frames end in the order of their timeline values.
+            std::unique_lock const lock{s.mtx};
+            auto const placement = s.locked_bump(this->m_info, this->gpu_timeline, allocation_size, alignment_requirement);
+            if (!placement.has_value())
+            {
+                return std::nullopt;
+            }
+            auto & [segment, offset] = placement.value();
+            u64 const timeline_value = s.timeline_value.load(std::memory_order_relaxed) + 1;
+            s.timeline_value.store(timeline_value, std::memory_order_release);
+            segment->frame_ends.push_back({timeline_value, segment->head.load(std::memory_order_relaxed)});
+            return make_allocation(*segment, offset, timeline_value);
+        }
+
+        // The timeline value must be read before the head is bumped.
+        // advance_timeline snapshots the heads before incrementing the timeline value,
+        // so an allocation can only ever be retired later than the value it reports, never earlier.
+        u64 const timeline_value = s.timeline_value.load(std::memory_order_acquire);
+        State::Segment * segment = s.current.load(std::memory_order_acquire);
+        if (auto offset = State::try_bump(*segment, allocation_size, alignment_requirement))
+        {
+            return make_allocation(*segment, offset.value(), timeline_value);
+        }
+        // Slow path, reclaim retired frames and grow if allowed.
+        std::unique_lock const lock{s.mtx};
+        auto const placement = s.locked_bump(this->m_info, this->gpu_timeline, allocation_size, alignment_requirement);
+        if (!placement.has_value())
+        {
+            return std::nullopt;
+        }
+        return make_allocation(*placement->first, placement->second, timeline_value);
+    }
+
+    auto TransferMemoryPool::timeline_value() const -> usize
+    {
+        return this->state->timeline_value.load(std::memory_order_acquire);
+    }
+
+    void TransferMemoryPool::advance_timeline()
+    {
+        auto & s = *this->state;
+        std::unique_lock const lock{s.mtx};
+        if (this->m_info.per_frame_retirement)
+        {
+            u64 const ended_frame = s.timeline_value.load(std::memory_order_relaxed);
+            for (auto & segment : s.segments)
+            {
+                u64 const head = segment->head.load(std::memory_order_relaxed);
+                u64 const last_end = segment->frame_ends.empty() ? segment->tail.load(std::memory_order_relaxed) : segment->frame_ends.back().second;
+                if (head != last_end)
+                {
+                    segment->frame_ends.push_back({ended_frame, head});
+                }
+            }
+            s.timeline_value.store(ended_frame + 1, std::memory_order_release);
+        }
+        s.retire_finished_frames(this->m_info, this->gpu_timeline.value());
+    }
+
+    auto TransferMemoryPool::timeline_semaphore() -> TimelineSemaphore const &
+    {
+        return this->gpu_timeline;
+    }
+
+    auto TransferMemoryPool::info() const -> TransferMemoryPoolInfo const &
+    {
+        return this->m_info;
+    }
+
+    auto TransferMemoryPool::buffer() const -> daxa::BufferId
+    {
+        return this->state->current.load(std::memory_order_acquire)->buffer;
+    }
+
+    struct UploadQueue::State
+    {
+        struct PendingBufferWrite
+        {
+            BufferId src_buffer = {};
+            u64 src_offset = {};
+            BufferId dst_buffer = {};
+            u64 dst_offset = {};
+            u64 size = {};
+            u64 sequence = {};
+            u32 wave = {};
+        };
+        struct PendingImageWrite
+        {
+            BufferId src_buffer = {};
+            u64 src_offset = {};
+            u64 size = {};
+            UploadImageInfo info = {};
+            u32 wave = {};
+        };
+
+        explicit State(TransferMemoryPoolInfo const & staging_info) : staging{staging_info} {}
+
+        TransferMemoryPool staging;
+        std::atomic<u64> next_sequence = {};
+        std::atomic<u64> staging_nanoseconds = {};
+        std::mutex mtx = {};
+        std::vector<PendingBufferWrite> buffer_writes = {};
+        std::vector<PendingImageWrite> image_writes = {};
+        UploadQueueStats total_stats = {};
+
+        auto allocate_staging(u64 size, u64 alignment) -> TransferMemoryPool::Allocation
+        {
+            DAXA_DBG_ASSERT_TRUE_M(size <= std::numeric_limits<u32>::max(), "upload queue writes must be smaller than 4GiB");
+            auto allocation = this->staging.allocate(static_cast<u32>(size), static_cast<u32>(alignment));
+            DAXA_DBG_ASSERT_TRUE_M(allocation.has_value(), "upload queue failed to allocate staging memory");
+            return allocation.value();
+        }
+
+        void push_buffer_write(TransferMemoryPool::Allocation const & allocation, BufferId dst_buffer, u64 dst_offset, u64 size)
+        {
+            u64 const sequence = this->next_sequence.fetch_add(1, std::memory_order_relaxed);
+            std::unique_lock const lock{this->mtx};
+            this->buffer_writes.push_back(PendingBufferWrite{
+                .src_buffer = allocation.buffer,
+                .src_offset = allocation.buffer_offset,
+                .dst_buffer = dst_buffer,
+                .dst_offset = dst_offset,
+                .size = size,
+                .sequence = sequence,
+            });
+        }
+    };
+
+    UploadQueue::UploadQueue(UploadQueueInfo a_info)
+        : m_info{std::move(a_info)},
+          state{std::make_unique<State>(TransferMemoryPoolInfo{
+              .device = this->m_info.device,
+              .capacity = static_cast<u32>(std::min(this->m_info.staging_capacity, u64{std::numeric_limits<u32>::max()})),
+              .allow_growth = true,
+              .per_frame_retirement = true,
+              .name = this->m_info.name + " staging",
+          })}
+    {
+    }
+
+    UploadQueue::UploadQueue(UploadQueue && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->state, other.state);
+    }
+
+    UploadQueue & UploadQueue::operator=(UploadQueue && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->state, other.state);
+        return *this;
+    }
+
+    UploadQueue::~UploadQueue() = default;
+
+    void UploadQueue::upload_buffer(UploadBufferInfo const & info)
+    {
+        if (info.data.empty())
+        {
+            return;
+        }
+        auto & s = *this->state;
+        auto const start = std::chrono::steady_clock::now();
+        auto const allocation = s.allocate_staging(info.data.size(), 1);
+        std::memcpy(allocation.host_address, info.data.data(), info.data.size());
+        s.staging_nanoseconds.fetch_add(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+        s.push_buffer_write(allocation, info.dst_buffer, info.dst_offset, info.data.size());
+    }
+
+    void UploadQueue::upload_image(UploadImageInfo const & info)
+    {
+        if (info.data.empty())
+        {
+            return;
+        }
+        auto & s = *this->state;
+        auto const start = std::chrono::steady_clock::now();
+        // Buffer offsets of buffer to image copies must be a multiple of the texel block size and 4.
+        u64 const alignment = std::lcm(u64{texel_block_size(this->m_info.device.info_image(info.dst_image).value().format)}, u64{4});
+        auto const allocation = s.allocate_staging(info.data.size(), alignment);
+        std::memcpy(allocation.host_address, info.data.data(), info.data.size());
+        s.staging_nanoseconds.fetch_add(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+        std::unique_lock const lock{s.mtx};
+        s.image_writes.push_back(State::PendingImageWrite{
+            .src_buffer = allocation.buffer,
+            .src_offset = allocation.buffer_offset,
+            .size = info.data.size(),
+            .info = info,
+        });
+        // The data span must not be kept, the caller may reuse the memory right after the call.
+        s.image_writes.back().info.data = {};
+    }
+
+    auto UploadQueue::upload_file(UploadFileInfo const & info) -> bool
+    {
+        auto & s = *this->state;
+        auto const start = std::chrono::steady_clock::now();
+        std::ifstream file{info.path, std::ios::binary | std::ios::ate};
+        if (!file.is_open())
+        {
+            return false;
+        }
+        u64 const file_size = static_cast<u64>(file.tellg());
+        if (info.file_offset > file_size)
+        {
+            return false;
+        }
+        u64 const size = std::min(info.size, file_size - info.file_offset);
+        if (size == 0)
+        {
+            return true;
+        }
+        auto const allocation = s.allocate_staging(size, 1);
+        // The staging memory is persistently mapped, reading straight into it avoids an intermediate copy.
+        file.seekg(static_cast<std::streamoff>(info.file_offset));
+        file.read(reinterpret_cast<char *>(allocation.host_address), static_cast<std::streamsize>(size));
+        s.staging_nanoseconds.fetch_add(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+        if (static_cast<u64>(file.gcount()) != size)
+        {
+            // The staging memory is simply left unused and retires with the frame.
+            return false;
+        }
+        s.push_buffer_write(allocation, info.dst_buffer, info.dst_offset, size);
+        return true;
+    }
+
+    auto UploadQueue::flush(CommandRecorder & recorder, UploadQueueFlushInfo const & info) -> UploadQueueFlushResult
+    {
+        auto & s = *this->state;
+        std::vector<State::PendingBufferWrite> buffer_writes = {};
+        std::vector<State::PendingImageWrite> image_writes = {};
+        {
+            std::unique_lock const lock{s.mtx};
+            std::swap(buffer_writes, s.buffer_writes);
+            std::swap(image_writes, s.image_writes);
+        }
+        UploadQueueStats stats = {
+            .write_count = buffer_writes.size() + image_writes.size(),
+            .staging_time = std::chrono::nanoseconds{s.staging_nanoseconds.exchange(0, std::memory_order_relaxed)},
+        };
+
+        // Writes overlapping earlier writes of the same flush are moved into later waves, separated by barriers.
+        // Overlaps are rare, so the quadratic wave assignment only runs for destination buffers that have any.
+        std::sort(buffer_writes.begin(), buffer_writes.end(), [](auto const & a, auto const & b)
+                  { return std::tuple{a.dst_buffer, a.dst_offset, a.sequence} < std::tuple{b.dst_buffer, b.dst_offset, b.sequence}; });
+        u32 wave_count = buffer_writes.empty() ? 0 : 1;
+        for (usize group_begin = 0; group_begin < buffer_writes.size();)
+        {
+            usize group_end = group_begin;
+            bool overlapping = false;
+            u64 max_end = 0;
+            while (group_end < buffer_writes.size() && buffer_writes[group_end].dst_buffer == buffer_writes[group_begin].dst_buffer)
+            {
+                overlapping = overlapping || buffer_writes[group_end].dst_offset < max_end;
+                max_end = std::max(max_end, buffer_writes[group_end].dst_offset + buffer_writes[group_end].size);
+                ++group_end;
+            }
+            if (overlapping)
+            {
+                std::sort(buffer_writes.begin() + static_cast<std::ptrdiff_t>(group_begin), buffer_writes.begin() + static_cast<std::ptrdiff_t>(group_end), [](auto const & a, auto const & b)
+                          { return a.sequence < b.sequence; });
+                for (usize i = group_begin; i < group_end; ++i)
+                {
+                    auto & write = buffer_writes[i];
+                    for (usize earlier = group_begin; earlier < i; ++earlier)
+                    {
+                        auto const & earlier_write = buffer_writes[earlier];
+                        if (write.dst_offset < earlier_write.dst_offset + earlier_write.size && earlier_write.dst_offset < write.dst_offset + write.size)
+                        {
+                            write.wave = std::max(write.wave, earlier_write.wave + 1);
+                        }
+                    }
+                    wave_count = std::max(wave_count, write.wave + 1);
+                }
+            }
+            group_begin = group_end;
+        }
+        if (wave_count > 1)
+        {
+            std::sort(buffer_writes.begin(), buffer_writes.end(), [](auto const & a, auto const & b)
+                      { return std::tuple{a.wave, a.dst_buffer, a.dst_offset, a.sequence} < std::tuple{b.wave, b.dst_buffer, b.dst_offset, b.sequence}; });
+        }
+
+        // Overlapping image writes are ordered the same way. Image writes are pushed under the mutex, so their order is the upload order.
+        std::stable_sort(image_writes.begin(), image_writes.end(), [](auto const & a, auto const & b)
+                         { return a.info.dst_image < b.info.dst_image; });
+        auto const image_writes_overlap = [](UploadImageInfo const & a, UploadImageInfo const & b) -> bool
+        {
+            auto const ranges_overlap = [](i64 a_begin, i64 a_size, i64 b_begin, i64 b_size)
+            { return a_begin < b_begin + b_size && b_begin < a_begin + a_size; };
+            return a.image_slice.mip_level == b.image_slice.mip_level &&
+                   ranges_overlap(a.image_slice.base_array_layer, a.image_slice.layer_count, b.image_slice.base_array_layer, b.image_slice.layer_count) &&
+                   ranges_overlap(a.image_offset.x, a.image_extent.x, b.image_offset.x, b.image_extent.x) &&
+                   ranges_overlap(a.image_offset.y, a.image_extent.y, b.image_offset.y, b.image_extent.y) &&
+                   ranges_overlap(a.image_offset.z, a.image_extent.z, b.image_offset.z, b.image_extent.z);
+        };
+        u32 image_wave_count = image_writes.empty() ? 0 : 1;
+        for (usize group_begin = 0; group_begin < image_writes.size();)
+        {
+            usize group_end = group_begin;
+            while (group_end < image_writes.size() && image_writes[group_end].info.dst_image == image_writes[group_begin].info.dst_image)
+            {
+                auto & write = image_writes[group_end];
+                for (usize earlier = group_begin; earlier < group_end; ++earlier)
+                {
+                    if (image_writes_overlap(write.info, image_writes[earlier].info))
+                    {
+                        write.wave = std::max(write.wave, image_writes[earlier].wave + 1);
+                    }
+                }
+                image_wave_count = std::max(image_wave_count, write.wave + 1);
+                ++group_end;
+            }
+            group_begin = group_end;
+        }
+        if (image_wave_count > 1)
+        {
+            std::stable_sort(image_writes.begin(), image_writes.end(), [](auto const & a, auto const & b)
+                             { return a.wave < b.wave; });
+        }
+
+        // Image writes to the same slice share their layout transitions.
+        std::vector<ImageMemoryBarrierInfo> image_transitions = {};
+        for (auto const & write : image_writes)
+        {
+            ImageMipArraySlice const slice = {
+                .base_mip_level = write.info.image_slice.mip_level,
+                .level_count = 1,
+                .base_array_layer = write.info.image_slice.base_array_layer,
+                .layer_count = write.info.image_slice.layer_count,
+            };
+            auto const existing = std::find_if(image_transitions.begin(), image_transitions.end(), [&](auto const & transition)
+                                               { return transition.image_id == write.info.dst_image && transition.image_slice == slice; });
+            if (existing == image_transitions.end())
+            {
+                image_transitions.push_back(ImageMemoryBarrierInfo{
+                    .src_layout = write.info.src_layout,
+                    .dst_layout = write.info.dst_layout,
+                    .image_slice = slice,
+                    .image_id = write.info.dst_image,
+                });
+            }
+            else
+            {
+                existing->dst_layout = write.info.dst_layout;
+            }
+        }
+
+        if (!buffer_writes.empty())
+        {
+            recorder.pipeline_barrier({
+                .src_access = info.src_access,
+                .dst_access = AccessConsts::TRANSFER_WRITE,
+            });
+            ++stats.barrier_count;
+        }
+        for (auto const & transition : image_transitions)
+        {
+            recorder.pipeline_barrier_image_transition({
+                .src_access = info.src_access,
+                .dst_access = AccessConsts::TRANSFER_WRITE,
+                .src_layout = transition.src_layout,
+                .dst_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+                .image_slice = transition.image_slice,
+                .image_id = transition.image_id,
+            });
+            ++stats.barrier_count;
+        }
+
+        for (usize i = 0; i < buffer_writes.size();)
+        {
+            auto const & first = buffer_writes[i];
+            if (i > 0 && first.wave != buffer_writes[i - 1].wave)
+            {
+                recorder.pipeline_barrier({
+                    .src_access = AccessConsts::TRANSFER_WRITE,
+                    .dst_access = AccessConsts::TRANSFER_WRITE,
+                });
+                ++stats.barrier_count;
+            }
+            // Coalesce writes that are contiguous in the staging memory and the destination.
+            u64 size = first.size;
+            usize next = i + 1;
+            while (next < buffer_writes.size() &&
+                   buffer_writes[next].wave == first.wave &&
+                   buffer_writes[next].dst_buffer == first.dst_buffer &&
+                   buffer_writes[next].src_buffer == first.src_buffer &&
+                   buffer_writes[next].dst_offset == first.dst_offset + size &&
+                   buffer_writes[next].src_offset == first.src_offset + size)
+            {
+                size += buffer_writes[next].size;
+                ++next;
+            }
+            recorder.copy_buffer_to_buffer({
+                .src_buffer = first.src_buffer,
+                .dst_buffer = first.dst_buffer,
+                .src_offset = first.src_offset,
+                .dst_offset = first.dst_offset,
+                .size = size,
+            });
+            stats.uploaded_bytes += size;
+            ++stats.buffer_copy_count;
+            i = next;
+        }
+        for (usize i = 0; i < image_writes.size(); ++i)
+        {
+            auto const & write = image_writes[i];
+            if (i > 0 && write.wave != image_writes[i - 1].wave)
+            {
+                // The images stay in TRANSFER_DST_OPTIMAL between waves, a memory barrier orders the overlapping writes.
+                recorder.pipeline_barrier({
+                    .src_access = AccessConsts::TRANSFER_WRITE,
+                    .dst_access = AccessConsts::TRANSFER_WRITE,
+                });
+                ++stats.barrier_count;
+            }
+            recorder.copy_buffer_to_image({
+                .buffer = write.src_buffer,
+                .buffer_offset = write.src_offset,
+                .image = write.info.dst_image,
+                .image_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+                .image_slice = write.info.image_slice,
+                .image_offset = write.info.image_offset,
+                .image_extent = write.info.image_extent,
+            });
+            stats.uploaded_bytes += write.size;
+            ++stats.image_copy_count;
+        }
+        if (!buffer_writes.empty())
+        {
+            recorder.pipeline_barrier({
+                .src_access = AccessConsts::TRANSFER_WRITE,
+                .dst_access = info.dst_access,
+            });
+            ++stats.barrier_count;
+        }
+        for (auto const & transition : image_transitions)
+        {
+            recorder.pipeline_barrier_image_transition({
+                .src_access = AccessConsts::TRANSFER_WRITE,
+                .dst_access = info.dst_access,
+                .src_layout = ImageLayout::TRANSFER_DST_OPTIMAL,
+                .dst_layout = transition.dst_layout,
+                .image_slice = transition.image_slice,
+                .image_id = transition.image_id,
+            });
+            ++stats.barrier_count;
+        }
+
+        // All staging memory of this flush retires once the gpu reached the returned value.
+        u64 const timeline_value = s.staging.timeline_value();
+        s.staging.advance_timeline();
+
+        s.total_stats.write_count += stats.write_count;
+        s.total_stats.uploaded_bytes += stats.uploaded_bytes;
+        s.total_stats.buffer_copy_count += stats.buffer_copy_count;
+        s.total_stats.image_copy_count += stats.image_copy_count;
+        s.total_stats.barrier_count += stats.barrier_count;
+        s.total_stats.staging_time += stats.staging_time;
+        return UploadQueueFlushResult{
+            .timeline_value = timeline_value,
+            .stats = stats,
+        };
+    }
+
+    auto UploadQueue::stats() const -> UploadQueueStats
+    {
+        return this->state->total_stats;
+    }
+
+    auto UploadQueue::timeline_semaphore() -> TimelineSemaphore const &
+    {
+        return this->state->staging.timeline_semaphore();
+    }
+
+    auto UploadQueue::info() const -> UploadQueueInfo const &
+    {
+        return this->m_info;
+    }
+
+    ReadbackRing::ReadbackRing(ReadbackRingInfo a_info)
         : m_info{std::move(a_info)},
           gpu_timeline{this->m_info.device.create_timeline_semaphore({
               .initial_value = {},
@@ -13,46 +685,354 @@ namespace daxa
           })},
           m_buffer{this->m_info.device.create_buffer({
               .size = this->m_info.capacity,
-              .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_SEQUENTIAL_WRITE | (a_info.use_bar_memory ? daxa::MemoryFlagBits::DEDICATED_MEMORY : daxa::MemoryFlagBits::NONE),
+              .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
               .name = this->m_info.name,
           })},
-          buffer_device_address{this->m_info.device.get_device_address(this->m_buffer).value()},
-          buffer_host_address{this->m_info.device.get_host_address(this->m_buffer).value()}
+          buffer_host_address{this->m_info.device.get_host_address_as<std::byte>(this->m_buffer).value()}
     {
     }
 
-    TransferMemoryPool::TransferMemoryPool(TransferMemoryPool && other)
+    ReadbackRing::ReadbackRing(ReadbackRing && other)
     {
         std::swap(this->m_info, other.m_info);
         std::swap(this->gpu_timeline, other.gpu_timeline);
+        std::swap(this->m_buffer, other.m_buffer);
+        std::swap(this->buffer_host_address, other.buffer_host_address);
+        std::swap(this->head, other.head);
+        std::swap(this->tail, other.tail);
         std::swap(this->current_timeline_value, other.current_timeline_value);
-        std::swap(this->live_allocations, other.live_allocations);
+        std::swap(this->reclaimed_timeline_value, other.reclaimed_timeline_value);
+        std::swap(this->has_unflushed_copies, other.has_unflushed_copies);
+        std::swap(this->current_callbacks, other.current_callbacks);
+        std::swap(this->frames, other.frames);
+    }
+
+    ReadbackRing & ReadbackRing::operator=(ReadbackRing && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->gpu_timeline, other.gpu_timeline);
         std::swap(this->m_buffer, other.m_buffer);
-        std::swap(this->buffer_device_address, other.buffer_device_address);
         std::swap(this->buffer_host_address, other.buffer_host_address);
-        std::swap(this->claimed_start, other.claimed_start);
-        std::swap(this->claimed_size, other.claimed_size);
+        std::swap(this->head, other.head);
+        std::swap(this->tail, other.tail);
+        std::swap(this->current_timeline_value, other.current_timeline_value);
+        std::swap(this->reclaimed_timeline_value, other.reclaimed_timeline_value);
+        std::swap(this->has_unflushed_copies, other.has_unflushed_copies);
+        std::swap(this->current_callbacks, other.current_callbacks);
+        std::swap(this->frames, other.frames);
+        return *this;
     }
 
-    TransferMemoryPool & TransferMemoryPool::operator=(TransferMemoryPool && other)
+    ReadbackRing::~ReadbackRing()
+    {
+        if (!this->m_buffer.is_empty())
+        {
+            this->m_info.device.destroy_buffer(this->m_buffer);
+        }
+    }
+
+    auto ReadbackRing::allocate(u64 size, u64 alignment) -> std::optional<u64>
+    {
+        u64 const capacity = this->m_info.capacity;
+        if (size == 0 || size > capacity)
+        {
+            return std::nullopt;
+        }
+        u64 wrap_start = this->head - this->head % capacity;
+        u64 offset = (this->head % capacity + alignment - 1) / alignment * alignment;
+        if (offset + size > capacity)
+        {
+            // Not enough space left at the end of the buffer, skip the rest and place the slot at offset 0.
+            offset = 0;
+            wrap_start += capacity;
+        }
+        u64 const new_head = wrap_start + offset + size;
+        if (new_head - this->tail > capacity)
+        {
+            return std::nullopt;
+        }
+        this->head = new_head;
+        return offset;
+    }
+
+    auto ReadbackRing::readback_buffer(CommandRecorder & recorder, ReadbackBufferInfo const & info, ReadbackCallback callback) -> std::optional<Readback>
+    {
+        auto const offset = this->allocate(info.size, 4);
+        if (!offset.has_value())
+        {
+            return std::nullopt;
+        }
+        recorder.copy_buffer_to_buffer({
+            .src_buffer = info.src_buffer,
+            .dst_buffer = this->m_buffer,
+            .src_offset = info.src_offset,
+            .dst_offset = offset.value(),
+            .size = info.size,
+        });
+        this->has_unflushed_copies = true;
+        if (callback)
+        {
+            this->current_callbacks.push_back({.buffer_offset = offset.value(), .size = info.size, .callback = std::move(callback)});
+        }
+        return Readback{.buffer_offset = offset.value(), .size = info.size, .timeline_value = this->current_timeline_value};
+    }
+
+    auto ReadbackRing::readback_image(CommandRecorder & recorder, ReadbackImageInfo const & info, ReadbackCallback callback) -> std::optional<Readback>
+    {
+        // Buffer offsets of image to buffer copies must be a multiple of the texel block size and 4.
+        u64 const alignment = std::lcm(u64{texel_block_size(this->m_info.device.info_image(info.src_image).value().format)}, u64{4});
+        auto const offset = this->allocate(info.size, alignment);
+        if (!offset.has_value())
+        {
+            return std::nullopt;
+        }
+        recorder.copy_image_to_buffer({
+            .image = info.src_image,
+            .image_layout = info.image_layout,
+            .image_slice = info.image_slice,
+            .image_offset = info.image_offset,
+            .image_extent = info.image_extent,
+            .buffer = this->m_buffer,
+            .buffer_offset = offset.value(),
+        });
+        this->has_unflushed_copies = true;
+        if (callback)
+        {
+            this->current_callbacks.push_back({.buffer_offset = offset.value(), .size = info.size, .callback = std::move(callback)});
+        }
+        return Readback{.buffer_offset = offset.value(), .size = info.size, .timeline_value = this->current_timeline_value};
+    }
+
+    void ReadbackRing::flush(CommandRecorder & recorder)
+    {
+        if (!this->has_unflushed_copies)
+        {
+            return;
+        }
+        recorder.pipeline_barrier({
+            .src_access = AccessConsts::TRANSFER_WRITE,
+            .dst_access = AccessConsts::HOST_READ,
+        });
+        this->has_unflushed_copies = false;
+    }
+
+    auto ReadbackRing::try_read(Readback const & readback) const -> std::optional<std::span<std::byte const>>
+    {
+        if (readback.timeline_value <= this->reclaimed_timeline_value || this->gpu_timeline.value() < readback.timeline_value)
+        {
+            return std::nullopt;
+        }
+        return std::span<std::byte const>{this->buffer_host_address + readback.buffer_offset, readback.size};
+    }
+
+    auto ReadbackRing::poll() -> usize
+    {
+        u64 const gpu_value = this->gpu_timeline.value();
+        usize invoked = 0;
+        while (!this->frames.empty() && this->frames.front().timeline_value <= gpu_value)
+        {
+            Frame frame = std::move(this->frames.front());
+            this->frames.pop_front();
+            for (auto & pending : frame.callbacks)
+            {
+                pending.callback(std::span<std::byte const>{this->buffer_host_address + pending.buffer_offset, pending.size});
+                ++invoked;
+            }
+            this->tail = frame.end_head;
+            this->reclaimed_timeline_value = frame.timeline_value;
+        }
+        return invoked;
+    }
+
+    auto ReadbackRing::timeline_value() const -> u64
+    {
+        return this->current_timeline_value;
+    }
+
+    void ReadbackRing::advance_timeline()
+    {
+        DAXA_DBG_ASSERT_TRUE_M(!this->has_unflushed_copies, "readback ring must be flushed before advancing its timeline");
+        bool const frame_used = this->head != (this->frames.empty() ? this->tail : this->frames.back().end_head);
+        if (frame_used)
+        {
+            this->frames.push_back(Frame{
+                .timeline_value = this->current_timeline_value,
+                .end_head = this->head,
+                .callbacks = std::move(this->current_callbacks),
+            });
+            this->current_callbacks.clear();
+        }
+        ++this->current_timeline_value;
+    }
+
+    auto ReadbackRing::timeline_semaphore() -> TimelineSemaphore const &
+    {
+        return this->gpu_timeline;
+    }
+
+    auto ReadbackRing::buffer() const -> daxa::BufferId
+    {
+        return this->m_buffer;
+    }
+
+    auto ReadbackRing::info() const -> ReadbackRingInfo const &
+    {
+        return this->m_info;
+    }
+
+    struct BufferSuballocator::State
+    {
+        static constexpr u32 INVALID_BLOCK = std::numeric_limits<u32>::max();
+        static constexpr u8 NO_ORDER = std::numeric_limits<u8>::max();
+
+        u64 min_block_size = {};
+        u32 max_order = {};
+        std::atomic_uint64_t timeline_value = 1;
+        std::atomic_uint64_t used_size = {};
+
+        // Everything below, except the pending free stack, is only accessed with the mutex locked.
+        std::mutex mtx = {};
+        // Blocks are identified by the index of their first min size block.
+        // Free blocks of each order form a doubly linked list through free_next and free_prev.
+        std::vector<u32> free_heads = {};
+        std::vector<u32> free_next = {};
+        std::vector<u32> free_prev = {};
+        std::vector<u8> free_order = {};
+        std::vector<u8> allocated_order = {};
+        // Lock-free stack of freed blocks, linked through pending_next.
+        // Only ever pushed to or taken as a whole, so it is not affected by the aba problem.
+        std::atomic_uint32_t pending_head = INVALID_BLOCK;
+        std::vector<u32> pending_next = {};
+        std::vector<u64> pending_timeline_values = {};
+        // Freed blocks that may still be in use by the gpu.
+        std::vector<u32> deferred_blocks = {};
+
+        void push_free(u32 block, u32 order)
+        {
+            this->free_order[block] = static_cast<u8>(order);
+            this->free_prev[block] = INVALID_BLOCK;
+            this->free_next[block] = this->free_heads[order];
+            if (this->free_heads[order] != INVALID_BLOCK)
+            {
+                this->free_prev[this->free_heads[order]] = block;
+            }
+            this->free_heads[order] = block;
+        }
+
+        void remove_free(u32 block)
+        {
+            u32 const order = this->free_order[block];
+            if (this->free_prev[block] != INVALID_BLOCK)
+            {
+                this->free_next[this->free_prev[block]] = this->free_next[block];
+            }
+            else
+            {
+                this->free_heads[order] = this->free_next[block];
+            }
+            if (this->free_next[block] != INVALID_BLOCK)
+            {
+                this->free_prev[this->free_next[block]] = this->free_prev[block];
+            }
+            this->free_order[block] = NO_ORDER;
+        }
+
+        void release_block(u32 block)
+        {
+            u32 order = this->allocated_order[block];
+            this->allocated_order[block] = NO_ORDER;
+            this->used_size.fetch_sub(this->min_block_size << order, std::memory_order_relaxed);
+            // Merge with the buddy as long as it is free as a whole.
+            while (order < this->max_order)
+            {
+                u32 const buddy = block ^ (1u << order);
+                if (this->free_order[buddy] != order)
+                {
+                    break;
+                }
+                this->remove_free(buddy);
+                block = std::min(block, buddy);
+                ++order;
+            }
+            this->push_free(block, order);
+        }
+
+        void reclaim(u64 gpu_timeline_value)
+        {
+            u32 pending = this->pending_head.exchange(INVALID_BLOCK, std::memory_order_acquire);
+            while (pending != INVALID_BLOCK)
+            {
+                this->deferred_blocks.push_back(pending);
+                pending = this->pending_next[pending];
+            }
+            auto const still_in_use = std::partition(
+                this->deferred_blocks.begin(), this->deferred_blocks.end(),
+                [&](u32 block)
+                { return this->pending_timeline_values[block] > gpu_timeline_value; });
+            for (auto iter = still_in_use; iter != this->deferred_blocks.end(); ++iter)
+            {
+                this->release_block(*iter);
+            }
+            this->deferred_blocks.erase(still_in_use, this->deferred_blocks.end());
+        }
+    };
+
+    BufferSuballocator::BufferSuballocator(BufferSuballocatorInfo a_info)
+        : m_info{std::move(a_info)},
+          gpu_timeline{this->m_info.device.create_timeline_semaphore({
+              .initial_value = {},
+              .name = this->m_info.name,
+          })},
+          state{std::make_unique<State>()}
+    {
+        this->m_info.min_allocation_size = std::bit_ceil(std::max(this->m_info.min_allocation_size, u64{1}));
+        this->m_info.capacity = std::bit_ceil(std::max(this->m_info.capacity, this->m_info.min_allocation_size));
+        u64 const block_count = this->m_info.capacity / this->m_info.min_allocation_size;
+        DAXA_DBG_ASSERT_TRUE_M(block_count <= std::numeric_limits<u32>::max(), "buffer suballocator min_allocation_size is too small for its capacity");
+        this->m_buffer = this->m_info.device.create_buffer({
+            .size = this->m_info.capacity,
+            .name = this->m_info.name,
+        });
+        this->buffer_device_address = this->m_info.device.get_device_address(this->m_buffer).value();
+
+        auto & s = *this->state;
+        s.min_block_size = this->m_info.min_allocation_size;
+        s.max_order = static_cast<u32>(std::countr_zero(block_count));
+        s.free_heads.resize(s.max_order + 1, State::INVALID_BLOCK);
+        s.free_next.resize(block_count, State::INVALID_BLOCK);
+        s.free_prev.resize(block_count, State::INVALID_BLOCK);
+        s.free_order.resize(block_count, State::NO_ORDER);
+        s.allocated_order.resize(block_count, State::NO_ORDER);
+        s.pending_next.resize(block_count, State::INVALID_BLOCK);
+        s.pending_timeline_values.resize(block_count, 0);
+        s.push_free(0, s.max_order);
+    }
+
+    BufferSuballocator::BufferSuballocator(BufferSuballocator && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->gpu_timeline, other.gpu_timeline);
+        std::swap(this->m_buffer, other.m_buffer);
+        std::swap(this->buffer_device_address, other.buffer_device_address);
+        std::swap(this->state, other.state);
+    }
+
+    BufferSuballocator & BufferSuballocator::operator=(BufferSuballocator && other)
     {
         if (!this->m_buffer.is_empty())
         {
             this->m_info.device.destroy_buffer(this->m_buffer);
+            this->m_buffer = {};
         }
         std::swap(this->m_info, other.m_info);
         std::swap(this->gpu_timeline, other.gpu_timeline);
-        std::swap(this->current_timeline_value, other.current_timeline_value);
-        std::swap(this->live_allocations, other.live_allocations);
         std::swap(this->m_buffer, other.m_buffer);
         std::swap(this->buffer_device_address, other.buffer_device_address);
-        std::swap(this->buffer_host_address, other.buffer_host_address);
-        std::swap(this->claimed_start, other.claimed_start);
-        std::swap(this->claimed_size, other.claimed_size);
+        std::swap(this->state, other.state);
         return *this;
     }
 
-    TransferMemoryPool::~TransferMemoryPool()
+    BufferSuballocator::~BufferSuballocator()
     {
         if (!this->m_buffer.is_empty())
         {
@@ -60,105 +1040,360 @@ namespace daxa
         }
     }
 
-    auto TransferMemoryPool::allocate(u32 allocation_size, u32 alignment_requirement) -> std::optional<TransferMemoryPool::Allocation>
+    auto BufferSuballocator::allocate(u64 size, u64 alignment_requirement) -> std::optional<Allocation>
     {
-        u32 const tail_alloc_offset = (this->claimed_start + this->claimed_size) % this->m_info.capacity;
-        auto up_align_offset = [](auto value, auto alignment)
+        DAXA_DBG_ASSERT_TRUE_M(std::has_single_bit(alignment_requirement), "buffer suballocator alignment must be a power of two");
+        auto & s = *this->state;
+        // Blocks are aligned to their size, so a block at least as large as the alignment is always aligned.
+        u64 const block_size = std::bit_ceil(std::max({size, alignment_requirement, s.min_block_size}));
+        if (size == 0 || block_size > this->m_info.capacity)
         {
-            return (value + alignment - 1) / alignment * alignment;
-        };
-        u32 const tail_alloc_offset_aligned = up_align_offset(tail_alloc_offset, alignment_requirement);
-        u32 const tail_alloc_align_padding = tail_alloc_offset_aligned - tail_alloc_offset;
-        // Two allocations are possible:
-        // Tail allocation is when the allocation is placed directly at the end of all other allocations.
-        // Zero offset allocation is possible when there is not enough space left at the tail BUT there is enough space from 0 up to the start of the other allocations.
-        auto calc_tail_allocation_possible = [&]()
-        {
-            u32 const tail = tail_alloc_offset_aligned;
-            bool const wrapped = this->claimed_start + this->claimed_size > this->m_info.capacity;
-            u32 const end = wrapped ? this->claimed_start : this->m_info.capacity;
-            return tail + allocation_size <= end;
-        };
-        auto calc_zero_offset_allocation_possible = [&]()
+            return std::nullopt;
+        }
+        u32 const order = static_cast<u32>(std::countr_zero(block_size / s.min_block_size));
+
+        std::unique_lock const lock{s.mtx};
+        auto find_free_order = [&]() -> u32
         {
-            return this->claimed_start + this->claimed_size <= this->m_info.capacity && allocation_size < this->claimed_start;
+            for (u32 free_order = order; free_order <= s.max_order; ++free_order)
+            {
+                if (s.free_heads[free_order] != State::INVALID_BLOCK)
+                {
+                    return free_order;
+                }
+            }
+            return State::INVALID_BLOCK;
         };
-        // Firstly, test if there is enough continuous space left to allocate.
-        bool tail_allocation_possible = calc_tail_allocation_possible();
-        // When there is no tail space left, it may be the case that we can place the allocation at offset 0.
-        // Illustration: |XXX ## |; "X": new allocation; "#": used up space; " ": free space.
-        bool zero_offset_allocation_possible = calc_zero_offset_allocation_possible();
-        if (!tail_allocation_possible && !zero_offset_allocation_possible)
-        {
-            this->reclaim_unused_memory();
-            tail_allocation_possible = calc_tail_allocation_possible();
-            zero_offset_allocation_possible = calc_zero_offset_allocation_possible();
-            if (!tail_allocation_possible && !zero_offset_allocation_possible)
+        u32 free_order = find_free_order();
+        if (free_order == State::INVALID_BLOCK)
+        {
+            s.reclaim(this->gpu_timeline.value());
+            free_order = find_free_order();
+            if (free_order == State::INVALID_BLOCK)
             {
                 return std::nullopt;
             }
         }
-        current_timeline_value += 1;
-        u32 returned_allocation_offset = {};
-        u32 actual_allocation_offset = {};
-        u32 actual_allocation_size = {};
-        if (tail_allocation_possible)
+        u32 const block = s.free_heads[free_order];
+        s.remove_free(block);
+        // Split the block until it has the requested order, the upper halves stay free.
+        while (free_order > order)
         {
-            actual_allocation_size = allocation_size + tail_alloc_align_padding;
-            returned_allocation_offset = tail_alloc_offset_aligned;
-            actual_allocation_offset = tail_alloc_offset;
+            --free_order;
+            s.push_free(block + (1u << free_order), free_order);
         }
-        else // Zero offset allocation.
+        s.allocated_order[block] = static_cast<u8>(order);
+        s.used_size.fetch_add(block_size, std::memory_order_relaxed);
+
+        u64 const offset = static_cast<u64>(block) * s.min_block_size;
+        return Allocation{
+            .device_address = this->buffer_device_address + offset,
+            .buffer_offset = offset,
+            .size = size,
+        };
+    }
+
+    void BufferSuballocator::free(Allocation const & allocation)
+    {
+        auto & s = *this->state;
+        auto const block = static_cast<u32>(allocation.buffer_offset / s.min_block_size);
+        s.pending_timeline_values[block] = s.timeline_value.load(std::memory_order_relaxed);
+        u32 next = s.pending_head.load(std::memory_order_relaxed);
+        do
         {
-            u32 const left_tail_space = this->m_info.capacity - (this->claimed_start + this->claimed_size);
-            actual_allocation_size = allocation_size + left_tail_space;
-            returned_allocation_offset = {};
-            actual_allocation_offset = {};
+            s.pending_next[block] = next;
+        } while (!s.pending_head.compare_exchange_weak(next, block, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    auto BufferSuballocator::timeline_value() const -> u64
+    {
+        return this->state->timeline_value.load(std::memory_order_relaxed);
+    }
+
+    void BufferSuballocator::advance_timeline()
+    {
+        auto & s = *this->state;
+        s.timeline_value.fetch_add(1, std::memory_order_relaxed);
+        // Once per frame is a good time to make the memory of finished frames available again.
+        std::unique_lock const lock{s.mtx};
+        s.reclaim(this->gpu_timeline.value());
+    }
+
+    auto BufferSuballocator::timeline_semaphore() -> TimelineSemaphore const &
+    {
+        return this->gpu_timeline;
+    }
+
+    auto BufferSuballocator::buffer() const -> daxa::BufferId
+    {
+        return this->m_buffer;
+    }
+
+    auto BufferSuballocator::used_size() const -> u64
+    {
+        return this->state->used_size.load(std::memory_order_relaxed);
+    }
+
+    auto BufferSuballocator::info() const -> BufferSuballocatorInfo const &
+    {
+        return this->m_info;
+    }
+
+    BlasCompactor::BlasCompactor(BlasCompactorInfo a_info)
+        : m_info{std::move(a_info)},
+          gpu_timeline{this->m_info.device.create_timeline_semaphore({
+              .initial_value = {},
+              .name = this->m_info.name,
+          })}
+    {
+    }
+
+    BlasCompactor::BlasCompactor(BlasCompactor && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->gpu_timeline, other.gpu_timeline);
+        std::swap(this->current_timeline_value, other.current_timeline_value);
+        std::swap(this->pending_batches, other.pending_batches);
+    }
+
+    BlasCompactor & BlasCompactor::operator=(BlasCompactor && other)
+    {
+        for (auto const & batch : this->pending_batches)
+        {
+            this->m_info.device.destroy_buffer(batch.size_buffer);
         }
-        this->claimed_size += actual_allocation_size;
-        live_allocations.push_back(TrackedAllocation{
-            .timeline_index = this->current_timeline_value,
-            .offset = actual_allocation_offset,
-            .size = actual_allocation_size,
+        this->pending_batches.clear();
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->gpu_timeline, other.gpu_timeline);
+        std::swap(this->current_timeline_value, other.current_timeline_value);
+        std::swap(this->pending_batches, other.pending_batches);
+        return *this;
+    }
+
+    BlasCompactor::~BlasCompactor()
+    {
+        for (auto const & batch : this->pending_batches)
+        {
+            this->m_info.device.destroy_buffer(batch.size_buffer);
+        }
+    }
+
+    void BlasCompactor::enqueue(CommandRecorder & recorder, std::span<BlasId const> blas)
+    {
+        if (blas.empty())
+        {
+            return;
+        }
+        auto size_buffer = this->m_info.device.create_buffer({
+            .size = blas.size() * sizeof(u64),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = this->m_info.name,
         });
-        return Allocation{
-            .device_address = this->buffer_device_address + returned_allocation_offset,
-            .host_address = reinterpret_cast<void *>(reinterpret_cast<u8 *>(this->buffer_host_address) + returned_allocation_offset),
-            .buffer_offset = returned_allocation_offset,
-            .size = allocation_size,
+        recorder.write_blas_compacted_sizes({
+            .blas = blas,
+            .dst_buffer = size_buffer,
+        });
+        this->current_timeline_value += 1;
+        this->pending_batches.push_back(PendingBatch{
             .timeline_index = this->current_timeline_value,
-        };
+            .size_buffer = size_buffer,
+            .blas = {blas.begin(), blas.end()},
+        });
     }
 
-    auto TransferMemoryPool::timeline_value() const -> usize
+    auto BlasCompactor::compact(CommandRecorder & recorder) -> std::vector<Compaction>
     {
-        return this->current_timeline_value;
+        std::vector<Compaction> ret = {};
+        auto const current_gpu_timeline_value = this->gpu_timeline.value();
+        while (!this->pending_batches.empty() && this->pending_batches.front().timeline_index <= current_gpu_timeline_value)
+        {
+            auto & batch = this->pending_batches.front();
+            auto const * compacted_sizes = this->m_info.device.get_host_address_as<u64>(batch.size_buffer).value();
+            for (usize i = 0; i < batch.blas.size(); ++i)
+            {
+                auto const original_info = this->m_info.device.info_blas(batch.blas[i]).value();
+                auto compacted = this->m_info.device.create_blas({
+                    .size = compacted_sizes[i],
+                    .name = original_info.name,
+                });
+                recorder.copy_blas_to_blas({
+                    .src_blas = batch.blas[i],
+                    .dst_blas = compacted,
+                    .compact = true,
+                });
+                recorder.destroy_blas_deferred(batch.blas[i]);
+                ret.push_back(Compaction{
+                    .original = batch.blas[i],
+                    .compacted = compacted,
+                    .original_size = original_info.size,
+                    .compacted_size = compacted_sizes[i],
+                });
+            }
+            recorder.destroy_buffer_deferred(batch.size_buffer);
+            this->pending_batches.pop_front();
+        }
+        return ret;
     }
 
-    void TransferMemoryPool::reclaim_unused_memory()
+    auto BlasCompactor::pending_count() const -> usize
     {
-        auto const current_gpu_timeline_value = this->gpu_timeline.value();
-        while (!live_allocations.empty() && live_allocations.front().timeline_index <= current_gpu_timeline_value)
+        usize count = 0;
+        for (auto const & batch : this->pending_batches)
         {
-            this->claimed_start = (this->claimed_start + live_allocations.front().size) % this->m_info.capacity;
-            this->claimed_size -= live_allocations.front().size;
-            live_allocations.pop_front();
+            count += batch.blas.size();
         }
+        return count;
     }
 
-    auto TransferMemoryPool::timeline_semaphore() -> TimelineSemaphore const &
+    auto BlasCompactor::timeline_value() const -> u64
+    {
+        return this->current_timeline_value;
+    }
+
+    auto BlasCompactor::timeline_semaphore() -> TimelineSemaphore const &
     {
         return this->gpu_timeline;
     }
 
-    auto TransferMemoryPool::info() const -> TransferMemoryPoolInfo const &
+    auto BlasCompactor::info() const -> BlasCompactorInfo const &
     {
         return this->m_info;
     }
 
-    auto TransferMemoryPool::buffer() const -> daxa::BufferId
+    BlasBatchBuilder::BlasBatchBuilder(BlasBatchBuilderInfo a_info)
+        : m_info{std::move(a_info)}
     {
-        return this->m_buffer;
+    }
+
+    BlasBatchBuilder::BlasBatchBuilder(BlasBatchBuilder && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->m_scratch_buffer, other.m_scratch_buffer);
+        std::swap(this->scratch_buffer_size, other.scratch_buffer_size);
+        std::swap(this->scratch_offsets, other.scratch_offsets);
+        std::swap(this->batch_ends, other.batch_ends);
+        std::swap(this->batch_build_infos, other.batch_build_infos);
+    }
+
+    BlasBatchBuilder & BlasBatchBuilder::operator=(BlasBatchBuilder && other)
+    {
+        if (!this->m_scratch_buffer.is_empty())
+        {
+            this->m_info.device.destroy_buffer(this->m_scratch_buffer);
+            this->m_scratch_buffer = {};
+            this->scratch_buffer_size = {};
+        }
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->m_scratch_buffer, other.m_scratch_buffer);
+        std::swap(this->scratch_buffer_size, other.scratch_buffer_size);
+        std::swap(this->scratch_offsets, other.scratch_offsets);
+        std::swap(this->batch_ends, other.batch_ends);
+        std::swap(this->batch_build_infos, other.batch_build_infos);
+        return *this;
+    }
+
+    BlasBatchBuilder::~BlasBatchBuilder()
+    {
+        if (!this->m_scratch_buffer.is_empty())
+        {
+            this->m_info.device.destroy_buffer(this->m_scratch_buffer);
+        }
+    }
+
+    auto BlasBatchBuilder::build(CommandRecorder & recorder, std::span<BlasBuildInfo const> build_infos) -> std::vector<BlasId>
+    {
+        std::vector<BlasId> ret = {};
+        if (build_infos.empty())
+        {
+            return ret;
+        }
+        auto & device = this->m_info.device;
+        u64 const alignment = std::max(u64{1}, static_cast<u64>(device.properties().acceleration_structure_properties.value().min_acceleration_structure_scratch_offset_alignment));
+        auto up_align_offset = [&](u64 value)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        };
+
+        // Calculate sizes, create missing blas and pack the scratch memory of each batch.
+        ret.reserve(build_infos.size());
+        this->scratch_offsets.clear();
+        this->batch_ends.clear();
+        u64 batch_scratch_size = 0;
+        u64 max_batch_scratch_size = 0;
+        for (usize i = 0; i < build_infos.size(); ++i)
+        {
+            auto const & build_info = build_infos[i];
+            auto const build_sizes = device.get_blas_build_sizes(build_info);
+            BlasId blas = build_info.dst_blas;
+            if (blas.is_empty())
+            {
+                blas = device.create_blas({
+                    .size = build_sizes.acceleration_structure_size,
+                    .name = this->m_info.name,
+                });
+            }
+            ret.push_back(blas);
+            // Updates (refits) use their own, usually much smaller, scratch size.
+            u64 const scratch_size = up_align_offset(build_info.src_blas.is_empty() ? build_sizes.build_scratch_size : build_sizes.update_scratch_size);
+            if (batch_scratch_size != 0 && batch_scratch_size + scratch_size > this->m_info.scratch_budget)
+            {
+                this->batch_ends.push_back(i);
+                batch_scratch_size = 0;
+            }
+            this->scratch_offsets.push_back(batch_scratch_size);
+            batch_scratch_size += scratch_size;
+            max_batch_scratch_size = std::max(max_batch_scratch_size, batch_scratch_size);
+        }
+        this->batch_ends.push_back(build_infos.size());
+
+        // The buffer device address is not guaranteed to be aligned to the scratch alignment, so reserve space to align it up.
+        u64 const required_scratch_buffer_size = max_batch_scratch_size + alignment;
+        if (this->scratch_buffer_size < required_scratch_buffer_size)
+        {
+            if (!this->m_scratch_buffer.is_empty())
+            {
+                recorder.destroy_buffer_deferred(this->m_scratch_buffer);
+            }
+            this->m_scratch_buffer = device.create_buffer({
+                .size = required_scratch_buffer_size,
+                .name = this->m_info.name,
+            });
+            this->scratch_buffer_size = required_scratch_buffer_size;
+        }
+        DeviceAddress const scratch_base = up_align_offset(device.get_device_address(this->m_scratch_buffer).value());
+
+        usize batch_start = 0;
+        for (usize const batch_end : this->batch_ends)
+        {
+            this->batch_build_infos.clear();
+            for (usize i = batch_start; i < batch_end; ++i)
+            {
+                auto build_info = build_infos[i];
+                build_info.dst_blas = ret[i];
+                build_info.scratch_data = scratch_base + this->scratch_offsets[i];
+                this->batch_build_infos.push_back(build_info);
+            }
+            // Previous builds, also from earlier submissions, may still use the scratch memory.
+            recorder.pipeline_barrier({
+                .src_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ_WRITE,
+                .dst_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ_WRITE,
+            });
+            recorder.build_acceleration_structures({
+                .blas_build_infos = this->batch_build_infos,
+            });
+            batch_start = batch_end;
+        }
+        return ret;
+    }
+
+    auto BlasBatchBuilder::scratch_buffer() const -> BufferId
+    {
+        return this->m_scratch_buffer;
+    }
+
+    auto BlasBatchBuilder::info() const -> BlasBatchBuilderInfo const &
+    {
+        return this->m_info;
     }
 } // namespace daxa
 
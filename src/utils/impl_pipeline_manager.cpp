@@ -481,6 +481,18 @@ namespace daxa
         return impl.reload_all();
     }
 
+    auto PipelineManager::wait_for_async_compilations() -> PipelineReloadResult
+    {
+        auto & impl = *r_cast<ImplPipelineManager *>(this->object);
+        return impl.wait_for_async_compilations();
+    }
+
+    auto PipelineManager::pending_async_compilations() const -> u32
+    {
+        auto const & impl = *r_cast<ImplPipelineManager *>(this->object);
+        return impl.pending_async_compilations();
+    }
+
     auto PipelineManager::all_pipelines_valid() const -> bool
     {
         auto const & impl = *r_cast<ImplPipelineManager *>(this->object);
@@ -533,6 +545,15 @@ namespace daxa
 
     ImplPipelineManager::~ImplPipelineManager()
     {
+        {
+            auto lock = std::lock_guard{this->async_mtx};
+            this->async_thread_exit = true;
+        }
+        this->async_cv.notify_all();
+        if (this->async_thread.joinable())
+        {
+            this->async_thread.join();
+        }
 #if DAXA_BUILT_WITH_UTILS_PIPELINE_MANAGER_GLSLANG
         {
             auto lock = std::lock_guard{glslang_init_mtx};
@@ -630,7 +651,7 @@ namespace daxa
                 auto spv_result = get_spirv(shader_compile_info, pipe_result.info.name, stage);
                 if (spv_result.is_err())
                 {
-                    if (this->info.register_null_pipelines_when_first_compile_fails)
+                    if (this->info.register_null_pipelines_when_first_compile_fails || this->info.async_compilation)
                     {
                         auto result = Result<RayTracingPipelineState>(pipe_result);
                         result.m = std::move(spv_result.message());
@@ -683,7 +704,7 @@ namespace daxa
         auto spirv_result = get_spirv(pipe_result.info.shader_info, pipe_result.info.name, ShaderStage::COMP);
         if (spirv_result.is_err())
         {
-            if (this->info.register_null_pipelines_when_first_compile_fails)
+            if (this->info.register_null_pipelines_when_first_compile_fails || this->info.async_compilation)
             {
                 auto result = Result<ComputePipelineState>(pipe_result);
                 result.m = std::move(spirv_result.message());
@@ -774,7 +795,7 @@ namespace daxa
                 *spv_result = get_spirv(pipe_result_shader_info->value(), pipe_result.info.name, stage);
                 if (spv_result->is_err())
                 {
-                    if (this->info.register_null_pipelines_when_first_compile_fails)
+                    if (this->info.register_null_pipelines_when_first_compile_fails || this->info.async_compilation)
                     {
                         auto result = Result<RasterPipelineState>(pipe_result);
                         result.m = std::move(spv_result->message());
@@ -796,9 +817,61 @@ namespace daxa
         return Result<RasterPipelineState>(std::move(pipe_result));
     }
 
+    template <typename StateT, typename PipeT>
+    static auto make_async_compilation(std::vector<StateT> & states, std::shared_ptr<PipeT> const & pipeline, Result<StateT> && result) -> AsyncCompilation
+    {
+        bool const is_valid = result.is_ok() && result.value().pipeline_ptr->is_valid();
+        auto compilation = AsyncCompilation{
+            .error = is_valid ? std::string{} : result.m,
+            .apply = {},
+        };
+        if (result.is_ok())
+        {
+            compilation.apply = [&states, pipeline, new_state = std::move(result.value())]() mutable
+            {
+                auto state_iter = std::find_if(
+                    states.begin(),
+                    states.end(),
+                    [&pipeline](StateT const & other)
+                    {
+                        return pipeline.get() == other.pipeline_ptr.get();
+                    });
+                // The pipeline was removed while it was compiling.
+                if (state_iter == states.end())
+                {
+                    return;
+                }
+                // The first compilation discovers the files that are observed for hot reloading.
+                if (state_iter->observed_hotload_files.empty())
+                {
+                    state_iter->observed_hotload_files = std::move(new_state.observed_hotload_files);
+                }
+                if (new_state.pipeline_ptr->is_valid())
+                {
+                    *pipeline = std::move(*new_state.pipeline_ptr);
+                }
+            };
+        }
+        return compilation;
+    }
+
     auto ImplPipelineManager::add_ray_tracing_pipeline(RayTracingPipelineCompileInfo const & a_info) -> Result<std::shared_ptr<RayTracingPipeline>>
     {
         // DAXA_DBG_ASSERT_TRUE_M(!daxa::holds_alternative<daxa::Monostate>(a_info.shader_info.source), "must provide shader source");
+        if (this->info.async_compilation)
+        {
+            auto pipeline = std::make_shared<RayTracingPipeline>(a_info.fallback_pipeline);
+            this->ray_tracing_pipelines.push_back(RayTracingPipelineState{
+                .pipeline_ptr = pipeline,
+                .info = a_info,
+                .last_hotload_time = std::chrono::file_clock::now(),
+                .observed_hotload_files = {},
+            });
+            queue_async_compilation([this, pipeline, a_info]()
+                                    { return make_async_compilation(this->ray_tracing_pipelines, pipeline, create_ray_tracing_pipeline(a_info)); });
+            return Result<std::shared_ptr<RayTracingPipeline>>(std::move(pipeline));
+        }
+        auto compile_lock = std::lock_guard{this->compile_mtx};
         auto pipe_result = create_ray_tracing_pipeline(a_info);
         if (pipe_result.is_err())
         {
@@ -820,6 +893,20 @@ namespace daxa
     auto ImplPipelineManager::add_compute_pipeline(ComputePipelineCompileInfo const & a_info) -> Result<std::shared_ptr<ComputePipeline>>
     {
         DAXA_DBG_ASSERT_TRUE_M(!daxa::holds_alternative<daxa::Monostate>(a_info.shader_info.source), "must provide shader source");
+        if (this->info.async_compilation)
+        {
+            auto pipeline = std::make_shared<ComputePipeline>(a_info.fallback_pipeline);
+            this->compute_pipelines.push_back(ComputePipelineState{
+                .pipeline_ptr = pipeline,
+                .info = a_info,
+                .last_hotload_time = std::chrono::file_clock::now(),
+                .observed_hotload_files = {},
+            });
+            queue_async_compilation([this, pipeline, a_info]()
+                                    { return make_async_compilation(this->compute_pipelines, pipeline, create_compute_pipeline(a_info)); });
+            return Result<std::shared_ptr<ComputePipeline>>(std::move(pipeline));
+        }
+        auto compile_lock = std::lock_guard{this->compile_mtx};
         auto pipe_result = create_compute_pipeline(a_info);
         if (pipe_result.is_err())
         {
@@ -840,6 +927,20 @@ namespace daxa
 
     auto ImplPipelineManager::add_raster_pipeline(RasterPipelineCompileInfo const & a_info) -> Result<std::shared_ptr<RasterPipeline>>
     {
+        if (this->info.async_compilation)
+        {
+            auto pipeline = std::make_shared<RasterPipeline>(a_info.fallback_pipeline);
+            this->raster_pipelines.push_back(RasterPipelineState{
+                .pipeline_ptr = pipeline,
+                .info = a_info,
+                .last_hotload_time = std::chrono::file_clock::now(),
+                .observed_hotload_files = {},
+            });
+            queue_async_compilation([this, pipeline, a_info]()
+                                    { return make_async_compilation(this->raster_pipelines, pipeline, create_raster_pipeline(a_info)); });
+            return Result<std::shared_ptr<RasterPipeline>>(std::move(pipeline));
+        }
+        auto compile_lock = std::lock_guard{this->compile_mtx};
         auto pipe_result = create_raster_pipeline(a_info);
         if (pipe_result.is_err())
         {
@@ -982,6 +1083,7 @@ namespace daxa
 
     void ImplPipelineManager::add_virtual_file(VirtualFileInfo const & virtual_info)
     {
+        auto compile_lock = std::lock_guard{this->compile_mtx};
         virtual_files[virtual_info.name] = VirtualFileState{
             .contents = virtual_info.contents,
             .timestamp = std::chrono::file_clock::now(),
@@ -1002,6 +1104,38 @@ namespace daxa
         // filesystem for the same file's write-time. Filesystem checks are really slow...
         auto lookup_table = FileWriteTimeLookupTable{};
 
+        if (this->info.async_compilation)
+        {
+            auto result = apply_finished_async_compilations();
+            for (auto & state : this->compute_pipelines)
+            {
+                if (check_if_sources_changed(state.last_hotload_time, state.observed_hotload_files, virtual_files, lookup_table))
+                {
+                    queue_async_compilation([this, pipeline = state.pipeline_ptr, compile_info = state.info]()
+                                            { return make_async_compilation(this->compute_pipelines, pipeline, create_compute_pipeline(compile_info)); });
+                }
+            }
+            for (auto & state : this->raster_pipelines)
+            {
+                if (check_if_sources_changed(state.last_hotload_time, state.observed_hotload_files, virtual_files, lookup_table))
+                {
+                    queue_async_compilation([this, pipeline = state.pipeline_ptr, compile_info = state.info]()
+                                            { return make_async_compilation(this->raster_pipelines, pipeline, create_raster_pipeline(compile_info)); });
+                }
+            }
+            for (auto & state : this->ray_tracing_pipelines)
+            {
+                if (check_if_sources_changed(state.last_hotload_time, state.observed_hotload_files, virtual_files, lookup_table))
+                {
+                    queue_async_compilation([this, pipeline = state.pipeline_ptr, compile_info = state.info]()
+                                            { return make_async_compilation(this->ray_tracing_pipelines, pipeline, create_ray_tracing_pipeline(compile_info)); });
+                }
+            }
+            return result;
+        }
+
+        auto compile_lock = std::lock_guard{this->compile_mtx};
+
         for (auto & [pipeline, compile_info, last_hotload_time, observed_hotload_files] : this->compute_pipelines)
         {
             if (check_if_sources_changed(last_hotload_time, observed_hotload_files, virtual_files, lookup_table))
@@ -1072,6 +1206,104 @@ namespace daxa
         }
     }
 
+    auto ImplPipelineManager::wait_for_async_compilations() -> PipelineReloadResult
+    {
+        {
+            auto lock = std::unique_lock{this->async_mtx};
+            this->async_cv.wait(lock, [this]()
+                                { return this->async_queue.empty() && this->async_running == 0; });
+        }
+        return apply_finished_async_compilations();
+    }
+
+    auto ImplPipelineManager::pending_async_compilations() const -> u32
+    {
+        auto lock = std::lock_guard{this->async_mtx};
+        return this->async_pending;
+    }
+
+    void ImplPipelineManager::queue_async_compilation(std::function<AsyncCompilation()> && compile)
+    {
+        {
+            auto lock = std::lock_guard{this->async_mtx};
+            this->async_queue.push_back(std::move(compile));
+            ++this->async_pending;
+            if (!this->async_thread.joinable())
+            {
+                this->async_thread = std::thread{[this]()
+                                                 { this->async_thread_main(); }};
+            }
+        }
+        this->async_cv.notify_all();
+    }
+
+    auto ImplPipelineManager::apply_finished_async_compilations() -> PipelineReloadResult
+    {
+        auto finished = std::vector<AsyncCompilation>{};
+        {
+            auto lock = std::lock_guard{this->async_mtx};
+            std::swap(finished, this->async_finished);
+            this->async_pending -= static_cast<u32>(finished.size());
+        }
+        if (finished.empty())
+        {
+            return NoPipelineChanged{};
+        }
+        // Apply every finished compilation, even when some of them failed, so that one broken shader does not hold back the others.
+        auto error_message = std::string{};
+        for (auto & compilation : finished)
+        {
+            if (compilation.apply)
+            {
+                compilation.apply();
+            }
+            if (!compilation.error.empty())
+            {
+                error_message += compilation.error;
+                error_message += "\n";
+            }
+        }
+        if (!error_message.empty())
+        {
+            return PipelineReloadError{error_message};
+        }
+        return PipelineReloadSuccess{};
+    }
+
+    void ImplPipelineManager::async_thread_main()
+    {
+        auto lock = std::unique_lock{this->async_mtx};
+        while (true)
+        {
+            this->async_cv.wait(lock, [this]()
+                                { return this->async_thread_exit || !this->async_queue.empty(); });
+            if (this->async_thread_exit)
+            {
+                return;
+            }
+            auto compile = std::move(this->async_queue.front());
+            this->async_queue.pop_front();
+            ++this->async_running;
+            lock.unlock();
+
+            auto compilation = AsyncCompilation{};
+            try
+            {
+                auto compile_lock = std::lock_guard{this->compile_mtx};
+                compilation = compile();
+            }
+            catch (std::exception const & exception)
+            {
+                compilation.error = std::string("failed to create pipeline: ") + exception.what();
+            }
+
+            lock.lock();
+            --this->async_running;
+            this->async_finished.push_back(std::move(compilation));
+            this->async_cv.notify_all();
+        }
+    }
+
     auto ImplPipelineManager::all_pipelines_valid() const -> bool
     {
         for (RasterPipelineState const & raster_pipeline_state : this->raster_pipelines)
@@ -2,6 +2,11 @@
 
 #include <daxa/utils/pipeline_manager.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #if DAXA_BUILT_WITH_UTILS_PIPELINE_MANAGER_DXC
 #if defined(_WIN32)
 #include "Windows.h"
@@ -41,6 +46,14 @@ namespace daxa
 
     using VirtualFileSet = std::map<std::string, VirtualFileState>;
 
+    struct AsyncCompilation
+    {
+        // Empty when the compilation succeeded.
+        std::string error = {};
+        // Swaps the compiled pipeline in. Always called on the thread calling reload_all/wait_for_async_compilations.
+        std::function<void()> apply = {};
+    };
+
     struct ImplPipelineManager final : ImplHandle
     {
         enum class ShaderStage
@@ -89,6 +102,17 @@ namespace daxa
         // PipelineManager is still externally thread-safe. You can create as many
         // PipelineManagers from as many threads as you'd like!
         ShaderCompileInfo const * current_shader_info = nullptr;
+        // Guards the compiler state above, as it is shared between the calling thread and the async compile thread.
+        std::mutex compile_mtx = {};
+
+        mutable std::mutex async_mtx = {};
+        std::condition_variable async_cv = {};
+        std::thread async_thread = {};
+        bool async_thread_exit = false;
+        u32 async_running = 0;
+        u32 async_pending = 0;
+        std::deque<std::function<AsyncCompilation()>> async_queue = {};
+        std::vector<AsyncCompilation> async_finished = {};
 
 #if DAXA_BUILT_WITH_UTILS_PIPELINE_MANAGER_GLSLANG
         struct GlslangBackend
@@ -125,8 +149,14 @@ namespace daxa
         void remove_raster_pipeline(std::shared_ptr<RasterPipeline> const & pipeline);
         void add_virtual_file(VirtualFileInfo const & virtual_info);
         auto reload_all() -> PipelineReloadResult;
+        auto wait_for_async_compilations() -> PipelineReloadResult;
+        auto pending_async_compilations() const -> u32;
         auto all_pipelines_valid() const -> bool;
 
+        void queue_async_compilation(std::function<AsyncCompilation()> && compile);
+        auto apply_finished_async_compilations() -> PipelineReloadResult;
+        void async_thread_main();
+
         auto full_path_to_file(std::filesystem::path const & path) -> Result<std::filesystem::path>;
         auto load_shader_source_from_file(std::filesystem::path const & path) -> Result<ShaderCode>;
 
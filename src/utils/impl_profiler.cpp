@@ -0,0 +1,288 @@
+#if DAXA_BUILT_WITH_UTILS_PROFILER
+
+#include <daxa/utils/profiler.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+namespace daxa
+{
+    static constexpr u32 GPU_PROFILER_DROPPED_SCOPE = std::numeric_limits<u32>::max();
+
+    GpuProfiler::GpuProfiler(GpuProfilerInfo a_info)
+        : m_info{std::move(a_info)},
+          timestamp_period{static_cast<f64>(this->m_info.device.properties().limits.timestamp_period)}
+    {
+        DAXA_DBG_ASSERT_TRUE_M(this->m_info.frames_in_flight > 0, "gpu profiler needs at least one frame in flight");
+        this->frame_slots.resize(this->m_info.frames_in_flight);
+        for (u32 i = 0; i < this->m_info.frames_in_flight; ++i)
+        {
+            this->frame_slots[i].query_pool = this->m_info.device.create_timeline_query_pool({
+                .query_count = this->m_info.max_scopes_per_frame * 2,
+                .name = this->m_info.name + std::string(" frame ") + std::to_string(i),
+            });
+        }
+    }
+
+    GpuProfiler::GpuProfiler(GpuProfiler && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->timestamp_period, other.timestamp_period);
+        std::swap(this->frame_slots, other.frame_slots);
+        std::swap(this->current_frame_index, other.current_frame_index);
+        std::swap(this->frame_active, other.frame_active);
+        std::swap(this->open_scopes, other.open_scopes);
+        std::swap(this->resolved_frames, other.resolved_frames);
+        std::swap(this->dropped_frames, other.dropped_frames);
+    }
+
+    GpuProfiler & GpuProfiler::operator=(GpuProfiler && other)
+    {
+        std::swap(this->m_info, other.m_info);
+        std::swap(this->timestamp_period, other.timestamp_period);
+        std::swap(this->frame_slots, other.frame_slots);
+        std::swap(this->current_frame_index, other.current_frame_index);
+        std::swap(this->frame_active, other.frame_active);
+        std::swap(this->open_scopes, other.open_scopes);
+        std::swap(this->resolved_frames, other.resolved_frames);
+        std::swap(this->dropped_frames, other.dropped_frames);
+        return *this;
+    }
+
+    GpuProfiler::~GpuProfiler() = default;
+
+    GpuProfiler::Scope::Scope(GpuProfiler & a_profiler, CommandRecorder & a_recorder, std::string_view name)
+        : profiler{a_profiler}, recorder{a_recorder}
+    {
+        this->profiler.begin_scope(this->recorder, name);
+    }
+
+    GpuProfiler::Scope::~Scope()
+    {
+        this->profiler.end_scope(this->recorder);
+    }
+
+    void GpuProfiler::begin_frame()
+    {
+        DAXA_DBG_ASSERT_TRUE_M(!this->frame_active, "gpu profiler frame must be ended before beginning a new one");
+        this->resolve();
+        auto & slot = this->frame_slots[this->current_frame_index % this->frame_slots.size()];
+        if (slot.pending)
+        {
+            // The gpu did not finish the frame that last used this slot yet.
+            // Waiting here would stall the cpu, so the frame is dropped instead.
+            slot.pending = false;
+            ++this->dropped_frames;
+        }
+        slot.frame_index = this->current_frame_index;
+        slot.query_count = 0;
+        slot.reset_recorded = false;
+        slot.scopes.clear();
+        this->frame_active = true;
+    }
+
+    void GpuProfiler::end_frame()
+    {
+        DAXA_DBG_ASSERT_TRUE_M(this->frame_active, "gpu profiler frame must be begun before ending it");
+        DAXA_DBG_ASSERT_TRUE_M(this->open_scopes.empty(), "all gpu profiler scopes must be ended before ending the frame");
+        auto & slot = this->frame_slots[this->current_frame_index % this->frame_slots.size()];
+        slot.pending = true;
+        ++this->current_frame_index;
+        this->frame_active = false;
+    }
+
+    void GpuProfiler::begin_scope(CommandRecorder & recorder, std::string_view name)
+    {
+        DAXA_DBG_ASSERT_TRUE_M(this->frame_active, "gpu profiler scopes can only be recorded between begin_frame and end_frame");
+        auto & slot = this->frame_slots[this->current_frame_index % this->frame_slots.size()];
+        if (!slot.reset_recorded)
+        {
+            recorder.reset_timestamps({
+                .query_pool = slot.query_pool,
+                .start_index = 0,
+                .count = slot.query_pool.info().query_count,
+            });
+            slot.reset_recorded = true;
+        }
+        if (slot.query_count + 2 > slot.query_pool.info().query_count)
+        {
+            this->open_scopes.push_back(GPU_PROFILER_DROPPED_SCOPE);
+            return;
+        }
+        this->open_scopes.push_back(static_cast<u32>(slot.scopes.size()));
+        slot.scopes.push_back(RecordedScope{
+            .name = std::string(name),
+            .depth = static_cast<u32>(this->open_scopes.size() - 1),
+            .begin_query = slot.query_count,
+            .end_query = slot.query_count + 1,
+        });
+        slot.query_count += 2;
+        recorder.write_timestamp({
+            .query_pool = slot.query_pool,
+            .pipeline_stage = PipelineStageFlagBits::ALL_COMMANDS,
+            .query_index = slot.scopes.back().begin_query,
+        });
+    }
+
+    void GpuProfiler::end_scope(CommandRecorder & recorder)
+    {
+        DAXA_DBG_ASSERT_TRUE_M(!this->open_scopes.empty(), "gpu profiler end_scope called without a matching begin_scope");
+        u32 const scope_index = this->open_scopes.back();
+        this->open_scopes.pop_back();
+        if (scope_index == GPU_PROFILER_DROPPED_SCOPE)
+        {
+            return;
+        }
+        auto & slot = this->frame_slots[this->current_frame_index % this->frame_slots.size()];
+        recorder.write_timestamp({
+            .query_pool = slot.query_pool,
+            .pipeline_stage = PipelineStageFlagBits::ALL_COMMANDS,
+            .query_index = slot.scopes[scope_index].end_query,
+        });
+    }
+
+    auto GpuProfiler::try_resolve(FrameSlot & slot) -> bool
+    {
+        GpuProfilerFrameResult frame = {.frame_index = slot.frame_index};
+        if (slot.query_count > 0)
+        {
+            // Results come in pairs of value and availability.
+            auto const query_results = slot.query_pool.get_query_results(0, slot.query_count);
+            for (u32 i = 0; i < slot.query_count; ++i)
+            {
+                if (query_results[i * 2 + 1] == 0)
+                {
+                    return false;
+                }
+            }
+            frame.scopes.reserve(slot.scopes.size());
+            for (auto & scope : slot.scopes)
+            {
+                frame.scopes.push_back(GpuProfilerScopeResult{
+                    .name = std::move(scope.name),
+                    .depth = scope.depth,
+                    .begin_ns = static_cast<u64>(static_cast<f64>(query_results[scope.begin_query * 2]) * this->timestamp_period),
+                    .end_ns = static_cast<u64>(static_cast<f64>(query_results[scope.end_query * 2]) * this->timestamp_period),
+                });
+            }
+        }
+        slot.pending = false;
+        this->resolved_frames.push_back(std::move(frame));
+        while (this->resolved_frames.size() > this->m_info.history_size)
+        {
+            this->resolved_frames.pop_front();
+        }
+        return true;
+    }
+
+    auto GpuProfiler::resolve() -> usize
+    {
+        // Resolve the oldest frames first, so that the history stays ordered.
+        usize resolved = 0;
+        for (u64 frame_offset = this->frame_slots.size(); frame_offset > 0; --frame_offset)
+        {
+            if (this->current_frame_index < frame_offset)
+            {
+                continue;
+            }
+            auto & slot = this->frame_slots[(this->current_frame_index - frame_offset) % this->frame_slots.size()];
+            if (!slot.pending)
+            {
+                continue;
+            }
+            if (!this->try_resolve(slot))
+            {
+                break;
+            }
+            ++resolved;
+        }
+        return resolved;
+    }
+
+    auto GpuProfiler::results() const -> std::deque<GpuProfilerFrameResult> const &
+    {
+        return this->resolved_frames;
+    }
+
+    auto GpuProfiler::dropped_frame_count() const -> u64
+    {
+        return this->dropped_frames;
+    }
+
+    static void gpu_profiler_append_json_string(std::string & out, std::string_view str)
+    {
+        out += '"';
+        for (char const c : str)
+        {
+            switch (c)
+            {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    out += fmt::format("\\u{:04x}", static_cast<u32>(c));
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    auto GpuProfiler::chrome_trace_json() const -> std::string
+    {
+        u64 base_ns = std::numeric_limits<u64>::max();
+        for (auto const & frame : this->resolved_frames)
+        {
+            for (auto const & scope : frame.scopes)
+            {
+                base_ns = std::min(base_ns, scope.begin_ns);
+            }
+        }
+        std::string ret = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        for (auto const & frame : this->resolved_frames)
+        {
+            for (auto const & scope : frame.scopes)
+            {
+                ret += first ? "\n" : ",\n";
+                first = false;
+                ret += "{\"name\":";
+                gpu_profiler_append_json_string(ret, scope.name);
+                ret += ",\"cat\":";
+                gpu_profiler_append_json_string(ret, this->m_info.name.empty() ? std::string_view{"gpu"} : std::string_view{this->m_info.name});
+                // Chrome trace timestamps are in microseconds.
+                ret += fmt::format(
+                    ",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"frame\":{},\"depth\":{}}}}}",
+                    static_cast<f64>(scope.begin_ns - base_ns) / 1000.0,
+                    static_cast<f64>(scope.end_ns - std::min(scope.end_ns, scope.begin_ns)) / 1000.0,
+                    frame.frame_index,
+                    scope.depth);
+            }
+        }
+        ret += "\n]}\n";
+        return ret;
+    }
+
+    void GpuProfiler::write_chrome_trace(std::filesystem::path const & path) const
+    {
+        std::ofstream file{path, std::ios::binary};
+        DAXA_DBG_ASSERT_TRUE_M(file.is_open(), "gpu profiler failed to open chrome trace file for writing");
+        file << this->chrome_trace_json();
+    }
+
+    auto GpuProfiler::info() const -> GpuProfilerInfo const &
+    {
+        return this->m_info;
+    }
+} // namespace daxa
+
+#endif
@@ -1,6 +1,7 @@
 #if DAXA_BUILT_WITH_UTILS_TASK_GRAPH
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <set>
 
@@ -196,6 +197,7 @@ namespace daxa
         case TaskBufferAccess::HOST_TRANSFER_WRITE: return {PipelineStageFlagBits::HOST, AccessTypeFlagBits::WRITE};
         case TaskBufferAccess::INDEX_READ: return {PipelineStageFlagBits::INDEX_INPUT, AccessTypeFlagBits::READ};
         case TaskBufferAccess::DRAW_INDIRECT_INFO_READ: return {PipelineStageFlagBits::DRAW_INDIRECT, AccessTypeFlagBits::READ};
+        case TaskBufferAccess::CONDITIONAL_RENDERING_READ: return {PipelineStageFlagBits::CONDITIONAL_RENDERING, AccessTypeFlagBits::READ};
         default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
         }
         return {};
@@ -252,6 +254,7 @@ namespace daxa
         case daxa::TaskBufferAccess::TRANSFER_WRITE: return std::string_view{"TRANSFER_WRITE"};
         case daxa::TaskBufferAccess::HOST_TRANSFER_READ: return std::string_view{"HOST_TRANSFER_READ"};
         case daxa::TaskBufferAccess::HOST_TRANSFER_WRITE: return std::string_view{"HOST_TRANSFER_WRITE"};
+        case daxa::TaskBufferAccess::CONDITIONAL_RENDERING_READ: return std::string_view{"CONDITIONAL_RENDERING_READ"};
         case daxa::TaskBufferAccess::MAX_ENUM: return std::string_view{"MAX_ENUM"};
         default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
         }
@@ -513,6 +516,73 @@ namespace daxa
             nullptr);
     }
 
+    TransientMemoryHeap::TransientMemoryHeap(TransientMemoryHeapInfo const & info)
+    {
+        this->object = new ImplTransientMemoryHeap(info);
+    }
+
+    ImplTransientMemoryHeap::ImplTransientMemoryHeap(TransientMemoryHeapInfo const & a_info)
+        : info{a_info}
+    {
+    }
+    ImplTransientMemoryHeap::~ImplTransientMemoryHeap() = default;
+
+    void ImplTransientMemoryHeap::fit(MemoryRequirements const & new_requirements)
+    {
+        u32 const memory_type_bits = requirements.memory_type_bits & new_requirements.memory_type_bits;
+        DAXA_DBG_ASSERT_TRUE_M(memory_type_bits != 0, "task graphs sharing a transient memory heap require incompatible memory types");
+        bool const fits =
+            requirements.size >= new_requirements.size &&
+            requirements.alignment >= new_requirements.alignment &&
+            requirements.memory_type_bits == memory_type_bits;
+        if (fits)
+        {
+            return;
+        }
+        requirements = {
+            .size = std::max(requirements.size, new_requirements.size),
+            .alignment = std::max(requirements.alignment, new_requirements.alignment),
+            .memory_type_bits = memory_type_bits,
+        };
+        // The old block stays alive until all resources created from it are destroyed.
+        memory_block = info.device.create_memory({
+            .requirements = requirements,
+            .flags = MemoryFlagBits::DEDICATED_MEMORY,
+            .transient = true,
+        });
+        generation += 1;
+    }
+
+    void ImplTransientMemoryHeap::zero_ref_callback(ImplHandle const * handle)
+    {
+        auto self = r_cast<ImplTransientMemoryHeap const *>(handle);
+        delete self;
+    }
+
+    auto TransientMemoryHeap::info() const -> TransientMemoryHeapInfo const &
+    {
+        auto & impl = *r_cast<ImplTransientMemoryHeap *>(this->object);
+        return impl.info;
+    }
+
+    auto TransientMemoryHeap::size() const -> usize
+    {
+        auto const & impl = *r_cast<ImplTransientMemoryHeap const *>(this->object);
+        return impl.requirements.size;
+    }
+
+    auto TransientMemoryHeap::inc_refcnt(ImplHandle const * object) -> u64
+    {
+        return object->inc_refcnt();
+    }
+
+    auto TransientMemoryHeap::dec_refcnt(ImplHandle const * object) -> u64
+    {
+        return object->dec_refcnt(
+            ImplTransientMemoryHeap::zero_ref_callback,
+            nullptr);
+    }
+
     TaskImage::TaskImage(TaskImageInfo const & a_info)
     {
         this->object = new ImplPersistentTaskImage(a_info);
@@ -625,8 +695,10 @@ namespace daxa
         impl.global_buffer_infos.emplace_back(PermIndepTaskBufferInfo{
             .task_buffer_data = PermIndepTaskBufferInfo::Persistent{
                 .buffer = buffer}});
-        impl.persistent_buffer_index_to_local_index[buffer.view().index] = task_buffer_id.index;
+        impl.persistent_buffer_index_to_local_index.insert(buffer.view().index, task_buffer_id.index);
+#if DAXA_VALIDATION
         impl.buffer_name_to_id[buffer.info().name] = task_buffer_id;
+#endif
     }
 
     void TaskGraph::use_persistent_image(TaskImage const & image)
@@ -656,8 +728,10 @@ namespace daxa
             .task_image_data = PermIndepTaskImageInfo::Persistent{
                 .image = image,
             }});
-        impl.persistent_image_index_to_local_index[image.view().index] = task_image_id.index;
+        impl.persistent_image_index_to_local_index.insert(image.view().index, task_image_id.index);
+#if DAXA_VALIDATION
         impl.image_name_to_id[image.info().name] = task_image_id;
+#endif
     }
 
     auto TaskGraph::create_transient_buffer(TaskTransientBufferInfo const & info) -> TaskBufferView
@@ -677,7 +751,9 @@ namespace daxa
         impl.global_buffer_infos.emplace_back(PermIndepTaskBufferInfo{
             .task_buffer_data = PermIndepTaskBufferInfo::Transient{.info = info_copy}});
 
+#if DAXA_VALIDATION
         impl.buffer_name_to_id[info.name] = task_buffer_id;
+#endif
         return task_buffer_id;
     }
 
@@ -708,10 +784,63 @@ namespace daxa
             .task_image_data = PermIndepTaskImageInfo::Transient{
                 .info = info_copy,
             }});
+#if DAXA_VALIDATION
         impl.image_name_to_id[info.name] = task_image_view;
+#endif
         return task_image_view;
     }
 
+    void TaskGraph::set_transient_extent(std::string const & name, Extent3D extent)
+    {
+        auto & impl = *reinterpret_cast<ImplTaskGraph *>(this->object);
+        auto const iter = impl.transient_extents.find(name);
+        if (iter != impl.transient_extents.end() && iter->second == extent)
+        {
+            return;
+        }
+        impl.transient_extents[name] = extent;
+        if (impl.compiled)
+        {
+            impl.transient_extents_changed = true;
+        }
+    }
+
+    auto scale_transient_extent(Extent3D const & extent, std::array<f32, 3> const & scale) -> Extent3D
+    {
+        auto scale_axis = [](u32 value, f32 factor) -> u32
+        {
+            return std::max(1u, static_cast<u32>(std::ceil(static_cast<f32>(value) * factor)));
+        };
+        return {
+            .x = scale_axis(extent.x, scale[0]),
+            .y = scale_axis(extent.y, scale[1]),
+            .z = scale_axis(extent.z, scale[2]),
+        };
+    }
+
+    auto ImplTaskGraph::transient_buffer_size(TaskTransientBufferInfo const & buffer_info) const -> usize
+    {
+        if (buffer_info.size_extent.empty())
+        {
+            return buffer_info.size;
+        }
+        DAXA_DBG_ASSERT_TRUE_M(transient_extents.contains(buffer_info.size_extent),
+                               std::string("transient buffer \"") + buffer_info.name + "\" is sized relative to extent \"" + buffer_info.size_extent + "\" which was never set");
+        Extent3D const extent = scale_transient_extent(transient_extents.at(buffer_info.size_extent), buffer_info.size_extent_scale);
+        return static_cast<usize>(buffer_info.size) * extent.x * extent.y * extent.z;
+    }
+
+    auto ImplTaskGraph::transient_image_size(TaskTransientImageInfo const & image_info) const -> Extent3D
+    {
+        if (image_info.size_extent.empty())
+        {
+            return image_info.size;
+        }
+        DAXA_DBG_ASSERT_TRUE_M(transient_extents.contains(image_info.size_extent),
+                               std::string("transient image \"") + image_info.name + "\" is sized relative to extent \"" + image_info.size_extent + "\" which was never set");
+        return scale_transient_extent(transient_extents.at(image_info.size_extent), image_info.size_extent_scale);
+    }
+
     auto ImplTaskGraph::get_actual_buffers(TaskBufferView id, TaskGraphPermutation const & perm) const -> std::span<BufferId const>
     {
         auto const & global_buffer = global_buffer_infos.at(id.index);
@@ -744,17 +873,46 @@ namespace daxa
         }
     }
 
+    void PersistentIndexTable::insert(u32 persistent_index, u32 local_index)
+    {
+        if (this->sorted.empty() || this->sorted.back().first < persistent_index)
+        {
+            this->sorted.push_back({persistent_index, local_index});
+            return;
+        }
+        auto const iter = std::lower_bound(
+            this->sorted.begin(), this->sorted.end(), persistent_index,
+            [](std::pair<u32, u32> const & entry, u32 index)
+            { return entry.first < index; });
+        if (iter != this->sorted.end() && iter->first == persistent_index)
+        {
+            iter->second = local_index;
+            return;
+        }
+        this->sorted.insert(iter, {persistent_index, local_index});
+    }
+
+    auto PersistentIndexTable::find(u32 persistent_index) const -> u32
+    {
+        auto const iter = std::lower_bound(
+            this->sorted.begin(), this->sorted.end(), persistent_index,
+            [](std::pair<u32, u32> const & entry, u32 index)
+            { return entry.first < index; });
+        return iter != this->sorted.end() && iter->first == persistent_index ? iter->second : NO_LOCAL_INDEX;
+    }
+
     auto ImplTaskGraph::id_to_local_id(TaskBufferView id) const -> TaskBufferView
     {
         DAXA_DBG_ASSERT_TRUE_M(!id.is_empty(), "detected empty task buffer id. Please make sure to only use initialized task buffer ids.");
         if (id.is_persistent())
         {
+            u32 const local_index = persistent_buffer_index_to_local_index.find(id.index);
             DAXA_DBG_ASSERT_TRUE_M(
-                persistent_buffer_index_to_local_index.contains(id.index),
+                local_index != PersistentIndexTable::NO_LOCAL_INDEX,
                 fmt::format("detected invalid access of persistent task buffer id ({}) in task graph \"{}\"; "
                             "please make sure to declare persistent resource use to each task graph that uses this buffer with the function use_persistent_buffer!",
                             id.index, info.name));
-            return TaskBufferView{{.task_graph_index = this->unique_index, .index = persistent_buffer_index_to_local_index.at(id.index)}};
+            return TaskBufferView{{.task_graph_index = this->unique_index, .index = local_index}};
         }
         else
         {
@@ -772,14 +930,15 @@ namespace daxa
         DAXA_DBG_ASSERT_TRUE_M(!id.is_empty(), "detected empty task image id. Please make sure to only use initialized task image ids.");
         if (id.is_persistent())
         {
+            u32 const local_index = persistent_image_index_to_local_index.find(id.index);
             DAXA_DBG_ASSERT_TRUE_MS(
-                persistent_image_index_to_local_index.contains(id.index),
+                local_index != PersistentIndexTable::NO_LOCAL_INDEX,
                 << "detected invalid access of persistent task image id "
                 << id.index
                 << " in task graph \""
                 << info.name
                 << "\". Please make sure to declare persistent resource use to each task graph that uses this image with the function use_persistent_image!");
-            return TaskImageView{{.task_graph_index = this->unique_index, .index = persistent_image_index_to_local_index.at(id.index)}, id.slice};
+            return TaskImageView{{.task_graph_index = this->unique_index, .index = local_index}, id.slice};
         }
         else
         {
@@ -1064,7 +1223,15 @@ namespace daxa
             .label_color = info.task_label_color,
             .name = std::string("task ") + std::to_string(in_batch_task_index) + std::string(" \"") + task.base_task->get_name() + std::string("\""),
         });
+        if (info.gpu_profiler != nullptr)
+        {
+            info.gpu_profiler->begin_scope(impl_runtime.recorder, task.base_task->get_name());
+        }
         task.base_task->callback(TaskInterface{&impl_runtime});
+        if (info.gpu_profiler != nullptr)
+        {
+            info.gpu_profiler->end_scope(impl_runtime.recorder);
+        }
         impl_runtime.recorder.end_label();
     }
 
@@ -1105,6 +1272,82 @@ namespace daxa
         impl.update_active_permutations();
     }
 
+    void TaskGraph::gpu_conditional(TaskGraphGpuConditionalInfo const & conditional_info)
+    {
+        auto & impl = *reinterpret_cast<ImplTaskGraph *>(this->object);
+        DAXA_DBG_ASSERT_TRUE_M(!impl.compiled, "completed task graphs can not record new tasks");
+        DAXA_DBG_ASSERT_TRUE_M(!impl.record_gpu_condition.has_value(), "can not nest gpu conditionals, vulkan conditional rendering can not be nested");
+        DAXA_DBG_ASSERT_TRUE_M(
+            (impl.info.device.info().flags & DeviceFlagBits::CONDITIONAL_RENDERING) != DeviceFlagBits::NONE,
+            "gpu conditionals require the CONDITIONAL_RENDERING device flag");
+        DAXA_DBG_ASSERT_TRUE_M(conditional_info.condition_offset % 4 == 0, "gpu conditional condition offset must be 4 byte aligned");
+        impl.record_gpu_condition = TaskGpuCondition{
+            .buffer = conditional_info.condition_buffer,
+            .offset = conditional_info.condition_offset,
+            .inverted = false,
+        };
+        if (conditional_info.when_true)
+        {
+            conditional_info.when_true();
+        }
+        impl.record_gpu_condition->inverted = true;
+        if (conditional_info.when_false)
+        {
+            conditional_info.when_false();
+        }
+        impl.record_gpu_condition.reset();
+    }
+
+    GpuConditionalTask::GpuConditionalTask(std::unique_ptr<detail::BaseTask> && a_task, TaskGpuCondition const & a_condition)
+        : task{std::move(a_task)}, condition{a_condition}
+    {
+        auto const task_uses = task->get_generic_uses();
+        uses.reserve(task_uses.size() + 1);
+        uses.insert(uses.end(), task_uses.begin(), task_uses.end());
+        // The condition use has no shader array, it is not part of the task head shader blob.
+        uses.push_back(BufferConditionalRenderingRead{condition.buffer});
+    }
+
+    auto GpuConditionalTask::get_generic_uses() -> std::span<GenericTaskResourceUse>
+    {
+        return std::span{uses.data(), uses.size()};
+    }
+
+    auto GpuConditionalTask::get_generic_uses() const -> std::span<GenericTaskResourceUse const>
+    {
+        return std::span{uses.data(), uses.size()};
+    }
+
+    auto GpuConditionalTask::get_task_head_shader_blob_size() const -> u64
+    {
+        return task->get_task_head_shader_blob_size();
+    }
+
+    auto GpuConditionalTask::get_name() const -> std::string
+    {
+        return task->get_name();
+    }
+
+    auto GpuConditionalTask::has_side_effects() const -> bool
+    {
+        return task->has_side_effects();
+    }
+
+    void GpuConditionalTask::callback(TaskInterface const & ti)
+    {
+        // The task graph translates ids and fills in runtime resources in the uses of this wrapper.
+        // Predeclared tasks access their own uses struct, so it is kept up to date.
+        auto task_uses = task->get_generic_uses();
+        std::copy_n(uses.begin(), task_uses.size(), task_uses.begin());
+        ti.get_recorder().begin_conditional_rendering({
+            .buffer = TaskBufferUse<>::from(uses.back()).buffer(),
+            .offset = condition.offset,
+            .inverted = condition.inverted,
+        });
+        task->callback(ti);
+        ti.get_recorder().end_conditional_rendering();
+    }
+
     void ImplTaskGraph::check_for_overlapping_use(BaseTask & task)
     {
         for_each(
@@ -1157,10 +1400,12 @@ namespace daxa
             });
     }
 
-    auto schedule_task(
-        ImplTaskGraph & impl,
-        TaskGraphPermutation & perm,
-        TaskBatchSubmitScope & current_submit_scope,
+    thread_local std::vector<std::pair<u32, ImageMipArraySlice>> tl_tracked_regions = {};
+    // Finds the earliest batch the task can be inserted into without altering the permutation.
+    auto find_first_possible_batch_index(
+        ImplTaskGraph const & impl,
+        TaskGraphPermutation const & perm,
+        TaskBatchSubmitScope const & current_submit_scope,
         usize const current_submit_scope_index,
         BaseTask & task)
         -> usize
@@ -1203,33 +1448,22 @@ namespace daxa
             [&](u32, TaskImageUse<> const & image_use)
             {
                 PerPermTaskImage const & task_image = perm.image_infos[image_use.handle.index];
-                PermIndepTaskImageInfo const & glob_task_image = impl.global_image_infos[image_use.handle.index];
-                DAXA_DBG_ASSERT_TRUE_M(!task_image.swapchain_semaphore_waited_upon, "swapchain image is already presented!");
-                if (glob_task_image.is_persistent() && glob_task_image.get_persistent().info.swapchain_image)
-                {
-                    if (perm.swapchain_image_first_use_submit_scope_index == std::numeric_limits<u64>::max())
-                    {
-                        perm.swapchain_image_first_use_submit_scope_index = current_submit_scope_index;
-                        perm.swapchain_image_last_use_submit_scope_index = current_submit_scope_index;
-                    }
-                    else
-                    {
-                        perm.swapchain_image_first_use_submit_scope_index = std::min(current_submit_scope_index, perm.swapchain_image_first_use_submit_scope_index);
-                        perm.swapchain_image_last_use_submit_scope_index = std::max(current_submit_scope_index, perm.swapchain_image_last_use_submit_scope_index);
-                    }
-                }
-
                 auto [this_task_image_layout, this_task_image_access] = task_image_access_to_layout_access(image_use.access());
                 // As image subresources can be in different layouts and also different synchronization scopes,
                 // we need to track these image ranges individually.
-                for (ExtendedImageSliceState const & tracked_slice : task_image.last_slice_states)
+                // Only tracked states of subresources the use touches are visited.
+                task_image.last_slice_state_grid.regions(image_use.handle.slice, tl_tracked_regions);
+                for (auto const & [tracked_state_index, tracked_region] : tl_tracked_regions)
                 {
+                    // When the subresources were never used before, we dont need to do any sync or execution ordering.
+                    if (tracked_state_index == ImageSubresourceStateGrid::NO_STATE)
+                    {
+                        continue;
+                    }
+                    ExtendedImageSliceState const & tracked_slice = task_image.last_slice_state_grid.states[tracked_state_index];
                     // If the latest access is in a previous submit scope, the earliest batch we can insert into is
                     // the current scopes first batch.
-                    // When the slices dont intersect, we dont need to do any sync or execution ordering between them.
-                    if (
-                        tracked_slice.latest_access_submit_scope_index < current_submit_scope_index ||
-                        !tracked_slice.state.slice.intersects(image_use.handle.slice))
+                    if (tracked_slice.latest_access_submit_scope_index < current_submit_scope_index)
                     {
                         continue;
                     }
@@ -1249,6 +1483,39 @@ namespace daxa
                     first_possible_batch_index = std::max(first_possible_batch_index, current_image_first_possible_batch_index);
                 }
             });
+        return first_possible_batch_index;
+    }
+
+    auto schedule_task(
+        ImplTaskGraph & impl,
+        TaskGraphPermutation & perm,
+        TaskBatchSubmitScope & current_submit_scope,
+        usize const current_submit_scope_index,
+        BaseTask & task)
+        -> usize
+    {
+        for_each(
+            task.get_generic_uses(),
+            [&](u32, TaskBufferUse<> const &) {},
+            [&](u32, TaskImageUse<> const & image_use)
+            {
+                PermIndepTaskImageInfo const & glob_task_image = impl.global_image_infos[image_use.handle.index];
+                DAXA_DBG_ASSERT_TRUE_M(!perm.image_infos[image_use.handle.index].swapchain_semaphore_waited_upon, "swapchain image is already presented!");
+                if (glob_task_image.is_persistent() && glob_task_image.get_persistent().info.swapchain_image)
+                {
+                    if (perm.swapchain_image_first_use_submit_scope_index == std::numeric_limits<u64>::max())
+                    {
+                        perm.swapchain_image_first_use_submit_scope_index = current_submit_scope_index;
+                        perm.swapchain_image_last_use_submit_scope_index = current_submit_scope_index;
+                    }
+                    else
+                    {
+                        perm.swapchain_image_first_use_submit_scope_index = std::min(current_submit_scope_index, perm.swapchain_image_first_use_submit_scope_index);
+                        perm.swapchain_image_last_use_submit_scope_index = std::max(current_submit_scope_index, perm.swapchain_image_last_use_submit_scope_index);
+                    }
+                }
+            });
+        usize const first_possible_batch_index = find_first_possible_batch_index(impl, perm, current_submit_scope, current_submit_scope_index, task);
         // Make sure we have enough batches.
         if (first_possible_batch_index >= current_submit_scope.task_batches.size())
         {
@@ -1281,11 +1548,18 @@ namespace daxa
     {
         auto & impl = *reinterpret_cast<ImplTaskGraph *>(this->object);
         DAXA_DBG_ASSERT_TRUE_M(!impl.compiled, "completed task graphs can not record new tasks");
+        if (impl.record_gpu_condition.has_value())
+        {
+            base_task = std::make_unique<GpuConditionalTask>(std::move(base_task), impl.record_gpu_condition.value());
+        }
         translate_persistent_ids(impl, *base_task);
+#if DAXA_VALIDATION
         // Overlapping resource uses can be valid in the case of reads in the same layout for example.
         // But in order to make the task graph implementation simpler,
         // daxa does not allow for overlapping use of a resource within a task, even when it is a read in the same layout.
+        // The check is quadratic in the number of uses, so it only runs with validation.
         impl.check_for_overlapping_use(*base_task);
+#endif
 
         TaskId const task_id = impl.tasks.size();
 
@@ -1302,99 +1576,182 @@ namespace daxa
         });
     }
 
-    thread_local std::vector<ImageMipArraySlice> tl_new_access_slices = {};
-    void update_image_initial_access_slices(
-        PerPermTaskImage & task_image,
-        ExtendedImageSliceState new_access_slice)
-    {
-        // We need to test if a new use adds and or subtracts from initial uses.
-        // To do that, we need to test if the new access slice is accessing a subresource BEFORE all other already stored initial access slices.
-        // We compare all new use slices with already tracked first uses.
-        // We intersect the earlier and later happening slices with the new slice and store the intersection rest or the respective later executing slice access.
-        // This list will contain the remainder of the new access ranges after intersections.
-        tl_new_access_slices.push_back(new_access_slice.state.slice);
-        // Name shortening:
-        auto & initial_accesses = task_image.first_slice_states;
-        // Note(pahrens):
-        // NEVER access new_access_slice.slice in this function past this point.
-        // ALWAYS access the new access ImageMipArraySlice's from an iterator or via vector indexing.
-        for (usize new_access_slice_i = 0; new_access_slice_i < tl_new_access_slices.size();)
-        {
-            bool broke_inner_loop = false;
-            for (usize initial_access_i = 0; initial_access_i < task_image.first_slice_states.size();)
-            {
-                bool const slices_disjoint = !tl_new_access_slices[new_access_slice_i].intersects(initial_accesses[initial_access_i].state.slice);
-                bool const same_batch =
-                    new_access_slice.latest_access_submit_scope_index == initial_accesses[initial_access_i].latest_access_submit_scope_index &&
-                    new_access_slice.latest_access_batch_index == initial_accesses[initial_access_i].latest_access_batch_index;
-                // We check if the sets are disjoint.
-                // If they are we do not need to do anything and advance to the next test.
-                // When two accesses are in the same batch and scope, they can not overlap.
-                // This is simply forbidden by task graph rules!
-                if (same_batch || slices_disjoint)
-                {
-                    ++initial_access_i;
-                    continue;
+    void ImageSubresourceStateGrid::fit(ImageMipArraySlice const & slice)
+    {
+        u32 const new_mip_level_count = std::max(this->mip_level_count, slice.base_mip_level + slice.level_count);
+        u32 const new_array_layer_count = std::max(this->array_layer_count, slice.base_array_layer + slice.layer_count);
+        if (new_mip_level_count == this->mip_level_count && new_array_layer_count == this->array_layer_count)
+        {
+            return;
+        }
+        std::vector<u32> new_cells(static_cast<usize>(new_mip_level_count) * new_array_layer_count, NO_STATE);
+        for (u32 mip = 0; mip < this->mip_level_count; ++mip)
+        {
+            std::copy_n(
+                this->cells.begin() + isize(mip * this->array_layer_count),
+                this->array_layer_count,
+                new_cells.begin() + isize(mip * new_array_layer_count));
+        }
+        this->cells = std::move(new_cells);
+        this->mip_level_count = new_mip_level_count;
+        this->array_layer_count = new_array_layer_count;
+    }
+
+    auto ImageSubresourceStateGrid::cell(u32 mip_level, u32 array_layer) -> u32 &
+    {
+        return this->cells[mip_level * this->array_layer_count + array_layer];
+    }
+
+    auto ImageSubresourceStateGrid::state_index(u32 mip_level, u32 array_layer) const -> u32
+    {
+        if (mip_level >= this->mip_level_count || array_layer >= this->array_layer_count)
+        {
+            return NO_STATE;
+        }
+        return this->cells[mip_level * this->array_layer_count + array_layer];
+    }
+
+    auto ImageSubresourceStateGrid::assign(ExtendedImageSliceState const & state) -> u32
+    {
+        auto const & slice = state.state.slice;
+        this->fit(slice);
+        u32 const index = static_cast<u32>(this->states.size());
+        this->states.push_back(state);
+        for (u32 mip = slice.base_mip_level; mip < slice.base_mip_level + slice.level_count; ++mip)
+        {
+            std::fill_n(this->cells.begin() + isize(mip * this->array_layer_count + slice.base_array_layer), slice.layer_count, index);
+        }
+        return index;
+    }
+
+    void ImageSubresourceStateGrid::regions(ImageMipArraySlice const & slice, std::vector<std::pair<u32, ImageMipArraySlice>> & out_regions) const
+    {
+        out_regions.clear();
+        u32 const end_array_layer = slice.base_array_layer + slice.layer_count;
+        // Regions before this index ended at an earlier mip level, they can not be extended anymore.
+        usize open_regions_begin = 0;
+        for (u32 mip = slice.base_mip_level; mip < slice.base_mip_level + slice.level_count; ++mip)
+        {
+            usize const row_regions_begin = out_regions.size();
+            for (u32 layer = slice.base_array_layer; layer < end_array_layer;)
+            {
+                u32 const index = this->state_index(mip, layer);
+                u32 run_end = layer + 1;
+                while (run_end < end_array_layer && this->state_index(mip, run_end) == index)
+                {
+                    ++run_end;
                 }
-                // Now that we have this edge case out the way, we now need to test which tracked slice is executed earlier.
-                bool const new_use_executes_earlier =
-                    new_access_slice.latest_access_submit_scope_index < initial_accesses[initial_access_i].latest_access_submit_scope_index ||
-                    (new_access_slice.latest_access_submit_scope_index == initial_accesses[initial_access_i].latest_access_submit_scope_index &&
-                     new_access_slice.latest_access_batch_index < initial_accesses[initial_access_i].latest_access_batch_index);
-                // When the new use is executing earlier, we subtract from the current initial access slice.
-                // We then replace the current initial access slice with the resulting rest.
-                if (new_use_executes_earlier)
-                {
-                    // When we intersect, we remove the old initial access slice and replace it with the rest of the subtraction.
-                    // We need a copy of this, as we will erase this value from the vector first.
-                    auto const initial_access_slice = initial_accesses[initial_access_i];
-                    // Erase value from vector.
-                    task_image.first_slice_states.erase(initial_accesses.begin() + isize(initial_access_i));
-                    // Subtract ranges.
-                    auto const [slice_rest, slice_rest_count] = initial_access_slice.state.slice.subtract(tl_new_access_slices[new_access_slice_i]);
-                    // Now construct new sub-ranges from the rest of the subtraction.
-                    // We advance the iterator each time.
-                    for (usize rest_i = 0; rest_i < slice_rest_count; ++rest_i)
-                    {
-                        auto rest_tracked_slice = initial_access_slice;
-                        rest_tracked_slice.state.slice = slice_rest[rest_i];
-                        // We insert into the beginning, so we dont recheck these with the current new use slice.
-                        // They are the result of a subtraction therefore disjoint.
-                        task_image.first_slice_states.insert(initial_accesses.begin(), rest_tracked_slice);
-                    }
-                    // We erased, so we implicitly advanced by an element, as erase moves all elements one to the left past the iterator.
-                    // But as we inserted into the front, we need to move the index accordingly to "stay in place".
-                    initial_access_i += slice_rest_count;
-                }
-                // When the new use is executing AFTER the current inital access slice, we subtract the current initial access slice from the new slice.
-                // We then replace the current new access slice with the resulting rest.
-                else
+                bool extended = false;
+                for (usize region_i = open_regions_begin; region_i < row_regions_begin; ++region_i)
+                {
+                    auto & [region_index, region] = out_regions[region_i];
+                    if (region_index == index &&
+                        region.base_array_layer == layer &&
+                        region.layer_count == run_end - layer &&
+                        region.base_mip_level + region.level_count == mip)
+                    {
+                        region.level_count += 1;
+                        extended = true;
+                        break;
+                    }
+                }
+                if (!extended)
                 {
-                    // We subtract the initial use from the new use and append the rest.
-                    auto const [slice_rest, slice_rest_count] = tl_new_access_slices[new_access_slice_i].subtract(initial_accesses[initial_access_i].state.slice);
-                    // We insert the rest of the subtraction into the new use list.
-                    tl_new_access_slices.insert(tl_new_access_slices.end(), slice_rest.begin(), slice_rest.begin() + isize(slice_rest_count));
-                    // We remove the current new use slice, as it intersects with an initial use slice and is later in the list.
-                    tl_new_access_slices.erase(tl_new_access_slices.begin() + isize(new_access_slice_i));
-                    // If we advance the new use index, we restart the inner loop over the initial accesses.
-                    broke_inner_loop = true;
-                    break;
+                    out_regions.push_back({index, ImageMipArraySlice{
+                                                      .base_mip_level = mip,
+                                                      .level_count = 1,
+                                                      .base_array_layer = layer,
+                                                      .layer_count = run_end - layer,
+                                                  }});
                 }
+                layer = run_end;
+            }
+            while (open_regions_begin < out_regions.size() &&
+                   out_regions[open_regions_begin].second.base_mip_level + out_regions[open_regions_begin].second.level_count != mip + 1)
+            {
+                ++open_regions_begin;
             }
-            // When we broke out the inner loop we want to "restart" iteration of the outer loop at the current index.
-            if (!broke_inner_loop)
+        }
+    }
+
+    auto ImageSubresourceStateGrid::slice_states() const -> std::vector<ExtendedImageSliceState>
+    {
+        thread_local std::vector<std::pair<u32, ImageMipArraySlice>> tl_regions = {};
+        this->regions({.base_mip_level = 0, .level_count = this->mip_level_count, .base_array_layer = 0, .layer_count = this->array_layer_count}, tl_regions);
+        std::vector<ExtendedImageSliceState> ret = {};
+        for (auto const & [index, region] : tl_regions)
+        {
+            if (index == NO_STATE)
             {
-                ++new_access_slice_i;
+                continue;
             }
+            ret.push_back(this->states[index]);
+            ret.back().state.slice = region;
         }
-        // Add the newly found initial access slices to the list of initial access slices.
-        for (auto const & new_slice : tl_new_access_slices)
+        return ret;
+    }
+
+    thread_local std::vector<std::pair<u32, u32>> tl_merged_first_states = {};
+    void update_image_initial_access_slices(
+        PerPermTaskImage & task_image,
+        ExtendedImageSliceState const & new_access_slice)
+    {
+        // We need to test if a new use adds to the initial uses.
+        // A subresource takes the new access as its initial access when it was not accessed before
+        // or when the new access executes BEFORE its currently tracked initial access.
+        auto & initial_accesses = task_image.first_slice_state_grid;
+        auto const & slice = new_access_slice.state.slice;
+        initial_accesses.fit(slice);
+        u32 new_state_index = ImageSubresourceStateGrid::NO_STATE;
+        for (u32 mip = slice.base_mip_level; mip < slice.base_mip_level + slice.level_count; ++mip)
         {
-            auto new_tracked_slice = new_access_slice;
-            new_tracked_slice.state.slice = new_slice;
-            initial_accesses.push_back(new_tracked_slice);
+            for (u32 layer = slice.base_array_layer; layer < slice.base_array_layer + slice.layer_count; ++layer)
+            {
+                u32 & state_index = initial_accesses.cell(mip, layer);
+                if (state_index != ImageSubresourceStateGrid::NO_STATE)
+                {
+                    ExtendedImageSliceState const initial_access = initial_accesses.states[state_index];
+                    bool const same_batch =
+                        new_access_slice.latest_access_submit_scope_index == initial_access.latest_access_submit_scope_index &&
+                        new_access_slice.latest_access_batch_index == initial_access.latest_access_batch_index;
+                    // Accesses in the same batch can only overlap when both are reads in the same layout.
+                    // Both are initial accesses, so we combine them into one state.
+                    if (same_batch)
+                    {
+                        auto merged_iter = std::find_if(
+                            tl_merged_first_states.begin(), tl_merged_first_states.end(),
+                            [&](auto const & pair)
+                            { return pair.first == state_index; });
+                        if (merged_iter == tl_merged_first_states.end())
+                        {
+                            auto merged_access = initial_access;
+                            merged_access.state.latest_access = merged_access.state.latest_access | new_access_slice.state.latest_access;
+                            initial_accesses.states.push_back(merged_access);
+                            merged_iter = tl_merged_first_states.insert(
+                                tl_merged_first_states.end(),
+                                {state_index, static_cast<u32>(initial_accesses.states.size() - 1)});
+                        }
+                        state_index = merged_iter->second;
+                        continue;
+                    }
+                    bool const new_use_executes_earlier =
+                        new_access_slice.latest_access_submit_scope_index < initial_access.latest_access_submit_scope_index ||
+                        (new_access_slice.latest_access_submit_scope_index == initial_access.latest_access_submit_scope_index &&
+                         new_access_slice.latest_access_batch_index < initial_access.latest_access_batch_index);
+                    if (!new_use_executes_earlier)
+                    {
+                        continue;
+                    }
+                }
+                if (new_state_index == ImageSubresourceStateGrid::NO_STATE)
+                {
+                    new_state_index = static_cast<u32>(initial_accesses.states.size());
+                    initial_accesses.states.push_back(new_access_slice);
+                }
+                state_index = new_state_index;
+            }
         }
-        tl_new_access_slices.clear();
+        tl_merged_first_states.clear();
     }
 
     using ShaderUseIdOffsetTable = std::vector<Variant<std::pair<TaskImageView, usize>, std::pair<TaskBufferView, usize>, Monostate>>;
@@ -1420,9 +1777,6 @@ namespace daxa
         }
     }
 
-    // I hate this function.
-    thread_local std::vector<ExtendedImageSliceState> tl_tracked_slice_rests = {};
-    thread_local std::vector<ImageMipArraySlice> tl_new_use_slices = {};
     void TaskGraphPermutation::add_task(
         TaskId task_id,
         ImplTaskGraph & task_graph_impl,
@@ -1638,11 +1992,6 @@ namespace daxa
                 task_image.usage |= access_to_usage(used_image_t_access);
                 auto [current_image_layout, current_image_access] = task_image_access_to_layout_access(used_image_t_access);
                 image_use.m_layout = current_image_layout;
-                // Now this seems strange, why would be need multiple current use slices, as we only have one here.
-                // This is because when we intersect this slice with the tracked slices, we get an intersection and a rest.
-                // We need to then test the rest against all the remaining tracked uses,
-                // as the intersected part is already beeing handled in the following code.
-                tl_new_use_slices.push_back(initial_used_image_slice);
                 // This is the tracked slice we will insert after we finished analyzing the current used image.
                 ExtendedImageSliceState ret_new_use_tracked_slice{
                     .state = {
@@ -1658,182 +2007,112 @@ namespace daxa
                 update_image_initial_access_slices(task_image, ret_new_use_tracked_slice);
                 // As image subresources can be in different layouts and also different synchronization scopes,
                 // we need to track these image ranges individually.
-                for (
-                    auto tracked_slice_iter = task_image.last_slice_states.begin();
-                    tracked_slice_iter != task_image.last_slice_states.end();)
-                {
-                    bool advanced_tracked_slice_iterator = false;
-                    for (
-                        auto used_image_slice_iter = tl_new_use_slices.begin();
-                        used_image_slice_iter != tl_new_use_slices.end();)
-                    {
-                        // We make a local copy of both slices here.
-                        // We can not rely on dereferencing the iterators, as we modify them in this function.
-                        // For this inner loop we want to remember the information about these slices,
-                        // even after they are removed from their respective vector.
-                        ImageMipArraySlice const used_image_slice = *used_image_slice_iter;
-                        ExtendedImageSliceState const tracked_slice = *tracked_slice_iter;
-                        // We are only interested in intersecting ranges, as use of non intersecting ranges does not need synchronization.
-                        if (!used_image_slice.intersects(tracked_slice.state.slice))
-                        {
-                            // We only need to advance the iterator manually here.
-                            // After this if statement there is an unconditional erase that advances the iterator if this is not hit.
-                            ++used_image_slice_iter;
-                            continue;
-                        }
-                        // As we found an intersection, part of the old tracked slice must be altered.
-                        // Instead of altering it we remove it and add the rest slices back in later.
-                        used_image_slice_iter = tl_new_use_slices.erase(used_image_slice_iter);
-                        // Now we know that the new use intersects slices with a previous use.
-                        // This means that we need to find the intersecting part,
-                        // sync the intersecting part from the previous use to the current use
-                        // and remove the overlapping part from the tracked slice.
-                        // Now we need to split the uses into three groups:
-                        // * the slice that is the intersection of tracked image slice and current new use (intersection)
-                        // * the part of the tracked image slice that does not intersect with the current new use (tracked_slice_rest)
-                        // * the part of the current new use slice that does not intersect with the tracked image (new_use_slice_rest)
-                        auto intersection = tracked_slice.state.slice.intersect(used_image_slice);
-                        auto [tracked_slice_rest, tracked_slice_rest_count] = tracked_slice.state.slice.subtract(intersection);
-                        auto [new_use_slice_rest, new_use_slice_rest_count] = used_image_slice.subtract(intersection);
-                        // We now remove the old tracked slice from the list of tracked slices, as we just split it.
-                        // We need to know if the iterator was advanced. This erase advances the iterator.
-                        // If the iterator got not advanced by this we need to advance it ourself manually later.
-                        advanced_tracked_slice_iterator = true;
-                        tracked_slice_iter = task_image.last_slice_states.erase(tracked_slice_iter);
-                        // Now we remember the left over slice from the original tracked slice.
-                        for (usize rest_i = 0; rest_i < tracked_slice_rest_count; ++rest_i)
-                        {
-                            // The rest tracked slices are the same as the original tracked slice,
-                            // except for the slice itself, which is the remainder of the subtraction of the intersection.
-                            ExtendedImageSliceState current_rest_tracked_slice = tracked_slice;
-                            current_rest_tracked_slice.state.slice = tracked_slice_rest[rest_i];
-                            tl_tracked_slice_rests.push_back(current_rest_tracked_slice);
-                        }
-                        // Now we remember the left over slice from our current used slice.
-                        for (usize rest_i = 0; rest_i < new_use_slice_rest_count; ++rest_i)
+                // The used slice is split into regions of subresources that share their tracked state.
+                // Each region is the intersection of the new use with one previous use and is synchronized on its own.
+                task_image.last_slice_state_grid.regions(initial_used_image_slice, tl_tracked_regions);
+                for (auto const & [tracked_state_index, intersection] : tl_tracked_regions)
+                {
+                    // Subresources without previous use within the graph are synchronized from their initial state.
+                    if (tracked_state_index == ImageSubresourceStateGrid::NO_STATE)
+                    {
+                        continue;
+                    }
+                    // Copy of the previous use state of the subresources in this region.
+                    ExtendedImageSliceState const tracked_slice = task_image.last_slice_state_grid.states[tracked_state_index];
+                    // Every other access (NONE, READ_WRITE, WRITE) are interpreted as writes in this context.
+                    // When the last use was a read AND the new use of the buffer is a read AND,
+                    // we need to add our stage flags to the existing barrier of the last use.
+                    // To be able to do this the layout of the image slice must also match.
+                    // If they differ we need to insert an execution barrier with a layout transition.
+                    bool const is_last_access_read = tracked_slice.state.latest_access.type == AccessTypeFlagBits::READ;
+                    bool const is_current_access_read = current_image_access.type == AccessTypeFlagBits::READ;
+                    bool const are_layouts_identical = tracked_slice.state.latest_layout == current_image_layout;
+                    if (is_last_access_read && is_current_access_read && are_layouts_identical)
+                    {
+                        if (LastReadSplitBarrierIndex const * index0 = daxa::get_if<LastReadSplitBarrierIndex>(&tracked_slice.latest_access_read_barrier_index))
                         {
-                            // We reassign the iterator here as it is getting invalidated by the insert.
-                            // The new iterator points to the newly inserted element.
-                            // When the next iteration of the outer for loop starts, all these elements get skipped.
-                            // This is good as these elements do NOT intersect with the currently inspected tracked slice.
-                            used_image_slice_iter = tl_new_use_slices.insert(
-                                tl_new_use_slices.end(),
-                                new_use_slice_rest[rest_i]);
+                            auto & last_read_split_barrier = this->split_barriers[index0->index];
+                            last_read_split_barrier.dst_access = last_read_split_barrier.dst_access | tracked_slice.state.latest_access;
                         }
-                        // Every other access (NONE, READ_WRITE, WRITE) are interpreted as writes in this context.
-                        // When the last use was a read AND the new use of the buffer is a read AND,
-                        // we need to add our stage flags to the existing barrier of the last use.
-                        // To be able to do this the layout of the image slice must also match.
-                        // If they differ we need to insert an execution barrier with a layout transition.
-                        bool const is_last_access_read = tracked_slice.state.latest_access.type == AccessTypeFlagBits::READ;
-                        bool const is_current_access_read = current_image_access.type == AccessTypeFlagBits::READ;
-                        bool const are_layouts_identical = tracked_slice.state.latest_layout == current_image_layout;
-                        if (is_last_access_read && is_current_access_read && are_layouts_identical)
+                        else if (LastReadBarrierIndex const * index1 = daxa::get_if<LastReadBarrierIndex>(&tracked_slice.latest_access_read_barrier_index))
                         {
-                            if (LastReadSplitBarrierIndex const * index0 = daxa::get_if<LastReadSplitBarrierIndex>(&tracked_slice.latest_access_read_barrier_index))
-                            {
-                                auto & last_read_split_barrier = this->split_barriers[index0->index];
-                                last_read_split_barrier.dst_access = last_read_split_barrier.dst_access | tracked_slice.state.latest_access;
-                            }
-                            else if (LastReadBarrierIndex const * index1 = daxa::get_if<LastReadBarrierIndex>(&tracked_slice.latest_access_read_barrier_index))
-                            {
-                                auto & last_read_barrier = this->barriers[index1->index];
-                                last_read_barrier.dst_access = last_read_barrier.dst_access | tracked_slice.state.latest_access;
-                            }
+                            auto & last_read_barrier = this->barriers[index1->index];
+                            last_read_barrier.dst_access = last_read_barrier.dst_access | tracked_slice.state.latest_access;
                         }
-                        else
+                    }
+                    else
+                    {
+                        // When the uses are incompatible (no read on read, or no identical layout) we need to insert a new barrier.
+                        // Host access needs to be handled in a specialized way.
+                        bool const src_host_only_access = tracked_slice.state.latest_access.stages == PipelineStageFlagBits::HOST;
+                        bool const dst_host_only_access = current_image_access.stages == PipelineStageFlagBits::HOST;
+                        DAXA_DBG_ASSERT_TRUE_M(!(src_host_only_access && dst_host_only_access), "direct sync between two host accesses on gpu is not allowed");
+                        bool const is_host_barrier = src_host_only_access || dst_host_only_access;
+                        // When the distance between src and dst batch is one, we can replace the split barrier with a normal barrier.
+                        // We also need to make sure we do not use split barriers when the src or dst stage exclusively uses the host stage.
+                        // This is because the host stage does not declare an execution dependency on the cpu but only a memory dependency.
+                        bool const use_pipeline_barrier =
+                            (tracked_slice.latest_access_batch_index + 1 == batch_index &&
+                             current_submit_scope_index == tracked_slice.latest_access_submit_scope_index) ||
+                            is_host_barrier;
+                        if (use_pipeline_barrier)
                         {
-                            // When the uses are incompatible (no read on read, or no identical layout) we need to insert a new barrier.
-                            // Host access needs to be handled in a specialized way.
-                            bool const src_host_only_access = tracked_slice.state.latest_access.stages == PipelineStageFlagBits::HOST;
-                            bool const dst_host_only_access = current_image_access.stages == PipelineStageFlagBits::HOST;
-                            DAXA_DBG_ASSERT_TRUE_M(!(src_host_only_access && dst_host_only_access), "direct sync between two host accesses on gpu is not allowed");
-                            bool const is_host_barrier = src_host_only_access || dst_host_only_access;
-                            // When the distance between src and dst batch is one, we can replace the split barrier with a normal barrier.
-                            // We also need to make sure we do not use split barriers when the src or dst stage exclusively uses the host stage.
-                            // This is because the host stage does not declare an execution dependency on the cpu but only a memory dependency.
-                            bool const use_pipeline_barrier =
-                                (tracked_slice.latest_access_batch_index + 1 == batch_index &&
-                                 current_submit_scope_index == tracked_slice.latest_access_submit_scope_index) ||
-                                is_host_barrier;
-                            if (use_pipeline_barrier)
+                            usize const barrier_index = this->barriers.size();
+                            this->barriers.push_back(TaskBarrier{
+                                .image_id = used_image_t_id,
+                                .slice = intersection,
+                                .layout_before = tracked_slice.state.latest_layout,
+                                .layout_after = current_image_layout,
+                                .src_access = tracked_slice.state.latest_access,
+                                .dst_access = current_image_access,
+                            });
+                            // And we insert the barrier index into the list of pipeline barriers of the current tasks batch.
+                            batch.pipeline_barrier_indices.push_back(barrier_index);
+                            if (current_image_access.type == AccessTypeFlagBits::READ)
                             {
-                                usize const barrier_index = this->barriers.size();
-                                this->barriers.push_back(TaskBarrier{
+                                // As the new access is a read we remember our barrier index,
+                                // So that potential future reads after this can reuse this barrier.
+                                ret_new_use_tracked_slice.latest_access_read_barrier_index = LastReadBarrierIndex{barrier_index};
+                            }
+                        }
+                        else
+                        {
+                            usize const split_barrier_index = this->split_barriers.size();
+                            this->split_barriers.push_back(TaskSplitBarrier{
+                                {
                                     .image_id = used_image_t_id,
                                     .slice = intersection,
                                     .layout_before = tracked_slice.state.latest_layout,
                                     .layout_after = current_image_layout,
                                     .src_access = tracked_slice.state.latest_access,
                                     .dst_access = current_image_access,
-                                });
-                                // And we insert the barrier index into the list of pipeline barriers of the current tasks batch.
-                                batch.pipeline_barrier_indices.push_back(barrier_index);
-                                if (current_image_access.type == AccessTypeFlagBits::READ)
-                                {
-                                    // As the new access is a read we remember our barrier index,
-                                    // So that potential future reads after this can reuse this barrier.
-                                    ret_new_use_tracked_slice.latest_access_read_barrier_index = LastReadBarrierIndex{barrier_index};
-                                }
+                                },
+                                /* .split_barrier_state = */ task_graph_impl.info.device.create_event({
+                                    .name = std::string("tg \"") + task_graph_impl.info.name + "\" sbi " + std::to_string(split_barrier_index),
+                                }),
+                            });
+                            // Now we give the src batch the index of this barrier to signal.
+                            TaskBatchSubmitScope & src_scope = this->batch_submit_scopes[tracked_slice.latest_access_submit_scope_index];
+                            TaskBatch & src_batch = src_scope.task_batches[tracked_slice.latest_access_batch_index];
+                            src_batch.signal_split_barrier_indices.push_back(split_barrier_index);
+                            // And we also insert the split barrier index into the waits of the current tasks batch.
+                            batch.wait_split_barrier_indices.push_back(split_barrier_index);
+                            if (current_image_access.type == AccessTypeFlagBits::READ)
+                            {
+                                // As the new access is a read we remember our barrier index,
+                                // So that potential future reads after this can reuse this barrier.
+                                ret_new_use_tracked_slice.latest_access_read_barrier_index = LastReadSplitBarrierIndex{split_barrier_index};
                             }
                             else
                             {
-                                usize const split_barrier_index = this->split_barriers.size();
-                                this->split_barriers.push_back(TaskSplitBarrier{
-                                    {
-                                        .image_id = used_image_t_id,
-                                        .slice = intersection,
-                                        .layout_before = tracked_slice.state.latest_layout,
-                                        .layout_after = current_image_layout,
-                                        .src_access = tracked_slice.state.latest_access,
-                                        .dst_access = current_image_access,
-                                    },
-                                    /* .split_barrier_state = */ task_graph_impl.info.device.create_event({
-                                        .name = std::string("tg \"") + task_graph_impl.info.name + "\" sbi " + std::to_string(split_barrier_index),
-                                    }),
-                                });
-                                // Now we give the src batch the index of this barrier to signal.
-                                TaskBatchSubmitScope & src_scope = this->batch_submit_scopes[tracked_slice.latest_access_submit_scope_index];
-                                TaskBatch & src_batch = src_scope.task_batches[tracked_slice.latest_access_batch_index];
-                                src_batch.signal_split_barrier_indices.push_back(split_barrier_index);
-                                // And we also insert the split barrier index into the waits of the current tasks batch.
-                                batch.wait_split_barrier_indices.push_back(split_barrier_index);
-                                if (current_image_access.type == AccessTypeFlagBits::READ)
-                                {
-                                    // As the new access is a read we remember our barrier index,
-                                    // So that potential future reads after this can reuse this barrier.
-                                    ret_new_use_tracked_slice.latest_access_read_barrier_index = LastReadSplitBarrierIndex{split_barrier_index};
-                                }
-                                else
-                                {
-                                    ret_new_use_tracked_slice.latest_access_read_barrier_index = Monostate{};
-                                }
+                                ret_new_use_tracked_slice.latest_access_read_barrier_index = Monostate{};
                             }
                         }
-                        // Make sure we have any tracked slices to intersect with left.
-                        if (tracked_slice_iter == task_image.last_slice_states.end())
-                        {
-                            break;
-                        }
-                    }
-                    if (!advanced_tracked_slice_iterator)
-                    {
-                        // If we didn't find any intersections, we dont remove the tracked slice.
-                        // Erasing a tracked slice "advances" iterator. As we did not remove,
-                        // we need to advance it manually.
-                        ++tracked_slice_iter;
                     }
                 }
-                tl_new_use_slices.clear();
-                // Now we need to add the latest use and tracked range of our current access:
-                task_image.last_slice_states.push_back(ret_new_use_tracked_slice);
-                // The remainder tracked slices we remembered from earlier are now inserted back into the list of tracked slices.
-                // We deferred this step as we dont want to check these in the loop above, as we found them to not intersect with the new use.
-                task_image.last_slice_states.insert(
-                    task_image.last_slice_states.end(),
-                    tl_tracked_slice_rests.begin(),
-                    tl_tracked_slice_rests.end());
-                tl_tracked_slice_rests.clear();
+                // Now we need to add the latest use and tracked range of our current access.
+                // It replaces the tracked state of all used subresources.
+                task_image.last_slice_state_grid.assign(ret_new_use_tracked_slice);
             });
     }
 
@@ -1881,13 +2160,13 @@ namespace daxa
 
         ExtendedImageSliceState default_slice;
         ExtendedImageSliceState const * tracked_slice = {};
-        if (this->image_infos[this->swapchain_image.index].last_slice_states.empty())
+        if (this->image_infos[this->swapchain_image.index].last_slice_state_grid.states.empty())
         {
             tracked_slice = &default_slice;
         }
         else
         {
-            tracked_slice = &this->image_infos[this->swapchain_image.index].last_slice_states.back();
+            tracked_slice = &this->image_infos[this->swapchain_image.index].last_slice_state_grid.states.back();
         }
         usize const submit_scope_index = tracked_slice->latest_access_submit_scope_index;
         DAXA_DBG_ASSERT_TRUE_M(submit_scope_index < this->batch_submit_scopes.size() - 1, "the last swapchain image use MUST be before the last submit when presenting");
@@ -1922,7 +2201,7 @@ namespace daxa
 
                 perm_buffer.actual_buffer = info.device.create_buffer_from_memory_block(MemoryBlockBufferInfo{
                     .buffer_info = BufferInfo{
-                        .size = transient_info.info.size,
+                        .size = transient_buffer_size(transient_info.info),
                         .name = transient_info.info.name,
                     },
                     .memory_block = transient_data_memory_block,
@@ -1952,7 +2231,7 @@ namespace daxa
                             .flags = daxa::ImageCreateFlagBits::ALLOW_ALIAS,
                             .dimensions = transient_image_info.dimensions,
                             .format = transient_image_info.format,
-                            .size = transient_image_info.size,
+                            .size = transient_image_size(transient_image_info),
                             .mip_level_count = transient_image_info.mip_level_count,
                             .array_layer_count = transient_image_info.array_layer_count,
                             .sample_count = transient_image_info.sample_count,
@@ -1966,6 +2245,52 @@ namespace daxa
         }
     }
 
+    void ImplTaskGraph::destroy_transient_runtime_resources(TaskGraphPermutation & permutation)
+    {
+        // because transient buffers are owned by the task graph, we need to destroy them
+        for (u32 buffer_info_idx = 0; buffer_info_idx < static_cast<u32>(global_buffer_infos.size()); buffer_info_idx++)
+        {
+            auto const & global_buffer = global_buffer_infos.at(buffer_info_idx);
+            auto & perm_buffer = permutation.buffer_infos.at(buffer_info_idx);
+            if (!global_buffer.is_persistent() && perm_buffer.valid && info.device.is_id_valid(perm_buffer.actual_buffer))
+            {
+                info.device.destroy_buffer(perm_buffer.actual_buffer);
+                perm_buffer.actual_buffer = {};
+            }
+        }
+        // because transient images are owned by the task graph, we need to destroy them
+        for (u32 image_info_idx = 0; image_info_idx < static_cast<u32>(global_image_infos.size()); image_info_idx++)
+        {
+            auto const & global_image = global_image_infos.at(image_info_idx);
+            auto & perm_image = permutation.image_infos.at(image_info_idx);
+            if (!global_image.is_persistent() && perm_image.valid && info.device.is_id_valid(perm_image.actual_image))
+            {
+                info.device.destroy_image(perm_image.actual_image);
+                perm_image.actual_image = {};
+            }
+        }
+    }
+
+    void ImplTaskGraph::reallocate_transient_resources()
+    {
+        // Destroyed resources and the old memory block are zombies, they stay alive until the gpu is done with them.
+        // The schedule, lifetimes and barriers of the permutations do not depend on the resource sizes and are kept.
+        for (auto & permutation : permutations)
+        {
+            destroy_transient_runtime_resources(permutation);
+        }
+        memory_block_size = {};
+        memory_type_bits = 0xFFFFFFFFu;
+        transient_data_memory_block = {};
+        allocate_transient_resources();
+        for (auto & permutation : permutations)
+        {
+            create_transient_runtime_buffers(permutation);
+            create_transient_runtime_images(permutation);
+        }
+        transient_extents_changed = false;
+    }
+
     void ImplTaskGraph::allocate_transient_resources()
     {
         usize transient_resource_count = 0;
@@ -1979,7 +2304,7 @@ namespace daxa
                 ImageInfo const image_info = {
                     .dimensions = transient_image.info.dimensions,
                     .format = transient_image.info.format,
-                    .size = transient_image.info.size,
+                    .size = transient_image_size(transient_image.info),
                     .mip_level_count = transient_image.info.mip_level_count,
                     .array_layer_count = transient_image.info.array_layer_count,
                     .sample_count = transient_image.info.sample_count,
@@ -1998,7 +2323,7 @@ namespace daxa
                 transient_resource_count += 1;
                 auto & transient_buffer = daxa::get<PermIndepTaskBufferInfo::Transient>(global_buffer.task_buffer_data);
                 BufferInfo const buffer_info = {
-                    .size = transient_buffer.info.size,
+                    .size = transient_buffer_size(transient_buffer.info),
                     .allocate_info = MemoryFlagBits::DEDICATED_MEMORY,
                     .name = "Dummy to figure mem requirements"};
                 transient_buffer.memory_requirements = info.device.get_memory_requirements({buffer_info});
@@ -2220,14 +2545,460 @@ namespace daxa
             }
         }
 
-        transient_data_memory_block = info.device.create_memory({
-            .requirements = {
-                .size = memory_block_size,
-                .alignment = max_alignment_requirement,
-                .memory_type_bits = memory_type_bits,
-            },
-            .flags = MemoryFlagBits::DEDICATED_MEMORY,
-        });
+        MemoryRequirements const requirements = {
+            .size = memory_block_size,
+            .alignment = max_alignment_requirement,
+            .memory_type_bits = memory_type_bits,
+        };
+        if (info.transient_memory_heap.has_value())
+        {
+            auto & heap = **r_cast<ImplTransientMemoryHeap **>(&info.transient_memory_heap.value());
+            heap.fit(requirements);
+            transient_data_memory_block = heap.memory_block;
+            transient_memory_heap_generation = heap.generation;
+        }
+        else
+        {
+            transient_data_memory_block = info.device.create_memory({
+                .requirements = requirements,
+                .flags = MemoryFlagBits::DEDICATED_MEMORY,
+                .transient = true,
+            });
+        }
+    }
+
+    thread_local std::vector<TaskBarrier> tl_unmerged_image_barriers = {};
+    void ImplTaskGraph::merge_batch_barriers(TaskGraphPermutation & permutation)
+    {
+        // All barriers before a batch are waited on at the same point, so their memory dependencies can be combined.
+        // The combined barrier may order a few more stages than needed, but saves recording one barrier per buffer.
+        for (auto & submit_scope : permutation.batch_submit_scopes)
+        {
+            for (auto & task_batch : submit_scope.task_batches)
+            {
+                task_batch.merged_barriers.clear();
+                std::optional<TaskBarrier> memory_barrier = {};
+                tl_unmerged_image_barriers.clear();
+                auto collect = [&](TaskBarrier const & barrier)
+                {
+                    if (barrier.image_id.is_empty())
+                    {
+                        if (!memory_barrier.has_value())
+                        {
+                            memory_barrier = TaskBarrier{};
+                        }
+                        memory_barrier->src_access = memory_barrier->src_access | barrier.src_access;
+                        memory_barrier->dst_access = memory_barrier->dst_access | barrier.dst_access;
+                    }
+                    else
+                    {
+                        tl_unmerged_image_barriers.push_back(barrier);
+                    }
+                };
+                for (auto barrier_index : task_batch.pipeline_barrier_indices)
+                {
+                    collect(permutation.barriers[barrier_index]);
+                }
+                if (!info.use_split_barriers)
+                {
+                    // Convert split barriers to normal barriers.
+                    for (auto barrier_index : task_batch.wait_split_barrier_indices)
+                    {
+                        collect(permutation.split_barriers[barrier_index]);
+                    }
+                }
+                if (memory_barrier.has_value())
+                {
+                    task_batch.merged_barriers.push_back(memory_barrier.value());
+                }
+                // Grouping the image barriers by image keeps merging linear in the number of images.
+                std::stable_sort(
+                    tl_unmerged_image_barriers.begin(), tl_unmerged_image_barriers.end(),
+                    [](TaskBarrier const & a, TaskBarrier const & b)
+                    { return a.image_id.index < b.image_id.index; });
+                usize image_group_begin = task_batch.merged_barriers.size();
+                for (auto const & barrier : tl_unmerged_image_barriers)
+                {
+                    if (image_group_begin < task_batch.merged_barriers.size() &&
+                        task_batch.merged_barriers[image_group_begin].image_id.index != barrier.image_id.index)
+                    {
+                        image_group_begin = task_batch.merged_barriers.size();
+                    }
+                    // Image barriers can only be merged when they transition the same subresources between the same layouts.
+                    bool merged = false;
+                    for (usize merged_index = image_group_begin; merged_index < task_batch.merged_barriers.size(); ++merged_index)
+                    {
+                        auto & merged_barrier = task_batch.merged_barriers[merged_index];
+                        if (merged_barrier.image_id == barrier.image_id &&
+                            merged_barrier.slice == barrier.slice &&
+                            merged_barrier.layout_before == barrier.layout_before &&
+                            merged_barrier.layout_after == barrier.layout_after)
+                        {
+                            merged_barrier.src_access = merged_barrier.src_access | barrier.src_access;
+                            merged_barrier.dst_access = merged_barrier.dst_access | barrier.dst_access;
+                            merged = true;
+                            break;
+                        }
+                    }
+                    if (!merged)
+                    {
+                        task_batch.merged_barriers.push_back(barrier);
+                    }
+                }
+            }
+        }
+    }
+
+    auto permutation_schedule_stats(TaskGraphPermutation const & permutation) -> TaskGraphScheduleStats
+    {
+        TaskGraphScheduleStats stats = {
+            .submit_scope_count = static_cast<u32>(permutation.batch_submit_scopes.size()),
+            .batch_count = 0,
+            .barrier_count = static_cast<u32>(permutation.barriers.size()),
+            .split_barrier_count = static_cast<u32>(permutation.split_barriers.size()),
+        };
+        for (auto const & submit_scope : permutation.batch_submit_scopes)
+        {
+            stats.batch_count += static_cast<u32>(submit_scope.task_batches.size());
+            for (auto const & task_batch : submit_scope.task_batches)
+            {
+                stats.merged_barrier_count += static_cast<u32>(task_batch.merged_barriers.size());
+            }
+        }
+        return stats;
+    }
+
+    struct TaskDependencyImageUse
+    {
+        ImageMipArraySlice slice = {};
+        usize task = {};
+        bool read = {};
+    };
+
+    struct TaskDependencyBufferUses
+    {
+        usize last_write = std::numeric_limits<usize>::max();
+        std::vector<usize> reads_since_write = {};
+    };
+
+    // Builds the dependency graph between the tasks of one submit scope.
+    // Reads of a resource only depend on the previous write, so they can be reordered freely between two writes.
+    // The tasks are given in recording order, dependencies therefore always point from a lower to a higher index.
+    void build_task_dependencies(
+        ImplTaskGraph & impl,
+        std::span<TaskId const> tasks,
+        std::vector<std::vector<usize>> & successors,
+        std::vector<u32> & predecessor_counts)
+    {
+        successors.assign(tasks.size(), {});
+        predecessor_counts.assign(tasks.size(), 0);
+        std::vector<TaskDependencyBufferUses> buffer_uses(impl.global_buffer_infos.size());
+        std::vector<std::vector<TaskDependencyImageUse>> image_uses(impl.global_image_infos.size());
+        auto add_dependency = [&](usize from, usize to)
+        {
+            if (from != std::numeric_limits<usize>::max() && from != to)
+            {
+                successors[from].push_back(to);
+                predecessor_counts[to] += 1;
+            }
+        };
+        for (usize task_i = 0; task_i < tasks.size(); ++task_i)
+        {
+            for_each(
+                impl.tasks[tasks[task_i]].base_task->get_generic_uses(),
+                [&](u32, TaskBufferUse<> const & buffer_use)
+                {
+                    auto & uses = buffer_uses[buffer_use.handle.index];
+                    add_dependency(uses.last_write, task_i);
+                    if (task_buffer_access_to_access(buffer_use.access()).type == AccessTypeFlagBits::READ)
+                    {
+                        uses.reads_since_write.push_back(task_i);
+                    }
+                    else
+                    {
+                        for (usize const read_task_i : uses.reads_since_write)
+                        {
+                            add_dependency(read_task_i, task_i);
+                        }
+                        uses.reads_since_write.clear();
+                        uses.last_write = task_i;
+                    }
+                },
+                [&](u32, TaskImageUse<> const & image_use)
+                {
+                    auto & uses = image_uses[image_use.handle.index];
+                    bool const read = std::get<1>(task_image_access_to_layout_access(image_use.access())).type == AccessTypeFlagBits::READ;
+                    for (auto const & previous_use : uses)
+                    {
+                        if (!(read && previous_use.read) && previous_use.slice.intersects(image_use.handle.slice))
+                        {
+                            add_dependency(previous_use.task, task_i);
+                        }
+                    }
+                    if (!read)
+                    {
+                        // Uses covered by this write are ordered before it, later uses only need to depend on the write.
+                        std::erase_if(uses, [&](TaskDependencyImageUse const & previous_use)
+                                      { return previous_use.task != task_i && image_use.handle.slice.contains(previous_use.slice); });
+                    }
+                    uses.push_back({.slice = image_use.handle.slice, .task = task_i, .read = read});
+                });
+        }
+    }
+
+    struct RecordedSubmitScope
+    {
+        std::vector<TaskId> tasks = {};
+        TaskSubmitInfo submit_info = {};
+        std::optional<TaskPresentInfo> present_info = {};
+    };
+
+    // Collects the tasks, submits and presents of a permutation so that it can be recorded again.
+    auto collect_recorded_submit_scopes(TaskGraphPermutation const & permutation) -> std::vector<RecordedSubmitScope>
+    {
+        std::vector<RecordedSubmitScope> recorded_submit_scopes = {};
+        for (auto const & submit_scope : permutation.batch_submit_scopes)
+        {
+            RecordedSubmitScope recorded = {.submit_info = submit_scope.user_submit_info};
+            for (auto const & batch : submit_scope.task_batches)
+            {
+                recorded.tasks.insert(recorded.tasks.end(), batch.tasks.begin(), batch.tasks.end());
+            }
+            // Task ids are assigned in recording order.
+            std::sort(recorded.tasks.begin(), recorded.tasks.end());
+            if (submit_scope.present_info.has_value())
+            {
+                recorded.present_info = TaskPresentInfo{.additional_binary_semaphores = submit_scope.present_info->additional_binary_semaphores};
+            }
+            recorded_submit_scopes.push_back(std::move(recorded));
+        }
+        return recorded_submit_scopes;
+    }
+
+    // Returns an empty permutation with the same record time state as the given one, ready to record tasks into.
+    auto empty_permutation_like(TaskGraphPermutation const & permutation) -> TaskGraphPermutation
+    {
+        TaskGraphPermutation ret = {
+            .active = permutation.active,
+            .swapchain_image = permutation.swapchain_image,
+            .culled_tasks = permutation.culled_tasks,
+        };
+        for (auto const & task_buffer : permutation.buffer_infos)
+        {
+            ret.buffer_infos.push_back(PerPermTaskBuffer{.valid = task_buffer.valid});
+        }
+        for (auto const & task_image : permutation.image_infos)
+        {
+            ret.image_infos.push_back(PerPermTaskImage{.valid = task_image.valid});
+        }
+        ret.batch_submit_scopes.push_back({});
+        return ret;
+    }
+
+    void ImplTaskGraph::optimize_schedule(TaskGraphPermutation & permutation)
+    {
+        std::vector<RecordedSubmitScope> const recorded_submit_scopes = collect_recorded_submit_scopes(permutation);
+
+        // The permutation is recorded again from scratch, the recording order schedule is kept to compare against.
+        TaskGraphPermutation recording_order_permutation = std::move(permutation);
+        permutation = empty_permutation_like(recording_order_permutation);
+
+        std::vector<std::vector<usize>> successors = {};
+        std::vector<u32> predecessor_counts = {};
+        std::vector<u32> path_lengths = {};
+        std::vector<usize> ready_tasks = {};
+        for (usize submit_scope_index = 0; submit_scope_index < recorded_submit_scopes.size(); ++submit_scope_index)
+        {
+            auto const & recorded = recorded_submit_scopes[submit_scope_index];
+            build_task_dependencies(*this, recorded.tasks, successors, predecessor_counts);
+            // Length of the longest dependency chain starting at each task.
+            path_lengths.assign(recorded.tasks.size(), 1);
+            for (usize task_i = recorded.tasks.size(); task_i-- > 0;)
+            {
+                for (usize const successor : successors[task_i])
+                {
+                    path_lengths[task_i] = std::max(path_lengths[task_i], path_lengths[successor] + 1);
+                }
+            }
+            ready_tasks.clear();
+            for (usize task_i = 0; task_i < recorded.tasks.size(); ++task_i)
+            {
+                if (predecessor_counts[task_i] == 0)
+                {
+                    ready_tasks.push_back(task_i);
+                }
+            }
+            // List scheduling: out of all tasks whose dependencies are scheduled, the one fitting into the earliest batch goes next.
+            // Reads of a resource that can share a batch and barrier with the previous read are therefore grouped.
+            // Ties are broken by the longest remaining dependency chain, then by recording order.
+            while (!ready_tasks.empty())
+            {
+                usize best_ready_i = 0;
+                usize best_batch_index = std::numeric_limits<usize>::max();
+                for (usize ready_i = 0; ready_i < ready_tasks.size(); ++ready_i)
+                {
+                    usize const task_i = ready_tasks[ready_i];
+                    usize const batch_index = find_first_possible_batch_index(
+                        *this,
+                        permutation,
+                        permutation.batch_submit_scopes.back(),
+                        submit_scope_index,
+                        *this->tasks[recorded.tasks[task_i]].base_task);
+                    usize const best_task_i = ready_tasks[best_ready_i];
+                    bool const better =
+                        batch_index < best_batch_index ||
+                        (batch_index == best_batch_index &&
+                         (path_lengths[task_i] > path_lengths[best_task_i] ||
+                          (path_lengths[task_i] == path_lengths[best_task_i] && task_i < best_task_i)));
+                    if (better)
+                    {
+                        best_ready_i = ready_i;
+                        best_batch_index = batch_index;
+                    }
+                }
+                usize const task_i = ready_tasks[best_ready_i];
+                ready_tasks[best_ready_i] = ready_tasks.back();
+                ready_tasks.pop_back();
+                TaskId const task_id = recorded.tasks[task_i];
+                permutation.add_task(task_id, *this, *this->tasks[task_id].base_task);
+                for (usize const successor : successors[task_i])
+                {
+                    if (--predecessor_counts[successor] == 0)
+                    {
+                        ready_tasks.push_back(successor);
+                    }
+                }
+            }
+            if (submit_scope_index + 1 < recorded_submit_scopes.size())
+            {
+                permutation.submit(recorded.submit_info);
+            }
+            if (recorded.present_info.has_value())
+            {
+                permutation.present(recorded.present_info.value());
+            }
+        }
+
+        auto const optimized_stats = permutation_schedule_stats(permutation);
+        auto const recording_order_stats = permutation_schedule_stats(recording_order_permutation);
+        u32 const optimized_barrier_count = optimized_stats.barrier_count + optimized_stats.split_barrier_count;
+        u32 const recording_order_barrier_count = recording_order_stats.barrier_count + recording_order_stats.split_barrier_count;
+        bool const optimized_is_better =
+            optimized_stats.batch_count < recording_order_stats.batch_count ||
+            (optimized_stats.batch_count == recording_order_stats.batch_count && optimized_barrier_count < recording_order_barrier_count);
+        if (!optimized_is_better)
+        {
+            permutation = std::move(recording_order_permutation);
+        }
+    }
+
+    void ImplTaskGraph::cull_dead_tasks(TaskGraphPermutation & permutation)
+    {
+        std::vector<RecordedSubmitScope> const recorded_submit_scopes = collect_recorded_submit_scopes(permutation);
+
+        // Walks all tasks backwards, tracking which transient resource parts are read by a kept later task.
+        // Writes never remove parts from the needed sets, so a task is only culled if no later kept task could read its outputs.
+        std::vector<bool> needed_buffers(global_buffer_infos.size(), false);
+        std::vector<std::vector<ImageMipArraySlice>> needed_image_slices(global_image_infos.size());
+        std::vector<bool> culled(this->tasks.size(), false);
+        usize culled_count = 0;
+        for (usize submit_scope_index = recorded_submit_scopes.size(); submit_scope_index-- > 0;)
+        {
+            auto const & recorded = recorded_submit_scopes[submit_scope_index];
+            for (usize task_i = recorded.tasks.size(); task_i-- > 0;)
+            {
+                TaskId const task_id = recorded.tasks[task_i];
+                auto const & task = *this->tasks[task_id].base_task;
+                bool writes_anything = false;
+                bool output_needed = task.has_side_effects();
+                for_each(
+                    task.get_generic_uses(),
+                    [&](u32, TaskBufferUse<> const & buffer_use)
+                    {
+                        if ((task_buffer_access_to_access(buffer_use.access()).type & AccessTypeFlagBits::WRITE) != AccessTypeFlagBits::NONE)
+                        {
+                            writes_anything = true;
+                            output_needed = output_needed ||
+                                            global_buffer_infos[buffer_use.handle.index].is_persistent() ||
+                                            needed_buffers[buffer_use.handle.index];
+                        }
+                    },
+                    [&](u32, TaskImageUse<> const & image_use)
+                    {
+                        if ((std::get<1>(task_image_access_to_layout_access(image_use.access())).type & AccessTypeFlagBits::WRITE) != AccessTypeFlagBits::NONE)
+                        {
+                            writes_anything = true;
+                            output_needed = output_needed ||
+                                            global_image_infos[image_use.handle.index].is_persistent() ||
+                                            std::any_of(
+                                                needed_image_slices[image_use.handle.index].begin(),
+                                                needed_image_slices[image_use.handle.index].end(),
+                                                [&](ImageMipArraySlice const & needed_slice)
+                                                { return needed_slice.intersects(image_use.handle.slice); });
+                        }
+                    });
+                if (writes_anything && !output_needed)
+                {
+                    culled[task_id] = true;
+                    ++culled_count;
+                    continue;
+                }
+                for_each(
+                    task.get_generic_uses(),
+                    [&](u32, TaskBufferUse<> const & buffer_use)
+                    {
+                        if ((task_buffer_access_to_access(buffer_use.access()).type & AccessTypeFlagBits::READ) != AccessTypeFlagBits::NONE)
+                        {
+                            needed_buffers[buffer_use.handle.index] = true;
+                        }
+                    },
+                    [&](u32, TaskImageUse<> const & image_use)
+                    {
+                        if ((std::get<1>(task_image_access_to_layout_access(image_use.access())).type & AccessTypeFlagBits::READ) != AccessTypeFlagBits::NONE)
+                        {
+                            auto & needed_slices = needed_image_slices[image_use.handle.index];
+                            bool const already_covered = std::any_of(
+                                needed_slices.begin(),
+                                needed_slices.end(),
+                                [&](ImageMipArraySlice const & needed_slice)
+                                { return needed_slice.contains(image_use.handle.slice); });
+                            if (!already_covered)
+                            {
+                                needed_slices.push_back(image_use.handle.slice);
+                            }
+                        }
+                    });
+            }
+        }
+        if (culled_count == 0)
+        {
+            return;
+        }
+
+        // The kept tasks are recorded again in their original order.
+        // Transient resources that lost all their uses keep an unset lifetime and are not allocated.
+        permutation = empty_permutation_like(permutation);
+        for (usize submit_scope_index = 0; submit_scope_index < recorded_submit_scopes.size(); ++submit_scope_index)
+        {
+            auto const & recorded = recorded_submit_scopes[submit_scope_index];
+            for (TaskId const task_id : recorded.tasks)
+            {
+                if (culled[task_id])
+                {
+                    permutation.culled_tasks.push_back(task_id);
+                    continue;
+                }
+                permutation.add_task(task_id, *this, *this->tasks[task_id].base_task);
+            }
+            if (submit_scope_index + 1 < recorded_submit_scopes.size())
+            {
+                permutation.submit(recorded.submit_info);
+            }
+            if (recorded.present_info.has_value())
+            {
+                permutation.present(recorded.present_info.value());
+            }
+        }
     }
 
     void TaskGraph::complete(TaskCompleteInfo const &)
@@ -2236,6 +3007,21 @@ namespace daxa
         DAXA_DBG_ASSERT_TRUE_M(!impl.compiled, "task graphs can only be completed once");
         impl.compiled = true;
 
+        if (impl.info.cull_dead_tasks)
+        {
+            for (auto & permutation : impl.permutations)
+            {
+                impl.cull_dead_tasks(permutation);
+            }
+        }
+        if (impl.info.optimize_schedule && impl.info.reorder_tasks)
+        {
+            for (auto & permutation : impl.permutations)
+            {
+                impl.optimize_schedule(permutation);
+            }
+        }
+
         impl.allocate_transient_resources();
         // Insert static barriers initializing image layouts.
         for (auto & permutation : impl.permutations)
@@ -2243,6 +3029,13 @@ namespace daxa
             impl.create_transient_runtime_buffers(permutation);
             impl.create_transient_runtime_images(permutation);
 
+            // Execution only needs the final tracked states, converted into disjoint slices once here.
+            for (auto & task_image : permutation.image_infos)
+            {
+                task_image.first_slice_states = task_image.first_slice_state_grid.slice_states();
+                task_image.last_slice_states = task_image.last_slice_state_grid.slice_states();
+            }
+
             // Insert static initialization barriers for non persistent resources:
             // Buffers never need layout initialization, only images.
             for (u32 task_image_index = 0; task_image_index < permutation.image_infos.size(); ++task_image_index)
@@ -2289,6 +3082,8 @@ namespace daxa
                     }
                 }
             }
+
+            impl.merge_batch_barriers(permutation);
         }
     }
 
@@ -2320,6 +3115,23 @@ namespace daxa
         return impl.memory_block_size;
     }
 
+    auto TaskGraph::get_schedule_stats() -> TaskGraphScheduleStats
+    {
+        auto & impl = *r_cast<ImplTaskGraph *>(this->object);
+        DAXA_DBG_ASSERT_TRUE_M(impl.compiled, "schedule stats are only available after completion");
+        TaskGraphScheduleStats stats = {};
+        for (auto const & permutation : impl.permutations)
+        {
+            auto const permutation_stats = permutation_schedule_stats(permutation);
+            stats.submit_scope_count += permutation_stats.submit_scope_count;
+            stats.batch_count += permutation_stats.batch_count;
+            stats.barrier_count += permutation_stats.barrier_count;
+            stats.split_barrier_count += permutation_stats.split_barrier_count;
+            stats.merged_barrier_count += permutation_stats.merged_barrier_count;
+        }
+        return stats;
+    }
+
     thread_local std::vector<EventWaitInfo> tl_split_barrier_wait_infos = {};
     thread_local std::vector<ImageMemoryBarrierInfo> tl_image_barrier_infos = {};
     thread_local std::vector<MemoryBarrierInfo> tl_memory_barrier_infos = {};
@@ -2358,6 +3170,98 @@ namespace daxa
         }
     }
 
+    void append_submit_scope_waits(
+        ImplTaskGraph & impl,
+        TaskGraphPermutation & permutation,
+        TaskBatchSubmitScope & submit_scope,
+        usize submit_scope_index,
+        std::vector<BinarySemaphore> & wait_binary_semaphores,
+        std::vector<std::pair<TimelineSemaphore, u64>> & wait_timeline_semaphores)
+    {
+        wait_binary_semaphores.insert(wait_binary_semaphores.end(), submit_scope.submit_info.wait_binary_semaphores.begin(), submit_scope.submit_info.wait_binary_semaphores.end());
+        wait_timeline_semaphores.insert(wait_timeline_semaphores.end(), submit_scope.submit_info.wait_timeline_semaphores.begin(), submit_scope.submit_info.wait_timeline_semaphores.end());
+        if (impl.info.swapchain.has_value())
+        {
+            Swapchain const & swapchain = impl.info.swapchain.value();
+            if (submit_scope_index == permutation.swapchain_image_first_use_submit_scope_index)
+            {
+                ImplPersistentTaskImage & swapchain_image = impl.global_image_infos.at(permutation.swapchain_image.index).get_persistent();
+                // It can happen, that a previous task graph accessed the swapchain image.
+                // In that case the acquire semaphore is already waited upon and by extension we wait on the previous access and therefore on the acquire.
+                // So we must not wait in the case that the semaphore is already waited upon.
+                if (!swapchain_image.waited_on_acquire)
+                {
+                    swapchain_image.waited_on_acquire = true;
+                    wait_binary_semaphores.push_back(swapchain.current_acquire_semaphore());
+                }
+            }
+            if (permutation.swapchain_image_first_use_submit_scope_index == std::numeric_limits<u64>::max() &&
+                submit_scope.present_info.has_value())
+            {
+                // It can be the case, that the only use of the swapchain is the present itself.
+                // If so, the submit before the present waits on the acquire, see append_submit_scope_signals.
+                ImplPersistentTaskImage & swapchain_image = impl.global_image_infos.at(permutation.swapchain_image.index).get_persistent();
+                swapchain_image.waited_on_acquire = true;
+                wait_binary_semaphores.push_back(swapchain.current_acquire_semaphore());
+            }
+        }
+        if (submit_scope.user_submit_info.additional_wait_binary_semaphores != nullptr)
+        {
+            wait_binary_semaphores.insert(wait_binary_semaphores.end(), submit_scope.user_submit_info.additional_wait_binary_semaphores->begin(), submit_scope.user_submit_info.additional_wait_binary_semaphores->end());
+        }
+        if (submit_scope.user_submit_info.additional_wait_timeline_semaphores != nullptr)
+        {
+            wait_timeline_semaphores.insert(wait_timeline_semaphores.end(), submit_scope.user_submit_info.additional_wait_timeline_semaphores->begin(), submit_scope.user_submit_info.additional_wait_timeline_semaphores->end());
+        }
+    }
+
+    void append_submit_scope_signals(
+        ImplTaskGraph & impl,
+        TaskGraphPermutation & permutation,
+        TaskBatchSubmitScope & submit_scope,
+        usize submit_scope_index,
+        std::vector<BinarySemaphore> & signal_binary_semaphores,
+        std::vector<std::pair<TimelineSemaphore, u64>> & signal_timeline_semaphores)
+    {
+        signal_binary_semaphores.insert(signal_binary_semaphores.end(), submit_scope.submit_info.signal_binary_semaphores.begin(), submit_scope.submit_info.signal_binary_semaphores.end());
+        signal_timeline_semaphores.insert(signal_timeline_semaphores.end(), submit_scope.submit_info.signal_timeline_semaphores.begin(), submit_scope.submit_info.signal_timeline_semaphores.end());
+        if (impl.info.swapchain.has_value())
+        {
+            Swapchain const & swapchain = impl.info.swapchain.value();
+            if (submit_scope_index == permutation.swapchain_image_last_use_submit_scope_index)
+            {
+                signal_binary_semaphores.push_back(swapchain.current_present_semaphore());
+                signal_timeline_semaphores.emplace_back(
+                    swapchain.gpu_timeline_semaphore(),
+                    swapchain.current_cpu_timeline_value());
+            }
+            if (permutation.swapchain_image_first_use_submit_scope_index == std::numeric_limits<u64>::max() &&
+                submit_scope.present_info.has_value())
+            {
+                // It can be the case, that the only use of the swapchain is the present itself.
+                // If so, simply signal the timeline sema of the swapchain with the latest submit.
+                // TODO: this is a hack until we get timeline semaphores for presenting.
+                // TODO: im not sure about this design, maybe just remove this explicit signaling completely.
+                signal_timeline_semaphores.emplace_back(
+                    swapchain.gpu_timeline_semaphore(),
+                    swapchain.current_cpu_timeline_value());
+                signal_binary_semaphores.push_back(swapchain.current_present_semaphore());
+            }
+        }
+        if (submit_scope.user_submit_info.additional_signal_binary_semaphores != nullptr)
+        {
+            signal_binary_semaphores.insert(signal_binary_semaphores.end(), submit_scope.user_submit_info.additional_signal_binary_semaphores->begin(), submit_scope.user_submit_info.additional_signal_binary_semaphores->end());
+        }
+        if (submit_scope.user_submit_info.additional_signal_timeline_semaphores != nullptr)
+        {
+            signal_timeline_semaphores.insert(signal_timeline_semaphores.end(), submit_scope.user_submit_info.additional_signal_timeline_semaphores->begin(), submit_scope.user_submit_info.additional_signal_timeline_semaphores->end());
+        }
+        if (impl.staging_memory.has_value())
+        {
+            signal_timeline_semaphores.push_back({impl.staging_memory->timeline_semaphore(), impl.staging_memory->timeline_value()});
+        }
+    }
+
     void generate_persistent_resource_synch(
         ImplTaskGraph & impl,
         TaskGraphPermutation & permutation,
@@ -2582,6 +3486,15 @@ namespace daxa
         impl.chosen_permutation_last_execution = permutation_index;
         TaskGraphPermutation & permutation = impl.permutations[permutation_index];
 
+        // Another task graph may have grown the shared heap, the transients must be recreated in the new memory block.
+        bool const transient_memory_heap_grown =
+            impl.info.transient_memory_heap.has_value() && impl.memory_block_size != 0 &&
+            (**r_cast<ImplTransientMemoryHeap **>(&impl.info.transient_memory_heap.value())).generation != impl.transient_memory_heap_generation;
+        if (impl.transient_extents_changed || transient_memory_heap_grown)
+        {
+            impl.reallocate_transient_resources();
+        }
+
         CommandRecorder recorder = impl.info.device.create_command_recorder({});
 
         ImplTaskRuntimeInterface impl_runtime{.task_graph = impl, .permutation = permutation, .recorder = recorder};
@@ -2593,6 +3506,14 @@ namespace daxa
         }
         // Generate and insert synchronization for persistent resources:
         generate_persistent_resource_synch(impl, permutation, recorder);
+        if (impl.info.transient_memory_heap.has_value() && impl.memory_block_size != 0)
+        {
+            // Other task graphs alias the transient memory, their accesses must be done before ours begin.
+            recorder.pipeline_barrier({
+                .src_access = AccessConsts::READ_WRITE,
+                .dst_access = AccessConsts::READ_WRITE,
+            });
+        }
 
         usize submit_scope_index = 0;
         for (auto & submit_scope : permutation.batch_submit_scopes)
@@ -2604,6 +3525,10 @@ namespace daxa
                     .name = impl.info.name + std::string(", submit ") + std::to_string(submit_scope_index),
                 });
             }
+            // Only the first submit of a scope waits on its semaphores, only the last one signals them.
+            bool scope_waits_submitted = false;
+            u32 batches_since_submit = 0;
+            usize tasks_since_submit = 0;
             usize batch_index = 0;
             for (auto & task_batch : submit_scope.task_batches)
             {
@@ -2616,23 +3541,13 @@ namespace daxa
                 }
                 batch_index += 1;
                 // Wait on pipeline barriers before batch execution.
-                for (auto barrier_index : task_batch.pipeline_barrier_indices)
+                // Without split barriers, the waited split barriers are merged into these as well.
+                for (auto & barrier : task_batch.merged_barriers)
                 {
-                    TaskBarrier & barrier = permutation.barriers[barrier_index];
                     insert_pipeline_barrier(impl, permutation, impl_runtime.recorder, barrier);
                 }
                 // Wait on split barriers before batch execution.
-                if (!impl.info.use_split_barriers)
-                {
-                    for (auto barrier_index : task_batch.wait_split_barrier_indices)
-                    {
-                        TaskSplitBarrier const & split_barrier = permutation.split_barriers[barrier_index];
-                        // Convert split barrier to normal barrier.
-                        TaskBarrier barrier = split_barrier;
-                        insert_pipeline_barrier(impl, permutation, impl_runtime.recorder, barrier);
-                    }
-                }
-                else
+                if (impl.info.use_split_barriers)
                 {
                     usize needed_image_barriers = 0;
                     for (auto barrier_index : task_batch.wait_split_barrier_indices)
@@ -2750,6 +3665,46 @@ namespace daxa
                 {
                     impl_runtime.recorder.end_label();
                 }
+                batches_since_submit += 1;
+                tasks_since_submit += task_batch.tasks.size();
+                bool const auto_submit =
+                    (impl.info.auto_submit_batch_count != 0 && batches_since_submit >= impl.info.auto_submit_batch_count) ||
+                    (impl.info.auto_submit_task_count != 0 && tasks_since_submit >= impl.info.auto_submit_task_count);
+                // The scope after the last submit is never submitted by the task graph, the last batch of a scope is submitted with the scopes semaphores.
+                if (auto_submit && &submit_scope != &permutation.batch_submit_scopes.back() && &task_batch != &submit_scope.task_batches.back())
+                {
+                    // Submits to the same queue execute in submission order.
+                    // Pipeline barriers and split barriers recorded in later submits still synchronize with the commands of this one.
+                    if (impl.info.enable_command_labels)
+                    {
+                        impl_runtime.recorder.end_label();
+                    }
+                    std::vector<ExecutableCommandList> commands = {};
+                    std::vector<BinarySemaphore> wait_binary_semaphores = {};
+                    std::vector<std::pair<TimelineSemaphore, u64>> wait_timeline_semaphores = {};
+                    if (!scope_waits_submitted)
+                    {
+                        commands.insert(commands.end(), submit_scope.submit_info.command_lists.begin(), submit_scope.submit_info.command_lists.end());
+                        append_submit_scope_waits(impl, permutation, submit_scope, submit_scope_index, wait_binary_semaphores, wait_timeline_semaphores);
+                        scope_waits_submitted = true;
+                    }
+                    commands.push_back(recorder.complete_current_commands());
+                    impl.info.device.submit_commands({
+                        .wait_stages = submit_scope.submit_info.wait_stages,
+                        .command_lists = commands,
+                        .wait_binary_semaphores = wait_binary_semaphores,
+                        .wait_timeline_semaphores = wait_timeline_semaphores,
+                    });
+                    batches_since_submit = 0;
+                    tasks_since_submit = 0;
+                    if (impl.info.enable_command_labels)
+                    {
+                        impl_runtime.recorder.begin_label({
+                            .label_color = impl.info.task_graph_label_color,
+                            .name = impl.info.name + std::string(", submit ") + std::to_string(submit_scope_index),
+                        });
+                    }
+                }
             }
             for (usize const barrier_index : submit_scope.last_minute_barrier_indices)
             {
@@ -2764,74 +3719,22 @@ namespace daxa
             if (&submit_scope != &permutation.batch_submit_scopes.back())
             {
                 PipelineStageFlags wait_stages = submit_scope.submit_info.wait_stages;
-                std::vector<ExecutableCommandList> commands = {submit_scope.submit_info.command_lists.begin(), submit_scope.submit_info.command_lists.end()};
-                std::vector<BinarySemaphore> wait_binary_semaphores = {submit_scope.submit_info.wait_binary_semaphores.begin(), submit_scope.submit_info.wait_binary_semaphores.end()};
-                std::vector<BinarySemaphore> signal_binary_semaphores = {submit_scope.submit_info.signal_binary_semaphores.begin(), submit_scope.submit_info.signal_binary_semaphores.end()};
-                std::vector<std::pair<TimelineSemaphore, u64>> wait_timeline_semaphores = {submit_scope.submit_info.wait_timeline_semaphores.begin(), submit_scope.submit_info.wait_timeline_semaphores.end()};
-                std::vector<std::pair<TimelineSemaphore, u64>> signal_timeline_semaphores = {submit_scope.submit_info.signal_timeline_semaphores.begin(), submit_scope.submit_info.signal_timeline_semaphores.end()};
-                commands.push_back(recorder.complete_current_commands());
-                if (impl.info.swapchain.has_value())
+                std::vector<ExecutableCommandList> commands = {};
+                std::vector<BinarySemaphore> wait_binary_semaphores = {};
+                std::vector<BinarySemaphore> signal_binary_semaphores = {};
+                std::vector<std::pair<TimelineSemaphore, u64>> wait_timeline_semaphores = {};
+                std::vector<std::pair<TimelineSemaphore, u64>> signal_timeline_semaphores = {};
+                if (!scope_waits_submitted)
                 {
-                    Swapchain const & swapchain = impl.info.swapchain.value();
-                    if (submit_scope_index == permutation.swapchain_image_first_use_submit_scope_index)
-                    {
-                        ImplPersistentTaskImage & swapchain_image = impl.global_image_infos.at(permutation.swapchain_image.index).get_persistent();
-                        // It can happen, that a previous task graph accessed the swapchain image.
-                        // In that case the acquire semaphore is already waited upon and by extension we wait on the previous access and therefore on the acquire.
-                        // So we must not wait in the case that the semaphore is already waited upon.
-                        if (!swapchain_image.waited_on_acquire)
-                        {
-                            swapchain_image.waited_on_acquire = true;
-                            wait_binary_semaphores.push_back(swapchain.current_acquire_semaphore());
-                        }
-                    }
-                    if (submit_scope_index == permutation.swapchain_image_last_use_submit_scope_index)
-                    {
-                        signal_binary_semaphores.push_back(swapchain.current_present_semaphore());
-                        signal_timeline_semaphores.emplace_back(
-                            swapchain.gpu_timeline_semaphore(),
-                            swapchain.current_cpu_timeline_value());
-                    }
-                    if (permutation.swapchain_image_first_use_submit_scope_index == std::numeric_limits<u64>::max() &&
-                        submit_scope.present_info.has_value())
-                    {
-                        // It can be the case, that the only use of the swapchain is the present itself.
-                        // If so, simply signal the timeline sema of the swapchain with the latest submit.
-                        // TODO: this is a hack until we get timeline semaphores for presenting.
-                        // TODO: im not sure about this design, maybe just remove this explicit signaling completely.
-                        signal_timeline_semaphores.emplace_back(
-                            swapchain.gpu_timeline_semaphore(),
-                            swapchain.current_cpu_timeline_value());
-                        ImplPersistentTaskImage & swapchain_image = impl.global_image_infos.at(permutation.swapchain_image.index).get_persistent();
-                        swapchain_image.waited_on_acquire = true;
-                        wait_binary_semaphores.push_back(impl.info.swapchain.value().current_acquire_semaphore());
-                        signal_binary_semaphores.push_back(impl.info.swapchain.value().current_present_semaphore());
-                    }
+                    commands.insert(commands.end(), submit_scope.submit_info.command_lists.begin(), submit_scope.submit_info.command_lists.end());
+                    append_submit_scope_waits(impl, permutation, submit_scope, submit_scope_index, wait_binary_semaphores, wait_timeline_semaphores);
                 }
+                commands.push_back(recorder.complete_current_commands());
                 if (submit_scope.user_submit_info.additional_command_lists != nullptr)
                 {
                     commands.insert(commands.end(), submit_scope.user_submit_info.additional_command_lists->begin(), submit_scope.user_submit_info.additional_command_lists->end());
                 }
-                if (submit_scope.user_submit_info.additional_wait_binary_semaphores != nullptr)
-                {
-                    wait_binary_semaphores.insert(wait_binary_semaphores.end(), submit_scope.user_submit_info.additional_wait_binary_semaphores->begin(), submit_scope.user_submit_info.additional_wait_binary_semaphores->end());
-                }
-                if (submit_scope.user_submit_info.additional_signal_binary_semaphores != nullptr)
-                {
-                    signal_binary_semaphores.insert(signal_binary_semaphores.end(), submit_scope.user_submit_info.additional_signal_binary_semaphores->begin(), submit_scope.user_submit_info.additional_signal_binary_semaphores->end());
-                }
-                if (submit_scope.user_submit_info.additional_wait_timeline_semaphores != nullptr)
-                {
-                    wait_timeline_semaphores.insert(wait_timeline_semaphores.end(), submit_scope.user_submit_info.additional_wait_timeline_semaphores->begin(), submit_scope.user_submit_info.additional_wait_timeline_semaphores->end());
-                }
-                if (submit_scope.user_submit_info.additional_signal_timeline_semaphores != nullptr)
-                {
-                    signal_timeline_semaphores.insert(signal_timeline_semaphores.end(), submit_scope.user_submit_info.additional_signal_timeline_semaphores->begin(), submit_scope.user_submit_info.additional_signal_timeline_semaphores->end());
-                }
-                if (impl.staging_memory.has_value() && impl.staging_memory->timeline_value() > impl.last_execution_staging_timeline_value)
-                {
-                    signal_timeline_semaphores.push_back({impl.staging_memory->timeline_semaphore(), impl.staging_memory->timeline_value()});
-                }
+                append_submit_scope_signals(impl, permutation, submit_scope, submit_scope_index, signal_binary_semaphores, signal_timeline_semaphores);
                 daxa::CommandSubmitInfo submit_info = {
                     .wait_stages = wait_stages,
                     .command_lists = commands,
@@ -2841,6 +3744,11 @@ namespace daxa
                     .signal_timeline_semaphores = signal_timeline_semaphores,
                 };
                 impl.info.device.submit_commands(submit_info);
+                if (impl.staging_memory.has_value())
+                {
+                    // Each submit ends a frame of the staging memory, its allocations retire as soon as the submit finished.
+                    impl.staging_memory->advance_timeline();
+                }
 
                 if (submit_scope.present_info.has_value())
                 {
@@ -2891,10 +3799,6 @@ namespace daxa
         // impl.left_over_command_lists = std::move(impl_runtime.recorder.complete_current_commands());
         impl.executed_once = true;
         impl.prev_frame_permutation_index = permutation_index;
-        if (impl.staging_memory.has_value())
-        {
-            impl.last_execution_staging_timeline_value = impl.staging_memory->timeline_value();
-        }
 
         if (impl.info.record_debug_information)
         {
@@ -2907,7 +3811,7 @@ namespace daxa
     {
         if (a_info.staging_memory_pool_size != 0)
         {
-            this->staging_memory = TransferMemoryPool{TransferMemoryPoolInfo{.device = info.device, .capacity = info.staging_memory_pool_size, .use_bar_memory = true, .name = info.name}};
+            this->staging_memory = TransferMemoryPool{TransferMemoryPoolInfo{.device = info.device, .capacity = info.staging_memory_pool_size, .use_bar_memory = true, .per_frame_retirement = true, .name = info.name}};
         }
     }
 
@@ -2933,26 +3837,7 @@ namespace daxa
         }
         for (auto & permutation : permutations)
         {
-            // because transient buffers are owned by the task graph, we need to destroy them
-            for (u32 buffer_info_idx = 0; buffer_info_idx < static_cast<u32>(global_buffer_infos.size()); buffer_info_idx++)
-            {
-                auto const & global_buffer = global_buffer_infos.at(buffer_info_idx);
-                auto const & perm_buffer = permutation.buffer_infos.at(buffer_info_idx);
-                if (!global_buffer.is_persistent() && perm_buffer.valid)
-                {
-                    info.device.destroy_buffer(get_actual_buffers(TaskBufferView{{.task_graph_index = unique_index, .index = buffer_info_idx}}, permutation)[0]);
-                }
-            }
-            // because transient images are owned by the task graph, we need to destroy them
-            for (u32 image_info_idx = 0; image_info_idx < static_cast<u32>(global_image_infos.size()); image_info_idx++)
-            {
-                auto const & global_image = global_image_infos.at(image_info_idx);
-                auto const & perm_image = permutation.image_infos.at(image_info_idx);
-                if (!global_image.is_persistent() && perm_image.valid)
-                {
-                    info.device.destroy_image(get_actual_images(TaskImageView{{.task_graph_index = unique_index, .index = image_info_idx}}, permutation)[0]);
-                }
-            }
+            destroy_transient_runtime_resources(permutation);
         }
     }
 
@@ -3137,6 +4022,8 @@ namespace daxa
         fmt::format_to(std::back_inserter(out), "device: {}\n", info.device.info().name.view());
         fmt::format_to(std::back_inserter(out), "swapchain: {}\n", (this->info.swapchain.has_value() ? this->info.swapchain.value().info().name.view() : "-"));
         fmt::format_to(std::back_inserter(out), "reorder tasks: {}\n", info.reorder_tasks);
+        fmt::format_to(std::back_inserter(out), "optimize schedule: {}\n", info.optimize_schedule);
+        fmt::format_to(std::back_inserter(out), "cull dead tasks: {}\n", info.cull_dead_tasks);
         fmt::format_to(std::back_inserter(out), "use split barriers: {}\n", info.use_split_barriers);
         fmt::format_to(std::back_inserter(out), "permutation_condition_count: {}\n", info.permutation_condition_count);
         fmt::format_to(std::back_inserter(out), "enable_command_labels: {}\n", info.enable_command_labels);
@@ -3163,6 +4050,14 @@ namespace daxa
         {
             this->print_permutation_aliasing_to(out, indent, permutation);
             permutation_index += 1;
+            fmt::format_to(std::back_inserter(out), "culled tasks: {}\n", permutation.culled_tasks.size());
+            {
+                [[maybe_unused]] FormatIndent d0{out, indent, true};
+                for (TaskId const task_id : permutation.culled_tasks)
+                {
+                    fmt::format_to(std::back_inserter(out), "{}task name: \"{}\", id: {}\n", indent, this->tasks[task_id].base_task->get_name(), task_id);
+                }
+            }
             fmt::format_to(std::back_inserter(out), "permutations split barriers: {}\n", info.use_split_barriers);
             [[maybe_unused]] FormatIndent d0{out, indent, true};
             usize submit_scope_index = 0;
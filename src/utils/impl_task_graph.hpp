@@ -67,14 +67,44 @@ namespace daxa
         Variant<Monostate, LastReadSplitBarrierIndex, LastReadBarrierIndex> latest_access_read_barrier_index = Monostate{};
     };
 
+    // Tracks the state of every image subresource in a mip level x array layer grid while recording.
+    // Each cell indexes into states, all cells last touched by the same use share that uses state.
+    // Intersecting and updating tracked states costs O(touched subresources),
+    // no matter how fragmented the tracked ranges of an image become.
+    struct ImageSubresourceStateGrid
+    {
+        static constexpr u32 NO_STATE = std::numeric_limits<u32>::max();
+
+        u32 mip_level_count = {};
+        u32 array_layer_count = {};
+        std::vector<u32> cells = {};
+        std::vector<ExtendedImageSliceState> states = {};
+
+        // Grows the grid to contain the slice. New cells have no state.
+        void fit(ImageMipArraySlice const & slice);
+        auto cell(u32 mip_level, u32 array_layer) -> u32 &;
+        // Returns NO_STATE for subresources outside the grid.
+        auto state_index(u32 mip_level, u32 array_layer) const -> u32;
+        // Assigns a new state to every subresource of its slice, returns the new state index.
+        auto assign(ExtendedImageSliceState const & state) -> u32;
+        // Splits the slice into rectangles of subresources sharing the same state index (including NO_STATE).
+        // Neighbouring mip levels with identical layer runs are merged into one rectangle.
+        void regions(ImageMipArraySlice const & slice, std::vector<std::pair<u32, ImageMipArraySlice>> & out_regions) const;
+        // Converts the tracked subresources back into disjoint slice states.
+        auto slice_states() const -> std::vector<ExtendedImageSliceState>;
+    };
+
     struct PerPermTaskImage
     {
         /// Every permutation always has all buffers but they are not necessarily valid in that permutation.
         /// This boolean is used to check this.
         bool valid = {};
         bool swapchain_semaphore_waited_upon = {};
+        // Filled from the state grids when the task graph is completed.
         std::vector<ExtendedImageSliceState> last_slice_states = {};
         std::vector<ExtendedImageSliceState> first_slice_states = {};
+        ImageSubresourceStateGrid last_slice_state_grid = {};
+        ImageSubresourceStateGrid first_slice_state_grid = {};
         // only for transient images
         ResourceLifetime lifetime = {};
         ImageUsageFlags usage = ImageUsageFlagBits::NONE;
@@ -105,6 +135,32 @@ namespace daxa
         std::vector<std::vector<ImageViewId>> image_view_cache = {};
     };
 
+    struct TaskGpuCondition
+    {
+        TaskBufferView buffer = {};
+        usize offset = {};
+        bool inverted = {};
+    };
+
+    // Wraps tasks recorded within a gpu conditional.
+    // Appends a use of the condition buffer and records the wrapped callback within conditional rendering.
+    struct GpuConditionalTask final : detail::BaseTask
+    {
+        std::unique_ptr<detail::BaseTask> task = {};
+        std::vector<GenericTaskResourceUse> uses = {};
+        TaskGpuCondition condition = {};
+
+        GpuConditionalTask(std::unique_ptr<detail::BaseTask> && a_task, TaskGpuCondition const & a_condition);
+        virtual ~GpuConditionalTask() override = default;
+
+        virtual auto get_generic_uses() -> std::span<GenericTaskResourceUse> override;
+        virtual auto get_generic_uses() const -> std::span<GenericTaskResourceUse const> override;
+        virtual auto get_task_head_shader_blob_size() const -> u64 override;
+        virtual auto get_name() const -> std::string override;
+        virtual auto has_side_effects() const -> bool override;
+        virtual void callback(TaskInterface const & ti) override;
+    };
+
     struct ImplPresentInfo
     {
         std::vector<BinarySemaphore> binary_semaphores = {};
@@ -117,6 +173,9 @@ namespace daxa
         std::vector<usize> wait_split_barrier_indices = {};
         std::vector<TaskId> tasks = {};
         std::vector<usize> signal_split_barrier_indices = {};
+        // Built when completing from the pipeline barriers and, without split barriers, the waited split barriers.
+        // Holds at most one combined memory barrier, followed by deduplicated image barriers.
+        std::vector<TaskBarrier> merged_barriers = {};
     };
 
     struct TaskBatchSubmitScope
@@ -152,6 +211,8 @@ namespace daxa
         std::vector<TaskBatchSubmitScope> batch_submit_scopes = {};
         usize swapchain_image_first_use_submit_scope_index = std::numeric_limits<usize>::max();
         usize swapchain_image_last_use_submit_scope_index = std::numeric_limits<usize>::max();
+        // Tasks removed by dead task culling, in recording order.
+        std::vector<TaskId> culled_tasks = {};
 
         void add_task(TaskId task_id, ImplTaskGraph & task_graph_impl, detail::BaseTask & task);
         void submit(TaskSubmitInfo const & info);
@@ -197,6 +258,24 @@ namespace daxa
         static void zero_ref_callback(ImplHandle const * handle);
     };
 
+    struct ImplTransientMemoryHeap final : ImplHandle
+    {
+        ImplTransientMemoryHeap(TransientMemoryHeapInfo const & a_info);
+        ~ImplTransientMemoryHeap();
+
+        TransientMemoryHeapInfo info = {};
+        MemoryBlock memory_block = {};
+        MemoryRequirements requirements = {.memory_type_bits = 0xFFFFFFFFu};
+        // Incremented every time the memory block is replaced by a larger one.
+        // Task graphs compare it to the generation their transients were created in.
+        u64 generation = {};
+
+        // Replaces the memory block with one fitting both the current and the new requirements, if the current one does not.
+        void fit(MemoryRequirements const & new_requirements);
+
+        static void zero_ref_callback(ImplHandle const * handle);
+    };
+
     struct PermIndepTaskBufferInfo
     {
         struct Persistent
@@ -302,6 +381,20 @@ namespace daxa
         std::optional<BinarySemaphore> last_submit_semaphore = {};
     };
 
+    // Maps the unique indices of the persistent resources a graph uses to their local indices.
+    // Unique indices grow with every persistent resource ever created, so they can not index a flat table.
+    // Lookups binary search a vector sorted by unique index. Resources are usually registered in creation order, which appends.
+    struct PersistentIndexTable
+    {
+        static constexpr u32 NO_LOCAL_INDEX = std::numeric_limits<u32>::max();
+
+        std::vector<std::pair<u32, u32>> sorted = {};
+
+        void insert(u32 persistent_index, u32 local_index);
+        // Returns NO_LOCAL_INDEX for resources not used by the graph.
+        auto find(u32 persistent_index) const -> u32;
+    };
+
     struct ImplTaskGraph final : ImplHandle
     {
         ImplTaskGraph(TaskGraphInfo a_info);
@@ -316,20 +409,27 @@ namespace daxa
         std::vector<PermIndepTaskImageInfo> global_image_infos = {};
         std::vector<TaskGraphPermutation> permutations = {};
         std::vector<ImplTask> tasks = {};
-        // TODO: replace with faster hash map.
-        std::unordered_map<u32, u32> persistent_buffer_index_to_local_index;
-        std::unordered_map<u32, u32> persistent_image_index_to_local_index;
+        PersistentIndexTable persistent_buffer_index_to_local_index = {};
+        PersistentIndexTable persistent_image_index_to_local_index = {};
 
         // record time information:
         u32 record_active_conditional_scopes = {};
         u32 record_conditional_states = {};
         std::vector<TaskGraphPermutation *> record_active_permutations = {};
+        std::optional<TaskGpuCondition> record_gpu_condition = {};
+        // Only filled with validation, used to check that resource names are unique.
         std::unordered_map<std::string, TaskBufferView> buffer_name_to_id = {};
         std::unordered_map<std::string, TaskImageView> image_name_to_id = {};
 
         usize memory_block_size = {};
         u32 memory_type_bits = 0xFFFFFFFFu;
         MemoryBlock transient_data_memory_block = {};
+        // Generation of the transient memory heap the transient resources were created in.
+        u64 transient_memory_heap_generation = {};
+        // Named extents transient resources can be sized relative to.
+        std::unordered_map<std::string, Extent3D> transient_extents = {};
+        // Set when an extent changes after completion, the transient resources are recreated on the next execution.
+        bool transient_extents_changed = {};
         bool compiled = {};
 
         // execution time information:
@@ -337,7 +437,6 @@ namespace daxa
         std::array<bool, DAXA_TASK_GRAPH_MAX_CONDITIONALS> execution_time_current_conditionals = {};
 
         // post execution information:
-        usize last_execution_staging_timeline_value = 0;
         u32 chosen_permutation_last_execution = {};
         std::vector<ExecutableCommandList> left_over_command_lists = {};
         bool executed_once = {};
@@ -353,9 +452,16 @@ namespace daxa
         void execute_task(ImplTaskRuntimeInterface & impl_runtime, TaskGraphPermutation & permutation, TaskBatchId in_batch_task_index, TaskId task_id);
         void insert_pre_batch_barriers(TaskGraphPermutation & permutation);
         void check_for_overlapping_use(detail::BaseTask & task);
+        auto transient_buffer_size(TaskTransientBufferInfo const & buffer_info) const -> usize;
+        auto transient_image_size(TaskTransientImageInfo const & image_info) const -> Extent3D;
         void create_transient_runtime_buffers(TaskGraphPermutation & permutation);
         void create_transient_runtime_images(TaskGraphPermutation & permutation);
+        void destroy_transient_runtime_resources(TaskGraphPermutation & permutation);
         void allocate_transient_resources();
+        void reallocate_transient_resources();
+        void optimize_schedule(TaskGraphPermutation & permutation);
+        void cull_dead_tasks(TaskGraphPermutation & permutation);
+        void merge_batch_barriers(TaskGraphPermutation & permutation);
         void print_task_buffer_to(std::string & out, std::string indent, TaskGraphPermutation const & permutation, TaskBufferView local_id);
         void print_task_image_to(std::string & out, std::string indent, TaskGraphPermutation const & permutation, TaskImageView image);
         void print_task_barrier_to(std::string & out, std::string & indent, TaskGraphPermutation const & permutation, usize index, bool const split_barrier);
@@ -1,5 +1,8 @@
 #include <daxa/daxa.hpp>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 namespace tests
 {
@@ -85,6 +88,392 @@ namespace tests
             exit(-1);
         }
     }
+    void batched_sro_creation(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device({.max_allowed_buffers = 64});
+            std::vector<daxa::BufferInfo> buffer_infos(16, test_buffer_info);
+            std::vector<daxa::ImageInfo> image_infos(4, test_image_info);
+            auto buffers = device.create_buffers(buffer_infos);
+            auto images = device.create_images(image_infos);
+            std::vector<daxa::ImageViewInfo> image_view_infos = {};
+            for (auto const & image : images)
+            {
+                image_view_infos.push_back({
+                    .type = daxa::ImageViewType::REGULAR_2D_ARRAY,
+                    .image = image,
+                    .name = "test image view",
+                });
+            }
+            auto image_views = device.create_image_views(image_view_infos);
+            for (usize i = 0; i < buffers.size(); ++i)
+            {
+                if (!device.is_id_valid(buffers[i]) || (i > 0 && buffers[i] == buffers[i - 1]))
+                {
+                    std::cout << "failed test \"batched_sro_creation\": batch created buffers must be valid and unique" << std::endl;
+                    exit(-1);
+                }
+            }
+            // A batch that does not fit must fail without creating any of its resources.
+            bool exceeded_batch_failed = false;
+            try
+            {
+                [[maybe_unused]] auto const too_many = device.create_buffers(std::vector<daxa::BufferInfo>(64, test_buffer_info));
+            }
+            catch (std::runtime_error const &)
+            {
+                exceeded_batch_failed = true;
+            }
+            auto remaining_buffers = device.create_buffers(std::vector<daxa::BufferInfo>(16, test_buffer_info));
+            if (!exceeded_batch_failed)
+            {
+                std::cout << "failed test \"batched_sro_creation\": batch exceeding max_allowed_buffers must fail" << std::endl;
+                exit(-1);
+            }
+            device.destroy_image_views(image_views);
+            device.destroy_images(images);
+            device.destroy_buffers(buffers);
+            device.destroy_buffers(remaining_buffers);
+            if (device.is_id_valid(buffers[0]) || device.is_id_valid(images[0]) || device.is_id_valid(image_views[0]))
+            {
+                std::cout << "failed test \"batched_sro_creation\": batch destroyed resources must be invalid" << std::endl;
+                exit(-1);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"batched_sro_creation\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void sampler_cache(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device({
+                .flags = daxa::DeviceInfo{}.flags | daxa::DeviceFlagBits::SAMPLER_CACHE,
+            });
+            auto sampler_a = device.create_sampler({.name = "sampler a"});
+            auto sampler_b = device.create_sampler({.name = "sampler b"});
+            auto sampler_c = device.create_sampler({
+                .address_mode_u = daxa::SamplerAddressMode::REPEAT,
+                .name = "sampler c",
+            });
+            if (sampler_a != sampler_b || sampler_a == sampler_c)
+            {
+                std::cout << "failed test \"sampler_cache\": identical infos must share a sampler, different infos must not" << std::endl;
+                exit(-1);
+            }
+            // The shared sampler lives until its last reference is destroyed.
+            device.destroy_sampler(sampler_a);
+            if (!device.is_id_valid(sampler_b))
+            {
+                std::cout << "failed test \"sampler_cache\": shared sampler destroyed while still referenced" << std::endl;
+                exit(-1);
+            }
+            device.destroy_sampler(sampler_b);
+            device.destroy_sampler(sampler_c);
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"sampler_cache\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void memory_report(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device({});
+            auto const before = device.memory_report();
+            auto buffer = device.create_buffer({.size = 1 << 20, .name = "memory report buffer"});
+            auto const with_buffer = device.memory_report();
+            if (with_buffer.buffer_count != before.buffer_count + 1 || with_buffer.buffer_bytes < before.buffer_bytes + (1 << 20))
+            {
+                std::cout << "failed test \"memory_report\": created buffer is not reported" << std::endl;
+                exit(-1);
+            }
+            u64 heap_allocation_bytes = 0;
+            for (u32 heap_i = 0; heap_i < with_buffer.heap_count; ++heap_i)
+            {
+                heap_allocation_bytes += with_buffer.heaps[heap_i].allocation_bytes;
+            }
+            if (with_buffer.heap_count == 0 || heap_allocation_bytes < with_buffer.buffer_bytes)
+            {
+                std::cout << "failed test \"memory_report\": heap statistics do not cover the live resources" << std::endl;
+                exit(-1);
+            }
+            device.destroy_buffer(buffer);
+            device.collect_garbage();
+            auto const after = device.memory_report();
+            if (after.buffer_count != before.buffer_count || after.buffer_bytes != before.buffer_bytes)
+            {
+                std::cout << "failed test \"memory_report\": destroyed buffer is still reported" << std::endl;
+                exit(-1);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"memory_report\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void timeline_callbacks(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device({});
+            auto semaphore_a = device.create_timeline_semaphore({.name = "callback semaphore a"});
+            auto semaphore_b = device.create_timeline_semaphore({.name = "callback semaphore b"});
+            std::atomic_uint32_t invoked = 0;
+            bool immediate = false;
+            // Already reached values invoke the callback right away.
+            device.on_timeline_reached(semaphore_a, 0, [&]()
+                                       { immediate = true; });
+            if (!immediate)
+            {
+                std::cout << "failed test \"timeline_callbacks\": callback of a reached value was not invoked right away" << std::endl;
+                exit(-1);
+            }
+            for (u64 value = 1; value <= 64; ++value)
+            {
+                device.on_timeline_reached(value % 2 == 0 ? semaphore_a : semaphore_b, value, [&]()
+                                           { invoked.fetch_add(1); });
+            }
+            semaphore_a.set_value(32);
+            semaphore_b.set_value(63);
+            semaphore_a.set_value(64);
+            auto const start = std::chrono::steady_clock::now();
+            while (invoked.load() != 64 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+            {
+                std::this_thread::yield();
+            }
+            if (invoked.load() != 64)
+            {
+                std::cout << "failed test \"timeline_callbacks\": only " << invoked.load() << " of 64 callbacks were invoked" << std::endl;
+                exit(-1);
+            }
+            // Registering wakes the completion thread, so that it also waits on the new value.
+            std::atomic_bool late_invoked = false;
+            device.on_timeline_reached(semaphore_b, 100, [&]()
+                                       { late_invoked = true; });
+            semaphore_b.set_value(100);
+            while (!late_invoked.load() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+            {
+                std::this_thread::yield();
+            }
+            if (!late_invoked.load())
+            {
+                std::cout << "failed test \"timeline_callbacks\": callback registered after a wake up was not invoked" << std::endl;
+                exit(-1);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"timeline_callbacks\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void background_garbage_collection(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device({
+                .flags = daxa::DeviceInfo{}.flags | daxa::DeviceFlagBits::BACKGROUND_GARBAGE_COLLECTION,
+                .name = "background garbage collection device",
+            });
+            auto const buffer_count = device.memory_report().buffer_count;
+            auto buffer = device.create_buffer({.size = 64, .name = "background garbage collection buffer"});
+            {
+                auto recorder = device.create_command_recorder({});
+                recorder.clear_buffer({.buffer = buffer, .size = 64, .clear_value = 0});
+                auto executable_commands = recorder.complete_current_commands();
+                recorder.~CommandRecorder();
+                device.destroy_buffer(buffer);
+                device.submit_commands({.command_lists = std::array{executable_commands}});
+            }
+            // No collect_garbage call, the device thread retires the buffer once the submission completed.
+            device.wait_idle();
+            auto const start = std::chrono::steady_clock::now();
+            while (device.memory_report().buffer_count != buffer_count && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (device.memory_report().buffer_count != buffer_count)
+            {
+                std::cout << "failed test \"background_garbage_collection\": destroyed buffer was not collected" << std::endl;
+                exit(-1);
+            }
+            // Manual collection still works alongside the device thread.
+            device.collect_garbage();
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"background_garbage_collection\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void defragmentation(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device({});
+            constexpr u32 BUFFER_COUNT = 64;
+            constexpr u32 BUFFER_SIZE = 1u << 16u;
+            constexpr u32 IMAGE_COUNT = 16;
+            constexpr u32 IMAGE_SIZE = 64;
+            // Images are left in different layouts, each must be copied from and left in its own.
+            auto image_layout = [](u32 i)
+            { return i % 4 == 0 ? daxa::ImageLayout::READ_ONLY_OPTIMAL : daxa::ImageLayout::GENERAL; };
+            std::vector<daxa::BufferId> buffers = {};
+            std::vector<daxa::ImageId> images = {};
+            {
+                auto recorder = device.create_command_recorder({});
+                for (u32 i = 0; i < BUFFER_COUNT; ++i)
+                {
+                    buffers.push_back(device.create_buffer({.size = BUFFER_SIZE, .name = "defragmentation buffer"}));
+                    recorder.clear_buffer({.buffer = buffers.back(), .size = BUFFER_SIZE, .clear_value = i});
+                    if (i < IMAGE_COUNT)
+                    {
+                        images.push_back(device.create_image({
+                            .format = daxa::Format::R32_UINT,
+                            .size = {IMAGE_SIZE, IMAGE_SIZE, 1},
+                            .usage = daxa::ImageUsageFlagBits::TRANSFER_SRC | daxa::ImageUsageFlagBits::TRANSFER_DST | daxa::ImageUsageFlagBits::SHADER_SAMPLED,
+                            .name = "defragmentation image",
+                        }));
+                        recorder.pipeline_barrier_image_transition({
+                            .dst_access = daxa::AccessConsts::TRANSFER_WRITE,
+                            .dst_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                            .image_id = images.back(),
+                        });
+                        recorder.clear_image({
+                            .clear_value = {std::array<u32, 4>{i, 0, 0, 0}},
+                            .dst_image = images.back(),
+                        });
+                        recorder.pipeline_barrier_image_transition({
+                            .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                            .dst_access = daxa::AccessConsts::READ,
+                            .src_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                            .dst_layout = image_layout(i),
+                            .image_id = images.back(),
+                        });
+                    }
+                }
+                auto executable_commands = recorder.complete_current_commands();
+                recorder.~CommandRecorder();
+                device.submit_commands({.command_lists = std::array{executable_commands}});
+            }
+            // Free every other buffer and image, leaving holes for the defragmentation to fill.
+            for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+            {
+                device.destroy_buffer(buffers[i]);
+            }
+            std::vector<daxa::DefragmentationImage> movable_images = {};
+            for (u32 i = 0; i < IMAGE_COUNT; ++i)
+            {
+                if (i % 2 == 1)
+                {
+                    device.destroy_image(images[i]);
+                }
+                else
+                {
+                    movable_images.push_back({.image = images[i], .layout = image_layout(i)});
+                }
+            }
+            device.wait_idle();
+            device.collect_garbage();
+
+            daxa::DefragmentationStatus status = {};
+            u32 pass_count = 0;
+            do
+            {
+                status = device.defragment({
+                    .max_bytes_per_pass = BUFFER_SIZE * 4,
+                    .move_buffers = true,
+                    .movable_images = movable_images,
+                });
+                device.wait_idle();
+                device.collect_garbage();
+                ++pass_count;
+            } while (status.in_progress && pass_count < 1000);
+            if (status.in_progress)
+            {
+                std::cout << "failed test \"defragmentation\": defragmentation did not finish" << std::endl;
+                exit(-1);
+            }
+
+            // Moved buffers and images keep their ids, contents and layouts.
+            auto readback_buffer = device.create_buffer({
+                .size = sizeof(u32) * (BUFFER_COUNT + IMAGE_COUNT),
+                .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+                .name = "defragmentation readback buffer",
+            });
+            {
+                auto recorder = device.create_command_recorder({});
+                for (u32 i = 0; i < BUFFER_COUNT; i += 2)
+                {
+                    recorder.copy_buffer_to_buffer({
+                        .src_buffer = buffers[i],
+                        .dst_buffer = readback_buffer,
+                        .src_offset = BUFFER_SIZE - sizeof(u32),
+                        .dst_offset = sizeof(u32) * i,
+                        .size = sizeof(u32),
+                    });
+                }
+                for (u32 i = 0; i < IMAGE_COUNT; i += 2)
+                {
+                    recorder.pipeline_barrier_image_transition({
+                        .src_access = daxa::AccessConsts::READ_WRITE,
+                        .dst_access = daxa::AccessConsts::TRANSFER_READ,
+                        .src_layout = image_layout(i),
+                        .dst_layout = daxa::ImageLayout::TRANSFER_SRC_OPTIMAL,
+                        .image_id = images[i],
+                    });
+                    recorder.copy_image_to_buffer({
+                        .image = images[i],
+                        .image_offset = {IMAGE_SIZE - 1, IMAGE_SIZE - 1, 0},
+                        .image_extent = {1, 1, 1},
+                        .buffer = readback_buffer,
+                        .buffer_offset = sizeof(u32) * (BUFFER_COUNT + i),
+                    });
+                }
+                recorder.pipeline_barrier({
+                    .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                    .dst_access = daxa::AccessConsts::HOST_READ,
+                });
+                auto executable_commands = recorder.complete_current_commands();
+                recorder.~CommandRecorder();
+                device.submit_commands({.command_lists = std::array{executable_commands}});
+            }
+            device.wait_idle();
+            u32 const * readback = device.get_host_address_as<u32>(readback_buffer).value();
+            for (u32 i = 0; i < BUFFER_COUNT; i += 2)
+            {
+                if (!device.is_id_valid(buffers[i]) || readback[i] != i)
+                {
+                    std::cout << "failed test \"defragmentation\": moved buffer " << i << " lost its contents" << std::endl;
+                    exit(-1);
+                }
+                device.destroy_buffer(buffers[i]);
+            }
+            for (u32 i = 0; i < IMAGE_COUNT; i += 2)
+            {
+                if (!device.is_id_valid(images[i]) || readback[BUFFER_COUNT + i] != i)
+                {
+                    std::cout << "failed test \"defragmentation\": moved image " << i << " lost its contents" << std::endl;
+                    exit(-1);
+                }
+                device.destroy_image(images[i]);
+            }
+            device.destroy_buffer(readback_buffer);
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"defragmentation\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
     void sro_aliased_suballocation(daxa::Instance & instance)
     {
         try
@@ -158,6 +547,12 @@ auto main() -> int
     tests::simplest(instance);
     tests::device_selection(instance);
     tests::sro_creation(instance);
+    tests::batched_sro_creation(instance);
+    tests::sampler_cache(instance);
+    tests::memory_report(instance);
+    tests::timeline_callbacks(instance);
+    tests::background_garbage_collection(instance);
+    tests::defragmentation(instance);
     tests::sro_aliased_suballocation(instance);
     tests::acceleration_structure_creation(instance);
     std::cout << "completed all tests successfully!" << std::endl;
@@ -507,6 +507,191 @@ namespace tests
         app.device.destroy_buffer(buf_b);
         app.device.destroy_buffer(buf_a);
     }
+    void set_uniform_buffer(App & app)
+    {
+        auto const ubo_alignment = app.device.properties().limits.min_uniform_buffer_offset_alignment;
+        daxa::BufferId ubo = app.device.create_buffer({.size = static_cast<usize>(ubo_alignment * 2), .name = "ubo"});
+
+        daxa::CommandRecorder cmdr = app.device.create_command_recorder({});
+
+        if (!app.device.properties().push_descriptor_supported)
+        {
+            // Without VK_KHR_push_descriptor, set_uniform_buffer must report an error instead of recording.
+            [[maybe_unused]] bool unsupported_caught = false;
+            try
+            {
+                cmdr.set_uniform_buffer({.slot = 0, .buffer = ubo, .size = 16, .offset = 0});
+            }
+            catch (std::runtime_error const &)
+            {
+                unsupported_caught = true;
+            }
+            DAXA_DBG_ASSERT_TRUE_M(unsupported_caught, "set_uniform_buffer must fail without push descriptor support");
+            app.device.destroy_buffer(ubo);
+            return;
+        }
+
+        // Uniform buffer bindings are pushed lazily on the next draw/dispatch, so they can be set without a pipeline.
+        cmdr.set_uniform_buffer({.slot = 0, .buffer = ubo, .size = 16, .offset = 0});
+        cmdr.set_uniform_buffer({.slot = daxa::CONSTANT_BUFFER_BINDINGS_COUNT - 1, .buffer = ubo, .size = 16, .offset = static_cast<usize>(ubo_alignment)});
+
+        [[maybe_unused]] bool slot_out_of_range_caught = false;
+        try
+        {
+            cmdr.set_uniform_buffer({.slot = daxa::CONSTANT_BUFFER_BINDINGS_COUNT, .buffer = ubo, .size = 16, .offset = 0});
+        }
+        catch (std::runtime_error const &)
+        {
+            slot_out_of_range_caught = true;
+        }
+        DAXA_DBG_ASSERT_TRUE_M(slot_out_of_range_caught, "set_uniform_buffer must reject slots outside of the uniform buffer set");
+
+        [[maybe_unused]] bool range_out_of_bounds_caught = false;
+        try
+        {
+            cmdr.set_uniform_buffer({.slot = 1, .buffer = ubo, .size = static_cast<usize>(ubo_alignment * 2), .offset = static_cast<usize>(ubo_alignment)});
+        }
+        catch (std::runtime_error const &)
+        {
+            range_out_of_bounds_caught = true;
+        }
+        DAXA_DBG_ASSERT_TRUE_M(range_out_of_bounds_caught, "set_uniform_buffer must reject ranges exceeding the buffer");
+
+        app.device.submit_commands({.command_lists = std::array{cmdr.complete_current_commands()}});
+        app.device.wait_idle();
+        app.device.destroy_buffer(ubo);
+    }
+
+    void queries(App & app)
+    {
+        daxa::QueryPool occlusion_pool = app.device.create_query_pool({
+            .query_type = daxa::QueryType::OCCLUSION,
+            .query_count = 2,
+            .name = "occlusion queries",
+        });
+        DAXA_DBG_ASSERT_TRUE_M(occlusion_pool.value_count() == 1, "occlusion queries write a single value");
+
+        // Pipeline statistics need to be enabled with a device flag.
+        [[maybe_unused]] bool statistics_without_flag_caught = false;
+        try
+        {
+            [[maybe_unused]] auto statistics_pool = app.device.create_query_pool({
+                .query_type = daxa::QueryType::PIPELINE_STATISTICS,
+                .pipeline_statistics = daxa::PipelineStatisticFlagBits::COMPUTE_SHADER_INVOCATIONS | daxa::PipelineStatisticFlagBits::CLIPPING_PRIMITIVES,
+                .query_count = 1,
+                .name = "pipeline statistics queries",
+            });
+        }
+        catch (std::runtime_error const &)
+        {
+            statistics_without_flag_caught = true;
+        }
+        DAXA_DBG_ASSERT_TRUE_M(statistics_without_flag_caught, "pipeline statistics query pools require DeviceFlagBits::PIPELINE_STATISTICS_QUERY");
+
+        daxa::CommandRecorder cmdr = app.device.create_command_recorder({});
+        cmdr.reset_queries({.query_pool = occlusion_pool, .start_index = 0, .count = 2});
+        // No draws, so the query must report zero samples passed.
+        cmdr.begin_query({.query_pool = occlusion_pool, .query_index = 0});
+        cmdr.end_query({.query_pool = occlusion_pool, .query_index = 0});
+
+        [[maybe_unused]] bool reset_out_of_range_caught = false;
+        try
+        {
+            cmdr.reset_queries({.query_pool = occlusion_pool, .start_index = 1, .count = 2});
+        }
+        catch (std::runtime_error const &)
+        {
+            reset_out_of_range_caught = true;
+        }
+        DAXA_DBG_ASSERT_TRUE_M(reset_out_of_range_caught, "reset_queries must reject ranges exceeding the pool");
+
+        app.device.submit_commands({.command_lists = std::array{cmdr.complete_current_commands()}});
+        app.device.wait_idle();
+
+        // Value and availability per query. Query 1 was never written, it must stay unavailable.
+        auto results = occlusion_pool.get_query_results(0, 2);
+        DAXA_DBG_ASSERT_TRUE_M(results[1] != 0 && results[0] == 0, "empty occlusion query must be available and report zero samples");
+        DAXA_DBG_ASSERT_TRUE_M(results[3] == 0, "unwritten query must not be available");
+    }
+
+    void conditional_rendering(App & app)
+    {
+        // Conditional rendering needs to be enabled with a device flag.
+        {
+            auto condition_buffer = app.device.create_buffer({.size = sizeof(u32), .name = "condition buffer"});
+            daxa::CommandRecorder cmdr = app.device.create_command_recorder({});
+            [[maybe_unused]] bool without_flag_caught = false;
+            try
+            {
+                cmdr.begin_conditional_rendering({.buffer = condition_buffer});
+            }
+            catch (std::runtime_error const &)
+            {
+                without_flag_caught = true;
+            }
+            DAXA_DBG_ASSERT_TRUE_M(without_flag_caught, "conditional rendering requires DeviceFlagBits::CONDITIONAL_RENDERING");
+            app.device.destroy_buffer(condition_buffer);
+        }
+
+        daxa::Device device;
+        try
+        {
+            device = app.daxa_ctx.create_device({
+                .flags = daxa::DeviceInfo{}.flags | daxa::DeviceFlagBits::CONDITIONAL_RENDERING,
+                .name = "conditional rendering device",
+            });
+        }
+        catch (std::runtime_error const &)
+        {
+            std::cout << "Test skipped. No present device supports conditional rendering!" << std::endl;
+            return;
+        }
+        auto condition_buffer = device.create_buffer({.size = 2 * sizeof(u32), .name = "condition buffer"});
+        daxa::CommandRecorder cmdr = device.create_command_recorder({});
+        // Conditions can be written on the gpu right before they are used.
+        cmdr.clear_buffer({.buffer = condition_buffer, .size = 2 * sizeof(u32), .clear_value = 0});
+        cmdr.pipeline_barrier({
+            .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+            .dst_access = daxa::AccessConsts::CONDITIONAL_RENDERING_READ,
+        });
+
+        auto expect_failure = [&](auto && command, char const * message)
+        {
+            [[maybe_unused]] bool caught = false;
+            try
+            {
+                command();
+            }
+            catch (std::runtime_error const &)
+            {
+                caught = true;
+            }
+            DAXA_DBG_ASSERT_TRUE_M(caught, message);
+        };
+        expect_failure([&]()
+                       { cmdr.end_conditional_rendering(); },
+                       "end_conditional_rendering without begin must fail");
+        expect_failure([&]()
+                       { cmdr.begin_conditional_rendering({.buffer = condition_buffer, .offset = 2}); },
+                       "condition offsets must be 4 byte aligned");
+        expect_failure([&]()
+                       { cmdr.begin_conditional_rendering({.buffer = condition_buffer, .offset = 2 * sizeof(u32)}); },
+                       "condition offsets must be within the buffer");
+
+        cmdr.begin_conditional_rendering({.buffer = condition_buffer, .offset = sizeof(u32), .inverted = true});
+        expect_failure([&]()
+                       { cmdr.begin_conditional_rendering({.buffer = condition_buffer}); },
+                       "conditional rendering can not be nested");
+        expect_failure([&]()
+                       { [[maybe_unused]] auto commands = cmdr.complete_current_commands(); },
+                       "commands can not be completed within conditional rendering");
+        cmdr.end_conditional_rendering();
+
+        device.submit_commands({.command_lists = std::array{cmdr.complete_current_commands()}});
+        device.wait_idle();
+        device.destroy_buffer(condition_buffer);
+    }
+
     void build_acceleration_structure(App & app)
     {
         try
@@ -575,6 +760,9 @@ namespace tests
                     .flags = {},
                 }};
             auto build_info = daxa::BlasBuildInfo{
+                .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE |
+                         daxa::AccelerationStructureBuildFlagBits::ALLOW_UPDATE |
+                         daxa::AccelerationStructureBuildFlagBits::ALLOW_COMPACTION,
                 .dst_blas = {}, // Ignored in get_acceleration_structure_build_sizes.
                 .geometries = geometries,
                 .scratch_data = {}, // Ignored in get_acceleration_structure_build_sizes.
@@ -583,7 +771,7 @@ namespace tests
             daxa::AccelerationStructureBuildSizesInfo build_size_info = device.get_blas_build_sizes(build_info);
             /// Create Scratch buffer and As:
             auto scratch_buffer = device.create_buffer({
-                .size = build_size_info.build_scratch_size,
+                .size = std::max(build_size_info.build_scratch_size, build_size_info.update_scratch_size),
                 .name = "scratch buffer",
             });
             defer { device.destroy_buffer(scratch_buffer); };
@@ -610,6 +798,57 @@ namespace tests
             }();
             device.submit_commands({.command_lists = std::array{exec_cmds}});
             device.wait_idle();
+            /// Refit the blas in place and query its compacted size:
+            auto compacted_size_buffer = device.create_buffer({
+                .size = sizeof(u64),
+                .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+                .name = "compacted size buffer",
+            });
+            defer { device.destroy_buffer(compacted_size_buffer); };
+            auto update_info = build_info;
+            update_info.src_blas = blas;
+            exec_cmds = [&]()
+            {
+                auto recorder = device.create_command_recorder({});
+                recorder.build_acceleration_structures({
+                    .blas_build_infos = std::array{update_info},
+                });
+                recorder.pipeline_barrier({
+                    .src_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+                    .dst_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ,
+                });
+                recorder.write_blas_compacted_sizes({
+                    .blas = std::array{blas},
+                    .dst_buffer = compacted_size_buffer,
+                });
+                return recorder.complete_current_commands();
+            }();
+            device.submit_commands({.command_lists = std::array{exec_cmds}});
+            device.wait_idle();
+            u64 const compacted_size = *device.get_host_address_as<u64>(compacted_size_buffer).value();
+            if (compacted_size == 0 || compacted_size > build_size_info.acceleration_structure_size)
+            {
+                std::cout << "failed test \"acceleration_structure_creation\": invalid compacted size " << compacted_size << std::endl;
+                exit(-1);
+            }
+            /// Compact the blas into a new, smaller one:
+            daxa::BlasId compacted_blas = device.create_blas({
+                .size = compacted_size,
+                .name = "test compacted blas",
+            });
+            defer { device.destroy_blas(compacted_blas); };
+            exec_cmds = [&]()
+            {
+                auto recorder = device.create_command_recorder({});
+                recorder.copy_blas_to_blas({
+                    .src_blas = blas,
+                    .dst_blas = compacted_blas,
+                    .compact = true,
+                });
+                return recorder.complete_current_commands();
+            }();
+            device.submit_commands({.command_lists = std::array{exec_cmds}});
+            device.wait_idle();
         }
         catch (std::runtime_error error)
         {
@@ -637,6 +876,18 @@ auto main() -> int
         App app = {};
         tests::multiple_ecl(app);
     }
+    {
+        App app = {};
+        tests::set_uniform_buffer(app);
+    }
+    {
+        App app = {};
+        tests::queries(app);
+    }
+    {
+        App app = {};
+        tests::conditional_rendering(app);
+    }
     {
         App app = {};
         tests::build_acceleration_structure(app);
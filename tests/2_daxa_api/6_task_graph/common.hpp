@@ -3,6 +3,7 @@
 #include <0_common/window.hpp>
 #include <iostream>
 #include <thread>
+#include <chrono>
 
 #include <daxa/utils/pipeline_manager.hpp>
 #include <daxa/utils/task_graph.hpp>
@@ -5,6 +5,7 @@
 #include "shaders/shader_integration.inl"
 #include "persistent_resources.hpp"
 #include "transient_overlap.hpp"
+#include "scheduling.hpp"
 
 namespace tests
 {
@@ -284,6 +285,92 @@ namespace tests
         app.device.destroy_image(image);
     }
 
+    void mip_chain_compile_time()
+    {
+        // TEST:
+        //    1) CREATE image with a full mip chain and 6 layers
+        //    2) Record 1000 tasks following the mipmapping pattern, each reading one mip of one layer and writing the next mip
+        //    3) Every full chain over all layers is followed by a read of the entire image
+        //    4) Complete and execute the task graph
+        //    Expected: All tasks run, the mips of each layer are written in order and every read of the entire image sees completed chains.
+        //    The recording and completion time of this pattern is measured in the task graph recording benchmark.
+        AppContext app = {};
+        constexpr u32 MIP_LEVEL_COUNT = 13;
+        constexpr u32 ARRAY_LAYER_COUNT = 6;
+        constexpr u32 TASK_COUNT = 1000;
+        u32 executed_task_count = 0;
+        std::array<u32, ARRAY_LAYER_COUNT> next_mips = {};
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = app.device,
+                .name = APPNAME_PREFIX("task_graph (mip_chain_compile_time)"),
+            });
+            auto task_image = task_graph.create_transient_image({
+                .size = {1u << (MIP_LEVEL_COUNT - 1), 1u << (MIP_LEVEL_COUNT - 1), 1},
+                .mip_level_count = MIP_LEVEL_COUNT,
+                .array_layer_count = ARRAY_LAYER_COUNT,
+                .name = "mip chain image",
+            });
+            u32 task_count = 0;
+            while (task_count < TASK_COUNT)
+            {
+                for (u32 layer = 0; layer < ARRAY_LAYER_COUNT && task_count < TASK_COUNT; ++layer)
+                {
+                    for (u32 mip = 0; mip < MIP_LEVEL_COUNT - 1 && task_count < TASK_COUNT; ++mip, ++task_count)
+                    {
+                        task_graph.add_task({
+                            .uses = {
+                                ImageTransferRead<>{task_image.view().view({.base_mip_level = mip, .base_array_layer = layer})},
+                                ImageTransferWrite<>{task_image.view().view({.base_mip_level = mip + 1, .base_array_layer = layer})},
+                            },
+                            .task = [&, layer, mip](daxa::TaskInterface const &)
+                            {
+                                if (next_mips[layer] != mip)
+                                {
+                                    std::cout << "failed test \"mip_chain_compile_time\": mip " << mip << " of layer " << layer << " ran out of order" << std::endl;
+                                    exit(-1);
+                                }
+                                next_mips[layer] = (mip + 1) % (MIP_LEVEL_COUNT - 1);
+                                ++executed_task_count;
+                            },
+                            .name = "mip map",
+                        });
+                    }
+                }
+                if (task_count < TASK_COUNT)
+                {
+                    task_graph.add_task({
+                        .uses = {ImageComputeShaderSampled<>{task_image.view().view({.level_count = MIP_LEVEL_COUNT, .layer_count = ARRAY_LAYER_COUNT})}},
+                        .task = [&](daxa::TaskInterface const &)
+                        {
+                            for (u32 const next_mip : next_mips)
+                            {
+                                if (next_mip != 0)
+                                {
+                                    std::cout << "failed test \"mip_chain_compile_time\": entire image was read before all mip chains completed" << std::endl;
+                                    exit(-1);
+                                }
+                            }
+                            ++executed_task_count;
+                        },
+                        .name = "read mip chain",
+                    });
+                    ++task_count;
+                }
+            }
+            task_graph.submit({});
+            task_graph.complete({});
+            task_graph.execute({});
+        }
+        if (executed_task_count != TASK_COUNT)
+        {
+            std::cout << "failed test \"mip_chain_compile_time\": executed " << executed_task_count << " of " << TASK_COUNT << " tasks" << std::endl;
+            exit(-1);
+        }
+        app.device.wait_idle();
+        app.device.collect_garbage();
+    }
+
     void shader_integration_inl_use()
     {
         // TEST:
@@ -483,6 +570,540 @@ namespace tests
         device.destroy_buffer(buffer);
         device.collect_garbage();
     }
+
+    void gpu_profiler()
+    {
+        // TEST:
+        //  1) Create a gpu profiler and a task graph using it
+        //  2) Execute the task graph over multiple frames
+        //  3) Check that every task got a resolved scope and export a chrome trace
+        AppContext app = {};
+        daxa::GpuProfiler profiler{daxa::GpuProfilerInfo{
+            .device = app.device,
+            .frames_in_flight = 2,
+            .name = APPNAME_PREFIX("gpu profiler"),
+        }};
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = app.device,
+                .gpu_profiler = &profiler,
+                .name = APPNAME_PREFIX("task_graph (gpu_profiler)"),
+            });
+            auto task_buffer = task_graph.create_transient_buffer({.size = 64, .name = "profiled buffer"});
+            task_graph.add_task({
+                .uses = {daxa::TaskBufferUse<daxa::TaskBufferAccess::TRANSFER_WRITE>{task_buffer}},
+                .task = [&](daxa::TaskInterface const & ti)
+                {
+                    ti.get_recorder().clear_buffer({.buffer = ti.uses[task_buffer].buffer(), .size = 64});
+                },
+                .name = "clear",
+            });
+            task_graph.add_task({
+                .uses = {daxa::TaskBufferUse<daxa::TaskBufferAccess::TRANSFER_READ>{task_buffer}},
+                .task = [&](daxa::TaskInterface const &) {},
+                .name = "read",
+            });
+            task_graph.submit({});
+            task_graph.complete({});
+
+            for (u32 frame = 0; frame < 4; ++frame)
+            {
+                profiler.begin_frame();
+                task_graph.execute({});
+                profiler.end_frame();
+                app.device.wait_idle();
+            }
+        }
+        profiler.resolve();
+        // Every frame is waited for before the next one starts, so none can be dropped.
+        bool results_valid = profiler.results().size() == 4 && profiler.dropped_frame_count() == 0;
+        for (auto const & frame : profiler.results())
+        {
+            // Every task must have a profiler scope.
+            results_valid = results_valid && frame.scopes.size() == 2;
+            for (auto const & scope : frame.scopes)
+            {
+                results_valid = results_valid && scope.end_ns >= scope.begin_ns;
+            }
+        }
+        if (!results_valid)
+        {
+            std::cout << "failed test \"gpu_profiler\": expected one resolved scope per task for every frame" << std::endl;
+            std::exit(-1);
+        }
+        // The chrome trace holds one complete event per task scope.
+        auto const trace = profiler.chrome_trace_json();
+        if (trace.find("\"name\":\"clear\"") == std::string::npos || trace.find("\"name\":\"read\"") == std::string::npos ||
+            trace.find("\"ph\":\"X\"") == std::string::npos)
+        {
+            std::cout << "failed test \"gpu_profiler\": chrome trace is missing the task events" << std::endl;
+            std::exit(-1);
+        }
+        app.device.collect_garbage();
+    }
+
+    void gpu_conditional()
+    {
+        // TEST:
+        //    1) Write a condition value into a transient buffer on the gpu
+        //    2) Record one task in each branch of a gpu conditional on that value
+        //    Expected: Both branches are part of the only permutation, both callbacks are recorded in a single execution.
+        //              The branch tasks only read the condition buffer, they share one batch after the write.
+        using namespace daxa::task_resource_uses;
+        daxa::Instance daxa_ctx = daxa::create_instance({});
+        daxa::Device device;
+        try
+        {
+            device = daxa_ctx.create_device({
+                .flags = daxa::DeviceInfo{}.flags | daxa::DeviceFlagBits::CONDITIONAL_RENDERING,
+                .name = APPNAME_PREFIX("device (gpu_conditional)"),
+            });
+        }
+        catch (std::runtime_error const &)
+        {
+            std::cout << "Test skipped. No present device supports conditional rendering!" << std::endl;
+            return;
+        }
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = device,
+                .name = APPNAME_PREFIX("task_graph (gpu_conditional)"),
+            });
+            auto condition_buffer = task_graph.create_transient_buffer({.size = sizeof(u32), .name = "condition buffer"});
+            task_graph.add_task({
+                .uses = {BufferTransferWrite{condition_buffer}},
+                .task = [=](daxa::TaskInterface const & ti)
+                {
+                    ti.get_recorder().clear_buffer({
+                        .buffer = ti.uses[condition_buffer].buffer(),
+                        .size = sizeof(u32),
+                        .clear_value = 1,
+                    });
+                },
+                .name = "write condition",
+            });
+            u32 when_true_count = 0;
+            u32 when_false_count = 0;
+            task_graph.gpu_conditional({
+                .condition_buffer = condition_buffer,
+                .when_true = [&]()
+                {
+                    task_graph.add_task({
+                        .uses = {},
+                        .task = [&](daxa::TaskInterface const &)
+                        { when_true_count += 1; },
+                        .name = "when true",
+                    });
+                },
+                .when_false = [&]()
+                {
+                    task_graph.add_task({
+                        .uses = {},
+                        .task = [&](daxa::TaskInterface const &)
+                        { when_false_count += 1; },
+                        .name = "when false",
+                    });
+                },
+            });
+            task_graph.complete({});
+            task_graph.execute({});
+            auto const stats = task_graph.get_schedule_stats();
+            if (when_true_count != 1 || when_false_count != 1 || stats.batch_count != 2)
+            {
+                std::cout << "failed test \"gpu_conditional\": expected both branches recorded once in 2 batches, got "
+                          << when_true_count << ", " << when_false_count << " and " << stats.batch_count << " batches" << std::endl;
+                std::exit(-1);
+            }
+        }
+        device.wait_idle();
+        device.collect_garbage();
+    }
+
+    void gpu_conditional_write()
+    {
+        // TEST:
+        //    1) Clear a condition buffer to a cpu chosen value and a result buffer to zero
+        //    2) Each branch of a gpu conditional dispatches a shader writing a value into its own slot of the result buffer
+        //    3) Execute the completed graph once with a true and once with a false condition, read back the result buffer
+        //    Expected: Only the slot of the branch matching the condition is written, the other stays zero.
+        using namespace daxa::task_resource_uses;
+        daxa::Instance daxa_ctx = daxa::create_instance({});
+        daxa::Device device;
+        try
+        {
+            device = daxa_ctx.create_device({
+                .flags = daxa::DeviceInfo{}.flags | daxa::DeviceFlagBits::CONDITIONAL_RENDERING,
+                .name = APPNAME_PREFIX("device (gpu_conditional_write)"),
+            });
+        }
+        catch (std::runtime_error const &)
+        {
+            std::cout << "Test skipped. No present device supports conditional rendering!" << std::endl;
+            return;
+        }
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {
+                    DAXA_SHADER_INCLUDE_DIR,
+                    "tests/2_daxa_api/6_task_graph/shaders",
+                },
+            },
+            .name = "pipeline manager",
+        });
+        auto compile_result = pipeline_manager.add_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderFile{"gpu_conditional.glsl"}},
+            .push_constant_size = sizeof(GpuConditionalPush),
+            .name = "gpu conditional write pipeline",
+        });
+        auto pipeline = compile_result.value();
+
+        u32 constexpr WRITTEN_VALUE = 42;
+        auto condition_buffer = device.create_buffer({.size = sizeof(u32), .name = "condition buffer"});
+        auto result_buffer = device.create_buffer({
+            .size = sizeof(u32) * 2,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "result buffer",
+        });
+        auto task_condition_buffer = daxa::TaskBuffer({.initial_buffers = {.buffers = {&condition_buffer, 1}}, .name = "condition buffer"});
+        auto task_result_buffer = daxa::TaskBuffer({
+            .initial_buffers = {
+                .buffers = {&result_buffer, 1},
+                .latest_access = daxa::AccessConsts::HOST_WRITE,
+            },
+            .name = "result buffer",
+        });
+        {
+            u32 condition_value = 0;
+            auto task_graph = daxa::TaskGraph({
+                .device = device,
+                .name = APPNAME_PREFIX("task_graph (gpu_conditional_write)"),
+            });
+            task_graph.use_persistent_buffer(task_condition_buffer);
+            task_graph.use_persistent_buffer(task_result_buffer);
+            task_graph.add_task({
+                .uses = {BufferTransferWrite{task_condition_buffer}, BufferTransferWrite{task_result_buffer}},
+                .task = [&](daxa::TaskInterface const & ti)
+                {
+                    ti.get_recorder().clear_buffer({.buffer = ti.uses[task_condition_buffer].buffer(), .size = sizeof(u32), .clear_value = condition_value});
+                    ti.get_recorder().clear_buffer({.buffer = ti.uses[task_result_buffer].buffer(), .size = sizeof(u32) * 2, .clear_value = 0});
+                },
+                .name = "clear condition and result",
+            });
+            // Clears are not affected by conditional rendering, so the branches write through a dispatch.
+            auto add_write = [&](u32 slot, char const * name)
+            {
+                task_graph.add_task({
+                    .uses = {BufferComputeShaderWrite{task_result_buffer}},
+                    .task = [&, slot](daxa::TaskInterface const & ti)
+                    {
+                        auto & cmd = ti.get_recorder();
+                        cmd.set_pipeline(*pipeline);
+                        cmd.push_constant(GpuConditionalPush{
+                            .dst = ti.get_device().get_device_address(ti.uses[task_result_buffer].buffer()).value() + sizeof(u32) * slot,
+                            .value = WRITTEN_VALUE,
+                        });
+                        cmd.dispatch({1, 1, 1});
+                    },
+                    .name = name,
+                });
+            };
+            task_graph.gpu_conditional({
+                .condition_buffer = task_condition_buffer,
+                .when_true = [&]()
+                { add_write(0, "write when true"); },
+                .when_false = [&]()
+                { add_write(1, "write when false"); },
+            });
+            task_graph.add_task({
+                .uses = {BufferHostTransferRead{task_result_buffer}},
+                .task = [](daxa::TaskInterface const &) {},
+                .name = "make result visible to the host",
+            });
+            task_graph.submit({});
+            task_graph.complete({});
+
+            for (u32 condition : {1u, 0u})
+            {
+                condition_value = condition;
+                task_graph.execute({});
+                device.wait_idle();
+                u32 const * result = device.get_host_address_as<u32>(result_buffer).value();
+                u32 const expected_true = condition != 0 ? WRITTEN_VALUE : 0;
+                u32 const expected_false = condition != 0 ? 0 : WRITTEN_VALUE;
+                if (result[0] != expected_true || result[1] != expected_false)
+                {
+                    std::cout << "failed test \"gpu_conditional_write\": with condition " << condition << " expected ("
+                              << expected_true << ", " << expected_false << "), got (" << result[0] << ", " << result[1] << ")" << std::endl;
+                    std::exit(-1);
+                }
+            }
+        }
+        device.destroy_buffer(condition_buffer);
+        device.destroy_buffer(result_buffer);
+        device.collect_garbage();
+    }
+
+    void resizable_transients()
+    {
+        // TEST:
+        //    1) Create a half resolution transient image and a per pixel transient buffer relative to a named extent
+        //    2) Execute, change the extent and execute again without re-completing the graph
+        //    Expected: The transient resources are recreated with the new sizes, the schedule stays the same.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        auto task_graph = daxa::TaskGraph({
+            .device = app.device,
+            .name = APPNAME_PREFIX("task_graph (resizable_transients)"),
+        });
+        task_graph.set_transient_extent("render", {64, 64, 1});
+        auto task_image = task_graph.create_transient_image({
+            .size_extent = "render",
+            .size_extent_scale = {0.5f, 0.5f, 1.0f},
+            .name = "half resolution image",
+        });
+        auto task_buffer = task_graph.create_transient_buffer({
+            .size = sizeof(u32),
+            .size_extent = "render",
+            .name = "per pixel buffer",
+        });
+        daxa::Extent3D image_size = {};
+        daxa::usize buffer_size = {};
+        task_graph.add_task({
+            .uses = {ImageTransferWrite<>{task_image}, BufferTransferWrite{task_buffer}},
+            .task = [&](daxa::TaskInterface const & ti)
+            {
+                image_size = ti.get_device().info_image(ti.uses[task_image].image()).value().size;
+                buffer_size = ti.get_device().info_buffer(ti.uses[task_buffer].buffer()).value().size;
+                ti.get_recorder().clear_image({
+                    .dst_image_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                    .clear_value = {std::array<f32, 4>{1, 0, 1, 1}},
+                    .dst_image = ti.uses[task_image].image(),
+                });
+                ti.get_recorder().clear_buffer({.buffer = ti.uses[task_buffer].buffer(), .size = buffer_size});
+            },
+            .name = "clear transients",
+        });
+        task_graph.submit({});
+        task_graph.complete({});
+        auto const stats_before = task_graph.get_schedule_stats();
+
+        task_graph.execute({});
+        if (image_size != daxa::Extent3D{32, 32, 1} || buffer_size != 64 * 64 * sizeof(u32))
+        {
+            std::cout << "failed test \"resizable_transients\": wrong transient sizes before resizing" << std::endl;
+            std::exit(-1);
+        }
+        daxa::usize const memory_size_before = task_graph.get_transient_memory_size();
+
+        task_graph.set_transient_extent("render", {128, 96, 1});
+        task_graph.execute({});
+        auto const stats_after = task_graph.get_schedule_stats();
+        if (image_size != daxa::Extent3D{64, 48, 1} || buffer_size != 128 * 96 * sizeof(u32) ||
+            task_graph.get_transient_memory_size() <= memory_size_before ||
+            stats_after.batch_count != stats_before.batch_count || stats_after.barrier_count != stats_before.barrier_count)
+        {
+            std::cout << "failed test \"resizable_transients\": transients were not resized or the schedule changed" << std::endl;
+            std::exit(-1);
+        }
+        app.device.wait_idle();
+        app.device.collect_garbage();
+    }
+
+    void shared_transient_memory_heap()
+    {
+        // TEST:
+        //    1) Create two task graphs with differently sized transient buffers sharing one transient memory heap
+        //    2) Complete and execute the smaller graph first, then complete the larger one and execute both over multiple frames
+        //    Expected: The heap grows to the larger requirement, the smaller graph moves its transients into the grown heap.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        auto heap = daxa::TransientMemoryHeap({.device = app.device, .name = "shared transient memory heap"});
+        daxa::BufferId small_buffer = {};
+        auto create_graph = [&](u32 buffer_size, std::string const & name, daxa::BufferId * executed_buffer) -> daxa::TaskGraph
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = app.device,
+                .transient_memory_heap = heap,
+                .name = APPNAME_PREFIX("task_graph (shared_transient_memory_heap) ") + name,
+            });
+            auto task_buffer = task_graph.create_transient_buffer({.size = buffer_size, .name = name + " buffer"});
+            task_graph.add_task({
+                .uses = {BufferTransferWrite{task_buffer}},
+                .task = [=](daxa::TaskInterface const & ti)
+                {
+                    ti.get_recorder().clear_buffer({.buffer = ti.uses[task_buffer].buffer(), .size = buffer_size});
+                    if (executed_buffer != nullptr)
+                    {
+                        *executed_buffer = ti.uses[task_buffer].buffer();
+                    }
+                },
+                .name = "clear " + name,
+            });
+            task_graph.submit({});
+            task_graph.complete({});
+            return task_graph;
+        };
+        auto small_graph = create_graph(1024, "small", &small_buffer);
+        small_graph.execute({});
+        auto const small_size = heap.size();
+        auto const outgrown_small_buffer = small_buffer;
+        auto large_graph = create_graph(1024 * 1024, "large", nullptr);
+        auto const large_size = heap.size();
+        for (u32 frame = 0; frame < 3; ++frame)
+        {
+            small_graph.execute({});
+            large_graph.execute({});
+        }
+        app.device.wait_idle();
+        if (small_size >= large_size || large_size < large_graph.get_transient_memory_size() || heap.size() != large_size)
+        {
+            std::cout << "failed test \"shared_transient_memory_heap\": heap did not grow to the largest requirement" << std::endl;
+            std::exit(-1);
+        }
+        if (outgrown_small_buffer.is_empty() || small_buffer == outgrown_small_buffer)
+        {
+            std::cout << "failed test \"shared_transient_memory_heap\": small graph did not recreate its transient buffer in the grown heap" << std::endl;
+            std::exit(-1);
+        }
+        app.device.collect_garbage();
+        if (app.device.is_id_valid(outgrown_small_buffer))
+        {
+            std::cout << "failed test \"shared_transient_memory_heap\": transient buffer of the outgrown heap block was not destroyed" << std::endl;
+            std::exit(-1);
+        }
+    }
+
+    void transient_memory_report()
+    {
+        // TEST:
+        //    1) Complete a task graph with a transient buffer
+        //    2) Destroy the task graph
+        //    Expected: The memory report counts the transient memory block separately from the memory blocks created by the user.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        auto const before = app.device.memory_report();
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = app.device,
+                .name = APPNAME_PREFIX("task_graph (transient_memory_report)"),
+            });
+            auto task_buffer = task_graph.create_transient_buffer({.size = 1024, .name = "reported buffer"});
+            task_graph.add_task({
+                .uses = {BufferTransferWrite{task_buffer}},
+                .task = [=](daxa::TaskInterface const & ti)
+                {
+                    ti.get_recorder().clear_buffer({.buffer = ti.uses[task_buffer].buffer(), .size = 1024});
+                },
+                .name = "clear",
+            });
+            task_graph.submit({});
+            task_graph.complete({});
+            auto const with_graph = app.device.memory_report();
+            if (with_graph.transient_memory_block_count != before.transient_memory_block_count + 1 ||
+                with_graph.transient_memory_block_bytes < before.transient_memory_block_bytes + task_graph.get_transient_memory_size() ||
+                with_graph.memory_block_bytes != before.memory_block_bytes)
+            {
+                std::cout << "failed test \"transient_memory_report\": transient memory block is not reported separately" << std::endl;
+                std::exit(-1);
+            }
+        }
+        app.device.wait_idle();
+        app.device.collect_garbage();
+        auto const after = app.device.memory_report();
+        if (after.transient_memory_block_count != before.transient_memory_block_count || after.transient_memory_block_bytes != before.transient_memory_block_bytes)
+        {
+            std::cout << "failed test \"transient_memory_report\": destroyed transient memory block is still reported" << std::endl;
+            std::exit(-1);
+        }
+    }
+
+    void auto_submit()
+    {
+        // TEST:
+        //    1) Record a chain of clears and copies bouncing a value between two buffers, one batch per task
+        //    2) Execute with automatic submits after every batch and read back the result
+        //    Expected: Each batch is its own submit, the barriers between them still order the chain and the value arrives in the readback buffer.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        auto buffer_a = app.device.create_buffer({.size = sizeof(u32), .name = "auto submit buffer a"});
+        auto buffer_b = app.device.create_buffer({.size = sizeof(u32), .name = "auto submit buffer b"});
+        auto readback_buffer = app.device.create_buffer({
+            .size = sizeof(u32),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "auto submit readback buffer",
+        });
+        *app.device.get_host_address_as<u32>(readback_buffer).value() = 0;
+        auto task_buffer_a = daxa::TaskBuffer({.initial_buffers = {.buffers = {&buffer_a, 1}}, .name = "buffer a"});
+        auto task_buffer_b = daxa::TaskBuffer({.initial_buffers = {.buffers = {&buffer_b, 1}}, .name = "buffer b"});
+        auto task_readback_buffer = daxa::TaskBuffer({
+            .initial_buffers = {
+                .buffers = {&readback_buffer, 1},
+                .latest_access = daxa::AccessConsts::HOST_WRITE,
+            },
+            .name = "readback buffer",
+        });
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = app.device,
+                .auto_submit_batch_count = 1,
+                .name = APPNAME_PREFIX("task_graph (auto_submit)"),
+            });
+            task_graph.use_persistent_buffer(task_buffer_a);
+            task_graph.use_persistent_buffer(task_buffer_b);
+            task_graph.use_persistent_buffer(task_readback_buffer);
+            auto add_clear = [&](daxa::TaskBuffer const & dst, u32 value)
+            {
+                task_graph.add_task({
+                    .uses = {BufferTransferWrite{dst}},
+                    .task = [=](daxa::TaskInterface const & ti)
+                    {
+                        ti.get_recorder().clear_buffer({.buffer = ti.uses[dst].buffer(), .size = sizeof(u32), .clear_value = value});
+                    },
+                    .name = "clear",
+                });
+            };
+            auto add_copy = [&](daxa::TaskBuffer const & src, daxa::TaskBuffer const & dst)
+            {
+                task_graph.add_task({
+                    .uses = {BufferTransferRead{src}, BufferTransferWrite{dst}},
+                    .task = [=](daxa::TaskInterface const & ti)
+                    {
+                        ti.get_recorder().copy_buffer_to_buffer({
+                            .src_buffer = ti.uses[src].buffer(),
+                            .dst_buffer = ti.uses[dst].buffer(),
+                            .size = sizeof(u32),
+                        });
+                    },
+                    .name = "copy",
+                });
+            };
+            add_clear(task_buffer_a, 7);
+            add_copy(task_buffer_a, task_buffer_b);
+            add_clear(task_buffer_a, 0);
+            add_copy(task_buffer_b, task_buffer_a);
+            add_copy(task_buffer_a, task_readback_buffer);
+            task_graph.add_task({
+                .uses = {BufferHostTransferRead{task_readback_buffer}},
+                .task = [](daxa::TaskInterface const &) {},
+                .name = "make readback visible to the host",
+            });
+            task_graph.submit({});
+            task_graph.complete({});
+            task_graph.execute({});
+            app.device.wait_idle();
+        }
+        u32 const result = *app.device.get_host_address_as<u32>(readback_buffer).value();
+        if (result != 7)
+        {
+            std::cout << "failed test \"auto_submit\": expected 7 in the readback buffer, got " << result << std::endl;
+            std::exit(-1);
+        }
+        app.device.destroy_buffer(buffer_a);
+        app.device.destroy_buffer(buffer_b);
+        app.device.destroy_buffer(readback_buffer);
+        app.device.collect_garbage();
+    }
 } // namespace tests
 
 auto main() -> i32
@@ -494,7 +1115,19 @@ auto main() -> i32
     tests::create_transfer_read_buffer();
     tests::initial_layout_access();
     tests::tracked_slice_barrier_collapsing();
+    tests::mip_chain_compile_time();
+    tests::schedule_read_grouping();
+    tests::schedule_random_graphs();
+    tests::dead_task_culling();
+    tests::batch_barrier_merging();
     tests::correct_read_buffer_task_ordering();
+    tests::gpu_profiler();
+    tests::gpu_conditional();
+    tests::gpu_conditional_write();
+    tests::resizable_transients();
+    tests::shared_transient_memory_heap();
+    tests::transient_memory_report();
+    tests::auto_submit();
     tests::sharing_persistent_image();
     tests::sharing_persistent_buffer();
     tests::transient_write_aliasing();
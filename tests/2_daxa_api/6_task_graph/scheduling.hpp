@@ -0,0 +1,323 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <random>
+
+namespace tests
+{
+    // Records the same graph into a task graph using the recording order schedule and one using the optimized schedule.
+    // Both graphs are executed once, the optimized one last.
+    template <typename RecordFn>
+    auto compare_schedules(daxa::Device & device, RecordFn && record) -> std::pair<daxa::TaskGraphScheduleStats, daxa::TaskGraphScheduleStats>
+    {
+        std::array<daxa::TaskGraphScheduleStats, 2> stats = {};
+        for (u32 optimize = 0; optimize < 2; ++optimize)
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = device,
+                .optimize_schedule = optimize != 0,
+                .name = APPNAME_PREFIX("task_graph (scheduling)"),
+            });
+            record(task_graph);
+            task_graph.complete({});
+            task_graph.execute({});
+            stats[optimize] = task_graph.get_schedule_stats();
+        }
+        device.wait_idle();
+        return {stats[0], stats[1]};
+    }
+
+    void schedule_read_grouping()
+    {
+        // TEST:
+        //    1) Write an image
+        //    2) Read it alternating between sampled and transfer src layout
+        //    Expected: The optimized schedule groups the reads by layout, needing fewer batches and barriers.
+        //    The write still runs before all reads.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        auto image = app.device.create_image({
+            .size = {8, 8, 1},
+            .usage = daxa::ImageUsageFlagBits::SHADER_STORAGE | daxa::ImageUsageFlagBits::SHADER_SAMPLED | daxa::ImageUsageFlagBits::TRANSFER_SRC,
+            .name = "schedule read grouping image",
+        });
+        auto task_image = daxa::TaskImage({.initial_images = {.images = {&image, 1}}, .name = "schedule read grouping image"});
+        u32 executed_reads = 0;
+        auto [recording_order, optimized] = compare_schedules(
+            app.device,
+            [&](daxa::TaskGraph & task_graph)
+            {
+                task_graph.use_persistent_image(task_image);
+                task_graph.add_task({
+                    .uses = {ImageComputeShaderStorageWriteOnly<>{task_image}},
+                    .task = [&](daxa::TaskInterface const &)
+                    { executed_reads = 0; },
+                    .name = "write",
+                });
+                auto read = [&](daxa::TaskInterface const &)
+                {
+                    ++executed_reads;
+                };
+                for (u32 i = 0; i < 8; ++i)
+                {
+                    if (i % 2 == 0)
+                    {
+                        task_graph.add_task({
+                            .uses = {ImageComputeShaderSampled<>{task_image}},
+                            .task = read,
+                            .name = "sampled read",
+                        });
+                    }
+                    else
+                    {
+                        task_graph.add_task({
+                            .uses = {ImageTransferRead<>{task_image}},
+                            .task = read,
+                            .name = "transfer read",
+                        });
+                    }
+                }
+            });
+        if (optimized.batch_count != 3 || recording_order.batch_count != 9)
+        {
+            std::cout << "failed test \"schedule_read_grouping\": expected 3 optimized and 9 recording order batches" << std::endl;
+            std::exit(-1);
+        }
+        // The write resets the counter, so all reads only count if they ran after it.
+        if (executed_reads != 8)
+        {
+            std::cout << "failed test \"schedule_read_grouping\": " << 8 - executed_reads << " reads ran before the write in the optimized schedule" << std::endl;
+            std::exit(-1);
+        }
+        app.device.destroy_image(image);
+    }
+
+    void schedule_random_graphs()
+    {
+        // TEST:
+        //    1) Record random graphs of buffer and image mip reads and writes over multiple submits
+        //    2) Complete and execute each graph with both schedulers
+        //    Expected: Both schedules keep the submit scopes. In the optimized schedule,
+        //    every task runs after the earlier recorded tasks it has a read/write or write/write conflict with.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        constexpr u32 BUFFER_COUNT = 4;
+        constexpr u32 MIP_LEVEL_COUNT = 4;
+        constexpr u32 TASK_COUNT = 96;
+        std::array<daxa::BufferId, BUFFER_COUNT> buffers = {};
+        std::array<daxa::TaskBuffer, BUFFER_COUNT> task_buffers = {};
+        for (u32 i = 0; i < BUFFER_COUNT; ++i)
+        {
+            buffers[i] = app.device.create_buffer({.size = 64, .name = std::string("schedule buffer ") + std::to_string(i)});
+            task_buffers[i] = daxa::TaskBuffer({.initial_buffers = {.buffers = {&buffers[i], 1}}, .name = std::string("schedule buffer ") + std::to_string(i)});
+        }
+        auto image = app.device.create_image({
+            .size = {8, 8, 1},
+            .mip_level_count = MIP_LEVEL_COUNT,
+            .usage = daxa::ImageUsageFlagBits::SHADER_STORAGE | daxa::ImageUsageFlagBits::SHADER_SAMPLED | daxa::ImageUsageFlagBits::TRANSFER_SRC,
+            .name = "schedule image",
+        });
+        auto task_image = daxa::TaskImage({.initial_images = {.images = {&image, 1}}, .name = "schedule image"});
+
+        // Resources accessed by each task in recording order, used to derive the dependencies between tasks.
+        struct TaskAccess
+        {
+            std::optional<u32> buffer = {};
+            bool buffer_write = {};
+            std::optional<u32> mip = {};
+            bool image_write = {};
+        };
+        auto depends_on = [](TaskAccess const & later, TaskAccess const & earlier)
+        {
+            bool const buffer_dependency = later.buffer.has_value() && later.buffer == earlier.buffer && (later.buffer_write || earlier.buffer_write);
+            bool const image_dependency = later.mip.has_value() && later.mip == earlier.mip && (later.image_write || earlier.image_write);
+            return buffer_dependency || image_dependency;
+        };
+        std::vector<TaskAccess> accesses = {};
+        std::vector<u32> execution_positions = {};
+        u32 next_execution_position = 0;
+        for (u32 seed = 0; seed < 32; ++seed)
+        {
+            auto [recording_order, optimized] = compare_schedules(
+                app.device,
+                [&](daxa::TaskGraph & task_graph)
+                {
+                    std::mt19937 rng{seed};
+                    accesses.assign(TASK_COUNT, {});
+                    execution_positions.assign(TASK_COUNT, ~0u);
+                    next_execution_position = 0;
+                    for (auto const & task_buffer : task_buffers)
+                    {
+                        task_graph.use_persistent_buffer(task_buffer);
+                    }
+                    task_graph.use_persistent_image(task_image);
+                    for (u32 task_i = 0; task_i < TASK_COUNT; ++task_i)
+                    {
+                        u32 const buffer_index = rng() % BUFFER_COUNT;
+                        u32 const mip = rng() % MIP_LEVEL_COUNT;
+                        auto const image_view = task_image.view().view({.base_mip_level = mip});
+                        std::vector<daxa::GenericTaskResourceUse> uses = {};
+                        u32 const kind = rng() % 5;
+                        if (kind == 0)
+                        {
+                            uses = {BufferComputeShaderWrite{task_buffers[buffer_index]}};
+                            accesses[task_i] = {.buffer = buffer_index, .buffer_write = true};
+                        }
+                        else if (kind == 1)
+                        {
+                            uses = {BufferComputeShaderRead{task_buffers[buffer_index]}, ImageComputeShaderSampled<>{image_view}};
+                            accesses[task_i] = {.buffer = buffer_index, .mip = mip};
+                        }
+                        else if (kind == 2)
+                        {
+                            uses = {BufferComputeShaderRead{task_buffers[buffer_index]}, ImageComputeShaderStorageWriteOnly<>{image_view}};
+                            accesses[task_i] = {.buffer = buffer_index, .mip = mip, .image_write = true};
+                        }
+                        else if (kind == 3)
+                        {
+                            uses = {ImageTransferRead<>{image_view}};
+                            accesses[task_i] = {.mip = mip};
+                        }
+                        else
+                        {
+                            uses = {BufferComputeShaderRead{task_buffers[buffer_index]}};
+                            accesses[task_i] = {.buffer = buffer_index};
+                        }
+                        task_graph.add_task({
+                            .uses = std::move(uses),
+                            .task = [&, task_i](daxa::TaskInterface const &)
+                            { execution_positions[task_i] = next_execution_position++; },
+                            .name = "random task",
+                        });
+                        if (task_i % 32 == 31)
+                        {
+                            task_graph.submit({});
+                        }
+                    }
+                });
+            if (optimized.submit_scope_count != recording_order.submit_scope_count)
+            {
+                std::cout << "failed test \"schedule_random_graphs\": optimized schedule of seed " << seed << " changed the submit scopes" << std::endl;
+                std::exit(-1);
+            }
+            // The optimized graph executed last, so the execution positions are the ones of the optimized schedule.
+            for (u32 later = 0; later < TASK_COUNT; ++later)
+            {
+                if (execution_positions[later] == ~0u)
+                {
+                    std::cout << "failed test \"schedule_random_graphs\": task " << later << " of seed " << seed << " did not run" << std::endl;
+                    std::exit(-1);
+                }
+                for (u32 earlier = 0; earlier < later; ++earlier)
+                {
+                    if (depends_on(accesses[later], accesses[earlier]) && execution_positions[earlier] > execution_positions[later])
+                    {
+                        std::cout << "failed test \"schedule_random_graphs\": task " << later << " of seed " << seed << " ran before task " << earlier << " it depends on" << std::endl;
+                        std::exit(-1);
+                    }
+                }
+            }
+        }
+        for (auto const & buffer : buffers)
+        {
+            app.device.destroy_buffer(buffer);
+        }
+        app.device.destroy_image(image);
+    }
+
+    void dead_task_culling()
+    {
+        // TEST:
+        //    1) Write a transient buffer, read it in a second task that writes another transient buffer nobody reads
+        //    2) Write a persistent buffer in an independent task
+        //    3) Complete the graph with and without dead task culling, then again with the second task marked as side effecting
+        //    Expected: Culling removes the whole dead chain, leaving a single batch. The side effecting task and its input are kept.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        auto task_buffer = daxa::TaskBuffer({.name = "dead task culling persistent buffer"});
+        auto batch_count = [&](bool cull_dead_tasks, bool side_effects) -> u32
+        {
+            auto task_graph = daxa::TaskGraph({
+                .device = app.device,
+                .cull_dead_tasks = cull_dead_tasks,
+                .name = APPNAME_PREFIX("task_graph (dead_task_culling)"),
+            });
+            task_graph.use_persistent_buffer(task_buffer);
+            auto transient_a = task_graph.create_transient_buffer({.size = 64, .name = "dead task culling transient a"});
+            auto transient_b = task_graph.create_transient_buffer({.size = 64, .name = "dead task culling transient b"});
+            task_graph.add_task({
+                .uses = {BufferComputeShaderWrite{transient_a}},
+                .task = [](daxa::TaskInterface const &) {},
+                .name = "write transient a",
+            });
+            task_graph.add_task({
+                .uses = {BufferComputeShaderRead{transient_a}, BufferComputeShaderWrite{transient_b}},
+                .task = [](daxa::TaskInterface const &) {},
+                .name = "read transient a write transient b",
+                .side_effects = side_effects,
+            });
+            task_graph.add_task({
+                .uses = {BufferComputeShaderWrite{task_buffer}},
+                .task = [](daxa::TaskInterface const &) {},
+                .name = "write persistent buffer",
+            });
+            task_graph.complete({});
+            return task_graph.get_schedule_stats().batch_count;
+        };
+        u32 const unculled = batch_count(false, false);
+        u32 const culled = batch_count(true, false);
+        u32 const culled_side_effects = batch_count(true, true);
+        if (unculled != 2 || culled != 1 || culled_side_effects != 2)
+        {
+            std::cout << "failed test \"dead_task_culling\": expected 2, 1 and 2 batches, got " << unculled << ", " << culled << " and " << culled_side_effects << std::endl;
+            std::exit(-1);
+        }
+    }
+
+    void batch_barrier_merging()
+    {
+        // TEST:
+        //    1) Write four buffers in one task
+        //    2) Read all of them in a second task
+        //    Expected: Four buffer barriers are generated between the batches, they are merged into a single memory barrier.
+        using namespace daxa::task_resource_uses;
+        AppContext app = {};
+        std::array<daxa::TaskBuffer, 4> task_buffers = {};
+        for (u32 i = 0; i < task_buffers.size(); ++i)
+        {
+            task_buffers[i] = daxa::TaskBuffer({.name = std::string("barrier merging buffer ") + std::to_string(i)});
+        }
+        auto task_graph = daxa::TaskGraph({
+            .device = app.device,
+            .use_split_barriers = false,
+            .name = APPNAME_PREFIX("task_graph (batch_barrier_merging)"),
+        });
+        std::vector<daxa::GenericTaskResourceUse> write_uses = {};
+        std::vector<daxa::GenericTaskResourceUse> read_uses = {};
+        for (auto const & task_buffer : task_buffers)
+        {
+            task_graph.use_persistent_buffer(task_buffer);
+            write_uses.push_back(BufferComputeShaderWrite{task_buffer});
+            read_uses.push_back(BufferComputeShaderRead{task_buffer});
+        }
+        task_graph.add_task({
+            .uses = std::move(write_uses),
+            .task = [](daxa::TaskInterface const &) {},
+            .name = "write buffers",
+        });
+        task_graph.add_task({
+            .uses = std::move(read_uses),
+            .task = [](daxa::TaskInterface const &) {},
+            .name = "read buffers",
+        });
+        task_graph.complete({});
+        auto const stats = task_graph.get_schedule_stats();
+        if (stats.barrier_count + stats.split_barrier_count != 4 || stats.merged_barrier_count != 1)
+        {
+            std::cout << "failed test \"batch_barrier_merging\": expected 4 barriers merged into 1, got "
+                      << stats.barrier_count + stats.split_barrier_count << " merged into " << stats.merged_barrier_count << std::endl;
+            std::exit(-1);
+        }
+    }
+} // namespace tests
@@ -0,0 +1,11 @@
+#include <daxa/daxa.inl>
+
+#include "shared.inl"
+
+DAXA_DECL_PUSH_CONSTANT(GpuConditionalPush, push)
+
+layout(local_size_x = 1) in;
+void main()
+{
+    deref(push.dst) = push.value;
+}
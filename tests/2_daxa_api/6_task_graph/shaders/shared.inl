@@ -34,3 +34,9 @@ struct DrawPush
 {
     daxa_BufferPtr(DrawVertex) vertex_buffer;
 };
+
+struct GpuConditionalPush
+{
+    daxa_RWBufferPtr(daxa_u32) dst;
+    daxa_u32 value;
+};
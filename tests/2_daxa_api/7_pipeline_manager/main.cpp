@@ -211,6 +211,82 @@ namespace tests
         return 0;
     }
 
+    auto async_compilation(daxa::Device & device) -> i32
+    {
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {
+                    DAXA_SHADER_INCLUDE_DIR,
+                    DAXA_SAMPLE_PATH "/shaders",
+                    "tests/0_common/shaders",
+                },
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .async_compilation = true,
+            .name = APPNAME_PREFIX("pipeline_manager"),
+        });
+
+        // The fallback is used until the async compilation is swapped in.
+        auto fallback_result = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {
+                    DAXA_SHADER_INCLUDE_DIR,
+                    DAXA_SAMPLE_PATH "/shaders",
+                    "tests/0_common/shaders",
+                },
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .name = APPNAME_PREFIX("fallback_pipeline_manager"),
+        }).add_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderFile{"main.glsl"}},
+            .name = APPNAME_PREFIX("fallback_compute_pipeline"),
+        });
+        if (fallback_result.is_err())
+        {
+            std::cerr << "Failed to compile the fallback compute_pipeline!\n";
+            std::cerr << fallback_result.message() << std::endl;
+            return -1;
+        }
+
+        auto compilation_result = pipeline_manager.add_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderFile{"main.glsl"}},
+            .name = APPNAME_PREFIX("compute_pipeline"),
+            .fallback_pipeline = *fallback_result.value(),
+        });
+
+        // Async compilations never fail on add, errors are reported by reload_all/wait_for_async_compilations.
+        if (compilation_result.is_err() || !compilation_result.value()->is_valid())
+        {
+            std::cerr << "Async add_compute_pipeline must return the fallback pipeline!\n";
+            return -1;
+        }
+
+        auto wait_result = pipeline_manager.wait_for_async_compilations();
+        if (auto * wait_err = daxa::get_if<daxa::PipelineReloadError>(&wait_result))
+        {
+            std::cerr << "Failed to compile the compute_pipeline!\n";
+            std::cerr << wait_err->message << std::endl;
+            return -1;
+        }
+        if (pipeline_manager.pending_async_compilations() != 0)
+        {
+            std::cerr << "All async compilations must be applied after waiting for them!\n";
+            return -1;
+        }
+
+        // The pipeline returned on add must now hold the compiled pipeline instead of the fallback.
+        auto const & compiled_pipeline = *compilation_result.value();
+        if (!compiled_pipeline.is_valid() || compiled_pipeline.info().name.view() != APPNAME_PREFIX("compute_pipeline"))
+        {
+            std::cerr << "The compiled pipeline must replace the fallback pipeline after waiting for it!\n";
+            return -1;
+        }
+
+        return 0;
+    }
+
     auto multi_thread(daxa::Device & device) -> i32
     {
         auto test_wrapper_0 = [](daxa::Device & a_device, i32 & ret)
@@ -281,6 +357,10 @@ auto main() -> int
     {
         return ret;
     }
+    if (ret = tests::async_compilation(device); ret != 0)
+    {
+        return ret;
+    }
     if (ret = tests::multi_thread(device); ret != 0)
     {
         return ret;
@@ -3,11 +3,799 @@ using namespace daxa::types;
 
 #include <daxa/utils/mem.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <thread>
+#include <vector>
 
 static inline constexpr usize ITERATION_COUNT = {1000};
 static inline constexpr usize ELEMENT_COUNT = {17};
 
+static void transfer_memory_pool_threaded_growth(daxa::Device & device)
+{
+    static constexpr u32 THREAD_COUNT = 8;
+    static constexpr u32 ALLOCATIONS_PER_THREAD = 256;
+    daxa::TransferMemoryPool tmem{daxa::TransferMemoryPoolInfo{
+        .device = device,
+        .capacity = 1024,
+        .allow_growth = true,
+        .per_frame_retirement = true,
+        .name = "growing transfer memory pool",
+    }};
+    std::array<std::vector<daxa::TransferMemoryPool::Allocation>, THREAD_COUNT> thread_allocations = {};
+    std::vector<std::thread> threads = {};
+    for (u32 thread_i = 0; thread_i < THREAD_COUNT; ++thread_i)
+    {
+        threads.emplace_back([&, thread_i]()
+                             {
+            for (u32 i = 0; i < ALLOCATIONS_PER_THREAD; ++i)
+            {
+                auto allocation = tmem.allocate(sizeof(u32) * (1 + i % 7), 16);
+                if (!allocation.has_value())
+                {
+                    return;
+                }
+                *reinterpret_cast<u32 *>(allocation->host_address) = thread_i;
+                thread_allocations[thread_i].push_back(allocation.value());
+            } });
+    }
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+    std::vector<daxa::TransferMemoryPool::Allocation> allocations = {};
+    for (u32 thread_i = 0; thread_i < THREAD_COUNT; ++thread_i)
+    {
+        if (thread_allocations[thread_i].size() != ALLOCATIONS_PER_THREAD)
+        {
+            std::cout << "failed test \"transfer_memory_pool_threaded_growth\": allocation failed despite growth" << std::endl;
+            exit(-1);
+        }
+        for (auto const & allocation : thread_allocations[thread_i])
+        {
+            if (allocation.buffer_offset % 16 != 0 || *reinterpret_cast<u32 *>(allocation.host_address) != thread_i)
+            {
+                std::cout << "failed test \"transfer_memory_pool_threaded_growth\": allocation is misaligned or was overwritten" << std::endl;
+                exit(-1);
+            }
+            allocations.push_back(allocation);
+        }
+    }
+    std::sort(allocations.begin(), allocations.end(), [](auto const & a, auto const & b)
+              { return std::pair{a.buffer, a.buffer_offset} < std::pair{b.buffer, b.buffer_offset}; });
+    for (usize i = 1; i < allocations.size(); ++i)
+    {
+        if (allocations[i - 1].buffer == allocations[i].buffer && allocations[i - 1].buffer_offset + allocations[i - 1].size > allocations[i].buffer_offset)
+        {
+            std::cout << "failed test \"transfer_memory_pool_threaded_growth\": allocations overlap" << std::endl;
+            exit(-1);
+        }
+    }
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    auto signals = std::array{std::pair{tmem.timeline_semaphore(), tmem.timeline_value()}};
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+        .signal_timeline_semaphores = signals,
+    });
+    device.wait_idle();
+    // The outgrown buffers are destroyed once their frame retired, new allocations all come from the grown buffer.
+    tmem.advance_timeline();
+    auto const allocation = tmem.allocate(sizeof(u32)).value();
+    if (allocation.buffer != tmem.buffer() || allocation.timeline_index != 2)
+    {
+        std::cout << "failed test \"transfer_memory_pool_threaded_growth\": allocation after retirement is not from the current buffer" << std::endl;
+        exit(-1);
+    }
+}
+
+static void upload_queue(daxa::Device & device)
+{
+    static constexpr u32 THREAD_COUNT = 4;
+    static constexpr u32 WRITES_PER_THREAD = 64;
+    static constexpr u32 VALUES_PER_WRITE = 4;
+    static constexpr u32 VALUE_COUNT = THREAD_COUNT * WRITES_PER_THREAD * VALUES_PER_WRITE;
+    daxa::UploadQueue upload_queue{daxa::UploadQueueInfo{
+        .device = device,
+        .staging_capacity = 1u << 12u,
+        .name = "upload queue",
+    }};
+    daxa::BufferId buffer = device.create_buffer({
+        .size = sizeof(u32) * (VALUE_COUNT + 4),
+        .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+        .name = "upload queue dst",
+    });
+    // Each thread uploads its own contiguous range in small writes, these are coalesced into one copy per thread.
+    std::vector<std::thread> threads = {};
+    for (u32 thread_i = 0; thread_i < THREAD_COUNT; ++thread_i)
+    {
+        threads.emplace_back([&, thread_i]()
+                             {
+            for (u32 write_i = 0; write_i < WRITES_PER_THREAD; ++write_i)
+            {
+                u32 const first_value = (thread_i * WRITES_PER_THREAD + write_i) * VALUES_PER_WRITE;
+                std::array<u32, VALUES_PER_WRITE> values = {};
+                for (u32 i = 0; i < VALUES_PER_WRITE; ++i)
+                {
+                    values[i] = first_value + i;
+                }
+                upload_queue.upload_buffer({
+                    .dst_buffer = buffer,
+                    .dst_offset = sizeof(u32) * first_value,
+                    .data = std::as_bytes(std::span{values}),
+                });
+            } });
+    }
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+    // Overlaps the end of the previous uploads, must be copied after them.
+    std::array<u32, 2> const overlapping_values = {1000000, 1000001};
+    upload_queue.upload_buffer({
+        .dst_buffer = buffer,
+        .dst_offset = sizeof(u32) * (VALUE_COUNT - 1),
+        .data = std::as_bytes(std::span{overlapping_values}),
+    });
+    auto const file_path = std::filesystem::temp_directory_path() / "daxa_upload_queue_test.bin";
+    {
+        std::array<u32, 4> const file_values = {7, 8, 9, 10};
+        std::ofstream file{file_path, std::ios::binary};
+        file.write(reinterpret_cast<char const *>(file_values.data()), sizeof(file_values));
+    }
+    bool const file_read = upload_queue.upload_file({
+        .path = file_path,
+        .file_offset = sizeof(u32) * 2,
+        .dst_buffer = buffer,
+        .dst_offset = sizeof(u32) * (VALUE_COUNT + 2),
+    });
+    std::filesystem::remove(file_path);
+
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    auto const flush = upload_queue.flush(cmd, {.dst_access = daxa::AccessConsts::HOST_READ});
+    auto signals = std::array{std::pair{upload_queue.timeline_semaphore(), flush.timeline_value}};
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+        .signal_timeline_semaphores = signals,
+    });
+    device.wait_idle();
+
+    u32 const * values = device.get_host_address_as<u32>(buffer).value();
+    bool values_correct = file_read && values[VALUE_COUNT + 2] == 9 && values[VALUE_COUNT + 3] == 10;
+    for (u32 i = 0; i < VALUE_COUNT - 1; ++i)
+    {
+        values_correct = values_correct && values[i] == i;
+    }
+    values_correct = values_correct && values[VALUE_COUNT - 1] == 1000000 && values[VALUE_COUNT] == 1000001;
+    if (!values_correct)
+    {
+        std::cout << "failed test \"upload_queue\": uploaded values are wrong" << std::endl;
+        exit(-1);
+    }
+    if (flush.stats.write_count != THREAD_COUNT * WRITES_PER_THREAD + 2)
+    {
+        std::cout << "failed test \"upload_queue\": wrong write count" << std::endl;
+        exit(-1);
+    }
+
+    // Writes from a single thread to adjacent ranges are contiguous in the staging memory and coalesce into one copy.
+    for (u32 i = 0; i < VALUE_COUNT; ++i)
+    {
+        u32 const value = VALUE_COUNT - i;
+        upload_queue.upload_buffer({
+            .dst_buffer = buffer,
+            .dst_offset = sizeof(u32) * i,
+            .data = std::as_bytes(std::span{&value, 1}),
+        });
+    }
+    daxa::CommandRecorder coalesce_cmd = device.create_command_recorder({});
+    auto const coalesce_flush = upload_queue.flush(coalesce_cmd, {.dst_access = daxa::AccessConsts::HOST_READ});
+    auto coalesce_signals = std::array{std::pair{upload_queue.timeline_semaphore(), coalesce_flush.timeline_value}};
+    device.submit_commands({
+        .command_lists = std::array{coalesce_cmd.complete_current_commands()},
+        .signal_timeline_semaphores = coalesce_signals,
+    });
+    device.wait_idle();
+    if (coalesce_flush.stats.buffer_copy_count != 1 || values[0] != VALUE_COUNT || values[VALUE_COUNT - 1] != 1)
+    {
+        std::cout << "failed test \"upload_queue\": adjacent writes were not coalesced" << std::endl;
+        exit(-1);
+    }
+    if (upload_queue.stats().write_count != flush.stats.write_count + coalesce_flush.stats.write_count)
+    {
+        std::cout << "failed test \"upload_queue\": total stats do not sum up the flushes" << std::endl;
+        exit(-1);
+    }
+    device.destroy_buffer(buffer);
+}
+
+static void upload_queue_image(daxa::Device & device)
+{
+    static constexpr u32 IMAGE_SIZE = 8;
+    static constexpr u32 LAYER_COUNT = 2;
+    static constexpr u32 TEXEL_COUNT = IMAGE_SIZE * IMAGE_SIZE;
+    daxa::UploadQueue upload_queue{daxa::UploadQueueInfo{
+        .device = device,
+        .staging_capacity = 1u << 12u,
+        .name = "upload queue image",
+    }};
+    daxa::ImageId image = device.create_image({
+        .format = daxa::Format::R32G32B32A32_UINT,
+        .size = {IMAGE_SIZE, IMAGE_SIZE, 1},
+        .array_layer_count = LAYER_COUNT,
+        .usage = daxa::ImageUsageFlagBits::TRANSFER_SRC | daxa::ImageUsageFlagBits::TRANSFER_DST,
+        .name = "upload queue dst image",
+    });
+    daxa::BufferId scratch_buffer = device.create_buffer({
+        .size = 16,
+        .name = "upload queue scratch",
+    });
+    daxa::BufferId readback_buffer = device.create_buffer({
+        .size = sizeof(u32) * 4 * TEXEL_COUNT * LAYER_COUNT,
+        .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+        .name = "upload queue image readback",
+    });
+    // An odd sized buffer write first, the image writes must still land on offsets aligned to the 16 byte texels.
+    std::array<std::byte, 3> const odd_values = {};
+    upload_queue.upload_buffer({.dst_buffer = scratch_buffer, .data = odd_values});
+    // Each layer is its own slice with its own transition, the second write to layer 0 shares the transition of the first.
+    std::array<std::array<u32, 4 * TEXEL_COUNT>, LAYER_COUNT> texels = {};
+    for (u32 layer = 0; layer < LAYER_COUNT; ++layer)
+    {
+        for (u32 i = 0; i < 4 * TEXEL_COUNT; ++i)
+        {
+            texels[layer][i] = layer * 1000 + i;
+        }
+        upload_queue.upload_image({
+            .dst_image = image,
+            .image_slice = {.base_array_layer = layer},
+            .image_extent = {IMAGE_SIZE, IMAGE_SIZE, 1},
+            .data = std::as_bytes(std::span{texels[layer]}),
+            .dst_layout = daxa::ImageLayout::TRANSFER_SRC_OPTIMAL,
+        });
+    }
+    std::array<u32, 4> const overwrite_texel = {7, 7, 7, 7};
+    std::memcpy(texels[0].data() + 4 * (TEXEL_COUNT - 1), overwrite_texel.data(), sizeof(overwrite_texel));
+    upload_queue.upload_image({
+        .dst_image = image,
+        .image_offset = {IMAGE_SIZE - 1, IMAGE_SIZE - 1, 0},
+        .image_extent = {1, 1, 1},
+        .data = std::as_bytes(std::span{overwrite_texel}),
+        .src_layout = daxa::ImageLayout::UNDEFINED,
+        .dst_layout = daxa::ImageLayout::TRANSFER_SRC_OPTIMAL,
+    });
+
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    auto const flush = upload_queue.flush(cmd, {.dst_access = daxa::AccessConsts::TRANSFER_READ});
+    for (u32 layer = 0; layer < LAYER_COUNT; ++layer)
+    {
+        cmd.copy_image_to_buffer({
+            .image = image,
+            .image_slice = {.base_array_layer = layer},
+            .image_extent = {IMAGE_SIZE, IMAGE_SIZE, 1},
+            .buffer = readback_buffer,
+            .buffer_offset = sizeof(u32) * 4 * TEXEL_COUNT * layer,
+        });
+    }
+    cmd.pipeline_barrier({
+        .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+        .dst_access = daxa::AccessConsts::HOST_READ,
+    });
+    auto signals = std::array{std::pair{upload_queue.timeline_semaphore(), flush.timeline_value}};
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+        .signal_timeline_semaphores = signals,
+    });
+    device.wait_idle();
+
+    // One barrier before and after the buffer write, one transition before and after each slice,
+    // and one barrier ordering the overwrite of the last texel after the write of the whole layer.
+    if (flush.stats.image_copy_count != LAYER_COUNT + 1 || flush.stats.barrier_count != 3 + 2 * LAYER_COUNT)
+    {
+        std::cout << "failed test \"upload_queue_image\": expected one copy per write, one transition pair per slice and one barrier before the overwrite" << std::endl;
+        exit(-1);
+    }
+    u32 const * readback = device.get_host_address_as<u32>(readback_buffer).value();
+    for (u32 layer = 0; layer < LAYER_COUNT; ++layer)
+    {
+        if (std::memcmp(readback + 4 * TEXEL_COUNT * layer, texels[layer].data(), sizeof(texels[layer])) != 0)
+        {
+            std::cout << "failed test \"upload_queue_image\": layer " << layer << " has wrong texels" << std::endl;
+            exit(-1);
+        }
+    }
+    device.destroy_buffer(readback_buffer);
+    device.destroy_buffer(scratch_buffer);
+    device.destroy_image(image);
+}
+
+static void readback_ring(daxa::Device & device)
+{
+    daxa::ReadbackRing readback_ring{daxa::ReadbackRingInfo{
+        .device = device,
+        .capacity = 1024,
+        .name = "readback ring",
+    }};
+    daxa::BufferId src_buffer = device.create_buffer({
+        .size = sizeof(u32) * 64,
+        .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+        .name = "readback src",
+    });
+    u32 * src_values = device.get_host_address_as<u32>(src_buffer).value();
+    for (u32 i = 0; i < 64; ++i)
+    {
+        src_values[i] = i * 3;
+    }
+
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    u32 callback_sum = 0;
+    auto const callback_readback = readback_ring.readback_buffer(
+        cmd, {.src_buffer = src_buffer, .src_offset = sizeof(u32) * 8, .size = sizeof(u32) * 4},
+        [&](std::span<std::byte const> data)
+        {
+            for (u32 i = 0; i < 4; ++i)
+            {
+                callback_sum += reinterpret_cast<u32 const *>(data.data())[i];
+            }
+        });
+    auto const polled_readback = readback_ring.readback_buffer(cmd, {.src_buffer = src_buffer, .size = sizeof(u32) * 64});
+    // The ring is too small to hold another copy of the whole source.
+    auto const failed_readback = readback_ring.readback_buffer(cmd, {.src_buffer = src_buffer, .size = 1024});
+    if (!callback_readback.has_value() || !polled_readback.has_value() || failed_readback.has_value())
+    {
+        std::cout << "failed test \"readback_ring\": unexpected allocation result" << std::endl;
+        exit(-1);
+    }
+    if (readback_ring.try_read(polled_readback.value()).has_value())
+    {
+        std::cout << "failed test \"readback_ring\": readback was available before the gpu executed it" << std::endl;
+        exit(-1);
+    }
+    readback_ring.flush(cmd);
+    auto signals = std::array{std::pair{readback_ring.timeline_semaphore(), readback_ring.timeline_value()}};
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+        .signal_timeline_semaphores = signals,
+    });
+    readback_ring.advance_timeline();
+    device.wait_idle();
+
+    auto const polled_data = readback_ring.try_read(polled_readback.value());
+    if (!polled_data.has_value() || reinterpret_cast<u32 const *>(polled_data->data())[63] != 63 * 3)
+    {
+        std::cout << "failed test \"readback_ring\": finished readback has wrong data" << std::endl;
+        exit(-1);
+    }
+    if (readback_ring.poll() != 1 || callback_sum != (8 + 9 + 10 + 11) * 3 || readback_ring.try_read(polled_readback.value()).has_value())
+    {
+        std::cout << "failed test \"readback_ring\": callback was not invoked or the slot was not reclaimed" << std::endl;
+        exit(-1);
+    }
+    device.destroy_buffer(src_buffer);
+}
+
+static void readback_ring_image(daxa::Device & device)
+{
+    daxa::ReadbackRing readback_ring{daxa::ReadbackRingInfo{
+        .device = device,
+        .capacity = 1024,
+        .name = "readback ring image",
+    }};
+    constexpr u32 SIZE = 4;
+    daxa::ImageId image = device.create_image({
+        .format = daxa::Format::R32G32B32A32_UINT,
+        .size = {SIZE, SIZE, 1},
+        .usage = daxa::ImageUsageFlagBits::TRANSFER_SRC | daxa::ImageUsageFlagBits::TRANSFER_DST,
+        .name = "readback ring image",
+    });
+    daxa::BufferId src_buffer = device.create_buffer({
+        .size = sizeof(u32),
+        .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+        .name = "readback ring image src",
+    });
+    *device.get_host_address_as<u32>(src_buffer).value() = 7;
+    auto const clear_value = std::array<u32, 4>{1, 2, 3, 4};
+
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    cmd.pipeline_barrier_image_transition({
+        .dst_access = daxa::AccessConsts::TRANSFER_WRITE,
+        .src_layout = daxa::ImageLayout::UNDEFINED,
+        .dst_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+        .image_id = image,
+    });
+    cmd.clear_image({.clear_value = {clear_value}, .dst_image = image});
+    cmd.pipeline_barrier_image_transition({
+        .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+        .dst_access = daxa::AccessConsts::TRANSFER_READ,
+        .src_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+        .dst_layout = daxa::ImageLayout::TRANSFER_SRC_OPTIMAL,
+        .image_id = image,
+    });
+    // The 4 byte buffer readback leaves the ring head unaligned for the 16 byte texels of the image.
+    auto const buffer_readback = readback_ring.readback_buffer(cmd, {.src_buffer = src_buffer, .size = sizeof(u32)});
+    auto const image_readback = readback_ring.readback_image(cmd, {
+                                                                      .src_image = image,
+                                                                      .image_extent = {SIZE, SIZE, 1},
+                                                                      .size = sizeof(u32) * 4 * SIZE * SIZE,
+                                                                  });
+    if (!buffer_readback.has_value() || !image_readback.has_value() || image_readback->buffer_offset % 16 != 0)
+    {
+        std::cout << "failed test \"readback_ring_image\": unexpected allocation result" << std::endl;
+        exit(-1);
+    }
+    readback_ring.flush(cmd);
+    auto signals = std::array{std::pair{readback_ring.timeline_semaphore(), readback_ring.timeline_value()}};
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+        .signal_timeline_semaphores = signals,
+    });
+    readback_ring.advance_timeline();
+    device.wait_idle();
+
+    auto const image_data = readback_ring.try_read(image_readback.value());
+    if (!image_data.has_value())
+    {
+        std::cout << "failed test \"readback_ring_image\": finished readback was not available" << std::endl;
+        exit(-1);
+    }
+    u32 const * texels = reinterpret_cast<u32 const *>(image_data->data());
+    for (u32 i = 0; i < SIZE * SIZE * 4; ++i)
+    {
+        if (texels[i] != clear_value[i % 4])
+        {
+            std::cout << "failed test \"readback_ring_image\": texel " << i / 4 << " does not hold the clear value" << std::endl;
+            exit(-1);
+        }
+    }
+    device.destroy_buffer(src_buffer);
+    device.destroy_image(image);
+}
+
+static void buffer_suballocator(daxa::Device & device)
+{
+    daxa::BufferSuballocator suballocator{daxa::BufferSuballocatorInfo{
+        .device = device,
+        .capacity = 1u << 16u,
+        .min_allocation_size = 256,
+        .name = "buffer suballocator",
+    }};
+    std::vector<daxa::BufferSuballocator::Allocation> allocations = {};
+    for (u64 size : {1ull, 100ull, 256ull, 257ull, 1000ull, 4096ull, 300ull})
+    {
+        auto allocation = suballocator.allocate(size, 512).value();
+        if (allocation.buffer_offset % 512 != 0 || allocation.size < size)
+        {
+            std::cout << "failed test \"buffer_suballocator\": allocation is misaligned or too small" << std::endl;
+            exit(-1);
+        }
+        for (auto const & other : allocations)
+        {
+            if (allocation.buffer_offset < other.buffer_offset + other.size && other.buffer_offset < allocation.buffer_offset + allocation.size)
+            {
+                std::cout << "failed test \"buffer_suballocator\": allocations overlap" << std::endl;
+                exit(-1);
+            }
+        }
+        allocations.push_back(allocation);
+    }
+    if (suballocator.allocate(1u << 17u).has_value())
+    {
+        std::cout << "failed test \"buffer_suballocator\": allocation larger than the capacity succeeded" << std::endl;
+        exit(-1);
+    }
+    for (auto const & allocation : allocations)
+    {
+        suballocator.free(allocation);
+    }
+    // Freed blocks stay in use until the gpu reached the timeline value they were freed at.
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    auto signals = std::array{std::pair{suballocator.timeline_semaphore(), suballocator.timeline_value()}};
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+        .signal_timeline_semaphores = signals,
+    });
+    suballocator.advance_timeline();
+    device.wait_idle();
+    // The whole buffer is only available again when all freed blocks merged back together.
+    auto const whole = suballocator.allocate(1u << 16u);
+    if (!whole.has_value() || suballocator.used_size() != (1u << 16u))
+    {
+        std::cout << "failed test \"buffer_suballocator\": freed blocks were not reclaimed" << std::endl;
+        exit(-1);
+    }
+    suballocator.free(whole.value());
+}
+
+// Creates a device with ray tracing enabled, returns nullopt when no present device supports it.
+static auto create_ray_tracing_device(daxa::Instance & instance) -> std::optional<daxa::Device>
+{
+    try
+    {
+        return instance.create_device({
+            .selector = [](daxa::DeviceProperties const & prop) -> i32
+            {
+                auto default_value = daxa::default_device_score(prop);
+                return prop.ray_tracing_properties.has_value() ? default_value : -1;
+            },
+            .flags = daxa::DeviceFlagBits::RAY_TRACING,
+            .name = "ray tracing device",
+        });
+    }
+    catch (std::runtime_error const &)
+    {
+        return std::nullopt;
+    }
+}
+
+struct TriangleMesh
+{
+    daxa::BufferId buffer = {};
+    daxa::BlasTriangleGeometryInfo geometry = {};
+};
+
+// Creates a host visible buffer holding the vertices and indices of triangle_count triangles, stacked along z.
+static auto create_triangle_mesh(daxa::Device & device, u32 triangle_count) -> TriangleMesh
+{
+    u32 const vertex_count = triangle_count * 3;
+    daxa::BufferId buffer = device.create_buffer({
+        .size = vertex_count * (sizeof(f32) * 3 + sizeof(u32)),
+        .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+        .name = "triangle mesh",
+    });
+    f32 * vertices = device.get_host_address_as<f32>(buffer).value();
+    u32 * indices = reinterpret_cast<u32 *>(vertices + vertex_count * 3);
+    for (u32 i = 0; i < vertex_count; ++i)
+    {
+        vertices[i * 3 + 0] = static_cast<f32>(i % 3 == 1);
+        vertices[i * 3 + 1] = static_cast<f32>(i % 3 == 2);
+        vertices[i * 3 + 2] = static_cast<f32>(i / 3);
+        indices[i] = i;
+    }
+    daxa::DeviceAddress const device_address = device.get_device_address(buffer).value();
+    return TriangleMesh{
+        .buffer = buffer,
+        .geometry = {
+            .vertex_format = daxa::Format::R32G32B32_SFLOAT,
+            .vertex_data = device_address,
+            .vertex_stride = sizeof(f32) * 3,
+            .max_vertex = vertex_count - 1,
+            .index_type = daxa::IndexType::uint32,
+            .index_data = device_address + sizeof(f32) * 3 * vertex_count,
+            .count = triangle_count,
+        },
+    };
+}
+
+static void blas_compactor(daxa::Instance & instance)
+{
+    auto opt_device = create_ray_tracing_device(instance);
+    if (!opt_device.has_value())
+    {
+        std::cout << "Test \"blas_compactor\" skipped. No present device supports raytracing!" << std::endl;
+        return;
+    }
+    daxa::Device & device = opt_device.value();
+    static constexpr u32 BLAS_COUNT = 3;
+    std::array<TriangleMesh, BLAS_COUNT> meshes = {};
+    std::array<daxa::BlasBuildInfo, BLAS_COUNT> build_infos = {};
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        meshes[i] = create_triangle_mesh(device, 16 * (i + 1));
+        build_infos[i] = daxa::BlasBuildInfo{
+            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE |
+                     daxa::AccelerationStructureBuildFlagBits::ALLOW_COMPACTION,
+            .geometries = daxa::Span<daxa::BlasTriangleGeometryInfo const>{&meshes[i].geometry, 1},
+        };
+    }
+    daxa::BlasBatchBuilder builder{daxa::BlasBatchBuilderInfo{
+        .device = device,
+        .name = "blas compactor test builder",
+    }};
+    daxa::BlasCompactor compactor{daxa::BlasCompactorInfo{
+        .device = device,
+        .name = "blas compactor",
+    }};
+
+    daxa::CommandRecorder build_cmd = device.create_command_recorder({});
+    auto const blas = builder.build(build_cmd, build_infos);
+    build_cmd.pipeline_barrier({
+        .src_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+        .dst_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ,
+    });
+    compactor.enqueue(build_cmd, blas);
+    // The compacted sizes are not written before the gpu executed the queries.
+    if (!compactor.compact(build_cmd).empty() || compactor.pending_count() != BLAS_COUNT)
+    {
+        std::cout << "failed test \"blas_compactor\": blas were compacted before their size queries finished" << std::endl;
+        exit(-1);
+    }
+    auto build_signals = std::array{std::pair{compactor.timeline_semaphore(), compactor.timeline_value()}};
+    device.submit_commands({
+        .command_lists = std::array{build_cmd.complete_current_commands()},
+        .signal_timeline_semaphores = build_signals,
+    });
+    device.wait_idle();
+
+    daxa::CommandRecorder compact_cmd = device.create_command_recorder({});
+    auto const compactions = compactor.compact(compact_cmd);
+    device.submit_commands({
+        .command_lists = std::array{compact_cmd.complete_current_commands()},
+    });
+    device.wait_idle();
+    device.collect_garbage();
+
+    if (compactions.size() != BLAS_COUNT || compactor.pending_count() != 0)
+    {
+        std::cout << "failed test \"blas_compactor\": not all enqueued blas were compacted" << std::endl;
+        exit(-1);
+    }
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        auto const & compaction = compactions[i];
+        if (compaction.original != blas[i] || !device.is_id_valid(compaction.compacted) || device.is_id_valid(compaction.original))
+        {
+            std::cout << "failed test \"blas_compactor\": compacted blas is invalid or the original was not destroyed" << std::endl;
+            exit(-1);
+        }
+        if (compaction.compacted_size == 0 || compaction.compacted_size > compaction.original_size ||
+            device.info_blas(compaction.compacted).value().size != compaction.compacted_size)
+        {
+            std::cout << "failed test \"blas_compactor\": invalid compacted size " << compaction.compacted_size << std::endl;
+            exit(-1);
+        }
+        device.destroy_blas(compaction.compacted);
+        device.destroy_buffer(meshes[i].buffer);
+    }
+}
+
+static void blas_batch_builder(daxa::Instance & instance)
+{
+    auto opt_device = create_ray_tracing_device(instance);
+    if (!opt_device.has_value())
+    {
+        std::cout << "Test \"blas_batch_builder\" skipped. No present device supports raytracing!" << std::endl;
+        return;
+    }
+    daxa::Device & device = opt_device.value();
+    static constexpr u32 BLAS_COUNT = 6;
+    std::array<TriangleMesh, BLAS_COUNT> meshes = {};
+    std::array<daxa::BlasBuildInfo, BLAS_COUNT> build_infos = {};
+    std::array<daxa::AccelerationStructureBuildSizesInfo, BLAS_COUNT> build_sizes = {};
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        meshes[i] = create_triangle_mesh(device, 8 << i);
+        build_infos[i] = daxa::BlasBuildInfo{
+            .geometries = daxa::Span<daxa::BlasTriangleGeometryInfo const>{&meshes[i].geometry, 1},
+        };
+        build_sizes[i] = device.get_blas_build_sizes(build_infos[i]);
+    }
+    // The first blas is created by the caller and must be built in place.
+    daxa::BlasId const caller_blas = device.create_blas({
+        .size = build_sizes[0].acceleration_structure_size,
+        .name = "caller created blas",
+    });
+    build_infos[0].dst_blas = caller_blas;
+    // A budget of a single build forces the builds into several batches that reuse the scratch memory.
+    daxa::BlasBatchBuilder builder{daxa::BlasBatchBuilderInfo{
+        .device = device,
+        .scratch_budget = 1,
+        .name = "blas batch builder",
+    }};
+
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    auto const blas = builder.build(cmd, build_infos);
+    cmd.pipeline_barrier({
+        .src_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+        .dst_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ,
+    });
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+    });
+    device.wait_idle();
+
+    if (blas.size() != BLAS_COUNT || blas[0] != caller_blas)
+    {
+        std::cout << "failed test \"blas_batch_builder\": built blas do not match the build infos" << std::endl;
+        exit(-1);
+    }
+    u64 max_scratch_size = 0;
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        if (!device.is_id_valid(blas[i]) || device.info_blas(blas[i]).value().size != build_sizes[i].acceleration_structure_size)
+        {
+            std::cout << "failed test \"blas_batch_builder\": blas " << i << " is invalid or has the wrong size" << std::endl;
+            exit(-1);
+        }
+        max_scratch_size = std::max(max_scratch_size, build_sizes[i].build_scratch_size);
+    }
+    // Every batch holds a single build, so the scratch buffer only needs to fit the largest one, not all of them.
+    u64 const scratch_alignment = device.properties().acceleration_structure_properties.value().min_acceleration_structure_scratch_offset_alignment;
+    if (!device.is_id_valid(builder.scratch_buffer()) ||
+        device.info_buffer(builder.scratch_buffer()).value().size > max_scratch_size + 2 * scratch_alignment)
+    {
+        std::cout << "failed test \"blas_batch_builder\": scratch buffer is missing or was not reused between batches" << std::endl;
+        exit(-1);
+    }
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        device.destroy_blas(blas[i]);
+        device.destroy_buffer(meshes[i].buffer);
+    }
+}
+
+static void blas_batch_builder_update(daxa::Instance & instance)
+{
+    auto opt_device = create_ray_tracing_device(instance);
+    if (!opt_device.has_value())
+    {
+        std::cout << "Test \"blas_batch_builder_update\" skipped. No present device supports raytracing!" << std::endl;
+        return;
+    }
+    daxa::Device & device = opt_device.value();
+    static constexpr u32 BLAS_COUNT = 4;
+    std::array<TriangleMesh, BLAS_COUNT> meshes = {};
+    std::array<daxa::BlasBuildInfo, BLAS_COUNT> build_infos = {};
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        meshes[i] = create_triangle_mesh(device, 64 << i);
+        build_infos[i] = daxa::BlasBuildInfo{
+            .flags = daxa::AccelerationStructureBuildFlagBits::ALLOW_UPDATE,
+            .geometries = daxa::Span<daxa::BlasTriangleGeometryInfo const>{&meshes[i].geometry, 1},
+        };
+    }
+    daxa::BlasBatchBuilder build_builder{daxa::BlasBatchBuilderInfo{
+        .device = device,
+        .name = "blas batch builder (build)",
+    }};
+    daxa::CommandRecorder cmd = device.create_command_recorder({});
+    auto const blas = build_builder.build(cmd, build_infos);
+    device.submit_commands({
+        .command_lists = std::array{cmd.complete_current_commands()},
+    });
+    device.wait_idle();
+
+    // Refit every blas in place.
+    u64 const scratch_alignment = device.properties().acceleration_structure_properties.value().min_acceleration_structure_scratch_offset_alignment;
+    u64 update_scratch_size = 0;
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        build_infos[i].dst_blas = blas[i];
+        build_infos[i].src_blas = blas[i];
+        auto const build_sizes = device.get_blas_build_sizes(build_infos[i]);
+        update_scratch_size += (build_sizes.update_scratch_size + scratch_alignment - 1) / scratch_alignment * scratch_alignment;
+    }
+    daxa::BlasBatchBuilder update_builder{daxa::BlasBatchBuilderInfo{
+        .device = device,
+        .name = "blas batch builder (update)",
+    }};
+    daxa::CommandRecorder update_cmd = device.create_command_recorder({});
+    auto const updated_blas = update_builder.build(update_cmd, build_infos);
+    device.submit_commands({
+        .command_lists = std::array{update_cmd.complete_current_commands()},
+    });
+    device.wait_idle();
+
+    if (updated_blas != blas)
+    {
+        std::cout << "failed test \"blas_batch_builder_update\": updates did not write into the source blas" << std::endl;
+        exit(-1);
+    }
+    // All updates fit into one batch, whose scratch memory is sized by the update scratch sizes, not the build scratch sizes.
+    if (device.info_buffer(update_builder.scratch_buffer()).value().size > update_scratch_size + scratch_alignment)
+    {
+        std::cout << "failed test \"blas_batch_builder_update\": update builds reserved the scratch size of full builds" << std::endl;
+        exit(-1);
+    }
+    for (u32 i = 0; i < BLAS_COUNT; ++i)
+    {
+        device.destroy_blas(blas[i]);
+        device.destroy_buffer(meshes[i].buffer);
+    }
+}
+
 auto main() -> int
 {
     daxa::Instance daxa_ctx = daxa::create_instance({});
@@ -92,6 +880,15 @@ auto main() -> int
         }
     }
     device.destroy_buffer(result_buffer);
+    transfer_memory_pool_threaded_growth(device);
+    buffer_suballocator(device);
+    upload_queue(device);
+    upload_queue_image(device);
+    readback_ring(device);
+    readback_ring_image(device);
     device.collect_garbage();
+    blas_compactor(daxa_ctx);
+    blas_batch_builder(daxa_ctx);
+    blas_batch_builder_update(daxa_ctx);
     std::cout << std::flush;
 }
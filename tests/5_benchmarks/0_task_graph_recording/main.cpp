@@ -0,0 +1,191 @@
+#include <daxa/daxa.hpp>
+#include <daxa/utils/task_graph.hpp>
+
+#include <chrono>
+#include <iostream>
+
+#define APPNAME "Daxa Benchmark TaskGraph Recording"
+#define APPNAME_PREFIX(x) ("[" APPNAME "] " x)
+
+using namespace daxa::types;
+using Clock = std::chrono::steady_clock;
+
+namespace benchmarks
+{
+    auto elapsed_ms(Clock::time_point begin, Clock::time_point end) -> f64
+    {
+        return std::chrono::duration<f64, std::milli>(end - begin).count();
+    }
+
+    // Records a synthetic graph similar to procedurally generated frames:
+    // Per tile tasks write tile buffers from a shared input, per light tasks read all tiles of their cluster and write a light buffer.
+    // Every few hundred tasks, a transient image is written and read to exercise image state tracking.
+    void record_synthetic_graph(daxa::Device & device, u32 task_count, bool cull_dead_tasks)
+    {
+        using namespace daxa::task_resource_uses;
+        constexpr u32 TILE_COUNT = 256;
+        constexpr u32 LIGHT_COUNT = 64;
+        constexpr u32 TILES_PER_LIGHT = 4;
+
+        auto input_buffer = daxa::TaskBuffer({.name = "input"});
+        std::vector<daxa::TaskBuffer> tile_buffers = {};
+        std::vector<daxa::TaskBuffer> light_buffers = {};
+        for (u32 i = 0; i < TILE_COUNT; ++i)
+        {
+            tile_buffers.push_back(daxa::TaskBuffer({.name = std::string("tile ") + std::to_string(i)}));
+        }
+        for (u32 i = 0; i < LIGHT_COUNT; ++i)
+        {
+            light_buffers.push_back(daxa::TaskBuffer({.name = std::string("light ") + std::to_string(i)}));
+        }
+
+        auto const record_begin = Clock::now();
+        auto task_graph = daxa::TaskGraph({
+            .device = device,
+            .cull_dead_tasks = cull_dead_tasks,
+            .name = APPNAME_PREFIX("synthetic task graph"),
+        });
+        task_graph.use_persistent_buffer(input_buffer);
+        for (auto const & tile_buffer : tile_buffers)
+        {
+            task_graph.use_persistent_buffer(tile_buffer);
+        }
+        for (auto const & light_buffer : light_buffers)
+        {
+            task_graph.use_persistent_buffer(light_buffer);
+        }
+        for (u32 task_i = 0; task_i < task_count; ++task_i)
+        {
+            if (task_i % 512 == 511)
+            {
+                auto image = task_graph.create_transient_image({
+                    .size = {64, 64, 1},
+                    .mip_level_count = 4,
+                    .name = std::string("scratch image ") + std::to_string(task_i),
+                });
+                task_graph.add_task({
+                    .uses = {ImageComputeShaderStorageWriteOnly<>{image.view({.level_count = 4})}},
+                    .task = [](daxa::TaskInterface const &) {},
+                    .name = "scratch write",
+                });
+                task_graph.add_task({
+                    .uses = {ImageComputeShaderSampled<>{image.view({.level_count = 4})}, BufferComputeShaderWrite{light_buffers[task_i % LIGHT_COUNT]}},
+                    .task = [](daxa::TaskInterface const &) {},
+                    .name = "scratch read",
+                });
+                task_i += 1;
+            }
+            else if (task_i % 4 != 3)
+            {
+                task_graph.add_task({
+                    .uses = {BufferComputeShaderRead{input_buffer}, BufferComputeShaderWrite{tile_buffers[task_i % TILE_COUNT]}},
+                    .task = [](daxa::TaskInterface const &) {},
+                    .name = "tile",
+                });
+            }
+            else
+            {
+                u32 const light = (task_i / 4) % LIGHT_COUNT;
+                std::vector<daxa::GenericTaskResourceUse> uses = {BufferComputeShaderWrite{light_buffers[light]}};
+                for (u32 tile = 0; tile < TILES_PER_LIGHT; ++tile)
+                {
+                    uses.push_back(BufferComputeShaderRead{tile_buffers[(light * TILES_PER_LIGHT + tile) % TILE_COUNT]});
+                }
+                task_graph.add_task({
+                    .uses = std::move(uses),
+                    .task = [](daxa::TaskInterface const &) {},
+                    .name = "light",
+                });
+            }
+        }
+        task_graph.submit({});
+        auto const record_end = Clock::now();
+        task_graph.complete({});
+        auto const complete_end = Clock::now();
+
+        auto const stats = task_graph.get_schedule_stats();
+        f64 const record_ms = elapsed_ms(record_begin, record_end);
+        f64 const complete_ms = elapsed_ms(record_end, complete_end);
+        std::cout << task_count << " tasks" << (cull_dead_tasks ? " (culling)" : "")
+                  << ": record " << record_ms << " ms (" << record_ms * 1000.0 / task_count << " us/task)"
+                  << ", complete " << complete_ms << " ms (" << complete_ms * 1000.0 / task_count << " us/task)"
+                  << ", " << stats.batch_count << " batches, " << stats.merged_barrier_count << " merged barriers" << std::endl;
+    }
+
+    // Records the mipmapping pattern on an image with a full mip chain and many layers:
+    // Each task reads one mip of one layer and writes the next, every full chain over all layers is followed by a read of the entire image.
+    // This fragments the tracked subresources of the image as much as a real mip generation pass does.
+    void record_mip_chain_graph(daxa::Device & device, u32 task_count)
+    {
+        using namespace daxa::task_resource_uses;
+        constexpr u32 MIP_LEVEL_COUNT = 13;
+        constexpr u32 ARRAY_LAYER_COUNT = 6;
+
+        auto const record_begin = Clock::now();
+        auto task_graph = daxa::TaskGraph({
+            .device = device,
+            .name = APPNAME_PREFIX("mip chain task graph"),
+        });
+        auto task_image = task_graph.create_transient_image({
+            .size = {1u << (MIP_LEVEL_COUNT - 1), 1u << (MIP_LEVEL_COUNT - 1), 1},
+            .mip_level_count = MIP_LEVEL_COUNT,
+            .array_layer_count = ARRAY_LAYER_COUNT,
+            .name = "mip chain image",
+        });
+        u32 recorded_task_count = 0;
+        while (recorded_task_count < task_count)
+        {
+            for (u32 layer = 0; layer < ARRAY_LAYER_COUNT && recorded_task_count < task_count; ++layer)
+            {
+                for (u32 mip = 0; mip < MIP_LEVEL_COUNT - 1 && recorded_task_count < task_count; ++mip, ++recorded_task_count)
+                {
+                    task_graph.add_task({
+                        .uses = {
+                            ImageTransferRead<>{task_image.view().view({.base_mip_level = mip, .base_array_layer = layer})},
+                            ImageTransferWrite<>{task_image.view().view({.base_mip_level = mip + 1, .base_array_layer = layer})},
+                        },
+                        .task = [](daxa::TaskInterface const &) {},
+                        .name = "mip map",
+                    });
+                }
+            }
+            if (recorded_task_count < task_count)
+            {
+                task_graph.add_task({
+                    .uses = {ImageComputeShaderSampled<>{task_image.view().view({.level_count = MIP_LEVEL_COUNT, .layer_count = ARRAY_LAYER_COUNT})}},
+                    .task = [](daxa::TaskInterface const &) {},
+                    .name = "read mip chain",
+                });
+                ++recorded_task_count;
+            }
+        }
+        task_graph.submit({});
+        auto const record_end = Clock::now();
+        task_graph.complete({});
+        auto const complete_end = Clock::now();
+
+        f64 const record_ms = elapsed_ms(record_begin, record_end);
+        f64 const complete_ms = elapsed_ms(record_end, complete_end);
+        std::cout << task_count << " mip chain tasks"
+                  << ": record " << record_ms << " ms (" << record_ms * 1000.0 / task_count << " us/task)"
+                  << ", complete " << complete_ms << " ms (" << complete_ms * 1000.0 / task_count << " us/task)" << std::endl;
+    }
+} // namespace benchmarks
+
+auto main() -> i32
+{
+    daxa::Instance instance = daxa::create_instance({});
+    daxa::Device device = instance.create_device({.name = APPNAME_PREFIX("device")});
+#if DAXA_VALIDATION
+    std::cout << "note: validation is enabled, recording includes validation checks" << std::endl;
+#endif
+    for (u32 task_count : {1'000u, 4'000u, 16'000u, 64'000u})
+    {
+        benchmarks::record_synthetic_graph(device, task_count, false);
+    }
+    benchmarks::record_synthetic_graph(device, 16'000u, true);
+    for (u32 task_count : {1'000u, 4'000u})
+    {
+        benchmarks::record_mip_chain_graph(device, task_count);
+    }
+}
@@ -0,0 +1,141 @@
+#include <daxa/daxa.hpp>
+
+#include <chrono>
+#include <iostream>
+
+#define APPNAME "Daxa Benchmark Resource Creation"
+#define APPNAME_PREFIX(x) ("[" APPNAME "] " x)
+
+using namespace daxa::types;
+using Clock = std::chrono::steady_clock;
+
+namespace benchmarks
+{
+    auto elapsed_ms(Clock::time_point begin, Clock::time_point end) -> f64
+    {
+        return std::chrono::duration<f64, std::milli>(end - begin).count();
+    }
+
+    void print_timings(char const * name, u32 count, bool batched, f64 create_ms, f64 destroy_ms)
+    {
+        std::cout << count << " " << name << (batched ? " (batched)" : " (per call)")
+                  << ": create " << create_ms << " ms (" << create_ms * 1000.0 / count << " us/resource)"
+                  << ", destroy " << destroy_ms << " ms (" << destroy_ms * 1000.0 / count << " us/resource)" << std::endl;
+    }
+
+    // Creates and destroys many small buffers, like streaming in a level chunk would.
+    void buffer_throughput(daxa::Device & device, u32 count, bool batched)
+    {
+        std::vector<daxa::BufferInfo> infos(count, daxa::BufferInfo{.size = 256, .name = "streamed buffer"});
+        std::vector<daxa::BufferId> buffers = {};
+
+        auto const create_begin = Clock::now();
+        if (batched)
+        {
+            buffers = device.create_buffers(infos);
+        }
+        else
+        {
+            buffers.reserve(count);
+            for (auto const & info : infos)
+            {
+                buffers.push_back(device.create_buffer(info));
+            }
+        }
+        auto const create_end = Clock::now();
+        if (batched)
+        {
+            device.destroy_buffers(buffers);
+        }
+        else
+        {
+            for (auto const & buffer : buffers)
+            {
+                device.destroy_buffer(buffer);
+            }
+        }
+        auto const destroy_end = Clock::now();
+        device.collect_garbage();
+
+        print_timings("buffers", count, batched, elapsed_ms(create_begin, create_end), elapsed_ms(create_end, destroy_end));
+    }
+
+    // Creates and destroys many small sampled images and an extra view for each of them.
+    void image_throughput(daxa::Device & device, u32 count, bool batched)
+    {
+        std::vector<daxa::ImageInfo> infos(count, daxa::ImageInfo{
+                                                      .format = daxa::Format::R8G8B8A8_UNORM,
+                                                      .size = {16, 16, 1},
+                                                      .usage = daxa::ImageUsageFlagBits::SHADER_SAMPLED,
+                                                      .name = "streamed image",
+                                                  });
+        std::vector<daxa::ImageId> images = {};
+        std::vector<daxa::ImageViewId> image_views = {};
+
+        auto const create_begin = Clock::now();
+        if (batched)
+        {
+            images = device.create_images(infos);
+        }
+        else
+        {
+            images.reserve(count);
+            for (auto const & info : infos)
+            {
+                images.push_back(device.create_image(info));
+            }
+        }
+        std::vector<daxa::ImageViewInfo> view_infos = {};
+        view_infos.reserve(count);
+        for (auto const & image : images)
+        {
+            view_infos.push_back({.format = daxa::Format::R8G8B8A8_UNORM, .image = image, .name = "streamed image view"});
+        }
+        if (batched)
+        {
+            image_views = device.create_image_views(view_infos);
+        }
+        else
+        {
+            image_views.reserve(count);
+            for (auto const & view_info : view_infos)
+            {
+                image_views.push_back(device.create_image_view(view_info));
+            }
+        }
+        auto const create_end = Clock::now();
+        if (batched)
+        {
+            device.destroy_image_views(image_views);
+            device.destroy_images(images);
+        }
+        else
+        {
+            for (auto const & image_view : image_views)
+            {
+                device.destroy_image_view(image_view);
+            }
+            for (auto const & image : images)
+            {
+                device.destroy_image(image);
+            }
+        }
+        auto const destroy_end = Clock::now();
+        device.collect_garbage();
+
+        print_timings("images with views", count, batched, elapsed_ms(create_begin, create_end), elapsed_ms(create_end, destroy_end));
+    }
+} // namespace benchmarks
+
+auto main() -> i32
+{
+    daxa::Instance instance = daxa::create_instance({});
+    daxa::Device device = instance.create_device({.name = APPNAME_PREFIX("device")});
+    for (u32 count : {1'000u, 4'000u})
+    {
+        benchmarks::buffer_throughput(device, count, false);
+        benchmarks::buffer_throughput(device, count, true);
+        benchmarks::image_throughput(device, count, false);
+        benchmarks::image_throughput(device, count, true);
+    }
+}